@@ -82,10 +82,12 @@ def configure_app(app):
 def register_routes(app):
     """Register application routes"""
     from .routes.graph_routes import graph_bp
+    from .routes.timepoint_routes import timepoint_bp
     
     # Register blueprints
     app.register_blueprint(graph_bp)
     app.register_blueprint(component_bp)
+    app.register_blueprint(timepoint_bp)
 
     @app.route("/api/graph-manager/status")
     def graph_manager_status():
@@ -159,33 +161,6 @@ def register_routes(app):
             print(f">>> Returning: {result}")
             return jsonify(result)
 
-    @app.route("/api/timepoints/<int:timepoint_id>")
-    def get_timepoint(timepoint_id):
-        """Get a specific timepoint by ID including its associated graph data."""
-        engine = get_db_engine()
-        with Session(engine) as session:
-            timepoint = session.query(Timepoint).filter(Timepoint.id == timepoint_id).first()
-            if timepoint is None:
-                return jsonify({"error": "Timepoint not found"}), 404
-            
-            # Get graph data from GraphManager
-            response_data = {
-                "id": timepoint.id,
-                "name": timepoint.name,
-                "graph_data": None
-            }
-            
-            try:
-                graph_manager = current_app.graph_manager
-                if graph_manager and timepoint.name in graph_manager.split_graphs:
-                    response_data["graph_data"] = graph_manager.split_graphs[timepoint.name]
-            except Exception as e:
-                print(f"Error retrieving graph data: {str(e)}")
-                # Don't fail the whole request if graph data is unavailable
-                response_data["graph_error"] = str(e)
-            
-            return jsonify(response_data)
-
 
 # Remove the direct configure_app(app) call from here
 
@@ -4,16 +4,34 @@ from dotenv import load_dotenv
 from sqlalchemy.orm import Session
 from sqlalchemy import text
 from .database.connection import get_db_engine
+from .database.profiler import init_sql_profiler
+from .utils.cpu_profiler import init_cpu_profiler
+from .utils.memory_accounting import init_memory_debug
 from .database.models import Timepoint
 from .core.graph_manager import GraphManager
+from .core.datasets import (
+    DEFAULT_DATASET,
+    Dataset,
+    DatasetConfig,
+    DatasetRegistry,
+    get_graph_manager,
+)
 from flask import Flask
 from flask_cors import CORS
 
-from .routes.graph_routes import graph_bp
+from .routes.graph_routes import clear_render_cache, graph_bp
 from .routes.component_routes import component_bp
 from .routes.llm_routes import llm_bp
 from .routes.enrichment_routes import enrichment_bp
 from .routes.edge_routes import edge_bp
+from .routes.overview_routes import overview_bp
+from .routes.legacy_routes import legacy_bp
+from .routes.timepoint_routes import timepoint_bp
+from .routes.statistics_routes import statistics_bp
+from .routes.analytics_routes import analytics_bp
+from .routes.similarity_routes import similarity_bp
+from .routes.dataset_routes import dataset_bp
+from .routes.ingest_routes import ingest_bp
 
 
 def configure_app(app):
@@ -57,6 +75,27 @@ def configure_app(app):
         SECRET_KEY=os.getenv("SECRET_KEY", "dev"),
         DEBUG=os.getenv("DEBUG", "true").lower() == "true",
         CORS_ORIGINS=os.getenv("CORS_ORIGINS", "http://localhost:3000"),
+        SQL_PROFILE=os.getenv("SQL_PROFILE", "false").lower() == "true",
+        SQL_PROFILE_HISTORY=os.getenv("SQL_PROFILE_HISTORY"),
+        SQL_PROFILE_REPEAT_THRESHOLD=os.getenv("SQL_PROFILE_REPEAT_THRESHOLD"),
+        SQL_PROFILE_EXPLAIN_MS=os.getenv("SQL_PROFILE_EXPLAIN_MS"),
+        SQL_PROFILE_TOKEN=os.getenv("SQL_PROFILE_TOKEN"),
+        CPU_PROFILE=os.getenv("CPU_PROFILE", "false").lower() == "true",
+        CPU_PROFILE_TOKEN=os.getenv("CPU_PROFILE_TOKEN"),
+        CPU_PROFILE_DIR=os.getenv("CPU_PROFILE_DIR", os.path.join(data_dir, "profiles")),
+        CPU_PROFILE_HISTORY=os.getenv("CPU_PROFILE_HISTORY"),
+        CPU_PROFILE_MAX_MB=os.getenv("CPU_PROFILE_MAX_MB"),
+        CPU_PROFILE_INTERVAL_MS=os.getenv("CPU_PROFILE_INTERVAL_MS"),
+        CPU_PROFILE_MAX_ACTIVE=os.getenv("CPU_PROFILE_MAX_ACTIVE"),
+        CPU_PROFILE_MAX_EVENTS=os.getenv("CPU_PROFILE_MAX_EVENTS"),
+        MEMORY_DEBUG=os.getenv("MEMORY_DEBUG", "false").lower() == "true",
+        MEMORY_DEBUG_TOKEN=os.getenv("MEMORY_DEBUG_TOKEN"),
+        MEMORY_SNAPSHOTS_KEPT=os.getenv("MEMORY_SNAPSHOTS_KEPT"),
+        MEMORY_TRACE_FRAMES=os.getenv("MEMORY_TRACE_FRAMES"),
+        GRAPH_MEMORY_BUDGET_MB=os.getenv("GRAPH_MEMORY_BUDGET_MB"),
+        DATASETS_FILE=os.getenv(
+            "DATASETS_FILE", os.path.join(project_root, "datasets.json")
+        ),
     )
 
     # Ensure required directories exist
@@ -67,6 +106,21 @@ def configure_app(app):
     # Set configuration
     app.graph_manager = GraphManager(config=app.config)
 
+    # Further cohorts from the dataset manifest, served under /api/datasets/<name>
+    app.datasets = DatasetRegistry(
+        app.config["DATASETS_FILE"],
+        default=Dataset(
+            DatasetConfig(
+                name=DEFAULT_DATASET,
+                data_dir=data_dir,
+                graph_data_dir=graph_data_dir,
+            ),
+            graph_manager=app.graph_manager,
+        ),
+    )
+    # Renders of a replaced or unloaded dataset must not outlive it
+    app.datasets.on_reset(clear_render_cache)
+
     # Initialize CORS
     # CORS(app, resources={r"/*": {"origins": app.config["CORS_ORIGINS"]}})
     # Enable CORS for all routes
@@ -119,6 +173,15 @@ def create_app(test_config=None):
     # Register routes
     register_routes(app)
 
+    # Opt-in SQL profiling (X-SQL-* headers and /debug/requests)
+    init_sql_profiler(app)
+
+    # Opt-in CPU profiling of flagged requests (?profile=cpu, /debug/profiles)
+    init_cpu_profiler(app)
+
+    # Opt-in memory accounting and tracemalloc diffs (/debug/memory)
+    init_memory_debug(app)
+
     return app
 
 
@@ -130,6 +193,14 @@ def register_routes(app):
     app.register_blueprint(llm_bp)
     app.register_blueprint(enrichment_bp)
     app.register_blueprint(edge_bp, url_prefix="/api/edge-details")
+    app.register_blueprint(overview_bp)
+    app.register_blueprint(legacy_bp)
+    app.register_blueprint(timepoint_bp)
+    app.register_blueprint(statistics_bp)
+    app.register_blueprint(analytics_bp)
+    app.register_blueprint(similarity_bp)
+    app.register_blueprint(dataset_bp)
+    app.register_blueprint(ingest_bp)
 
     @app.route("/api/health")
     def health_check():
@@ -165,7 +236,7 @@ def register_routes(app):
     def graph_manager_status():
         """Check GraphManager status"""
         try:
-            graph_manager = current_app.graph_manager
+            graph_manager = get_graph_manager()
             return jsonify(
                 {
                     "status": "ok",
@@ -182,8 +253,15 @@ def register_routes(app):
         """Get all timepoint names from the database."""
         engine = get_db_engine()
         with Session(engine) as session:
-            timepoints = session.query(Timepoint.id, Timepoint.name).all()
-            return jsonify([{"id": t.id, "name": t.name} for t in timepoints])
+            timepoints = session.query(
+                Timepoint.id, Timepoint.name, Timepoint.description
+            ).all()
+            return jsonify(
+                [
+                    {"id": t.id, "name": t.name, "description": t.description}
+                    for t in timepoints
+                ]
+            )
 
     @app.route("/api/dmr/analysis")
     def get_dmr_analysis():
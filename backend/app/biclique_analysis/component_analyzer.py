@@ -7,6 +7,12 @@ from collections import defaultdict
 from .statistics import analyze_components
 from .edge_classification import classify_edges
 from .classifier import BicliqueSizeCategory, classify_component
+from .dominating_diagnostics import (
+    BicliqueIncidence,
+    diagnose_dominating_set,
+    full_component_labels,
+)
+from backend.app.core.graph_arrays import GraphArrays
 from backend.app.utils.edge_info import EdgeInfo
 
 
@@ -19,6 +25,30 @@ class ComponentAnalyzer:
         self.bicliques_result = bicliques_result
         # Use provided biclique graph or create new one
         self.biclique_graph = biclique_graph if biclique_graph is not None else self._create_biclique_graph()
+        self._graph_arrays = None
+        self._biclique_incidence = None
+
+    @property
+    def graph_arrays(self) -> GraphArrays:
+        """CSR arrays and component labels of the original graph, built once."""
+        if self._graph_arrays is None:
+            self._graph_arrays = GraphArrays.from_networkx(self.bipartite_graph)
+        return self._graph_arrays
+
+    @property
+    def biclique_incidence(self) -> BicliqueIncidence:
+        """DMR -> biclique index, built once."""
+        if self._biclique_incidence is None:
+            self._biclique_incidence = BicliqueIncidence.from_bicliques(
+                self.bicliques_result["bicliques"]
+            )
+        return self._biclique_incidence
+
+    def diagnose_dominating_set(self, dominating_set: Set[int]) -> Dict:
+        """Coverage, per-component and redundancy diagnostics in one pass."""
+        return diagnose_dominating_set(
+            self.graph_arrays, self.biclique_incidence, dominating_set
+        )
 
     def _create_biclique_graph(self) -> nx.Graph:
         """Create graph from bicliques."""
@@ -86,44 +116,41 @@ class ComponentAnalyzer:
 
     def _analyze_dominating_set(self, dominating_set: Set[int]) -> Dict:
         """Calculate statistics about the dominating set."""
-        dmr_nodes = {
-            n for n, d in self.bipartite_graph.nodes(data=True) if d["bipartite"] == 0
-        }
-        gene_nodes = {
-            n for n, d in self.bipartite_graph.nodes(data=True) if d["bipartite"] == 1
+        diagnostics = self.diagnose_dominating_set(dominating_set)
+        return {
+            **self._coverage_summary(dominating_set, diagnostics),
+            "components_with_ds": len(diagnostics["component_sizes"]),
+            "avg_size_per_component": self._avg_size(dominating_set, diagnostics),
         }
 
-        # Calculate dominated genes
-        dominated_genes = set()
-        for dmr in dominating_set:
-            dominated_genes.update(self.bipartite_graph.neighbors(dmr))
-
+    def _coverage_summary(self, dominating_set: Set[int], diagnostics: Dict) -> Dict:
+        summary = self.graph_arrays.summary()
+        num_dmrs, num_genes = summary["num_dmrs"], summary["num_genes"]
+        genes_dominated = len(diagnostics["certificate"])
         return {
             "size": len(dominating_set),
-            "percentage": len(dominating_set) / len(dmr_nodes) if dmr_nodes else 0,
-            "genes_dominated": len(dominated_genes),
-            "genes_dominated_percentage": len(dominated_genes) / len(gene_nodes)
-            if gene_nodes
+            "percentage": len(dominating_set) / num_dmrs if num_dmrs else 0,
+            "genes_dominated": genes_dominated,
+            "genes_dominated_percentage": genes_dominated / num_genes
+            if num_genes
             else 0,
-            "components_with_ds": self._count_components_with_dominating_nodes(
-                dominating_set
-            ),
-            "avg_size_per_component": self._calculate_avg_size_per_component(
-                dominating_set
-            ),
         }
 
+    @staticmethod
+    def _avg_size(dominating_set: Set[int], diagnostics: Dict) -> float:
+        if not diagnostics["num_components"]:
+            return 0.0
+        return len(dominating_set) / diagnostics["num_components"]
+
     def _count_components_with_dominating_nodes(self, dominating_set: Set[int]) -> int:
         """Count components containing dominating nodes."""
-        components = nx.connected_components(self.bipartite_graph)
-        return sum(1 for comp in components if comp & dominating_set)
+        return len(self.diagnose_dominating_set(dominating_set)["component_sizes"])
 
     def _calculate_avg_size_per_component(self, dominating_set: Set[int]) -> float:
         """Calculate average dominating set size per component."""
-        components = list(nx.connected_components(self.bipartite_graph))
-        if not components:
-            return 0.0
-        return len(dominating_set) / len(components)
+        return self._avg_size(
+            dominating_set, self.diagnose_dominating_set(dominating_set)
+        )
 
     def get_edge_classifications(self) -> Dict[str, List[EdgeInfo]]:
         """Get edge classifications between original and biclique graphs."""
@@ -143,46 +170,29 @@ class ComponentAnalyzer:
             List of (biclique_id, set of DMRs from dominating set) tuples
             where the biclique has more than one DMR in the dominating set
         """
-        redundant_opportunities = []
-
-        for idx, (dmr_nodes, _) in enumerate(self.bicliques_result["bicliques"]):
-            dmrs_in_ds = dmr_nodes & dominating_set
-            if len(dmrs_in_ds) > 1:
-                # Found a biclique with multiple dominating DMRs
-                redundant_opportunities.append((idx, dmrs_in_ds))
-
-        return redundant_opportunities
+        return self.diagnose_dominating_set(dominating_set)["redundant_bicliques"]
 
     def validate_dominating_set(self, dominating_set: Set[int]) -> bool:
         """
         Validate that the dominating set properly dominates all components.
         """
-        biclique_ds_nodes = defaultdict(set)
-
-        components = list(nx.connected_components(self.bipartite_graph))
-        for idx, comp in enumerate(components):
-            ds_nodes = comp & dominating_set
-            if not ds_nodes:
-                raise ValueError(
-                    f"Component {idx} (size {len(comp)}) has no dominating nodes"
-                )
-
-            # Check if component has multiple dominating nodes in same biclique
-            for dmr in ds_nodes:
-                for bic_idx, (dmr_nodes, _) in enumerate(
-                    self.bicliques_result["bicliques"]
-                ):
-                    if dmr in dmr_nodes:
-                        biclique_ds_nodes[bic_idx].add(dmr)
-
-            # Report potential optimizations
-            for bic_idx, dmrs in biclique_ds_nodes.items():
-                if len(dmrs) > 1:
-                    print(
-                        f"Warning: Biclique {bic_idx} in component {idx} has "
-                        f"{len(dmrs)} dominating nodes: {dmrs}"
-                    )
-                    print("Consider removing redundant dominating nodes")
+        diagnostics = self.diagnose_dominating_set(dominating_set)
+
+        if diagnostics["components_without_ds"]:
+            labels, _ = full_component_labels(self.graph_arrays)
+            idx = diagnostics["components_without_ds"][0]
+            size = int((labels == idx).sum())
+            raise ValueError(
+                f"Component {idx} (size {size}) has no dominating nodes"
+            )
+
+        # Report potential optimizations
+        for bic_idx, dmrs in diagnostics["redundant_bicliques"]:
+            print(
+                f"Warning: Biclique {bic_idx} has "
+                f"{len(dmrs)} dominating nodes: {dmrs}"
+            )
+            print("Consider removing redundant dominating nodes")
 
         return True
 
@@ -243,32 +253,21 @@ class ComponentAnalyzer:
 
         Returns:
             Dictionary containing:
-            - Basic stats (size, coverage)
+            - Basic stats (size, coverage, undominated genes)
+            - Per-component counts and individually removable DMRs
             - Redundancy analysis
             - Optimization opportunities
         """
-        dmr_nodes = {
-            n for n, d in self.bipartite_graph.nodes(data=True) if d["bipartite"] == 0
-        }
-        gene_nodes = {
-            n for n, d in self.bipartite_graph.nodes(data=True) if d["bipartite"] == 1
-        }
-
-        # Find redundancies
-        redundant = self.find_redundant_dominating_nodes(dominating_set)
-
-        # Calculate dominated genes
-        dominated_genes = set()
-        for dmr in dominating_set:
-            dominated_genes.update(self.bipartite_graph.neighbors(dmr))
+        diagnostics = self.diagnose_dominating_set(dominating_set)
+        redundant = diagnostics["redundant_bicliques"]
 
         return {
-            "size": len(dominating_set),
-            "percentage": len(dominating_set) / len(dmr_nodes) if dmr_nodes else 0,
-            "genes_dominated": len(dominated_genes),
-            "genes_dominated_percentage": len(dominated_genes) / len(gene_nodes)
-            if gene_nodes
-            else 0,
+            **self._coverage_summary(dominating_set, diagnostics),
+            "undominated_genes": diagnostics["undominated_genes"],
+            "components_with_ds": len(diagnostics["component_sizes"]),
+            "components_without_ds": len(diagnostics["components_without_ds"]),
+            "avg_size_per_component": self._avg_size(dominating_set, diagnostics),
+            "removable_dmrs": diagnostics["removable_dmrs"],
             "redundancy_analysis": {
                 "bicliques_with_multiple_ds": len(redundant),
                 "potential_reductions": sum(len(dmrs) - 1 for _, dmrs in redundant),
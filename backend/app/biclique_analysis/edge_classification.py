@@ -4,7 +4,15 @@
 from typing import Dict, List, Tuple, Set, Union, Any
 from collections import defaultdict
 import networkx as nx
-
+import numpy as np
+
+from backend.app import native
+from backend.app.core.bitset_adjacency import BitsetAdjacency, is_dense, row_popcount
+from backend.app.biclique_analysis.edge_keys import (
+    graph_edge_keys,
+    pack_edge_keys,
+    unpack_edge_keys,
+)
 from backend.app.utils.edge_info import EdgeInfo
 from backend.app.biclique_analysis.classifier import BicliqueSizeCategory
 from backend.app.utils.json_utils import convert_for_json
@@ -149,29 +157,34 @@ def classify_edges(
 
     # Get all edges from both graphs
     original_edges = set(original_graph.edges())
-    biclique_edges = set(biclique_graph.edges())
 
-    # Classify each edge
-    for u, v in original_edges:
-        edge = (u, v) if u < v else (v, u)
+    if native.available():
+        _classify_edges_native(
+            original_graph, biclique_graph, simple_biclique_edges, edge_sources, classifications
+        )
+    else:
+        biclique_edges = set(biclique_graph.edges())
+        # Classify each edge
+        for u, v in original_edges:
+            edge = (u, v) if u < v else (v, u)
         
-        if edge in simple_biclique_edges:
-            classifications["permanent"].append(
-                EdgeInfo(edge=edge, sources=edge_sources[edge])
-            )
-        elif biclique_graph.has_edge(u, v):
-            classifications["permanent"].append(
-                EdgeInfo(edge=edge, sources=edge_sources.get(edge, set()))
-            )
-        else:
-            classifications["false_positive"].append(
-                EdgeInfo(edge=edge, sources=edge_sources.get(edge, set()))
-            )
+            if edge in simple_biclique_edges:
+                classifications["permanent"].append(
+                    EdgeInfo(edge=edge, sources=edge_sources[edge])
+                )
+            elif biclique_graph.has_edge(u, v):
+                classifications["permanent"].append(
+                    EdgeInfo(edge=edge, sources=edge_sources.get(edge, set()))
+                )
+            else:
+                classifications["false_positive"].append(
+                    EdgeInfo(edge=edge, sources=edge_sources.get(edge, set()))
+                )
 
-    # 3. Edges only in biclique graph are false negatives
-    for u, v in biclique_edges - original_edges:
-        edge = (min(u, v), max(u, v))
-        classifications["false_negative"].append(EdgeInfo(edge, sources=set()))
+        # 3. Edges only in biclique graph are false negatives
+        for u, v in biclique_edges - original_edges:
+            edge = (min(u, v), max(u, v))
+            classifications["false_negative"].append(EdgeInfo(edge, sources=set()))
 
     # Calculate component-wide statistics
     component_stats = calculate_edge_statistics(
@@ -189,20 +202,30 @@ def classify_edges(
     }
 
     if bicliques:
+        bitset_counts = _biclique_edge_counts_bitset(
+            original_graph, biclique_graph, simple_biclique_edges, bicliques
+        )
+        if bitset_counts is None:
+            edges_by_label = {
+                label: {e.edge for e in classifications[label]} for label in classifications
+            }
         for idx, (dmrs, genes) in enumerate(bicliques):
-            biclique_edges = set()
-            for dmr in dmrs:
-                for gene in genes:
-                    edge = (min(dmr, gene), max(dmr, gene))
-                    biclique_edges.add(edge)
+            if bitset_counts is not None:
+                stats = bitset_counts[idx]
+            else:
+                biclique_edges = set()
+                for dmr in dmrs:
+                    for gene in genes:
+                        edge = (min(dmr, gene), max(dmr, gene))
+                        biclique_edges.add(edge)
+
+                stats = {
+                    "total_edges": len(biclique_edges),
+                    "permanent": len(biclique_edges & edges_by_label["permanent"]),
+                    "false_positives": len(biclique_edges & edges_by_label["false_positive"]),
+                    "false_negatives": len(biclique_edges & edges_by_label["false_negative"])
+                }
 
-            stats = {
-                "total_edges": len(biclique_edges),
-                "permanent": sum(1 for e in classifications["permanent"] if e.edge in biclique_edges),
-                "false_positives": sum(1 for e in classifications["false_positive"] if e.edge in biclique_edges),
-                "false_negatives": sum(1 for e in classifications["false_negative"] if e.edge in biclique_edges)
-            }
-            
             biclique_stats["edge_counts"][idx] = stats
             biclique_stats["reliability"][idx] = calculate_edge_statistics(
                 total_edges=stats["total_edges"],
@@ -220,6 +243,80 @@ def classify_edges(
     }
 
 
+def _classify_edges_native(
+    original_graph: nx.Graph,
+    biclique_graph: nx.Graph,
+    simple_biclique_edges: Set[Tuple[int, int]],
+    edge_sources: Dict[Tuple[int, int], Set[str]],
+    classifications: Dict[str, List[EdgeInfo]],
+) -> None:
+    """Fill classifications from a merge of the packed edge keys of both graphs."""
+    original_keys = graph_edge_keys(original_graph)
+    if simple_biclique_edges:
+        simple = np.array(list(simple_biclique_edges), dtype=np.int64)
+        simple_keys = np.unique(pack_edge_keys(simple[:, 0], simple[:, 1]))
+    else:
+        simple_keys = np.empty(0, dtype=np.int64)
+
+    permanent, missing = native.classify_edge_keys(
+        original_keys, graph_edge_keys(biclique_graph), simple_keys
+    )
+    low, high = unpack_edge_keys(original_keys)
+    for u, v, is_permanent in zip(low.tolist(), high.tolist(), permanent.tolist()):
+        edge = (u, v)
+        label = "permanent" if is_permanent else "false_positive"
+        classifications[label].append(EdgeInfo(edge=edge, sources=edge_sources.get(edge, set())))
+
+    low, high = unpack_edge_keys(missing)
+    for u, v in zip(low.tolist(), high.tolist()):
+        classifications["false_negative"].append(EdgeInfo((u, v), sources=set()))
+
+
+def _biclique_edge_counts_bitset(
+    original_graph: nx.Graph,
+    biclique_graph: nx.Graph,
+    simple_biclique_edges: Set[Tuple[int, int]],
+    bicliques: List[Tuple[Set[int], Set[int]]],
+) -> Union[List[Dict[str, int]], None]:
+    """
+    Per-biclique edge label counts from AND/popcount over the biclique cells,
+    or None when the component is too sparse for bitsets (or a biclique node
+    falls outside it).
+    """
+    num_dmrs = sum(1 for _, b in original_graph.nodes(data="bipartite") if b == 0)
+    num_genes = original_graph.number_of_nodes() - num_dmrs
+    if not is_dense(num_dmrs, num_genes, original_graph.number_of_edges()):
+        return None
+
+    try:
+        original = BitsetAdjacency.from_graph(original_graph)
+        in_bicliques = original.with_edges(biclique_graph.edges()).rows
+        kept = in_bicliques | original.with_edges(simple_biclique_edges).rows
+        counts = []
+        for dmrs, genes in bicliques:
+            if not dmrs or not genes:
+                counts.append(
+                    {"total_edges": 0, "permanent": 0, "false_positives": 0, "false_negatives": 0}
+                )
+                continue
+            rows = original.dmr_positions(dmrs)
+            cells = original.gene_mask(genes)
+            present = original.rows[rows] & cells
+            counts.append(
+                {
+                    "total_edges": len(dmrs) * len(genes),
+                    "permanent": int(row_popcount(present & kept[rows]).sum()),
+                    "false_positives": int(row_popcount(present & ~kept[rows]).sum()),
+                    "false_negatives": int(
+                        row_popcount(in_bicliques[rows] & cells & ~present).sum()
+                    ),
+                }
+            )
+    except KeyError:
+        return None
+    return counts
+
+
 def validate_edge_classification(
     classification: Dict[str, Set[Tuple[int, int]]],
     original_graph: nx.Graph,
@@ -0,0 +1,84 @@
+# File edge_keys.py
+# Author: Peter Shaw
+#
+"""Packed integer edge keys for vectorised biclique coverage statistics.
+
+An undirected edge (u, v) is stored as one int64, ``min(u, v) << 32 |
+max(u, v)``, so sets of edges become sorted arrays and membership and
+multiplicity are np.isin / np.unique calls instead of per-cell tuple and
+``has_edge`` work. Node ids must be non-negative and below 2**31, which holds
+for DMR ids and the gene ids starting at START_GENE_ID.
+"""
+
+from typing import List, Set, Tuple
+
+import networkx as nx
+import numpy as np
+
+EDGE_KEY_SHIFT = np.int64(32)
+EDGE_KEY_MASK = np.int64((1 << 32) - 1)
+
+
+def pack_edge_keys(u: np.ndarray, v: np.ndarray) -> np.ndarray:
+    """Orientation-independent keys for the edges (u[i], v[i])."""
+    u = np.asarray(u, dtype=np.int64)
+    v = np.asarray(v, dtype=np.int64)
+    return (np.minimum(u, v) << EDGE_KEY_SHIFT) | np.maximum(u, v)
+
+
+def unpack_edge_keys(keys: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """Inverse of pack_edge_keys, returning (smaller id, larger id)."""
+    keys = np.asarray(keys, dtype=np.int64)
+    return keys >> EDGE_KEY_SHIFT, keys & EDGE_KEY_MASK
+
+
+def graph_edge_keys(graph: nx.Graph) -> np.ndarray:
+    """Sorted, unique keys of all edges in a graph."""
+    if graph.number_of_edges() == 0:
+        return np.empty(0, dtype=np.int64)
+    edges = np.array(list(graph.edges()), dtype=np.int64)
+    return np.unique(pack_edge_keys(edges[:, 0], edges[:, 1]))
+
+
+def node_array(nodes: Set[int]) -> np.ndarray:
+    return np.fromiter(nodes, dtype=np.int64, count=len(nodes))
+
+
+def biclique_cells(
+    bicliques: List[Tuple[Set[int], Set[int]]],
+) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Expand bicliques into their DMR x gene cells.
+
+    Returns:
+        Tuple of (dmr ids, gene ids, biclique index) arrays, one entry per cell,
+        in biclique order
+    """
+    dmr_parts, gene_parts, index_parts = [], [], []
+    for idx, (dmr_nodes, gene_nodes) in enumerate(bicliques):
+        if not dmr_nodes or not gene_nodes:
+            continue
+        dmrs = node_array(dmr_nodes)
+        genes = node_array(gene_nodes)
+        dmr_parts.append(np.repeat(dmrs, genes.size))
+        gene_parts.append(np.tile(genes, dmrs.size))
+        index_parts.append(np.full(dmrs.size * genes.size, idx, dtype=np.int64))
+
+    if not dmr_parts:
+        empty = np.empty(0, dtype=np.int64)
+        return empty, empty, empty
+    return (
+        np.concatenate(dmr_parts),
+        np.concatenate(gene_parts),
+        np.concatenate(index_parts),
+    )
+
+
+def participation_distribution(node_sets: List[Set[int]]) -> dict:
+    """Map 'number of sets a node is in' -> 'number of such nodes'."""
+    non_empty = [node_array(nodes) for nodes in node_sets if nodes]
+    if not non_empty:
+        return {}
+    _, counts = np.unique(np.concatenate(non_empty), return_counts=True)
+    values, frequency = np.unique(counts, return_counts=True)
+    return {int(v): int(f) for v, f in zip(values, frequency)}
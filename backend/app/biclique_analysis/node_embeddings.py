@@ -0,0 +1,330 @@
+"""
+Graph embeddings of genes, DMRs and bicliques for similarity search.
+
+The layouts in ``embeddings.py`` are for display only. This module embeds a
+whole timepoint graph so that nodes can be compared: "which genes are wired
+like this one".
+
+The DMR x gene biadjacency matrix B is degree-normalised,
+D_dmr^-1/2 B D_gene^-1/2, and factored with a randomized truncated SVD. DMRs
+take the rows of U * S and genes the rows of V * S, so both live in one
+space. Nodes with similar neighbourhoods, including a DMR and the genes it is
+linked to, end up close together. A biclique is the mean of its members'
+vectors. All vectors are L2-normalised float32, so the inner product is the
+cosine similarity.
+
+``SimilarityIndex`` answers top-k queries. Up to ``HNSW_MIN_ITEMS`` rows it
+does an exact scan (one matrix-vector product). Above that it uses an HNSW
+graph when hnswlib is installed, and falls back to the exact scan otherwise.
+
+Index files live in ``<GRAPH_DATA_DIR>/embeddings/<timepoint_id>/``. They are
+built at ingest, by initialize_database, on the graph read from the
+timepoint's graph file; the routes only load them.
+"""
+
+import os
+import threading
+from typing import Dict, List, Optional, Set, Tuple
+
+import networkx as nx
+import numpy as np
+import scipy.sparse as sp
+from sklearn.utils.extmath import randomized_svd
+
+try:
+    import hnswlib
+except ImportError:  # optional; exact search is used without it
+    hnswlib = None
+
+DEFAULT_DIMENSIONS = 32
+# An exact scan of 100k x 32 floats takes under a millisecond; HNSW pays off
+# (and is worth its build time) only well beyond that
+HNSW_MIN_ITEMS = 250000
+HNSW_M = 16
+HNSW_EF_CONSTRUCTION = 100
+HNSW_EF_SEARCH = 128
+
+EMBEDDING_FILE = "embedding.npz"
+HNSW_FILE = "hnsw.bin"
+
+# Values of the ``kinds`` array
+DMR, GENE, BICLIQUE = 0, 1, 2
+KIND_NAMES = {DMR: "dmr", GENE: "gene", BICLIQUE: "biclique"}
+KINDS_BY_NAME = {name: kind for kind, name in KIND_NAMES.items()}
+
+
+def _normalize_rows(matrix: np.ndarray) -> np.ndarray:
+    norms = np.linalg.norm(matrix, axis=1, keepdims=True)
+    norms[norms == 0] = 1.0
+    return (matrix / norms).astype(np.float32)
+
+
+def spectral_node_embedding(
+    graph: nx.Graph, dimensions: int = DEFAULT_DIMENSIONS, random_state: int = 42
+) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Embed the non-isolated nodes of a bipartite DMR-gene graph.
+
+    Args:
+        graph: Bipartite graph, DMRs with bipartite=0 and genes with bipartite=1
+        dimensions: Embedding dimension (capped by the graph size)
+        random_state: Seed for the randomized SVD
+
+    Returns:
+        (ids, kinds, vectors): node ids, DMR/GENE kinds and unit float32 rows
+    """
+    linked = [(n, d.get("bipartite")) for n, d in graph.nodes(data=True) if graph.degree(n)]
+    dmrs = sorted(n for n, side in linked if side == 0)
+    genes = sorted(n for n, side in linked if side == 1)
+    if not dmrs or not genes:
+        return np.zeros(0, np.int64), np.zeros(0, np.uint8), np.zeros((0, 0), np.float32)
+
+    dmr_index = {n: i for i, n in enumerate(dmrs)}
+    gene_index = {n: i for i, n in enumerate(genes)}
+    rows, cols = [], []
+    for u, v in graph.edges():
+        if u in gene_index:
+            u, v = v, u
+        if u in dmr_index and v in gene_index:
+            rows.append(dmr_index[u])
+            cols.append(gene_index[v])
+    biadjacency = sp.csr_matrix(
+        (np.ones(len(rows), np.float64), (rows, cols)), shape=(len(dmrs), len(genes))
+    )
+    biadjacency.sum_duplicates()
+    biadjacency.data[:] = 1.0
+
+    dmr_scale = sp.diags(1.0 / np.sqrt(np.asarray(biadjacency.sum(axis=1)).ravel()))
+    gene_scale = sp.diags(1.0 / np.sqrt(np.asarray(biadjacency.sum(axis=0)).ravel()))
+    normalized = dmr_scale @ biadjacency @ gene_scale
+
+    k = max(1, min(dimensions, min(normalized.shape) - 1 or 1))
+    u, s, vt = randomized_svd(normalized, n_components=k, random_state=random_state)
+
+    ids = np.array(dmrs + genes, dtype=np.int64)
+    kinds = np.array([DMR] * len(dmrs) + [GENE] * len(genes), dtype=np.uint8)
+    vectors = _normalize_rows(np.vstack([u * s, vt.T * s]))
+    return ids, kinds, vectors
+
+
+def biclique_vectors(
+    bicliques: Dict[int, Tuple[Set[int], Set[int]]],
+    ids: np.ndarray,
+    vectors: np.ndarray,
+) -> Tuple[np.ndarray, np.ndarray]:
+    """Mean member vector of each biclique, keyed by biclique id."""
+    row_of = {int(n): i for i, n in enumerate(ids)}
+    kept, rows = [], []
+    for biclique_id, (dmrs, genes) in sorted(bicliques.items()):
+        members = [row_of[n] for n in set(dmrs) | set(genes) if n in row_of]
+        if members:
+            kept.append(biclique_id)
+            rows.append(vectors[members].mean(axis=0))
+    if not rows:
+        return np.zeros(0, np.int64), np.zeros((0, vectors.shape[1]), np.float32)
+    return np.array(kept, dtype=np.int64), _normalize_rows(np.vstack(rows))
+
+
+class SimilarityIndex:
+    """Top-k cosine search over DMR, gene and biclique vectors."""
+
+    def __init__(self, ids: np.ndarray, kinds: np.ndarray, vectors: np.ndarray, ann=None):
+        order = np.argsort(kinds, kind="stable")
+        self.ids = ids[order]
+        self.kinds = kinds[order]
+        self.vectors = np.ascontiguousarray(vectors[order], dtype=np.float32)
+        self.ann = ann
+        # Rows are grouped by kind so a kind filter is a slice
+        bounds = np.searchsorted(self.kinds, [DMR, GENE, BICLIQUE, BICLIQUE + 1])
+        self.kind_rows = {
+            kind: slice(int(bounds[i]), int(bounds[i + 1]))
+            for i, kind in enumerate((DMR, GENE, BICLIQUE))
+        }
+        self._rows = {(int(k), int(n)): i for i, (k, n) in enumerate(zip(self.kinds, self.ids))}
+
+    @classmethod
+    def build(
+        cls,
+        graph: nx.Graph,
+        bicliques: Optional[Dict[int, Tuple[Set[int], Set[int]]]] = None,
+        dimensions: int = DEFAULT_DIMENSIONS,
+        use_ann: Optional[bool] = None,
+    ) -> "SimilarityIndex":
+        """Embed ``graph`` (and ``bicliques``, by id) and build the search index."""
+        ids, kinds, vectors = spectral_node_embedding(graph, dimensions)
+        if bicliques:
+            biclique_ids, rows = biclique_vectors(bicliques, ids, vectors)
+            ids = np.concatenate([ids, biclique_ids])
+            kinds = np.concatenate([kinds, np.full(len(biclique_ids), BICLIQUE, np.uint8)])
+            vectors = np.vstack([vectors, rows])
+        index = cls(ids, kinds, vectors)
+        if use_ann is None:
+            use_ann = len(ids) >= HNSW_MIN_ITEMS
+        if use_ann and hnswlib is not None and len(ids):
+            index.ann = index._build_ann()
+        return index
+
+    def _build_ann(self):
+        ann = hnswlib.Index(space="ip", dim=self.vectors.shape[1])
+        ann.init_index(
+            max_elements=len(self.ids), ef_construction=HNSW_EF_CONSTRUCTION, M=HNSW_M
+        )
+        ann.add_items(self.vectors, np.arange(len(self.ids)))
+        ann.set_ef(HNSW_EF_SEARCH)
+        return ann
+
+    def __len__(self) -> int:
+        return len(self.ids)
+
+    def row(self, node_id: int, kind: Optional[int] = None) -> Optional[int]:
+        """Row of a node; DMR and gene ids are unique, so kind may be omitted."""
+        if kind is not None:
+            return self._rows.get((kind, node_id))
+        for k in (DMR, GENE):
+            if (k, node_id) in self._rows:
+                return self._rows[(k, node_id)]
+        return None
+
+    def _exact(
+        self, vector: np.ndarray, k: int, kind: Optional[int]
+    ) -> Tuple[np.ndarray, np.ndarray]:
+        rows = self.kind_rows[kind] if kind is not None else slice(0, len(self.ids))
+        scores = self.vectors[rows] @ vector
+        if k < len(scores):
+            top = np.argpartition(-scores, k)[:k]
+        else:
+            top = np.arange(len(scores))
+        top = top[np.argsort(-scores[top], kind="stable")]
+        return top + rows.start, scores[top]
+
+    def search(
+        self,
+        vector: np.ndarray,
+        k: int = 10,
+        kind: Optional[int] = None,
+        exclude_row: Optional[int] = None,
+    ) -> List[Dict]:
+        """The ``k`` most similar items, optionally only of one kind."""
+        wanted = k + (exclude_row is not None)
+        found = None
+        if self.ann is not None:
+            # Over-fetch so that a kind filter still leaves k hits
+            fetch = min(len(self.ids), wanted * (4 if kind is not None else 1))
+            labels, distances = self.ann.knn_query(vector, k=fetch)
+            rows, scores = labels[0], 1.0 - distances[0]
+            if kind is not None:
+                keep = self.kinds[rows] == kind
+                rows, scores = rows[keep], scores[keep]
+            if len(rows) >= min(wanted, self._count(kind)):
+                found = rows, scores
+        if found is None:
+            found = self._exact(vector.astype(np.float32), wanted, kind)
+
+        results = []
+        for row, score in zip(*found):
+            if row == exclude_row:
+                continue
+            results.append(
+                {
+                    "id": int(self.ids[row]),
+                    "type": KIND_NAMES[int(self.kinds[row])],
+                    "similarity": round(float(score), 6),
+                }
+            )
+        return results[:k]
+
+    def _count(self, kind: Optional[int]) -> int:
+        if kind is None:
+            return len(self.ids)
+        rows = self.kind_rows[kind]
+        return rows.stop - rows.start
+
+    def similar(
+        self,
+        node_id: int,
+        k: int = 10,
+        kind: Optional[int] = None,
+        source_kind: Optional[int] = None,
+    ) -> Optional[List[Dict]]:
+        """Neighbours of a stored node or biclique; None if it is not indexed."""
+        row = self.row(node_id, source_kind)
+        if row is None:
+            return None
+        return self.search(self.vectors[row], k, kind, exclude_row=row)
+
+    def save(self, directory: str) -> None:
+        os.makedirs(directory, exist_ok=True)
+        np.savez(
+            os.path.join(directory, EMBEDDING_FILE),
+            ids=self.ids,
+            kinds=self.kinds,
+            vectors=self.vectors,
+        )
+        ann_path = os.path.join(directory, HNSW_FILE)
+        if self.ann is not None:
+            self.ann.save_index(ann_path)
+        elif os.path.exists(ann_path):
+            os.remove(ann_path)
+
+    @classmethod
+    def load(cls, directory: str) -> "SimilarityIndex":
+        with np.load(os.path.join(directory, EMBEDDING_FILE)) as data:
+            index = cls(data["ids"], data["kinds"], data["vectors"])
+        ann_path = os.path.join(directory, HNSW_FILE)
+        if hnswlib is not None and os.path.exists(ann_path):
+            ann = hnswlib.Index(space="ip", dim=index.vectors.shape[1])
+            ann.load_index(ann_path, max_elements=len(index.ids))
+            ann.set_ef(HNSW_EF_SEARCH)
+            index.ann = ann
+        return index
+
+
+_loaded: Dict[str, Tuple[float, SimilarityIndex]] = {}
+_loaded_lock = threading.Lock()
+
+
+def get_similarity_index(directory: str) -> Optional[SimilarityIndex]:
+    """Cached index from ``directory``, reloaded when its files are rebuilt."""
+    path = os.path.join(directory, EMBEDDING_FILE)
+    if not os.path.exists(path):
+        return None
+    mtime = os.path.getmtime(path)
+    with _loaded_lock:
+        cached = _loaded.get(directory)
+        if cached is None or cached[0] != mtime:
+            cached = (mtime, SimilarityIndex.load(directory))
+            _loaded[directory] = cached
+        return cached[1]
+
+
+def stored_bicliques(session, timepoint_id: int) -> Dict[int, Tuple[Set[int], Set[int]]]:
+    """
+    Stored bicliques of a timepoint as {id: (dmr nodes, gene ids)}.
+
+    Biclique.dmr_ids holds table ids; they are mapped back to original graph
+    node ids as in build_timepoint_decomposition.
+    """
+    from backend.app.database.models import Biclique
+    from backend.app.utils.id_mapping import reverse_create_dmr_id
+
+    rows = session.query(Biclique).filter(Biclique.timepoint_id == timepoint_id)
+    return {
+        b.id: (
+            {reverse_create_dmr_id(d, timepoint_id) for d in b.dmr_ids or []},
+            set(b.gene_ids or []),
+        )
+        for b in rows
+    }
+
+
+def build_timepoint_index(
+    graph: nx.Graph,
+    timepoint_id: int,
+    output_root: str,
+    bicliques: Optional[Dict[int, Tuple[Set[int], Set[int]]]] = None,
+    dimensions: int = DEFAULT_DIMENSIONS,
+) -> SimilarityIndex:
+    """Build the similarity index of a timepoint's original graph and store it."""
+    index = SimilarityIndex.build(graph, bicliques, dimensions)
+    index.save(os.path.join(output_root, str(timepoint_id)))
+    return index
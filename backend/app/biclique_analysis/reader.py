@@ -4,8 +4,12 @@
 import os
 from typing import Dict, List, Union, Tuple, Set
 import networkx as nx
+import numpy as np
 import json
 
+from .. import native
+from .edge_keys import biclique_cells, graph_edge_keys, pack_edge_keys
+
 
 import logging
 
@@ -254,6 +258,17 @@ def parse_bicliques(
             break
         line_idx += 1
 
+    if native.available():
+        bicliques, unknown = native.parse_biclique_lines(
+            lines, line_idx, max_DMR_id, gene_id_mapping
+        )
+        if unknown:
+            print(f"Warning: {len(unknown)} gene tokens not found in mapping")
+            print(f"First unknown genes: {sorted(set(unknown))[:5]}")
+        print(f"\nParsing complete:")
+        print(f"Total bicliques found: {len(bicliques)}")
+        return bicliques, len(lines)
+
     # Parse bicliques
     while line_idx < len(lines):
         line = lines[line_idx].strip()
@@ -319,26 +334,27 @@ def calculate_coverage(
     bicliques: List[Tuple[Set[int], Set[int]]], original_graph: nx.Graph
 ) -> Dict:
     """Calculate coverage statistics."""
-    dmr_coverage = set()
-    gene_coverage = set()
-
-    for dmr_nodes, gene_nodes in bicliques:
-        dmr_coverage.update(dmr_nodes)
-        gene_coverage.update(gene_nodes)
+    dmr_coverage = set().union(*(dmr_nodes for dmr_nodes, _ in bicliques))
+    gene_coverage = set().union(*(gene_nodes for _, gene_nodes in bicliques))
 
-    dmr_nodes = {n for n, d in original_graph.nodes(data=True) if d["bipartite"] == 0}
-    gene_nodes = {n for n, d in original_graph.nodes(data=True) if d["bipartite"] == 1}
+    node_types = np.fromiter(
+        (d["bipartite"] for _, d in original_graph.nodes(data=True)),
+        dtype=np.int8,
+        count=original_graph.number_of_nodes(),
+    )
+    total_dmrs = int(np.count_nonzero(node_types == 0))
+    total_genes = int(np.count_nonzero(node_types == 1))
 
     return {
         "dmrs": {
             "covered": len(dmr_coverage),
-            "total": len(dmr_nodes),
-            "percentage": len(dmr_coverage) / len(dmr_nodes),
+            "total": total_dmrs,
+            "percentage": len(dmr_coverage) / total_dmrs,
         },
         "genes": {
             "covered": len(gene_coverage),
-            "total": len(gene_nodes),
-            "percentage": len(gene_coverage) / len(gene_nodes),
+            "total": total_genes,
+            "percentage": len(gene_coverage) / total_genes,
         },
     }
 
@@ -347,18 +363,29 @@ def calculate_edge_distribution(
     bicliques: List[Tuple[Set[int], Set[int]]], original_graph: nx.Graph
 ) -> Dict:
     """Calculate edge distribution across bicliques."""
-    edge_distribution = {}
-
-    for biclique_idx, (dmr_nodes, gene_nodes) in enumerate(bicliques):
-        for dmr in dmr_nodes:
-            for gene in gene_nodes:
-                edge = (dmr, gene)
-                if original_graph.has_edge(dmr, gene):
-                    if edge not in edge_distribution:
-                        edge_distribution[edge] = []
-                    edge_distribution[edge].append(biclique_idx)
-
-    return edge_distribution
+    # Keep only the biclique cells that are edges of the original graph
+    cell_dmrs, cell_genes, cell_bicliques = biclique_cells(bicliques)
+    in_graph = np.isin(
+        pack_edge_keys(cell_dmrs, cell_genes), graph_edge_keys(original_graph)
+    )
+    cell_dmrs = cell_dmrs[in_graph]
+    cell_genes = cell_genes[in_graph]
+    cell_bicliques = cell_bicliques[in_graph]
+
+    # Group cells by (dmr, gene); the stable sort keeps biclique order per edge
+    if cell_dmrs.size == 0:
+        return {}
+    order = np.lexsort((cell_genes, cell_dmrs))
+    cell_dmrs, cell_genes = cell_dmrs[order], cell_genes[order]
+    cell_bicliques = cell_bicliques[order]
+    new_edge = (cell_dmrs[1:] != cell_dmrs[:-1]) | (cell_genes[1:] != cell_genes[:-1])
+    starts = np.flatnonzero(np.r_[True, new_edge])
+    groups = np.split(cell_bicliques, starts[1:])
+
+    return {
+        (int(cell_dmrs[start]), int(cell_genes[start])): group.tolist()
+        for start, group in zip(starts, groups)
+    }
 
 
 def create_result_dict(
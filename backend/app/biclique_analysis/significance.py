@@ -0,0 +1,359 @@
+# File significance.py
+#
+"""Degree-preserving permutation significance of bicliques.
+
+``classify_biclique`` only looks at a biclique's size. Whether a K(3,5) is
+surprising depends on the degree sequence: three hub DMRs share five genes
+easily. Here we compare the observed graph with null graphs drawn by
+degree-preserving edge swaps. A swap replaces (d1, g1), (d2, g2) with
+(d1, g2), (d2, g1), which leaves every DMR and gene degree unchanged.
+
+The swaps are vectorised over the edge arrays. Each round proposes one swap
+for every pair of a random edge pairing, and rejects swaps that would create
+a multi-edge or collide with another swap in the same round. The graph is
+never rebuilt in NetworkX.
+
+Two statistics are computed for every null graph:
+
+* pattern: for each biclique's DMR set, the number of genes adjacent to all
+  of them (the observed value is at least the biclique's gene count). The
+  per-biclique empirical p-value is (1 + #null >= observed) / (1 + n_null).
+* size: for each gene-side size b of the observed bicliques, the number of
+  DMR pairs sharing at least b genes (K(2,b) seeds, contained in every
+  K(a>=2,b)); likewise gene pairs sharing at least a DMRs for K(a,2).
+
+Null graphs are generated in fixed-size chunks, each with its own seed, in
+worker processes. Results therefore depend only on the seed, not on the
+worker count.
+"""
+
+import logging
+import os
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Set, Tuple
+
+import networkx as nx
+import numpy as np
+import scipy.sparse as sp
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_NULL_GRAPHS = 1000
+SWAPS_PER_EDGE = 5
+NULL_CHUNK = 25
+
+
+@dataclass
+class EdgeArrays:
+    """Bipartite graph as parallel DMR / gene index arrays."""
+
+    dmr_ids: np.ndarray
+    gene_ids: np.ndarray
+    dmr: np.ndarray  # per edge, index into dmr_ids
+    gene: np.ndarray  # per edge, index into gene_ids
+
+    @classmethod
+    def from_graph(cls, graph: nx.Graph) -> "EdgeArrays":
+        dmr_ids = np.array(
+            sorted(n for n, d in graph.nodes(data=True) if d.get("bipartite") == 0),
+            dtype=np.int64,
+        )
+        gene_ids = np.array(
+            sorted(n for n, d in graph.nodes(data=True) if d.get("bipartite") == 1),
+            dtype=np.int64,
+        )
+        dmr_index = {int(n): i for i, n in enumerate(dmr_ids)}
+        gene_index = {int(n): i for i, n in enumerate(gene_ids)}
+        dmr, gene = [], []
+        for u, v in graph.edges():
+            if u in gene_index and v in dmr_index:
+                u, v = v, u
+            if u in dmr_index and v in gene_index:
+                dmr.append(dmr_index[u])
+                gene.append(gene_index[v])
+        return cls(dmr_ids, gene_ids, np.array(dmr, np.int64), np.array(gene, np.int64))
+
+    def biadjacency(self, gene: Optional[np.ndarray] = None) -> sp.csr_matrix:
+        gene = self.gene if gene is None else gene
+        return sp.csr_matrix(
+            (np.ones(len(self.dmr), np.int32), (self.dmr, gene)),
+            shape=(len(self.dmr_ids), len(self.gene_ids)),
+        )
+
+
+def swap_edges(
+    dmr: np.ndarray,
+    gene: np.ndarray,
+    n_genes: int,
+    rounds: int,
+    rng: np.random.Generator,
+) -> np.ndarray:
+    """
+    Run ``rounds`` rounds of vectorised degree-preserving swaps.
+
+    Only the gene endpoints move, so the returned gene array (a copy) together
+    with the unchanged ``dmr`` array is the randomised graph.
+    """
+    gene = gene.copy()
+    half = len(dmr) // 2
+    if half == 0:
+        return gene
+    present = np.sort(dmr * n_genes + gene)
+
+    def exists(keys):
+        pos = np.minimum(np.searchsorted(present, keys), len(present) - 1)
+        return present[pos] == keys
+
+    for _ in range(rounds):
+        perm = rng.permutation(len(dmr))
+        i, j = perm[:half], perm[half : 2 * half]
+        new_i = dmr[i] * n_genes + gene[j]
+        new_j = dmr[j] * n_genes + gene[i]
+        ok = (dmr[i] != dmr[j]) & (gene[i] != gene[j]) & ~exists(new_i) & ~exists(new_j)
+
+        # Two swaps of one round must not create the same edge
+        candidates = np.flatnonzero(ok)
+        created = np.concatenate([new_i[candidates], new_j[candidates]])
+        _, inverse, counts = np.unique(created, return_inverse=True, return_counts=True)
+        clash = (counts[inverse] > 1).reshape(2, -1).any(axis=0)
+        accepted = candidates[~clash]
+
+        gi, gj = gene[i[accepted]], gene[j[accepted]]
+        gene[i[accepted]] = gj
+        gene[j[accepted]] = gi
+        present = np.sort(dmr * n_genes + gene)
+    return gene
+
+
+def common_gene_counts(
+    membership: sp.csr_matrix, set_sizes: np.ndarray, biadjacency: sp.csr_matrix
+) -> np.ndarray:
+    """Per DMR set (a row of ``membership``), genes adjacent to every member."""
+    shared = (membership @ biadjacency).tocsr()
+    rows = np.repeat(np.arange(shared.shape[0]), np.diff(shared.indptr))
+    full = shared.data == set_sizes[rows]
+    return np.bincount(rows[full], minlength=shared.shape[0])
+
+
+def pair_counts_at_least(adjacency: sp.csr_matrix, thresholds: np.ndarray) -> np.ndarray:
+    """For each threshold t, the number of row pairs sharing at least t columns."""
+    if not len(thresholds):
+        return np.zeros(0, np.int64)
+    shared = sp.triu(adjacency @ adjacency.T, k=1).tocsr()
+    values = np.sort(shared.data)
+    return len(values) - np.searchsorted(values, thresholds, side="left")
+
+
+@dataclass
+class _NullTask:
+    edges: EdgeArrays
+    membership: sp.csr_matrix
+    set_sizes: np.ndarray
+    observed_common: np.ndarray
+    gene_thresholds: np.ndarray
+    dmr_thresholds: np.ndarray
+    observed_gene_pairs: np.ndarray
+    observed_dmr_pairs: np.ndarray
+    samples: int
+    rounds: int
+    seed: np.random.SeedSequence
+
+
+def _statistics(
+    biadjacency: sp.csr_matrix,
+    membership: sp.csr_matrix,
+    set_sizes: np.ndarray,
+    gene_thresholds: np.ndarray,
+    dmr_thresholds: np.ndarray,
+):
+    """Pattern counts, DMR-pair counts and gene-pair counts of one graph."""
+    common = common_gene_counts(membership, set_sizes, biadjacency)
+    dmr_pairs = pair_counts_at_least(biadjacency, gene_thresholds)
+    gene_pairs = pair_counts_at_least(biadjacency.T.tocsr(), dmr_thresholds)
+    return common, dmr_pairs, gene_pairs
+
+
+def _run_null_chunk(task: _NullTask) -> Dict[str, np.ndarray]:
+    """Worker entry point: draw ``task.samples`` null graphs and tally exceedances."""
+    rng = np.random.default_rng(task.seed)
+    tallies = {
+        "pattern_exceed": np.zeros(len(task.set_sizes), np.int64),
+        "pattern_sum": np.zeros(len(task.set_sizes), np.float64),
+        "dmr_pair_exceed": np.zeros(len(task.gene_thresholds), np.int64),
+        "gene_pair_exceed": np.zeros(len(task.dmr_thresholds), np.int64),
+    }
+    edges = task.edges
+    for _ in range(task.samples):
+        gene = swap_edges(edges.dmr, edges.gene, len(edges.gene_ids), task.rounds, rng)
+        common, dmr_pairs, gene_pairs = _statistics(
+            edges.biadjacency(gene),
+            task.membership,
+            task.set_sizes,
+            task.gene_thresholds,
+            task.dmr_thresholds,
+        )
+        tallies["pattern_exceed"] += common >= task.observed_common
+        tallies["pattern_sum"] += common
+        tallies["dmr_pair_exceed"] += dmr_pairs >= task.observed_dmr_pairs
+        tallies["gene_pair_exceed"] += gene_pairs >= task.observed_gene_pairs
+    return tallies
+
+
+def compute_biclique_significance(
+    graph: nx.Graph,
+    bicliques: List[Tuple[Set[int], Set[int]]],
+    n_null: int = DEFAULT_NULL_GRAPHS,
+    swaps_per_edge: int = SWAPS_PER_EDGE,
+    max_workers: Optional[int] = None,
+    seed: int = 0,
+) -> Dict:
+    """
+    Empirical p-values of bicliques against degree-preserving null graphs.
+
+    Args:
+        graph: Original bipartite graph (DMRs bipartite=0, genes bipartite=1)
+        bicliques: List of (dmr_nodes, gene_nodes) tuples
+        n_null: Number of null graphs
+        swaps_per_edge: Swap attempts per edge for each null graph
+        max_workers: Process count (defaults to CPU count); 1 runs inline
+        seed: Seed of the null graph chunks
+
+    Returns:
+        JSON-safe dict with "bicliques" (one entry per input biclique, same
+        order), "sizes" (K(2,b) / K(a,2) counts and p-values) and run settings
+    """
+    edges = EdgeArrays.from_graph(graph)
+    dmr_index = {int(n): i for i, n in enumerate(edges.dmr_ids)}
+
+    member_rows, member_cols = [], []
+    for row, (dmrs, _) in enumerate(bicliques):
+        for d in dmrs:
+            if d in dmr_index:
+                member_rows.append(row)
+                member_cols.append(dmr_index[d])
+    membership = sp.csr_matrix(
+        (np.ones(len(member_rows), np.int32), (member_rows, member_cols)),
+        shape=(len(bicliques), len(edges.dmr_ids)),
+    )
+    set_sizes = np.diff(membership.indptr)
+
+    gene_thresholds = np.array(
+        sorted({len(g) for d, g in bicliques if len(d) >= 2 and len(g) >= 2}), np.int64
+    )
+    dmr_thresholds = np.array(
+        sorted({len(d) for d, g in bicliques if len(d) >= 2 and len(g) >= 2}), np.int64
+    )
+    observed_common, observed_dmr_pairs, observed_gene_pairs = _statistics(
+        edges.biadjacency(), membership, set_sizes, gene_thresholds, dmr_thresholds
+    )
+
+    rounds = max(1, 2 * swaps_per_edge)  # each round proposes len(edges) / 2 swaps
+    chunks = [NULL_CHUNK] * (n_null // NULL_CHUNK)
+    if n_null % NULL_CHUNK:
+        chunks.append(n_null % NULL_CHUNK)
+    tasks = [
+        _NullTask(
+            edges=edges,
+            membership=membership,
+            set_sizes=set_sizes,
+            observed_common=observed_common,
+            gene_thresholds=gene_thresholds,
+            dmr_thresholds=dmr_thresholds,
+            observed_gene_pairs=observed_gene_pairs,
+            observed_dmr_pairs=observed_dmr_pairs,
+            samples=samples,
+            rounds=rounds,
+            seed=seq,
+        )
+        for samples, seq in zip(chunks, np.random.SeedSequence(seed).spawn(len(chunks)))
+    ]
+
+    workers = min(max_workers or os.cpu_count() or 1, max(len(tasks), 1))
+    logger.info(
+        f"Drawing {n_null} degree-preserving null graphs "
+        f"({len(edges.dmr)} edges) with {workers} workers"
+    )
+    if workers == 1:
+        results = [_run_null_chunk(task) for task in tasks]
+    else:
+        with ProcessPoolExecutor(max_workers=workers) as executor:
+            results = list(executor.map(_run_null_chunk, tasks))
+
+    totals = {
+        "pattern_exceed": np.zeros(len(bicliques), np.int64),
+        "pattern_sum": np.zeros(len(bicliques), np.float64),
+        "dmr_pair_exceed": np.zeros(len(gene_thresholds), np.int64),
+        "gene_pair_exceed": np.zeros(len(dmr_thresholds), np.int64),
+    }
+    for result in results:
+        for key, value in result.items():
+            totals[key] += value
+
+    def p_values(exceed: np.ndarray) -> np.ndarray:
+        return (1 + exceed) / (1 + n_null)
+
+    pattern_p = p_values(totals["pattern_exceed"])
+    null_mean = totals["pattern_sum"] / max(n_null, 1)
+
+    sizes = {}
+    for b, count, p in zip(
+        gene_thresholds, observed_dmr_pairs, p_values(totals["dmr_pair_exceed"])
+    ):
+        sizes[f"K(2,{b})"] = {"observed": int(count), "p_value": float(p)}
+    for a, count, p in zip(
+        dmr_thresholds, observed_gene_pairs, p_values(totals["gene_pair_exceed"])
+    ):
+        sizes[f"K({a},2)"] = {"observed": int(count), "p_value": float(p)}
+
+    return {
+        "n_null": n_null,
+        "swaps_per_edge": swaps_per_edge,
+        "seed": seed,
+        "bicliques": [
+            {
+                "dmrs": len(dmrs),
+                "genes": len(genes),
+                "observed_common_genes": int(observed_common[k]),
+                "null_mean_common_genes": round(float(null_mean[k]), 4),
+                "p_value": float(pattern_p[k]),
+            }
+            for k, (dmrs, genes) in enumerate(bicliques)
+        ],
+        "sizes": sizes,
+    }
+
+
+def compute_timepoint_significance(
+    job, n_null: int = DEFAULT_NULL_GRAPHS, max_workers: Optional[int] = None
+) -> Tuple[List[Tuple[Set[int], Set[int]]], Dict]:
+    """
+    Load a timepoint's graph and bicliques and compute their significance.
+
+    Args:
+        job: StatisticsJob of the timepoint (graph and bicliques files)
+        n_null: Number of null graphs
+        max_workers: Process count for the null graphs
+
+    Returns:
+        (bicliques, significance) for ``store_biclique_significance``
+    """
+    from backend.app.biclique_analysis.reader import read_bicliques_file
+    from backend.app.utils.graph_io import read_bipartite_graph
+    from backend.app.utils.id_mapping import create_dmr_id
+
+    graph = read_bipartite_graph(job.original_graph_file, timepoint=job.timepoint_name)
+    bicliques = read_bicliques_file(
+        job.bicliques_file,
+        graph,
+        gene_id_mapping=job.gene_id_mapping,
+        file_format=job.file_format,
+    )["bicliques"]
+    # The reader numbers DMRs as in the bicliques file; the graph (and the
+    # stored bicliques, see analyze_bicliques) offset them by timepoint
+    bicliques = [
+        ({create_dmr_id(d, job.timepoint_id) for d in dmrs}, genes) for dmrs, genes in bicliques
+    ]
+    return bicliques, compute_biclique_significance(
+        graph, bicliques, n_null=n_null, max_workers=max_workers
+    )
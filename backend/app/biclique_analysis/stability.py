@@ -0,0 +1,335 @@
+# File stability.py
+#
+"""Bootstrap stability of dominating DMRs and bicliques.
+
+One dominating set and one biclique cover per timepoint say nothing about how
+much of either rests on individual, possibly noisy, edges. Here we perturb
+the graph many times and recompute both on each replicate:
+
+* every edge is dropped with probability ``drop_rate`` times the weight of
+  its source (``source_weights``; an edge with several sources takes the
+  smallest weight, i.e. its most reliable support), and
+* about ``add_rate`` times the edge count of random DMR-gene pairs are added.
+
+For each replicate the greedy red-blue dominating set is recomputed, and each
+biclique is checked for how many of its DMR x gene cells survive. The results
+are:
+
+* per DMR, its selection frequency, the fraction of replicates whose
+  dominating set contains it;
+* per biclique, its survival rate (the fraction of replicates with every cell
+  present) and its mean cell retention;
+* per replicate, the fraction of its edges covered by some biclique,
+  summarised over the replicates.
+
+The base edge arrays are sent to each worker process once, through the pool
+initializer. A task then carries only its replicate count and seed.
+Replicates are drawn in fixed-size chunks with spawned seeds, so results
+depend only on the seed and not on the worker count. Domination uses the
+native kernel when it is built. Otherwise it falls back to
+greedy_rb_domination on a NetworkX copy of each replicate, which is much
+slower.
+"""
+
+import logging
+import os
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Set, Tuple
+
+import networkx as nx
+import numpy as np
+import pandas as pd
+
+from backend.app import native
+from backend.app.biclique_analysis.edge_keys import biclique_cells, pack_edge_keys
+from backend.app.biclique_analysis.significance import EdgeArrays
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_REPLICATES = 200
+DEFAULT_DROP_RATE = 0.1
+DEFAULT_ADD_RATE = 0.0
+REPLICATE_CHUNK = 10
+
+
+@dataclass
+class StabilityBase:
+    """Everything a worker needs, shipped once per process."""
+
+    edges: EdgeArrays
+    drop_prob: np.ndarray  # per edge, already weighted by source
+    add_rate: float
+    area: np.ndarray  # per DMR (same order as edges.dmr_ids)
+    cell_keys: np.ndarray  # packed (dmr id, gene id) key of every biclique cell
+    cell_biclique: np.ndarray  # biclique index of each cell
+    num_bicliques: int
+
+
+_BASE: Optional[StabilityBase] = None
+
+
+def parse_source_weights(spec: str) -> Dict[str, float]:
+    """Parse "source=weight,source=weight" (as in STABILITY_SOURCE_WEIGHTS)."""
+    weights = {}
+    for item in spec.split(","):
+        if item.strip():
+            source, _, weight = item.rpartition("=")
+            weights[source.strip()] = float(weight)
+    return weights
+
+
+def _init_worker(base: StabilityBase) -> None:
+    global _BASE
+    _BASE = base
+
+
+def edge_drop_probabilities(
+    edges: EdgeArrays,
+    drop_rate: float,
+    edge_sources: Optional[Dict[Tuple[int, int], Set[str]]] = None,
+    source_weights: Optional[Dict[str, float]] = None,
+) -> np.ndarray:
+    """Per-edge drop probability: drop_rate x the smallest weight of its sources."""
+    weights = np.ones(len(edges.dmr), dtype=np.float64)
+    if edge_sources and source_weights:
+        dmr_ids = edges.dmr_ids[edges.dmr].tolist()
+        gene_ids = edges.gene_ids[edges.gene].tolist()
+        for k, (d, g) in enumerate(zip(dmr_ids, gene_ids)):
+            sources = edge_sources.get((min(d, g), max(d, g))) or edge_sources.get((d, g))
+            if sources:
+                weights[k] = min(source_weights.get(s, 1.0) for s in sources)
+    return np.clip(drop_rate * weights, 0.0, 1.0)
+
+
+def perturb_edges(
+    base: StabilityBase, rng: np.random.Generator
+) -> Tuple[np.ndarray, np.ndarray]:
+    """One replicate as (dmr index, gene index) arrays, without duplicate edges."""
+    edges = base.edges
+    keep = rng.random(len(edges.dmr)) >= base.drop_prob
+    dmr, gene = edges.dmr[keep], edges.gene[keep]
+
+    n_dmrs, n_genes = len(edges.dmr_ids), len(edges.gene_ids)
+    n_add = rng.poisson(base.add_rate * len(edges.dmr)) if base.add_rate > 0 else 0
+    if n_add and n_dmrs and n_genes:
+        present = edges.dmr * n_genes + edges.gene
+        added = np.unique(
+            rng.integers(0, n_dmrs, n_add) * n_genes + rng.integers(0, n_genes, n_add)
+        )
+        # Only genuinely new pairs; dropped originals are not re-added
+        added = added[~np.isin(added, present)]
+        dmr = np.concatenate([dmr, added // n_genes])
+        gene = np.concatenate([gene, added % n_genes])
+    return dmr, gene
+
+
+def replicate_dominating_set(
+    base: StabilityBase, dmr: np.ndarray, gene: np.ndarray
+) -> np.ndarray:
+    """Indices (into edges.dmr_ids) of the dominating set of one replicate."""
+    edges = base.edges
+    n_dmrs, n_genes = len(edges.dmr_ids), len(edges.gene_ids)
+    if native.available():
+        # CSR over positions: DMRs first, then genes
+        rows = np.concatenate([dmr, n_dmrs + gene])
+        cols = np.concatenate([n_dmrs + gene, dmr])
+        order = np.argsort(rows, kind="stable")
+        indptr = np.zeros(n_dmrs + n_genes + 1, dtype=np.int64)
+        np.cumsum(np.bincount(rows, minlength=n_dmrs + n_genes), out=indptr[1:])
+        is_gene = np.concatenate([np.zeros(n_dmrs, np.int8), np.ones(n_genes, np.int8)])
+        area = np.concatenate([base.area, np.ones(n_genes)])
+        node_ids = np.concatenate([edges.dmr_ids, edges.gene_ids])
+        chosen = native.rb_domination_arrays(
+            indptr, cols[order].astype(np.int64), is_gene, area, node_ids
+        )
+        return chosen[chosen < n_dmrs]
+
+    from backend.app.core.rb_domination import greedy_rb_domination
+
+    graph = nx.Graph()
+    graph.add_nodes_from(edges.dmr_ids.tolist(), bipartite=0)
+    graph.add_nodes_from(edges.gene_ids.tolist(), bipartite=1)
+    graph.add_edges_from(zip(edges.dmr_ids[dmr].tolist(), edges.gene_ids[gene].tolist()))
+    df = pd.DataFrame({"DMR_No.": edges.dmr_ids + 1, "Area": base.area})
+    chosen = greedy_rb_domination(graph, df, area_col="Area")
+    return np.searchsorted(edges.dmr_ids, np.fromiter(chosen, np.int64, len(chosen)))
+
+
+def _run_replicate_chunk(task: Tuple[int, np.random.SeedSequence]) -> Dict[str, np.ndarray]:
+    """Worker entry point: ``samples`` replicates tallied against the shared base."""
+    samples, seed = task
+    base = _BASE
+    rng = np.random.default_rng(seed)
+    tallies = {
+        "selected": np.zeros(len(base.edges.dmr_ids), np.int64),
+        "survived": np.zeros(base.num_bicliques, np.int64),
+        "retention_sum": np.zeros(base.num_bicliques, np.float64),
+        "covered_fraction": np.zeros(samples, np.float64),
+    }
+    cell_sizes = np.bincount(base.cell_biclique, minlength=base.num_bicliques)
+    unique_cells = np.unique(base.cell_keys)
+    for k in range(samples):
+        dmr, gene = perturb_edges(base, rng)
+        tallies["selected"][replicate_dominating_set(base, dmr, gene)] += 1
+
+        keys = pack_edge_keys(base.edges.dmr_ids[dmr], base.edges.gene_ids[gene])
+        present = np.isin(base.cell_keys, keys)
+        kept = np.bincount(base.cell_biclique[present], minlength=base.num_bicliques)
+        tallies["survived"] += (kept == cell_sizes) & (cell_sizes > 0)
+        tallies["retention_sum"] += np.divide(
+            kept, cell_sizes, out=np.zeros(base.num_bicliques), where=cell_sizes > 0
+        )
+        tallies["covered_fraction"][k] = np.isin(keys, unique_cells).mean() if keys.size else 0.0
+    return tallies
+
+
+def compute_stability(
+    graph: nx.Graph,
+    bicliques: List[Tuple[Set[int], Set[int]]],
+    n_replicates: int = DEFAULT_REPLICATES,
+    drop_rate: float = DEFAULT_DROP_RATE,
+    add_rate: float = DEFAULT_ADD_RATE,
+    source_weights: Optional[Dict[str, float]] = None,
+    area: Optional[Dict[int, float]] = None,
+    max_workers: Optional[int] = None,
+    seed: int = 0,
+) -> Dict:
+    """
+    Bootstrap selection frequencies of DMRs and survival rates of bicliques.
+
+    Args:
+        graph: Original bipartite graph (DMRs bipartite=0, genes bipartite=1);
+            edge sources are read from graph.graph["edge_sources"] if present
+        bicliques: List of (dmr_nodes, gene_nodes) tuples
+        n_replicates: Number of perturbed graphs
+        drop_rate: Base probability of dropping an edge
+        add_rate: Expected added edges as a fraction of the edge count
+        source_weights: Drop-rate multiplier per edge source (default 1.0)
+        area: Area statistic per DMR id for domination tie-breaks (default 1.0)
+        max_workers: Process count (defaults to CPU count); 1 runs inline
+        seed: Seed of the replicate chunks
+
+    Returns:
+        JSON-safe dict with "dmrs" ({dmr id: selection frequency} for every
+        DMR selected at least once), "bicliques" (one entry per input
+        biclique, same order), "coverage" and the run settings
+    """
+    edges = EdgeArrays.from_graph(graph)
+    area = area or {}
+    cell_dmrs, cell_genes, cell_biclique = biclique_cells(bicliques)
+    base = StabilityBase(
+        edges=edges,
+        drop_prob=edge_drop_probabilities(
+            edges, drop_rate, graph.graph.get("edge_sources"), source_weights
+        ),
+        add_rate=add_rate,
+        area=np.array([area.get(int(d), 1.0) for d in edges.dmr_ids], dtype=np.float64),
+        cell_keys=pack_edge_keys(cell_dmrs, cell_genes),
+        cell_biclique=cell_biclique,
+        num_bicliques=len(bicliques),
+    )
+
+    chunks = [REPLICATE_CHUNK] * (n_replicates // REPLICATE_CHUNK)
+    if n_replicates % REPLICATE_CHUNK:
+        chunks.append(n_replicates % REPLICATE_CHUNK)
+    tasks = list(zip(chunks, np.random.SeedSequence(seed).spawn(len(chunks))))
+
+    workers = min(max_workers or os.cpu_count() or 1, max(len(tasks), 1))
+    logger.info(
+        f"Drawing {n_replicates} stability replicates "
+        f"({len(edges.dmr)} edges, drop {drop_rate}, add {add_rate}) with {workers} workers"
+    )
+    if workers == 1:
+        _init_worker(base)
+        results = [_run_replicate_chunk(task) for task in tasks]
+    else:
+        with ProcessPoolExecutor(
+            max_workers=workers, initializer=_init_worker, initargs=(base,)
+        ) as executor:
+            results = list(executor.map(_run_replicate_chunk, tasks))
+
+    selected = np.zeros(len(edges.dmr_ids), np.int64)
+    survived = np.zeros(len(bicliques), np.int64)
+    retention = np.zeros(len(bicliques), np.float64)
+    for result in results:
+        selected += result["selected"]
+        survived += result["survived"]
+        retention += result["retention_sum"]
+    covered = np.concatenate([r["covered_fraction"] for r in results]) if results else np.zeros(0)
+
+    n = max(n_replicates, 1)
+    return {
+        "n_replicates": n_replicates,
+        "drop_rate": drop_rate,
+        "add_rate": add_rate,
+        "source_weights": dict(source_weights or {}),
+        "seed": seed,
+        "dmrs": {
+            int(edges.dmr_ids[i]): round(float(selected[i]) / n, 4)
+            for i in np.flatnonzero(selected)
+        },
+        "bicliques": [
+            {
+                "dmrs": len(dmrs),
+                "genes": len(genes),
+                "survival_rate": round(float(survived[k]) / n, 4),
+                "mean_cell_retention": round(float(retention[k]) / n, 4),
+            }
+            for k, (dmrs, genes) in enumerate(bicliques)
+        ],
+        "coverage": {
+            "mean": round(float(covered.mean()), 4) if covered.size else 0.0,
+            "std": round(float(covered.std()), 4) if covered.size else 0.0,
+            "min": round(float(covered.min()), 4) if covered.size else 0.0,
+        },
+    }
+
+
+def compute_timepoint_stability(
+    job,
+    n_replicates: int = DEFAULT_REPLICATES,
+    drop_rate: float = DEFAULT_DROP_RATE,
+    add_rate: float = DEFAULT_ADD_RATE,
+    source_weights: Optional[Dict[str, float]] = None,
+    edge_sources: Optional[Dict[Tuple[int, int], Set[str]]] = None,
+    max_workers: Optional[int] = None,
+) -> Tuple[List[Tuple[Set[int], Set[int]]], Dict]:
+    """
+    Load a timepoint's graph and bicliques and compute their stability.
+
+    Args:
+        edge_sources: Sources of each (DMR node, gene) edge of the graph, as
+            returned by ``get_edge_sources``; without them every edge has
+            weight 1.0
+
+    Returns:
+        (bicliques, stability) for ``store_stability_scores``
+    """
+    from backend.app.biclique_analysis.reader import read_bicliques_file
+    from backend.app.utils.graph_io import read_bipartite_graph
+    from backend.app.utils.id_mapping import create_dmr_id
+
+    graph = read_bipartite_graph(job.original_graph_file, timepoint=job.timepoint_name)
+    if edge_sources:
+        graph.graph["edge_sources"] = edge_sources
+    bicliques = read_bicliques_file(
+        job.bicliques_file,
+        graph,
+        gene_id_mapping=job.gene_id_mapping,
+        file_format=job.file_format,
+    )["bicliques"]
+    # The reader numbers DMRs as in the bicliques file; the graph (and the
+    # stored bicliques, see analyze_bicliques) offset them by timepoint
+    bicliques = [
+        ({create_dmr_id(d, job.timepoint_id) for d in dmrs}, genes) for dmrs, genes in bicliques
+    ]
+    return bicliques, compute_stability(
+        graph,
+        bicliques,
+        n_replicates=n_replicates,
+        drop_rate=drop_rate,
+        add_rate=add_rate,
+        source_weights=source_weights,
+        max_workers=max_workers,
+    )
@@ -2,7 +2,15 @@
 import warnings
 from typing import List, Dict, Tuple, Set
 import networkx as nx
+import numpy as np
 import json
+from backend.app import native
+from backend.app.biclique_analysis.edge_keys import (
+    biclique_cells,
+    graph_edge_keys,
+    pack_edge_keys,
+    participation_distribution,
+)
 from backend.app.biclique_analysis.classifier import (
     classify_biclique,
     classify_biclique_types,
@@ -137,39 +145,21 @@ def calculate_coverage_statistics(
     # Validate graph structure first
     dmrs, genes = validate_graph(graph)
 
-    # Initialize coverage sets
-    dmr_coverage = set()
-    gene_coverage = set()
-
-    # Track participation counts
-    dmr_participation = {}
-    gene_participation = {}
-
-    # Process each biclique
-    for dmr_nodes, gene_nodes in bicliques:
-        # Update coverage
-        dmr_coverage.update(dmr_nodes)
-        gene_coverage.update(gene_nodes)
-
-        # Update participation counts
-        for dmr in dmr_nodes:
-            dmr_participation[dmr] = dmr_participation.get(dmr, 0) + 1
-        for gene in gene_nodes:
-            gene_participation[gene] = gene_participation.get(gene, 0) + 1
+    dmr_sets = [dmr_nodes for dmr_nodes, _ in bicliques]
+    gene_sets = [gene_nodes for _, gene_nodes in bicliques]
+    dmr_coverage = set().union(*dmr_sets)
+    gene_coverage = set().union(*gene_sets)
 
-    # Calculate edge coverage
-    covered_edges = set()
-    multiple_covered = set()
-    for dmr_nodes, gene_nodes in bicliques:
-        for dmr in dmr_nodes:
-            for gene in gene_nodes:
-                edge = (min(dmr, gene), max(dmr, gene))
-                if edge in covered_edges:
-                    multiple_covered.add(edge)
-                covered_edges.add(edge)
+    # Count how many biclique cells land on each edge
+    cell_dmrs, cell_genes, _ = biclique_cells(bicliques)
+    _, cell_counts = np.unique(
+        pack_edge_keys(cell_dmrs, cell_genes), return_counts=True
+    )
+    covered_count = int(cell_counts.size)
+    multiple_count = int(np.count_nonzero(cell_counts > 1))
+    single_count = covered_count - multiple_count
 
     total_edges = len(graph.edges())
-    single_covered = covered_edges - multiple_covered
 
     size_distribution = calculate_size_distribution(bicliques)
     return {
@@ -177,30 +167,24 @@ def calculate_coverage_statistics(
             "covered": len(dmr_coverage),
             "total": len(dmrs),
             "percentage": len(dmr_coverage) / len(dmrs) if dmrs else 0,
-            "participation": {
-                k: v for k, v in sorted(Counter(dmr_participation.values()).items())
-            },
+            "participation": participation_distribution(dmr_sets),
         },
         "genes": {
             "covered": len(gene_coverage),
             "total": len(genes),
             "percentage": len(gene_coverage) / len(genes) if genes else 0,
-            "participation": {
-                k: v for k, v in sorted(Counter(gene_participation.values()).items())
-            },
+            "participation": participation_distribution(gene_sets),
         },
         "edges": {
-            "single_coverage": len(single_covered),
-            "multiple_coverage": len(multiple_covered),
-            "uncovered": total_edges - len(covered_edges),
+            "single_coverage": single_count,
+            "multiple_coverage": multiple_count,
+            "uncovered": total_edges - covered_count,
             "total": total_edges,
-            "single_percentage": len(single_covered) / total_edges
+            "single_percentage": single_count / total_edges if total_edges else 0,
+            "multiple_percentage": multiple_count / total_edges
             if total_edges
             else 0,
-            "multiple_percentage": len(multiple_covered) / total_edges
-            if total_edges
-            else 0,
-            "uncovered_percentage": (total_edges - len(covered_edges)) / total_edges
+            "uncovered_percentage": (total_edges - covered_count) / total_edges
             if total_edges
             else 0,
         },
@@ -323,27 +307,11 @@ def calculate_size_distribution(bicliques: List) -> Dict:
 
 def calculate_node_participation(bicliques: List[Tuple[Set[int], Set[int]]]) -> Dict:
     """Calculate how many nodes participate in multiple bicliques."""
-    dmr_participation = {}
-    gene_participation = {}
-
-    # First count participation for each node
-    for dmr_nodes, gene_nodes in bicliques:
-        for node in dmr_nodes:
-            dmr_participation[node] = dmr_participation.get(node, 0) + 1
-        for node in gene_nodes:
-            gene_participation[node] = gene_participation.get(node, 0) + 1
-
-    # Convert to count distribution
-    dmr_dist = {}
-    gene_dist = {}
-
-    # Count nodes by their participation frequency
-    for count in sorted(set(dmr_participation.values())):
-        dmr_dist[count] = sum(1 for v in dmr_participation.values() if v == count)
-    for count in sorted(set(gene_participation.values())):
-        gene_dist[count] = sum(1 for v in gene_participation.values() if v == count)
-
-    return {"dmrs": dmr_dist, "genes": gene_dist}
+    # Map participation frequency -> number of nodes with that frequency
+    return {
+        "dmrs": participation_distribution([dmrs for dmrs, _ in bicliques]),
+        "genes": participation_distribution([genes for _, genes in bicliques]),
+    }
 
 
 def calculate_edge_coverage(
@@ -354,39 +322,31 @@ def calculate_edge_coverage(
     print(f"Number of bicliques: {len(bicliques)}")
     print(f"Number of edges in graph: {len(graph.edges())}")
 
-    # Track coverage for each edge
-    edge_coverage = {}
-
-    # Count how many bicliques cover each edge
-    for dmr_nodes, gene_nodes in bicliques:
-        # Create edges for each DMR-gene pair in the biclique
-        for dmr in dmr_nodes:
-            for gene in gene_nodes:
-                # Try both orderings of the edge
-                edge1 = tuple(sorted([dmr, gene]))
-                edge2 = tuple(sorted([gene, dmr]))
-
-                # Check if either ordering exists in the graph
-                if graph.has_edge(dmr, gene) or graph.has_edge(gene, dmr):
-                    edge = edge1  # Use consistent ordering
-                    edge_coverage[edge] = edge_coverage.get(edge, 0) + 1
-
-    # Calculate coverage statistics
+    # Count how many bicliques cover each edge of the graph
+    graph_keys = graph_edge_keys(graph)
+    cell_dmrs, cell_genes, _ = biclique_cells(bicliques)
+    cell_keys = pack_edge_keys(cell_dmrs, cell_genes)
     total_edges = len(graph.edges())
-    covered_edges = set(edge_coverage.keys())
-    single_covered = {e for e in covered_edges if edge_coverage[e] == 1}
-    multiple_covered = {e for e in covered_edges if edge_coverage[e] > 1}
-    uncovered = set(map(tuple, map(sorted, graph.edges()))) - covered_edges
+    if native.available():
+        single_covered, multiple_covered, uncovered = native.edge_coverage_counts(
+            graph_keys, cell_keys
+        )
+    else:
+        cell_keys = cell_keys[np.isin(cell_keys, graph_keys, assume_unique=False)]
+        _, counts = np.unique(cell_keys, return_counts=True)
+        single_covered = int(np.count_nonzero(counts == 1))
+        multiple_covered = int(np.count_nonzero(counts > 1))
+        uncovered = int(graph_keys.size - counts.size)
 
     # Debug output
     print(f"\nEdge coverage details:")
     print(f"Total edges in graph: {total_edges}")
-    print(f"Single covered edges: {len(single_covered)}")
-    print(f"Multiple covered edges: {len(multiple_covered)}")
-    print(f"Uncovered edges: {len(uncovered)}")
+    print(f"Single covered edges: {single_covered}")
+    print(f"Multiple covered edges: {multiple_covered}")
+    print(f"Uncovered edges: {uncovered}")
 
     # If all edges are uncovered, print some debug info
-    if len(uncovered) == total_edges:
+    if uncovered == total_edges:
         print("\nWARNING: All edges uncovered! Debug info:")
         print(
             f"First biclique DMRs: {list(next(iter(bicliques))[0]) if bicliques else []}"
@@ -397,15 +357,13 @@ def calculate_edge_coverage(
         print("First few graph edges:", list(graph.edges())[:5])
 
     return {
-        "single_coverage": len(single_covered),
-        "multiple_coverage": len(multiple_covered),
-        "uncovered": len(uncovered),
+        "single_coverage": single_covered,
+        "multiple_coverage": multiple_covered,
+        "uncovered": uncovered,
         "total": total_edges,
-        "single_percentage": len(single_covered) / total_edges if total_edges else 0,
-        "multiple_percentage": len(multiple_covered) / total_edges
-        if total_edges
-        else 0,
-        "uncovered_percentage": len(uncovered) / total_edges if total_edges else 0,
+        "single_percentage": single_covered / total_edges if total_edges else 0,
+        "multiple_percentage": multiple_covered / total_edges if total_edges else 0,
+        "uncovered_percentage": uncovered / total_edges if total_edges else 0,
     }
 
 
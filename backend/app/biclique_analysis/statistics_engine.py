@@ -0,0 +1,150 @@
+# File statistics_engine.py
+# Author: Peter Shaw
+#
+"""Precompute the per-timepoint summary statistics shown on the statistics pages.
+
+The summary functions in statistics.py rebuild connected and biconnected
+components of both the original and the biclique graph on every call. At
+ingest we run them once per timepoint, in parallel worker processes, and
+store the JSON results in the ``statistics`` table (see
+``database.operations.store_timepoint_statistics``) so the pages are served
+from a handful of rows.
+"""
+
+import os
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass
+from typing import Dict, List, Optional
+
+import networkx as nx
+
+from backend.app.biclique_analysis.classifier import classify_biclique_types
+from backend.app.biclique_analysis.reader import read_bicliques_file
+from backend.app.biclique_analysis.reporting import get_bicliques_summary
+from backend.app.biclique_analysis.statistics import (
+    calculate_component_statistics,
+    calculate_coverage_statistics,
+    calculate_edge_coverage,
+    calculate_node_participation,
+    calculate_size_distribution,
+)
+from backend.app.utils.graph_io import read_bipartite_graph
+from backend.app.utils.json_utils import convert_for_json
+
+import logging
+
+logger = logging.getLogger(__name__)
+
+# Bump when the layout of the stored statistics changes
+STATISTICS_VERSION = 1
+
+
+@dataclass
+class StatisticsJob:
+    """Inputs needed to compute the statistics of one timepoint in a worker."""
+
+    timepoint_id: int
+    timepoint_name: str
+    original_graph_file: str
+    bicliques_file: str
+    gene_id_mapping: Dict[str, int]
+    file_format: str = "gene_name"
+
+
+def compute_timepoint_statistics(original_graph: nx.Graph, bicliques_result: Dict) -> Dict:
+    """
+    Compute every summary metric used by the statistics templates.
+
+    Args:
+        original_graph: Original bipartite graph of the timepoint
+        bicliques_result: Result of read_bicliques_file for the timepoint
+
+    Returns:
+        JSON-safe dictionary keyed by section (coverage, edge_coverage,
+        components, ...)
+    """
+    bicliques = bicliques_result["bicliques"]
+
+    coverage = calculate_coverage_statistics(bicliques, original_graph)
+    edges = calculate_edge_coverage(bicliques, original_graph)
+
+    stats = {
+        "graph_info": {
+            "total_dmrs": coverage["dmrs"]["total"],
+            "total_genes": coverage["genes"]["total"],
+            "total_edges": edges["total"],
+            "total_bicliques": len(bicliques),
+        },
+        "coverage": coverage,
+        # Flat names used by templates/components/stats/edge_coverage.html
+        "edge_coverage": {
+            "single": edges["single_coverage"],
+            "multiple": edges["multiple_coverage"],
+            "uncovered": edges["uncovered"],
+            "total": edges["total"],
+            "single_percentage": edges["single_percentage"],
+            "multiple_percentage": edges["multiple_percentage"],
+            "uncovered_percentage": edges["uncovered_percentage"],
+        },
+        "components": calculate_component_statistics(bicliques, original_graph),
+        "node_participation": calculate_node_participation(bicliques),
+        "size_distribution": calculate_size_distribution(bicliques),
+        "biclique_types": classify_biclique_types(bicliques),
+    }
+    if "graph_info" in bicliques_result:
+        stats["bicliques_summary"] = get_bicliques_summary(
+            bicliques_result, original_graph
+        )
+
+    return convert_for_json(stats)
+
+
+def _run_job(job: StatisticsJob) -> Dict:
+    """Worker entry point: load the graph files and compute the statistics."""
+    try:
+        original_graph = read_bipartite_graph(
+            job.original_graph_file, timepoint=job.timepoint_name
+        )
+        bicliques_result = read_bicliques_file(
+            job.bicliques_file,
+            original_graph,
+            gene_id_mapping=job.gene_id_mapping,
+            file_format=job.file_format,
+        )
+        return compute_timepoint_statistics(original_graph, bicliques_result)
+    except Exception as e:
+        logger.error(f"Statistics failed for timepoint {job.timepoint_name}: {str(e)}")
+        return {"error": str(e)}
+
+
+def run_statistics_engine(
+    jobs: List[StatisticsJob], max_workers: Optional[int] = None
+) -> Dict[int, Dict]:
+    """
+    Compute statistics for several timepoints, one worker process per timepoint.
+
+    Args:
+        jobs: One job per timepoint; jobs whose files are missing are skipped
+        max_workers: Process count (defaults to CPU count); 1 runs inline
+
+    Returns:
+        Dictionary mapping timepoint id to its statistics (or {"error": ...})
+    """
+    jobs = [
+        job
+        for job in jobs
+        if os.path.exists(job.original_graph_file) and os.path.exists(job.bicliques_file)
+    ]
+    if not jobs:
+        return {}
+
+    workers = min(max_workers or os.cpu_count() or 1, len(jobs))
+    print(f"\nComputing statistics for {len(jobs)} timepoints with {workers} workers")
+
+    if workers == 1:
+        results = [_run_job(job) for job in jobs]
+    else:
+        with ProcessPoolExecutor(max_workers=workers) as executor:
+            results = list(executor.map(_run_job, jobs))
+
+    return {job.timepoint_id: result for job, result in zip(jobs, results)}
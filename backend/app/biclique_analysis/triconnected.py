@@ -1,4 +1,7 @@
-from typing import Tuple, List, Set, Dict
+import itertools
+from collections import defaultdict, deque
+from dataclasses import dataclass
+from typing import Tuple, List, Set, Dict, Optional
 import networkx as nx
 # from .classifier import BicliqueSizeCategory, classify_component
 
@@ -127,3 +130,156 @@ def find_separation_pairs(graph: nx.Graph) -> List[Set]:
             tricomps.append(bicomp)
 
     return tricomps
+
+
+# Blocks with more nodes than this are kept as a single "U" (undecomposed)
+# node: the separation pair search is quadratic in the block size
+SPLIT_MAX_NODES = 200
+
+
+@dataclass
+class SplitComponent:
+    """A node of a block's SPQR tree."""
+
+    kind: str  # "S" cycle, "P" bond, "R" triconnected, "U" not decomposed
+    nodes: List[int]
+    virtual_edges: List[Tuple[int, int]]  # separation pairs shared with tree neighbours
+    parent: int  # index of the tree neighbour towards the root, -1 for the root
+    separation_pair: Optional[Tuple[int, int]]  # virtual edge shared with the parent
+
+
+def split_components(block: nx.Graph, max_nodes: int = SPLIT_MAX_NODES) -> List[SplitComponent]:
+    """
+    Triconnected components of a biconnected graph, as the nodes of its SPQR tree.
+
+    The block is split recursively at separation pairs, each split adding a
+    virtual edge between the pair to both sides, and adjacent cycles and
+    bonds are merged afterwards, which gives the unique decomposition. Parts
+    are returned in breadth-first order of the tree, so a parent precedes its
+    children. Bridges (two-node blocks) have no decomposition.
+    """
+    if block.number_of_nodes() < 3:
+        return []
+    virtual_ids = itertools.count()
+    pending = [[(u, v, None) for u, v in block.edges()]]
+    parts = []  # [kind, edges]; an edge is (u, v, virtual id or None)
+    while pending:
+        edges = pending.pop()
+        graph = nx.MultiGraph()
+        graph.add_edges_from((u, v) for u, v, _ in edges)
+        kind = _terminal_kind(graph, max_nodes)
+        pair = None if kind else _separation_pair(graph)
+        if kind is None and pair is None:
+            kind = "R"
+        if kind:
+            parts.append([kind, edges])
+        else:
+            pending.extend(_split(graph, edges, pair, virtual_ids))
+    return _spqr_tree(_merge_parts(parts))
+
+
+def _terminal_kind(graph: nx.MultiGraph, max_nodes: int) -> Optional[str]:
+    if graph.number_of_nodes() == 2:
+        return "P"
+    if all(d == 2 for _, d in graph.degree()):
+        return "S"
+    if graph.number_of_nodes() > max_nodes:
+        return "U"
+    return None
+
+
+def _separation_pair(graph: nx.MultiGraph) -> Optional[Tuple[int, int]]:
+    """A pair of nodes whose removal splits the graph, or None if it is triconnected."""
+    # Parallel edges split off as a bond
+    for u, v, key in sorted(graph.edges(keys=True)):
+        if key > 0:
+            return (u, v) if u < v else (v, u)
+    simple = nx.Graph(graph)
+    nodes = sorted(simple)
+    # The neighbours of a degree-2 node separate it from the rest
+    for node in nodes:
+        if simple.degree(node) == 2:
+            a, b = sorted(simple[node])
+            return a, b
+    for a in nodes:
+        rest = simple.subgraph(n for n in nodes if n != a)
+        for b in nx.articulation_points(rest):
+            return (a, b) if a < b else (b, a)
+    return None
+
+
+def _split(graph: nx.MultiGraph, edges: List, pair: Tuple[int, int], virtual_ids) -> List[List]:
+    """Split at a separation pair; each side gets a virtual edge for the pair."""
+    a, b = pair
+    rest = nx.Graph(graph)
+    rest.remove_nodes_from(pair)
+    classes = sorted(nx.connected_components(rest), key=min)
+    between = [e for e in edges if {e[0], e[1]} == {a, b}]
+
+    def side(nodes, virtual_id):
+        return [e for e in edges if e[0] in nodes or e[1] in nodes] + [(a, b, virtual_id)]
+
+    if len(classes) == 2 and not between:
+        virtual_id = next(virtual_ids)
+        return [side(nodes, virtual_id) for nodes in classes]
+    # Three or more classes: a bond holds the edges between the pair
+    bond, sides = list(between), []
+    for nodes in classes:
+        virtual_id = next(virtual_ids)
+        bond.append((a, b, virtual_id))
+        sides.append(side(nodes, virtual_id))
+    return sides + [bond]
+
+
+def _merge_parts(parts: List[List]) -> List[List]:
+    """Merge cycles sharing a virtual edge with cycles, and bonds with bonds."""
+    alive = set(range(len(parts)))
+    merged = True
+    while merged:
+        merged = False
+        owners = defaultdict(list)
+        for i in sorted(alive):
+            for _, _, virtual_id in parts[i][1]:
+                if virtual_id is not None:
+                    owners[virtual_id].append(i)
+        for virtual_id, (i, j) in owners.items():
+            if parts[i][0] == parts[j][0] and parts[i][0] in ("S", "P"):
+                parts[i][1] = [e for e in parts[i][1] + parts[j][1] if e[2] != virtual_id]
+                alive.discard(j)
+                merged = True
+                break
+    return [parts[i] for i in sorted(alive)]
+
+
+def _spqr_tree(parts: List[List]) -> List[SplitComponent]:
+    """Link parts sharing a virtual edge, breadth first from the part with the lowest node."""
+    nodes = [sorted({n for u, v, _ in edges for n in (u, v)}) for _, edges in parts]
+    owners = defaultdict(list)
+    for i, (_, edges) in enumerate(parts):
+        for u, v, virtual_id in edges:
+            if virtual_id is not None:
+                owners[virtual_id].append((i, (min(u, v), max(u, v))))
+
+    root = min(range(len(parts)), key=lambda i: (nodes[i], parts[i][0]))
+    order, parent, links = [root], {root: (-1, None)}, deque([root])
+    while links:
+        i = links.popleft()
+        for _, _, virtual_id in parts[i][1]:
+            for j, pair in owners.get(virtual_id, []):
+                if j not in parent:
+                    parent[j] = (i, pair)
+                    order.append(j)
+                    links.append(j)
+    position = {i: k for k, i in enumerate(order)}
+    return [
+        SplitComponent(
+            kind=parts[i][0],
+            nodes=nodes[i],
+            virtual_edges=sorted(
+                {(min(u, v), max(u, v)) for u, v, vid in parts[i][1] if vid is not None}
+            ),
+            parent=position[parent[i][0]] if parent[i][0] >= 0 else -1,
+            separation_pair=parent[i][1],
+        )
+        for i in order
+    ]
@@ -0,0 +1,341 @@
+# File datasets.py
+# Author: Peter Shaw
+#
+"""Dataset namespaces for serving several cohorts side by side.
+
+Every dataset is one experiment with its own database, input files,
+analytics snapshot directory and GraphManager. Datasets are listed in a JSON
+manifest, located by DATASETS_FILE and defaulting to
+``<project root>/datasets.json``:
+
+    {
+      "datasets": {
+        "cohort_b": {
+          "data_dir": "/srv/dmr/cohort_b",
+          "database_url": "postgresql://.../cohort_b",
+          "memory_budget_mb": 2048,
+          "timepoints": [1, 2, 3]
+        }
+      }
+    }
+
+Only ``data_dir`` is required. By default the database is
+``<data_dir>/dmr_analysis.db``, graph files and tiles go under
+``<data_dir>/graphs`` and analytics snapshots under ``<data_dir>/analytics``.
+The server's own configuration is the ``default`` dataset, which keeps
+serving the unprefixed /api routes.
+
+To add a cohort, ingest it with the manifest entry in place:
+
+    DATASET=cohort_b python -m backend.app.database.management.initialize_database
+
+The running server re-reads the manifest when the file changes, so no
+restart is needed. A dataset's GraphManager is created on the dataset's
+first request, under a lock of its own. It loads timepoints on demand and
+evicts the least recently used ones beyond the dataset's memory budget, so
+loading one cohort neither blocks nor evicts another.
+
+``activate(dataset)`` scopes the current request to a dataset. Within it,
+get_db_engine(), the DMR id offsets, the analytics store,
+get_graph_manager() and get_graph_data_dir() all resolve to that dataset.
+"""
+
+import json
+import logging
+import os
+import re
+import threading
+from contextlib import contextmanager
+from contextvars import ContextVar
+from dataclasses import dataclass, fields
+from pathlib import Path
+from typing import Callable, Dict, List, Optional
+
+from flask import current_app
+
+from backend.app.core.graph_manager import GraphManager
+from backend.app.database.analytics import AnalyticsStore, use_analytics_store
+from backend.app.database.connection import use_database
+from backend.app.utils.id_mapping import use_timepoint_offsets
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_DATASET = "default"
+DATASET_NAME = re.compile(r"^[A-Za-z0-9_-]{1,64}$")
+
+
+@dataclass
+class DatasetConfig:
+    """Storage locations and serving limits of one dataset."""
+
+    name: str
+    data_dir: str
+    database_url: Optional[str] = None
+    graph_data_dir: Optional[str] = None
+    analytics_dir: Optional[str] = None
+    dss1_file: Optional[str] = None
+    dss_pairwise_file: Optional[str] = None
+    timepoints: Optional[List[int]] = None
+    memory_budget_mb: Optional[float] = None
+    preload: bool = False
+    description: str = ""
+
+    @classmethod
+    def from_dict(cls, name: str, entry: Dict) -> "DatasetConfig":
+        """Manifest entry with defaults filled in; ValueError when invalid."""
+        if not DATASET_NAME.match(name) or name == DEFAULT_DATASET:
+            raise ValueError(f"Invalid dataset name: {name!r}")
+        known = {f.name for f in fields(cls)} - {"name"}
+        unknown = set(entry) - known
+        if unknown:
+            raise ValueError(f"Unknown keys for dataset {name}: {sorted(unknown)}")
+        if not entry.get("data_dir"):
+            raise ValueError(f"Dataset {name} has no data_dir")
+
+        config = cls(name=name, **entry)
+        data_dir = config.data_dir
+        config.database_url = config.database_url or (
+            f"sqlite:///{os.path.join(data_dir, 'dmr_analysis.db')}"
+        )
+        config.graph_data_dir = config.graph_data_dir or os.path.join(data_dir, "graphs")
+        config.analytics_dir = config.analytics_dir or os.path.join(data_dir, "analytics")
+        config.dss1_file = config.dss1_file or os.path.join(data_dir, "DSS1.xlsx")
+        config.dss_pairwise_file = config.dss_pairwise_file or os.path.join(
+            data_dir, "DSS_PAIRWISE.xlsx"
+        )
+        return config
+
+    def environment(self) -> Dict[str, str]:
+        """Environment variables pointing the ingest scripts at this dataset."""
+        return {
+            "DATABASE_URL": self.database_url,
+            "DATA_DIR": self.data_dir,
+            "DSS1_FILE": self.dss1_file,
+            "DSS_PAIRWISE_FILE": self.dss_pairwise_file,
+            "ANALYTICS_DIR": self.analytics_dir,
+            "GRAPH_DATA_DIR": self.graph_data_dir,
+        }
+
+    def graph_manager_config(self) -> Dict:
+        return {
+            "DATA_DIR": self.data_dir,
+            "TIMEPOINTS": self.timepoints,
+            "GRAPH_PRELOAD": self.preload,
+            "GRAPH_MEMORY_BUDGET_MB": self.memory_budget_mb,
+        }
+
+
+class Dataset:
+    """A dataset's lazily created graph manager and analytics store."""
+
+    def __init__(
+        self,
+        config: DatasetConfig,
+        graph_manager: Optional[GraphManager] = None,
+        analytics_store: Optional[AnalyticsStore] = None,
+    ):
+        self.config = config
+        self._graph_manager = graph_manager
+        self.analytics_store = analytics_store
+        if analytics_store is None and config.analytics_dir and config.name != DEFAULT_DATASET:
+            self.analytics_store = AnalyticsStore(Path(config.analytics_dir))
+        self._lock = threading.Lock()
+
+    @property
+    def name(self) -> str:
+        return self.config.name
+
+    @property
+    def is_default(self) -> bool:
+        return self.config.name == DEFAULT_DATASET
+
+    @property
+    def loaded(self) -> bool:
+        return self._graph_manager is not None
+
+    @property
+    def graph_manager(self) -> GraphManager:
+        """The dataset's GraphManager, created on first use."""
+        if self._graph_manager is None:
+            with self._lock:
+                if self._graph_manager is None:
+                    logger.info(f"Creating graph manager for dataset {self.name}")
+                    self._graph_manager = GraphManager(
+                        config=self.config.graph_manager_config(),
+                        database_url=self.config.database_url,
+                    )
+        return self._graph_manager
+
+    def timepoint_offsets(self) -> Optional[Dict[int, int]]:
+        """DMR id offsets of the dataset; None keeps the global TIMEPOINT_OFFSETS."""
+        if self.is_default:
+            return None
+        return self.graph_manager.timepoint_offsets()
+
+    def status(self) -> Dict:
+        status = {
+            "name": self.name,
+            "description": self.config.description,
+            "loaded": self.loaded,
+        }
+        if self.loaded:
+            manager = self._graph_manager
+            status["timepoints"] = sorted(manager.timepoints)
+            status["loaded_timepoints"] = sorted(manager.original_graphs)
+            status["memory"] = manager.memory_usage()
+        return status
+
+
+class DatasetRegistry:
+    """Datasets of the manifest, re-read whenever the file changes."""
+
+    def __init__(self, manifest_path, default: Optional[Dataset] = None):
+        self.manifest_path = Path(manifest_path)
+        self.default = default
+        self._configs: Dict[str, DatasetConfig] = {}
+        self._datasets: Dict[str, Dataset] = {}
+        self._mtime: Optional[float] = None
+        self._lock = threading.Lock()
+        self._reset_listeners: List[Callable[[str], None]] = []
+
+    def on_reset(self, listener: Callable[[str], None]) -> None:
+        """Call ``listener(name)`` whenever a dataset is replaced or unloaded."""
+        self._reset_listeners.append(listener)
+
+    def _notify_reset(self, names) -> None:
+        for name in names:
+            for listener in self._reset_listeners:
+                listener(name)
+
+    def refresh(self, force: bool = False) -> None:
+        """
+        Reload the manifest when it changed; datasets whose entry changed are reset.
+
+        An invalid manifest keeps the previous datasets; the error is logged,
+        and raised as ValueError when force is set.
+        """
+        try:
+            mtime = self.manifest_path.stat().st_mtime
+        except FileNotFoundError:
+            mtime = None
+        with self._lock:
+            if mtime == self._mtime and not force:
+                return
+            configs = {}
+            if mtime is not None:
+                try:
+                    entries = json.loads(self.manifest_path.read_text()).get("datasets", {})
+                    configs = {
+                        name: DatasetConfig.from_dict(name, e) for name, e in entries.items()
+                    }
+                except (ValueError, TypeError, AttributeError) as e:
+                    self._mtime = mtime
+                    logger.error(f"Invalid dataset manifest {self.manifest_path}: {str(e)}")
+                    if force:
+                        raise ValueError(f"Invalid dataset manifest: {str(e)}")
+                    return
+            reset = {
+                name
+                for name in set(configs) | set(self._configs)
+                if configs.get(name) != self._configs.get(name)
+            }
+            for name in reset & set(self._datasets):
+                # Dropped or reconfigured; in-flight requests keep the old instance
+                del self._datasets[name]
+            self._configs, self._mtime = configs, mtime
+            logger.info(f"Dataset manifest {self.manifest_path}: {sorted(configs)}")
+        self._notify_reset(sorted(reset))
+
+    def names(self) -> List[str]:
+        self.refresh()
+        names = sorted(self._configs)
+        return ([DEFAULT_DATASET] if self.default is not None else []) + names
+
+    def config(self, name: str) -> DatasetConfig:
+        """Manifest entry by name; KeyError when it is not configured."""
+        self.refresh()
+        return self._configs[name]
+
+    def get(self, name: str) -> Dataset:
+        """Dataset by name; KeyError when it is not configured."""
+        if name == DEFAULT_DATASET and self.default is not None:
+            return self.default
+        self.refresh()
+        with self._lock:
+            dataset = self._datasets.get(name)
+            if dataset is None:
+                dataset = Dataset(self._configs[name])
+                self._datasets[name] = dataset
+            return dataset
+
+    def unload(self, name: str) -> bool:
+        """Release a dataset's graphs and caches; it is rebuilt on its next request."""
+        with self._lock:
+            unloaded = self._datasets.pop(name, None) is not None
+        self._notify_reset([name])
+        return unloaded
+
+
+_active: ContextVar[Optional[Dataset]] = ContextVar("active_dataset", default=None)
+
+
+@contextmanager
+def activate(dataset: Dataset):
+    """Scope database, id offsets, analytics and graph lookups to a dataset."""
+    token = _active.set(dataset)
+    try:
+        with use_database(dataset.config.database_url), use_timepoint_offsets(
+            dataset.timepoint_offsets()
+        ), use_analytics_store(dataset.analytics_store):
+            yield dataset
+    finally:
+        _active.reset(token)
+
+
+def active_dataset() -> Optional[Dataset]:
+    return _active.get()
+
+
+def current_dataset_name() -> str:
+    dataset = _active.get()
+    return dataset.name if dataset is not None else DEFAULT_DATASET
+
+
+def get_graph_manager() -> Optional[GraphManager]:
+    """GraphManager of the active dataset, else the app's (None when it has none)."""
+    dataset = _active.get()
+    if dataset is not None and not dataset.is_default:
+        return dataset.graph_manager
+    return getattr(current_app, "graph_manager", None)
+
+
+def get_graph_data_dir() -> str:
+    """Directory for the active dataset's graph files, tiles and indexes."""
+    dataset = _active.get()
+    if dataset is not None and not dataset.is_default:
+        return dataset.config.graph_data_dir
+    return current_app.config["GRAPH_DATA_DIR"]
+
+
+def scoped_url(url: str) -> str:
+    """Rewrite an /api URL built by url_for into the active dataset's namespace."""
+    dataset = _active.get()
+    if dataset is None or dataset.is_default or not url.startswith("/api/"):
+        return url
+    return f"/api/datasets/{dataset.name}/{url[len('/api/'):]}"
+
+
+def get_dataset_config(name: str, manifest_path=None) -> DatasetConfig:
+    """A manifest entry by name, for ingest scripts run outside the server."""
+    if manifest_path is None:
+        manifest_path = default_manifest_path()
+    try:
+        return DatasetRegistry(manifest_path).config(name)
+    except KeyError:
+        raise KeyError(f"Dataset {name} is not in {manifest_path}")
+
+
+def default_manifest_path() -> str:
+    from backend.app.config import get_project_root
+
+    return os.getenv("DATASETS_FILE", os.path.join(get_project_root(), "datasets.json"))
@@ -0,0 +1,472 @@
+# File decomposition_index.py
+# Author: Peter Shaw
+#
+"""Columnar index of a timepoint's decomposition hierarchy.
+
+    connected component -> blocks (block-cut tree) -> SPQR nodes -> bicliques
+
+Every node of the hierarchy is one position in a set of parallel arrays,
+positioned level by level and, within a level, grouped by parent. The
+children of a node at each level are therefore a contiguous run of
+positions, and each level's nodes a contiguous range. Members (graph node
+ids) are laid out in the same order, so the members of a node are one slice
+of ``members``. Nodes overlap where the decomposition does (a cut vertex is
+a member of each of its blocks); ``member_flags`` marks genes and the
+separating nodes (cut vertices of a block, separation pair nodes of an SPQR
+node).
+
+Links within a level:
+- a block's ``link`` is its parent block in the block-cut tree, rooted at
+  the block with the component's lowest node; ``link_a`` is the cut vertex
+  they share
+- an SPQR node's ``link`` is its neighbour towards the root of the block's
+  SPQR tree; ``link_a``/``link_b`` is the separation pair they share
+
+A biclique hangs under the deepest node that contains all of its members.
+``source_id`` holds the database id of the row the node stands for
+(components.id, triconnected_components.id for blocks recorded there,
+bicliques.id), or -1.
+
+Moving between levels, and from a graph node to the nodes containing it,
+are array slices; nothing is recomputed from the graph.
+"""
+
+from collections import deque
+from dataclasses import dataclass
+from typing import Dict, Iterable, List, Optional, Sequence, Set, Tuple
+
+import networkx as nx
+import numpy as np
+
+from backend.app.biclique_analysis.triconnected import SPLIT_MAX_NODES, split_components
+
+LEVELS = ("component", "block", "spqr", "biclique")
+KINDS = ("component", "block", "bridge", "S", "P", "R", "U", "biclique")
+
+# Member flags
+GENE = 1
+SEPARATOR = 2
+
+NONE = -1
+
+
+@dataclass
+class _Entry:
+    level: int
+    kind: str
+    parent: int = NONE
+    link: int = NONE
+    link_a: int = NONE
+    link_b: int = NONE
+    source_id: int = NONE
+    members: Sequence[int] = ()
+    separators: Set[int] = frozenset()
+
+
+def _csr(keys: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """Unique keys and indptr for an already sorted key column."""
+    unique, counts = np.unique(keys, return_counts=True)
+    indptr = np.zeros(unique.size + 1, dtype=np.int64)
+    np.cumsum(counts, out=indptr[1:])
+    return unique, indptr
+
+
+class DecompositionIndex:
+    """Decomposition hierarchy of one timepoint's original graph."""
+
+    def __init__(
+        self,
+        level: np.ndarray,  # int8[n], index into LEVELS, non-decreasing
+        kind: np.ndarray,  # int8[n], index into KINDS
+        parent: np.ndarray,  # int64[n], position of the parent or -1
+        link: np.ndarray,  # int64[n], see module docstring
+        link_a: np.ndarray,  # int64[n]
+        link_b: np.ndarray,  # int64[n]
+        source_id: np.ndarray,  # int64[n]
+        member_indptr: np.ndarray,  # int64[n + 1], slices of members
+        members: np.ndarray,  # int64[m], graph node ids
+        member_flags: np.ndarray,  # uint8[m], GENE | SEPARATOR
+    ):
+        self.level = level
+        self.kind = kind
+        self.parent = parent
+        self.link = link
+        self.link_a = link_a
+        self.link_b = link_b
+        self.source_id = source_id
+        self.member_indptr = member_indptr
+        self.members = members
+        self.member_flags = member_flags
+
+        count = level.size
+        self.level_indptr = np.searchsorted(level, np.arange(len(LEVELS) + 1)).astype(np.int64)
+        # Children CSR: positions sorted by parent (stable keeps level order)
+        order = np.argsort(parent, kind="stable")
+        roots = int(np.count_nonzero(parent == NONE))
+        self.child_order = order[roots:]
+        self.child_indptr = np.zeros(count + 1, dtype=np.int64)
+        np.cumsum(np.bincount(parent[parent != NONE], minlength=count), out=self.child_indptr[1:])
+        # Node -> positions of the hierarchy nodes containing it
+        self.member_entry = np.repeat(np.arange(count), np.diff(member_indptr))
+        self.node_order = np.argsort(members, kind="stable")
+        self.node_keys, self.node_indptr = _csr(members[self.node_order])
+
+    # Construction
+
+    @classmethod
+    def build(
+        cls,
+        graph: nx.Graph,
+        components: Optional[Sequence[Iterable[int]]] = None,
+        bicliques: Sequence[Tuple[Set[int], Set[int]]] = (),
+        component_ids: Optional[Sequence[int]] = None,
+        biclique_ids: Optional[Sequence[int]] = None,
+        block_ids: Optional[Dict[frozenset, int]] = None,
+        max_split_nodes: int = SPLIT_MAX_NODES,
+    ) -> "DecompositionIndex":
+        """
+        Decompose a bipartite graph (nodes carry ``bipartite``, 1 for genes).
+
+        Args:
+            graph: Original graph of a timepoint
+            components: Node sets of its connected components, in the order of
+                ``component_ids`` (default: all non-trivial components)
+            bicliques: (dmr nodes, gene nodes) pairs, in the order of ``biclique_ids``
+            component_ids, biclique_ids: Database ids recorded as source_id
+            block_ids: Database ids of blocks, keyed by node set
+            max_split_nodes: Larger blocks get one "U" node instead of an SPQR tree
+        """
+        if components is None:
+            components = sorted(
+                (c for c in nx.connected_components(graph) if len(c) > 1), key=min
+            )
+        components = [set(c) for c in components]
+        block_ids = block_ids or {}
+        genes = {n for n, d in graph.nodes(data=True) if d.get("bipartite") == 1}
+
+        entries: List[_Entry] = []
+        component_of: Dict[int, int] = {}
+        for i, nodes in enumerate(components):
+            entries.append(
+                _Entry(
+                    level=0,
+                    kind="component",
+                    source_id=component_ids[i] if component_ids is not None else NONE,
+                    members=sorted(nodes),
+                )
+            )
+            component_of.update((n, i) for n in nodes)
+
+        # Blocks of each component, breadth first over its block-cut tree
+        block_members: Dict[int, Set[int]] = {}
+        blocks_by_node: Dict[int, List[int]] = {}
+        for c, nodes in enumerate(components):
+            if len(nodes) < 2:
+                continue
+            subgraph = graph.subgraph(nodes)
+            cuts = set(nx.articulation_points(subgraph))
+            blocks = sorted((set(b) for b in nx.biconnected_components(subgraph)), key=min)
+            containing: Dict[int, List[int]] = {}
+            for b, members in enumerate(blocks):
+                for n in members & cuts:
+                    containing.setdefault(n, []).append(b)
+            seen, queue, linked = {0}, deque([0]), {0: (NONE, NONE)}
+            while queue:
+                b = queue.popleft()
+                for cut in sorted(blocks[b] & cuts):
+                    for other in containing[cut]:
+                        if other not in seen:
+                            seen.add(other)
+                            linked[other] = (b, cut)
+                            queue.append(other)
+            first = len(entries)
+            position = {b: first + k for k, b in enumerate(linked)}
+            for b, (parent_block, cut) in linked.items():
+                members = blocks[b]
+                position_b = len(entries)
+                entries.append(
+                    _Entry(
+                        level=1,
+                        kind="bridge" if len(members) == 2 else "block",
+                        parent=c,
+                        link=position[parent_block] if parent_block != NONE else NONE,
+                        link_a=cut,
+                        source_id=block_ids.get(frozenset(members), NONE),
+                        members=sorted(members),
+                        separators=members & cuts,
+                    )
+                )
+                block_members[position_b] = members
+                for n in members:
+                    blocks_by_node.setdefault(n, []).append(position_b)
+
+        # SPQR nodes of each block, parents before children
+        spqr_by_block: Dict[int, List[int]] = {}
+        spqr_nodes: Dict[int, Set[int]] = {}
+        for position_b, members in block_members.items():
+            if len(members) < 3:
+                continue
+            parts = split_components(graph.subgraph(members), max_split_nodes)
+            first = len(entries)
+            for part in parts:
+                spqr_by_block.setdefault(position_b, []).append(len(entries))
+                spqr_nodes[len(entries)] = set(part.nodes)
+                pair = part.separation_pair or (NONE, NONE)
+                entries.append(
+                    _Entry(
+                        level=2,
+                        kind=part.kind,
+                        parent=position_b,
+                        link=first + part.parent if part.parent != NONE else NONE,
+                        link_a=pair[0],
+                        link_b=pair[1],
+                        members=part.nodes,
+                        separators={n for edge in part.virtual_edges for n in edge},
+                    )
+                )
+
+        # Bicliques under the deepest node containing them, grouped by parent
+        placed = []
+        for i, (dmrs, gene_nodes) in enumerate(bicliques):
+            nodes = set(dmrs) | set(gene_nodes)
+            if not nodes:
+                continue
+            parent = component_of.get(next(iter(nodes)), NONE)
+            if parent != NONE and not nodes <= components[parent]:
+                parent = NONE
+            for position_b in blocks_by_node.get(next(iter(nodes)), []):
+                if nodes <= block_members[position_b]:
+                    parent = position_b
+                    for position_s in spqr_by_block.get(position_b, []):
+                        if nodes <= spqr_nodes[position_s]:
+                            parent = position_s
+                            break
+                    break
+            placed.append((parent, i, nodes))
+        for parent, i, nodes in sorted(placed, key=lambda p: (p[0], p[1])):
+            entries.append(
+                _Entry(
+                    level=3,
+                    kind="biclique",
+                    parent=parent,
+                    source_id=biclique_ids[i] if biclique_ids is not None else NONE,
+                    members=sorted(nodes),
+                )
+            )
+
+        return cls._from_entries(entries, genes)
+
+    @classmethod
+    def _from_entries(cls, entries: List[_Entry], genes: Set[int]) -> "DecompositionIndex":
+        kind_code = {k: i for i, k in enumerate(KINDS)}
+        sizes = [len(e.members) for e in entries]
+        member_indptr = np.zeros(len(entries) + 1, dtype=np.int64)
+        np.cumsum(sizes, out=member_indptr[1:])
+        members = np.fromiter(
+            (n for e in entries for n in e.members), dtype=np.int64, count=int(member_indptr[-1])
+        )
+        member_flags = np.fromiter(
+            (
+                (GENE if n in genes else 0) | (SEPARATOR if n in e.separators else 0)
+                for e in entries
+                for n in e.members
+            ),
+            dtype=np.uint8,
+            count=members.size,
+        )
+
+        def column(name, dtype=np.int64):
+            return np.array([getattr(e, name) for e in entries], dtype=dtype)
+
+        return cls(
+            level=column("level", np.int8),
+            kind=np.array([kind_code[e.kind] for e in entries], dtype=np.int8),
+            parent=column("parent"),
+            link=column("link"),
+            link_a=column("link_a"),
+            link_b=column("link_b"),
+            source_id=column("source_id"),
+            member_indptr=member_indptr,
+            members=members,
+            member_flags=member_flags,
+        )
+
+    # Persistence (decomposition_nodes / decomposition_members rows)
+
+    NODE_COLUMNS = (
+        "position",
+        "level",
+        "kind",
+        "parent",
+        "link",
+        "link_a",
+        "link_b",
+        "source_id",
+        "member_start",
+        "member_stop",
+    )
+    MEMBER_COLUMNS = ("position", "node_id", "flags")
+
+    def node_rows(self) -> List[Tuple]:
+        """Rows in NODE_COLUMNS order; levels and kinds by name, -1 as NULL."""
+
+        def value(v):
+            return None if v == NONE else v
+
+        return [
+            (
+                i,
+                LEVELS[level],
+                KINDS[kind],
+                value(parent),
+                value(link),
+                value(link_a),
+                value(link_b),
+                value(source_id),
+                start,
+                stop,
+            )
+            for i, (level, kind, parent, link, link_a, link_b, source_id, start, stop) in enumerate(
+                zip(
+                    self.level.tolist(),
+                    self.kind.tolist(),
+                    self.parent.tolist(),
+                    self.link.tolist(),
+                    self.link_a.tolist(),
+                    self.link_b.tolist(),
+                    self.source_id.tolist(),
+                    self.member_indptr[:-1].tolist(),
+                    self.member_indptr[1:].tolist(),
+                )
+            )
+        ]
+
+    def member_rows(self) -> List[Tuple]:
+        return list(
+            zip(range(self.members.size), self.members.tolist(), self.member_flags.tolist())
+        )
+
+    @classmethod
+    def from_rows(cls, nodes: Iterable, members: Iterable) -> "DecompositionIndex":
+        """Rebuild the index from rows with NODE_COLUMNS / MEMBER_COLUMNS attributes."""
+        nodes = sorted(nodes, key=lambda r: r.position)
+        members = sorted(members, key=lambda r: r.position)
+        level_code = {name: i for i, name in enumerate(LEVELS)}
+        kind_code = {name: i for i, name in enumerate(KINDS)}
+
+        def column(name):
+            return np.array(
+                [NONE if getattr(r, name) is None else getattr(r, name) for r in nodes],
+                dtype=np.int64,
+            )
+
+        member_indptr = np.zeros(len(nodes) + 1, dtype=np.int64)
+        member_indptr[1:] = [r.member_stop for r in nodes]
+        return cls(
+            level=np.array([level_code[r.level] for r in nodes], dtype=np.int8),
+            kind=np.array([kind_code[r.kind] for r in nodes], dtype=np.int8),
+            parent=column("parent"),
+            link=column("link"),
+            link_a=column("link_a"),
+            link_b=column("link_b"),
+            source_id=column("source_id"),
+            member_indptr=member_indptr,
+            members=np.array([r.node_id for r in members], dtype=np.int64),
+            member_flags=np.array([r.flags for r in members], dtype=np.uint8),
+        )
+
+    # Lookups
+
+    @property
+    def num_nodes(self) -> int:
+        return int(self.level.size)
+
+    @property
+    def nbytes(self) -> int:
+        arrays = [
+            self.level,
+            self.kind,
+            self.parent,
+            self.link,
+            self.link_a,
+            self.link_b,
+            self.source_id,
+            self.member_indptr,
+            self.members,
+            self.member_flags,
+            self.level_indptr,
+            self.child_order,
+            self.child_indptr,
+            self.member_entry,
+            self.node_order,
+            self.node_keys,
+            self.node_indptr,
+        ]
+        return sum(a.nbytes for a in arrays)
+
+    def level_positions(self, level: str) -> range:
+        """Positions of all nodes of a level (a contiguous range)."""
+        i = LEVELS.index(level)
+        return range(int(self.level_indptr[i]), int(self.level_indptr[i + 1]))
+
+    def find(self, level: str, source_id: int) -> Optional[int]:
+        """Position of the node of a level standing for a database row."""
+        span = self.level_positions(level)
+        hits = np.flatnonzero(self.source_id[span.start : span.stop] == source_id)
+        return span.start + int(hits[0]) if hits.size else None
+
+    def children(self, position: int, level: Optional[str] = None) -> np.ndarray:
+        """Positions of a node's children, optionally only those of one level."""
+        children = self.child_order[self.child_indptr[position] : self.child_indptr[position + 1]]
+        if level is not None:
+            children = children[self.level[children] == LEVELS.index(level)]
+        return children
+
+    def ancestors(self, position: int) -> List[int]:
+        """Positions from the node's parent up to its component."""
+        path = []
+        position = int(self.parent[position])
+        while position != NONE:
+            path.append(position)
+            position = int(self.parent[position])
+        return path
+
+    def node_members(self, position: int) -> Tuple[np.ndarray, np.ndarray]:
+        """Graph node ids of a hierarchy node and their flags."""
+        span = slice(int(self.member_indptr[position]), int(self.member_indptr[position + 1]))
+        return self.members[span], self.member_flags[span]
+
+    def containing(self, node_id: int, level: Optional[str] = None) -> np.ndarray:
+        """Positions of the hierarchy nodes a graph node is a member of."""
+        i = int(np.searchsorted(self.node_keys, node_id))
+        if i == self.node_keys.size or self.node_keys[i] != node_id:
+            return np.zeros(0, dtype=np.int64)
+        rows = self.node_order[self.node_indptr[i] : self.node_indptr[i + 1]]
+        positions = self.member_entry[rows]
+        if level is not None:
+            positions = positions[self.level[positions] == LEVELS.index(level)]
+        return positions
+
+    def describe(self, position: int) -> Dict:
+        """Fields of one hierarchy node, members as raw graph node ids."""
+        nodes, flags = self.node_members(position)
+        gene = (flags & GENE) != 0
+        separator = (flags & SEPARATOR) != 0
+        link_pair = [v for v in (int(self.link_a[position]), int(self.link_b[position])) if v != NONE]
+        counts = {
+            level: int(np.count_nonzero(self.level[self.children(position)] == i))
+            for i, level in enumerate(LEVELS)
+        }
+        return {
+            "position": position,
+            "level": LEVELS[self.level[position]],
+            "kind": KINDS[self.kind[position]],
+            "source_id": None if self.source_id[position] == NONE else int(self.source_id[position]),
+            "parent": None if self.parent[position] == NONE else int(self.parent[position]),
+            "link": None if self.link[position] == NONE else int(self.link[position]),
+            "link_nodes": link_pair,
+            "dmrs": nodes[~gene].tolist(),
+            "genes": nodes[gene].tolist(),
+            "separators": nodes[separator].tolist(),
+            "child_counts": {level: n for level, n in counts.items() if n},
+        }
@@ -0,0 +1,209 @@
+# File edge_index.py
+# Author: Peter Shaw
+#
+"""Columnar in-memory index of a timepoint's ``edge_details`` rows.
+
+Each edge is one position in a set of parallel arrays: DMR id, gene id,
+distance from the TSS, and small integer codes into per-index vocabularies
+for the gene symbol, edge type, edit type and description. Rows are sorted
+by (DMR, gene), so the edges of a DMR are a contiguous slice found through a
+CSR ``indptr``; a second permutation plus ``indptr`` gives the same for genes.
+Lookups are two binary searches and a slice, with no database round trip.
+"""
+
+from dataclasses import dataclass
+from typing import Dict, Iterable, List, Sequence, Tuple
+
+import numpy as np
+
+# Value stored for a NULL distance_from_tss
+MISSING_DISTANCE = np.iinfo(np.int64).min
+
+# Output key for each coded column, in the order rows are unpacked
+CODED_COLUMNS = ("gene_symbol", "edge_type", "edit_type", "description")
+
+
+def _encode(values: Sequence) -> Tuple[np.ndarray, List]:
+    """Integer codes for a column plus the vocabulary they index."""
+    vocabulary: Dict = {}
+    codes = np.fromiter(
+        (vocabulary.setdefault(v, len(vocabulary)) for v in values),
+        dtype=np.int32,
+        count=len(values),
+    )
+    return codes, list(vocabulary)
+
+
+def _csr(keys: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """Unique keys and indptr for an already sorted key column."""
+    unique, counts = np.unique(keys, return_counts=True)
+    indptr = np.zeros(unique.size + 1, dtype=np.int64)
+    np.cumsum(counts, out=indptr[1:])
+    return unique, indptr
+
+
+@dataclass
+class EdgeDetailsIndex:
+    """Edge details of one timepoint with per-DMR and per-gene slices."""
+
+    dmr_ids: np.ndarray  # int64[m], sorted by (dmr, gene)
+    gene_ids: np.ndarray  # int64[m]
+    distances: np.ndarray  # int64[m], MISSING_DISTANCE for NULL
+    codes: Dict[str, np.ndarray]  # column -> int32[m] codes
+    vocabularies: Dict[str, List]  # column -> code -> value
+    dmr_keys: np.ndarray  # sorted unique DMR ids
+    dmr_indptr: np.ndarray  # edges of dmr_keys[i] are rows dmr_indptr[i]:[i+1]
+    gene_order: np.ndarray  # row permutation sorting edges by (gene, dmr)
+    gene_keys: np.ndarray
+    gene_indptr: np.ndarray  # slices into gene_order
+
+    @classmethod
+    def from_rows(cls, rows: Iterable) -> "EdgeDetailsIndex":
+        """
+        Build the index from rows with dmr_id, gene_id, gene_symbol, edge_type,
+        edit_type, distance_from_tss and description attributes.
+        """
+        rows = sorted(rows, key=lambda r: (r.dmr_id, r.gene_id))
+        count = len(rows)
+
+        dmr_ids = np.fromiter((r.dmr_id for r in rows), dtype=np.int64, count=count)
+        gene_ids = np.fromiter((r.gene_id for r in rows), dtype=np.int64, count=count)
+        distances = np.fromiter(
+            (
+                MISSING_DISTANCE if r.distance_from_tss is None else r.distance_from_tss
+                for r in rows
+            ),
+            dtype=np.int64,
+            count=count,
+        )
+        codes, vocabularies = {}, {}
+        for column in CODED_COLUMNS:
+            codes[column], vocabularies[column] = _encode(
+                [getattr(r, column) for r in rows]
+            )
+
+        dmr_keys, dmr_indptr = _csr(dmr_ids)
+        gene_order = np.lexsort((dmr_ids, gene_ids))
+        gene_keys, gene_indptr = _csr(gene_ids[gene_order])
+
+        return cls(
+            dmr_ids=dmr_ids,
+            gene_ids=gene_ids,
+            distances=distances,
+            codes=codes,
+            vocabularies=vocabularies,
+            dmr_keys=dmr_keys,
+            dmr_indptr=dmr_indptr,
+            gene_order=gene_order,
+            gene_keys=gene_keys,
+            gene_indptr=gene_indptr,
+        )
+
+    @property
+    def num_edges(self) -> int:
+        return int(self.dmr_ids.size)
+
+    @property
+    def nbytes(self) -> int:
+        """Bytes held by the index arrays (vocabularies not included)."""
+        arrays = [
+            self.dmr_ids,
+            self.gene_ids,
+            self.distances,
+            self.dmr_keys,
+            self.dmr_indptr,
+            self.gene_order,
+            self.gene_keys,
+            self.gene_indptr,
+            *self.codes.values(),
+        ]
+        return sum(a.nbytes for a in arrays)
+
+    def _slice(self, keys: np.ndarray, indptr: np.ndarray, node_id: int) -> slice:
+        pos = int(np.searchsorted(keys, node_id))
+        if pos == keys.size or keys[pos] != node_id:
+            return slice(0, 0)
+        return slice(int(indptr[pos]), int(indptr[pos + 1]))
+
+    def dmr_rows(self, dmr_id: int) -> np.ndarray:
+        """Row positions of the edges of a DMR, ordered by gene."""
+        rows = self._slice(self.dmr_keys, self.dmr_indptr, dmr_id)
+        return np.arange(rows.start, rows.stop)
+
+    def gene_rows(self, gene_id: int) -> np.ndarray:
+        """Row positions of the edges of a gene, ordered by DMR."""
+        return self.gene_order[self._slice(self.gene_keys, self.gene_indptr, gene_id)]
+
+    def records(self, rows: np.ndarray) -> List[Dict]:
+        """Edge detail dictionaries, in the shape the edge-details API returns."""
+        decoded = {
+            column: [self.vocabularies[column][c] for c in self.codes[column][rows]]
+            for column in CODED_COLUMNS
+        }
+        distances = self.distances[rows].tolist()
+        return [
+            {
+                "dmr_id": dmr_id,
+                "gene_id": gene_id,
+                "gene_symbol": decoded["gene_symbol"][i],
+                "edge_type": decoded["edge_type"][i],
+                "edit_type": decoded["edit_type"][i],
+                "distance_from_tss": None
+                if distances[i] == MISSING_DISTANCE
+                else distances[i],
+                "description": decoded["description"][i],
+            }
+            for i, (dmr_id, gene_id) in enumerate(
+                zip(self.dmr_ids[rows].tolist(), self.gene_ids[rows].tolist())
+            )
+        ]
+
+    def dmr_edges(self, dmr_id: int) -> List[Dict]:
+        return self.records(self.dmr_rows(dmr_id))
+
+    def gene_edges(self, gene_id: int) -> List[Dict]:
+        return self.records(self.gene_rows(gene_id))
+
+    def set_edit_types(self, updates: Iterable[Tuple[int, int, str]]) -> int:
+        """
+        Apply (dmr_id, gene_id, edit_type) updates, as written to the database
+        by update_edge_details; the source edge_type is left unchanged.
+        Returns the number of edges changed.
+        """
+        vocabulary = self.vocabularies["edit_type"]
+        lookup = {value: code for code, value in enumerate(vocabulary)}
+        changed = 0
+        for dmr_id, gene_id, edit_type in updates:
+            rows = self.dmr_rows(dmr_id)
+            pos = np.searchsorted(self.gene_ids[rows], gene_id)
+            if pos == rows.size or self.gene_ids[rows[pos]] != gene_id:
+                continue
+            if edit_type not in lookup:
+                lookup[edit_type] = len(vocabulary)
+                vocabulary.append(edit_type)
+            self.codes["edit_type"][rows[pos]] = lookup[edit_type]
+            changed += 1
+        return changed
+
+    def dmr_edge_counts(self) -> Dict[int, int]:
+        """Number of edges of each DMR, straight from the CSR offsets."""
+        return dict(zip(self.dmr_keys.tolist(), np.diff(self.dmr_indptr).tolist()))
+
+    def dmr_metadata(self) -> Dict[int, Dict]:
+        """Per-DMR edge lists: {dmr_id: {"edge_details": [...]}}, one dict per edge."""
+        metadata = {}
+        for i, dmr_id in enumerate(self.dmr_keys.tolist()):
+            rows = np.arange(self.dmr_indptr[i], self.dmr_indptr[i + 1])
+            metadata[dmr_id] = {
+                "edge_details": [
+                    {
+                        "gene_id": edge["gene_id"],
+                        "gene_name": edge["gene_symbol"],
+                        "edge_type": edge["edge_type"],
+                        "distance_from_tss": edge["distance_from_tss"],
+                        "edit_type": edge["edit_type"],
+                    }
+                    for edge in self.records(rows)
+                ]
+            }
+        return metadata
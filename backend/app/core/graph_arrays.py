@@ -0,0 +1,240 @@
+# File graph_arrays.py
+# Author: Peter Shaw
+#
+"""Compact CSR representation of a timepoint graph.
+
+NetworkX graphs are convenient for building and editing, but every node and
+edge is a Python object. ``GraphArrays`` freezes a graph into a handful of
+numpy arrays (sorted node ids, node types, CSR adjacency and connected
+component labels) that are cheap to keep per timepoint, fast to scan with
+vectorised code and can be shipped to the browser as one binary blob.
+
+Binary layout (little-endian, every section 8-byte aligned)::
+
+    0   char[4]  magic "DMRG"
+    4   uint32   format version
+    8   uint32   number of nodes
+    12  uint32   number of (undirected) edges
+    16  uint32   number of connected components
+    20  uint32   number of sections
+    24  section table, one entry per section:
+            char[8] name, uint64 byte offset, uint64 byte length
+        followed by the section payloads
+
+Sections: ``node_ids`` int32[n], ``ntype`` int8[n] (0 = DMR, 1 = gene),
+``indptr`` int32[n+1], ``indices`` int32[2m] (neighbour positions) and
+``comp`` int32[n] (component label, -1 for isolated nodes). A client can read
+the header with a small range request and fetch only the sections it needs.
+"""
+
+import struct
+from dataclasses import dataclass
+from typing import Dict
+
+import networkx as nx
+import numpy as np
+from scipy.sparse import csr_matrix
+from scipy.sparse.csgraph import connected_components
+
+GRAPH_ARRAYS_MAGIC = b"DMRG"
+GRAPH_ARRAYS_VERSION = 1
+HEADER_FORMAT = "<4s5I"
+SECTION_FORMAT = "<8sQQ"
+SECTIONS = (
+    ("node_ids", np.int32),
+    ("ntype", np.int8),
+    ("indptr", np.int32),
+    ("indices", np.int32),
+    ("comp", np.int32),
+)
+
+
+def _align(offset: int, alignment: int = 8) -> int:
+    return (offset + alignment - 1) // alignment * alignment
+
+
+@dataclass
+class GraphArrays:
+    """Immutable CSR view of a bipartite DMR/gene graph."""
+
+    node_ids: np.ndarray  # sorted node ids
+    node_type: np.ndarray  # bipartite attribute per node
+    indptr: np.ndarray  # CSR row pointers, length n + 1
+    indices: np.ndarray  # neighbour positions, length 2m
+    component: np.ndarray  # component label per node, -1 for isolated
+
+    @classmethod
+    def from_edges(
+        cls, node_ids, node_type, src_ids, dst_ids
+    ) -> "GraphArrays":
+        """
+        Build arrays from node and edge id lists.
+
+        Args:
+            node_ids: All node ids (need not be sorted)
+            node_type: Bipartite attribute for each entry of node_ids
+            src_ids, dst_ids: Edge endpoints as node ids
+        """
+        node_ids = np.asarray(node_ids, dtype=np.int64)
+        order = np.argsort(node_ids, kind="stable")
+        node_ids = node_ids[order]
+        node_type = np.asarray(node_type, dtype=np.int8)[order]
+        n = node_ids.size
+
+        src = np.searchsorted(node_ids, np.asarray(src_ids, dtype=np.int64))
+        dst = np.searchsorted(node_ids, np.asarray(dst_ids, dtype=np.int64))
+
+        # Store each undirected edge in both directions, neighbours sorted
+        rows = np.concatenate([src, dst])
+        cols = np.concatenate([dst, src])
+        order = np.lexsort((cols, rows))
+        rows, cols = rows[order], cols[order]
+
+        indptr = np.zeros(n + 1, dtype=np.int64)
+        np.cumsum(np.bincount(rows, minlength=n), out=indptr[1:])
+        indices = cols.astype(np.int32)
+
+        component = np.full(n, -1, dtype=np.int32)
+        if n:
+            adjacency = csr_matrix(
+                (np.ones(indices.size, dtype=np.int8), indices, indptr), shape=(n, n)
+            )
+            _, labels = connected_components(adjacency, directed=False)
+            connected = np.diff(indptr) > 0
+            # Relabel so non-isolated components are numbered 0..k-1
+            _, relabelled = np.unique(labels[connected], return_inverse=True)
+            component[connected] = relabelled
+
+        return cls(node_ids, node_type, indptr, indices, component)
+
+    @classmethod
+    def from_networkx(cls, graph: nx.Graph) -> "GraphArrays":
+        """Freeze a NetworkX graph; nodes without a bipartite attribute are DMRs."""
+        nodes = list(graph.nodes())
+        node_type = [graph.nodes[n].get("bipartite", 0) for n in nodes]
+        if graph.number_of_edges():
+            src, dst = zip(*graph.edges())
+        else:
+            src, dst = (), ()
+        return cls.from_edges(nodes, node_type, src, dst)
+
+    @property
+    def num_nodes(self) -> int:
+        return int(self.node_ids.size)
+
+    @property
+    def num_edges(self) -> int:
+        return int(self.indices.size // 2)
+
+    @property
+    def num_components(self) -> int:
+        return int(self.component.max() + 1) if self.component.size else 0
+
+    @property
+    def nbytes(self) -> int:
+        return sum(
+            a.nbytes for a in (self.node_ids, self.node_type, self.indptr, self.indices, self.component)
+        )
+
+    def degrees(self) -> np.ndarray:
+        return np.diff(self.indptr)
+
+    def positions(self, node_ids) -> np.ndarray:
+        """Map node ids to array positions (-1 for unknown ids)."""
+        node_ids = np.asarray(node_ids, dtype=np.int64)
+        if not self.num_nodes:
+            return np.full(node_ids.shape, -1, dtype=np.int64)
+        pos = np.minimum(np.searchsorted(self.node_ids, node_ids), self.num_nodes - 1)
+        return np.where(self.node_ids[pos] == node_ids, pos, -1)
+
+    def neighbors(self, node_id: int) -> np.ndarray:
+        """Neighbour ids of a single node."""
+        pos = int(self.positions([node_id])[0])
+        if pos < 0:
+            return np.empty(0, dtype=self.node_ids.dtype)
+        return self.node_ids[self.indices[self.indptr[pos] : self.indptr[pos + 1]]]
+
+    def edge_arrays(self):
+        """Return (src_pos, dst_pos) with each undirected edge once, src < dst."""
+        src = np.repeat(np.arange(self.num_nodes), self.degrees())
+        mask = src < self.indices
+        return src[mask], self.indices[mask].astype(np.int64)
+
+    def summary(self) -> Dict:
+        """Small JSON-friendly description of the graph."""
+        sizes = np.bincount(self.component[self.component >= 0])
+        return {
+            "num_nodes": self.num_nodes,
+            "num_edges": self.num_edges,
+            "num_dmrs": int(np.count_nonzero(self.node_type == 0)),
+            "num_genes": int(np.count_nonzero(self.node_type == 1)),
+            "num_isolated": int(np.count_nonzero(self.component < 0)),
+            "num_components": self.num_components,
+            "largest_component": int(sizes.max()) if sizes.size else 0,
+        }
+
+    def to_bytes(self) -> bytes:
+        """Serialise to the binary layout described in the module docstring."""
+        payloads = [
+            (name, np.ascontiguousarray(getattr(self, attr), dtype=dtype).tobytes())
+            for (name, dtype), attr in zip(
+                SECTIONS, ("node_ids", "node_type", "indptr", "indices", "component")
+            )
+        ]
+
+        table_start = struct.calcsize(HEADER_FORMAT)
+        offset = _align(table_start + len(payloads) * struct.calcsize(SECTION_FORMAT))
+        table = []
+        for name, payload in payloads:
+            table.append((name.encode("ascii"), offset, len(payload)))
+            offset = _align(offset + len(payload))
+
+        buffer = bytearray(offset)
+        struct.pack_into(
+            HEADER_FORMAT,
+            buffer,
+            0,
+            GRAPH_ARRAYS_MAGIC,
+            GRAPH_ARRAYS_VERSION,
+            self.num_nodes,
+            self.num_edges,
+            self.num_components,
+            len(payloads),
+        )
+        for i, (entry, (_, payload)) in enumerate(zip(table, payloads)):
+            struct.pack_into(
+                SECTION_FORMAT,
+                buffer,
+                table_start + i * struct.calcsize(SECTION_FORMAT),
+                *entry,
+            )
+            buffer[entry[1] : entry[1] + entry[2]] = payload
+        return bytes(buffer)
+
+    @classmethod
+    def from_bytes(cls, data: bytes) -> "GraphArrays":
+        """Inverse of to_bytes."""
+        magic, version, _, _, _, count = struct.unpack_from(HEADER_FORMAT, data, 0)
+        if magic != GRAPH_ARRAYS_MAGIC or version != GRAPH_ARRAYS_VERSION:
+            raise ValueError("Not a graph arrays buffer")
+
+        dtypes = dict(SECTIONS)
+        arrays = {}
+        table_start = struct.calcsize(HEADER_FORMAT)
+        for i in range(count):
+            name, offset, length = struct.unpack_from(
+                SECTION_FORMAT, data, table_start + i * struct.calcsize(SECTION_FORMAT)
+            )
+            name = name.rstrip(b"\0").decode("ascii")
+            arrays[name] = np.frombuffer(
+                data, dtype=dtypes[name], count=length // np.dtype(dtypes[name]).itemsize,
+                offset=offset,
+            )
+
+        return cls(
+            arrays["node_ids"].astype(np.int64),
+            arrays["ntype"].copy(),
+            arrays["indptr"].astype(np.int64),
+            arrays["indices"].copy(),
+            arrays["comp"].copy(),
+        )
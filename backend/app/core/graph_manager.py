@@ -3,8 +3,13 @@
 # Started 8 Jan 2025
 #
 
+import hashlib
 import os
+import threading
 import networkx as nx
+import numpy as np
+from collections import OrderedDict
+from contextlib import ExitStack, contextmanager
 from pathlib import Path
 from typing import Dict, Optional, Tuple, List, Set
 from sqlalchemy.orm import Session
@@ -12,21 +17,38 @@ from sqlalchemy import text
 from flask import current_app
 from dataclasses import dataclass
 
+from backend.app import native
 from backend.app.utils.graph_io import read_bipartite_graph
 from backend.app.core.data_loader import create_bipartite_graph, read_gene_mapping
-from backend.app.database.connection import get_db_engine
+from backend.app.database.connection import get_db_engine, use_database
 from backend.app.database.operations import update_component_edge_classification
 from backend.app.database.models import Timepoint
 from backend.app.schemas import TimePointSchema
 from backend.app.biclique_analysis.edge_classification import classify_edges
 from backend.app.database.operations import update_edge_details
-from backend.app.utils.id_mapping import convert_dmr_id
+from backend.app.database.decomposition import load_decomposition_index
+from backend.app.utils.id_mapping import convert_dmr_id, use_timepoint_offsets
+from backend.app.core.graph_arrays import GraphArrays
+from backend.app.core.edge_index import EdgeDetailsIndex
+from backend.app.core.decomposition_index import DecompositionIndex
 
 
 import logging
 
 logger = logging.getLogger(__name__)
 
+# Rough in-memory footprint of a networkx graph: a node costs its adjacency
+# and attribute dicts, an edge two adjacency entries and a shared attribute dict
+NX_NODE_BYTES = 400
+NX_EDGE_BYTES = 450
+
+
+def estimate_graph_bytes(graph: Optional[nx.Graph]) -> int:
+    """Approximate memory held by a networkx graph."""
+    if graph is None:
+        return 0
+    return graph.number_of_nodes() * NX_NODE_BYTES + graph.number_of_edges() * NX_EDGE_BYTES
+
 
 class ComponentMapping:
     """Maps components between original and split graphs"""
@@ -47,7 +69,10 @@ class ComponentMapping:
         )
 
         # Get components
-        self._compute_components()
+        if native.available():
+            self._compute_components_native(original_graph, split_graph)
+        else:
+            self._compute_components()
 
     def _compute_components(self):
         """Compute components and establish mapping between them"""
@@ -70,6 +95,32 @@ class ComponentMapping:
                     self.split_to_original[split_id] = orig_id
                     break
 
+    def _compute_components_native(self, original_graph: nx.Graph, split_graph: nx.Graph):
+        """Label the full graphs natively, dropping the singleton (isolated) nodes"""
+
+        def label_components(graph):
+            nodes, labels = native.connected_components(graph)
+            keep = np.bincount(labels)[labels] > 1
+            # Renumber densely; first-appearance order is preserved
+            _, labels = np.unique(labels[keep], return_inverse=True)
+            return [n for n, k in zip(nodes, keep.tolist()) if k], labels.tolist()
+
+        orig_nodes, orig_labels = label_components(original_graph)
+        split_nodes, split_labels = label_components(split_graph)
+
+        for node, label in zip(orig_nodes, orig_labels):
+            self.original_components.setdefault(label, set()).add(node)
+        for node, label in zip(split_nodes, split_labels):
+            self.split_components.setdefault(label, set()).add(node)
+
+        # A split component lies inside an original one iff all of its nodes
+        # carry the same original label
+        orig_label = dict(zip(orig_nodes, orig_labels))
+        for split_id, nodes in self.split_components.items():
+            labels = {orig_label.get(node) for node in nodes}
+            if len(labels) == 1 and None not in labels:
+                self.split_to_original[split_id] = labels.pop()
+
     def get_original_component(self, split_component_id: int) -> Set[int]:
         """Get the original component containing a split component"""
         orig_id = self.split_to_original.get(split_component_id)
@@ -109,16 +160,54 @@ class GraphManager:
     timepoints: Dict[int, TimepointInfo]  # Change type annotation
     data_dir: str
 
-    def __init__(self, config=None):
+    def __init__(self, config=None, database_url: Optional[str] = None):
+        """
+        Args:
+            config: Mapping with DATA_DIR and optionally TIMEPOINTS (ids to
+                serve, default all), GRAPH_PRELOAD (load every timepoint up
+                front, default True) and GRAPH_MEMORY_BUDGET_MB (evict least
+                recently used timepoints beyond it, default unlimited)
+            database_url: Database of this manager's dataset; by default the
+                one get_db_engine() resolves
+        """
         logger.info("Initializing GraphManager")
+        config = config or {}
         self.original_graphs = {}
         self.split_graphs = {}
         self.timepoints = {}  # Add timepoint mapping cache
         self.component_mappings = {}  # Add this to store mappings per timepoint
-        self.data_dir = config.get("DATA_DIR", "./data") if config else "./data"
+        self.graph_arrays = {}  # (timepoint_id, graph_type) -> GraphArrays
+        self.graph_array_bytes = {}  # (timepoint_id, graph_type) -> serialised arrays
+        self.graph_array_etags = {}  # (timepoint_id, graph_type) -> ETag of those bytes
+        self.edge_indexes = {}  # timepoint_id -> EdgeDetailsIndex
+        self._index_lock = threading.Lock()  # one build per lazily loaded index
+        self.decomposition_indexes = {}  # timepoint_id -> DecompositionIndex
+        self.data_dir = config.get("DATA_DIR", "./data")
+        self.database_url = database_url
+        timepoint_ids = config.get("TIMEPOINTS")
+        self.timepoint_filter = (
+            {int(t) for t in timepoint_ids} if timepoint_ids is not None else None
+        )
+        self.preload = str(config.get("GRAPH_PRELOAD", True)).lower() not in ("0", "false", "no")
+        budget_mb = config.get("GRAPH_MEMORY_BUDGET_MB")
+        self.memory_budget = int(float(budget_mb) * 1024 * 1024) if budget_mb else None
+        self.timepoint_bytes: "OrderedDict[int, int]" = OrderedDict()  # LRU order
         logger.info(f"Using data directory: {self.data_dir}")
         self.load_all_timepoints()
 
+    @contextmanager
+    def scope(self):
+        """Resolve database access and DMR id offsets against this manager's dataset."""
+        with ExitStack() as stack:
+            if self.database_url is not None:
+                stack.enter_context(use_database(self.database_url))
+                stack.enter_context(use_timepoint_offsets(self.timepoint_offsets()))
+            yield
+
+    def timepoint_offsets(self) -> Dict[int, int]:
+        """DMR id offset of every cached timepoint"""
+        return {tp_id: info.dmr_id_offset for tp_id, info in self.timepoints.items()}
+
     def initialize_timepoint_mapping(self, timepoint_id: int) -> ComponentMapping:
         """Initialize component mapping when timepoint is selected"""
         logger.info(f"Initializing component mapping for timepoint {timepoint_id}")
@@ -217,10 +306,13 @@ class GraphManager:
     def load_all_timepoints(self):
         """Load graphs for all timepoints from the database"""
         try:
-            engine = get_db_engine()
+            engine = get_db_engine(self.database_url)
             with Session(engine) as session:
                 # Get all timepoints with complete information
-                timepoints = session.query(Timepoint).all()
+                query = session.query(Timepoint)
+                if self.timepoint_filter is not None:
+                    query = query.filter(Timepoint.id.in_(self.timepoint_filter))
+                timepoints = query.all()
                 print(f"\nLoading graphs for {len(timepoints)} timepoints...")
 
                 # Debug logging
@@ -244,6 +336,10 @@ class GraphManager:
                     self.timepoints[int(timepoint.id)] = timepoint_info
                     logger.info(f"Cached timepoint {timepoint.id}: {timepoint.name}")
 
+                    if not self.preload:
+                        # Graphs are loaded on first use
+                        continue
+
                     try:
                         self.load_graphs(int(timepoint.id))
                     except Exception as e:
@@ -293,43 +389,16 @@ class GraphManager:
 
     def load_graphs(self, timepoint_id: int) -> None:
         """Load graphs for a specific timepoint"""
+        with self.scope():
+            self._load_graphs(timepoint_id)
+        self._enforce_memory_budget(timepoint_id)
+
+    def _load_graphs(self, timepoint_id: int) -> None:
         try:
             timepoint_info = self.timepoints.get(timepoint_id)
             if not timepoint_info:
                 raise ValueError(f"Timepoint {timepoint_id} not found")
 
-            # Load edge details for DMRs
-            engine = get_db_engine()
-            with Session(engine) as session:
-                # Query edge details for all DMRs in this timepoint
-                edge_details = session.execute(
-                    text("""
-                        SELECT ed.dmr_id, ed.gene_id, g.symbol as gene_name,
-                               ed.edge_type, ed.edit_type, ed.distance_from_tss
-                        FROM edge_details ed
-                        JOIN genes g ON ed.gene_id = g.id
-                        WHERE ed.timepoint_id = :timepoint_id
-                    """),
-                    {"timepoint_id": timepoint_id},
-                ).fetchall()
-
-                # Group edge details by DMR
-                self.dmr_edge_details = {}
-                for detail in edge_details:
-                    dmr_id = detail.dmr_id
-                    if dmr_id not in self.dmr_edge_details:
-                        self.dmr_edge_details[dmr_id] = {"edge_details": []}
-
-                    self.dmr_edge_details[dmr_id]["edge_details"].append(
-                        {
-                            "gene_id": detail.gene_id,
-                            "gene_name": detail.gene_name,
-                            "edge_type": detail.edge_type,
-                            "distance_from_tss": detail.distance_from_tss,
-                            "edit_type": detail.edit_type,
-                        }
-                    )
-
             original_graph_file, split_graph_file = self.get_graph_paths(timepoint_info)
 
             logger.info(f"Loading graphs for timepoint {timepoint_id}")
@@ -486,6 +555,7 @@ class GraphManager:
 
     def get_original_graph(self, timepoint_id: int) -> Optional[nx.Graph]:
         """Get the original graph for a timepoint"""
+        self._touch(timepoint_id)
         if timepoint_id not in self.original_graphs:
             try:
                 self.load_graphs(timepoint_id)
@@ -498,6 +568,7 @@ class GraphManager:
 
     def get_split_graph(self, timepoint_id: int) -> Optional[nx.Graph]:
         """Get the split graph for a timepoint"""
+        self._touch(timepoint_id)
         if timepoint_id not in self.split_graphs:
             try:
                 self.load_graphs(timepoint_id)
@@ -512,6 +583,123 @@ class GraphManager:
         """Clear all loaded graphs"""
         self.original_graphs.clear()
         self.split_graphs.clear()
+        self.graph_arrays.clear()
+        self.graph_array_bytes.clear()
+        self.graph_array_etags.clear()
+        self.edge_indexes.clear()
+        self.decomposition_indexes.clear()
+        self.component_mappings.clear()
+        self.timepoint_bytes.clear()
+
+    def evict_timepoint(self, timepoint_id: int) -> None:
+        """Drop everything loaded for one timepoint; it is reloaded on next use"""
+        self.original_graphs.pop(timepoint_id, None)
+        self.split_graphs.pop(timepoint_id, None)
+        self.component_mappings.pop(timepoint_id, None)
+        self.edge_indexes.pop(timepoint_id, None)
+        self.decomposition_indexes.pop(timepoint_id, None)
+        for graph_type in ("original", "split"):
+            self.graph_arrays.pop((timepoint_id, graph_type), None)
+            self.graph_array_bytes.pop((timepoint_id, graph_type), None)
+            self.graph_array_etags.pop((timepoint_id, graph_type), None)
+        self.timepoint_bytes.pop(timepoint_id, None)
+
+    def estimate_timepoint_bytes(self, timepoint_id: int) -> int:
+        """Approximate memory held for a timepoint's graphs, arrays and indexes"""
+        total = estimate_graph_bytes(self.original_graphs.get(timepoint_id))
+        total += estimate_graph_bytes(self.split_graphs.get(timepoint_id))
+        for index in (
+            self.edge_indexes.get(timepoint_id),
+            self.decomposition_indexes.get(timepoint_id),
+        ):
+            if index is not None:
+                total += index.nbytes
+        for graph_type in ("original", "split"):
+            arrays = self.graph_arrays.get((timepoint_id, graph_type))
+            if arrays is not None:
+                total += arrays.nbytes
+            total += len(self.graph_array_bytes.get((timepoint_id, graph_type), b""))
+        return total
+
+    def memory_usage(self) -> Dict:
+        """Estimated bytes per loaded timepoint against the memory budget"""
+        for timepoint_id in self.timepoint_bytes:
+            self.timepoint_bytes[timepoint_id] = self.estimate_timepoint_bytes(timepoint_id)
+        return {
+            "budget_bytes": self.memory_budget,
+            "total_bytes": sum(self.timepoint_bytes.values()),
+            "timepoints": dict(self.timepoint_bytes),
+        }
+
+    def _touch(self, timepoint_id: int) -> None:
+        if timepoint_id in self.timepoint_bytes:
+            self.timepoint_bytes.move_to_end(timepoint_id)
+
+    def _enforce_memory_budget(self, keep: int) -> None:
+        """Account a freshly loaded timepoint and evict the least recently used others"""
+        if keep not in self.original_graphs and keep not in self.split_graphs:
+            return
+        self.timepoint_bytes[keep] = self.estimate_timepoint_bytes(keep)
+        self.timepoint_bytes.move_to_end(keep)
+        if self.memory_budget is None:
+            return
+        while sum(self.timepoint_bytes.values()) > self.memory_budget:
+            oldest = next(iter(self.timepoint_bytes))
+            if oldest == keep:
+                logger.warning(
+                    f"Timepoint {keep} alone exceeds the graph memory budget "
+                    f"({self.timepoint_bytes[keep]} > {self.memory_budget} bytes)"
+                )
+                break
+            logger.info(f"Evicting graphs of timepoint {oldest} (memory budget)")
+            self.evict_timepoint(oldest)
+
+    def get_graph_arrays(
+        self, timepoint_id: int, graph_type: str = "original"
+    ) -> Optional[GraphArrays]:
+        """Get the compact CSR arrays for a timepoint's original or split graph"""
+        key = (timepoint_id, graph_type)
+        if key not in self.graph_arrays:
+            if graph_type == "original":
+                graph = self.get_original_graph(timepoint_id)
+            elif graph_type == "split":
+                graph = self.get_split_graph(timepoint_id)
+            else:
+                raise ValueError(f"Unknown graph type: {graph_type}")
+            if graph is None:
+                return None
+            self.graph_arrays[key] = GraphArrays.from_networkx(graph)
+        return self.graph_arrays[key]
+
+    def get_graph_array_bytes(
+        self, timepoint_id: int, graph_type: str = "original"
+    ) -> Optional[bytes]:
+        """Get the serialised CSR arrays, built once per timepoint and graph type"""
+        key = (timepoint_id, graph_type)
+        if key not in self.graph_array_bytes:
+            arrays = self.get_graph_arrays(timepoint_id, graph_type)
+            if arrays is None:
+                return None
+            data = arrays.to_bytes()
+            self.graph_array_etags[key] = hashlib.sha256(data).hexdigest()[:32]
+            self.graph_array_bytes[key] = data
+        return self.graph_array_bytes[key]
+
+    def get_graph_array_etag(
+        self, timepoint_id: int, graph_type: str = "original"
+    ) -> Optional[str]:
+        """ETag of the serialised CSR arrays, hashed once when they are built"""
+        if self.get_graph_array_bytes(timepoint_id, graph_type) is None:
+            return None
+        return self.graph_array_etags[(timepoint_id, graph_type)]
+
+    def get_timepoint_graph_summary(self, timepoint_id: int) -> Dict:
+        """Summaries of the original and split graphs without any node data"""
+        summary = {}
+        for graph_type in ("original", "split"):
+            arrays = self.get_graph_arrays(timepoint_id, graph_type)
+            summary[graph_type] = arrays.summary() if arrays is not None else None
+        return summary
 
     def load_timepoint_components(self, timepoint_id: int) -> ComponentMapping:
         """Load and map components for a timepoint"""
@@ -523,11 +711,66 @@ class GraphManager:
 
         return ComponentMapping(original_graph, split_graph)
 
-    def get_dmr_metadata(self, timepoint_id: int) -> Dict:
-        """Get DMR metadata including edge details."""
-        if not hasattr(self, "dmr_edge_details"):
-            return {}
-        return self.dmr_edge_details
+    def get_edge_index(self, timepoint_id: int) -> EdgeDetailsIndex:
+        """Get the in-memory edge details of a timepoint, loaded on first use"""
+        index = self.edge_indexes.get(timepoint_id)
+        if index is not None:
+            return index
+        with self._index_lock:
+            if timepoint_id in self.edge_indexes:
+                return self.edge_indexes[timepoint_id]
+            engine = get_db_engine(self.database_url)
+            with Session(engine) as session:
+                edge_details = session.execute(
+                    text("""
+                        SELECT ed.dmr_id, ed.gene_id, g.symbol AS gene_symbol,
+                               ed.edge_type, ed.edit_type, ed.distance_from_tss,
+                               ed.description
+                        FROM edge_details ed
+                        LEFT JOIN genes g ON ed.gene_id = g.id
+                        WHERE ed.timepoint_id = :timepoint_id
+                    """),
+                    {"timepoint_id": timepoint_id},
+                ).fetchall()
+            index = EdgeDetailsIndex.from_rows(edge_details)
+            self.edge_indexes[timepoint_id] = index
+            logger.info(
+                f"Indexed {len(edge_details)} edge details for timepoint {timepoint_id}"
+            )
+        return index
+
+    def get_decomposition_index(self, timepoint_id: int) -> Optional[DecompositionIndex]:
+        """Get the component/block/SPQR/biclique hierarchy of a timepoint, loaded on first use"""
+        index = self.decomposition_indexes.get(timepoint_id)
+        if index is not None:
+            return index
+        with self._index_lock:
+            if timepoint_id in self.decomposition_indexes:
+                return self.decomposition_indexes[timepoint_id]
+            engine = get_db_engine(self.database_url)
+            with Session(engine) as session:
+                index = load_decomposition_index(session, timepoint_id)
+            if index is None:
+                # Databases loaded before the hierarchy was persisted
+                original_graph = self.get_original_graph(timepoint_id)
+                if original_graph is None:
+                    return None
+                logger.warning(
+                    f"No stored decomposition for timepoint {timepoint_id}, building it"
+                )
+                index = DecompositionIndex.build(original_graph)
+            self.decomposition_indexes[timepoint_id] = index
+            logger.info(
+                f"Indexed {index.num_nodes} decomposition nodes for timepoint {timepoint_id}"
+            )
+        return index
+
+    def update_edit_types(
+        self, timepoint_id: int, updates: List[Tuple[int, int, str]]
+    ) -> None:
+        """Mirror edit type updates written by update_edge_details in the index"""
+        if timepoint_id in self.edge_indexes:
+            self.edge_indexes[timepoint_id].set_edit_types(updates)
 
     def update_component_edge_classification(
         self,
@@ -566,18 +809,21 @@ class GraphManager:
             classification_result = classification_result.model_dump()
 
         updates = []
-        for cls_type in ["permanent", "false_positive", "false_negative"]:
-            for edge_info in classification_result["classifications"].get(cls_type, []):
-                raw_dmr, gene_id = edge_info.edge
-                converted_dmr = convert_dmr_id(raw_dmr, timepoint_id, is_original=True)
-                updates.append((converted_dmr, gene_id, cls_type))
+        with self.scope():
+            for cls_type in ["permanent", "false_positive", "false_negative"]:
+                for edge_info in classification_result["classifications"].get(cls_type, []):
+                    raw_dmr, gene_id = edge_info.edge
+                    converted_dmr = convert_dmr_id(raw_dmr, timepoint_id, is_original=True)
+                    updates.append((converted_dmr, gene_id, cls_type))
         # Build the list of update tuples
 
         if updates:
             # current_app.logger.info("Updating edge_details with: " + str(updates))
             current_app.logger.info("Updating edge_details")
             try:
-                update_edge_details(timepoint_id, updates)
+                with self.scope():
+                    update_edge_details(timepoint_id, updates)
+                self.update_edit_types(timepoint_id, updates)
                 current_app.logger.info("Edge_details update succeeded.")
             except Exception as e:
                 current_app.logger.error("Edge_details update failed: " + str(e))
@@ -0,0 +1,452 @@
+# File ingest_jobs.py
+# Author: Peter Shaw
+#
+"""Background ingest jobs: upload workbooks, rebuild a dataset, publish it.
+
+A job ingests into a new version of a dataset (see core/datasets.py), so the
+version being served is never modified:
+
+    <INGEST_DIR>/<dataset>/<job id>/
+        DSS1.xlsx, DSS_PAIRWISE.xlsx, ...  uploaded files
+        dmr_analysis.db                    staging database (SQLite datasets)
+        analytics/                         DuckDB snapshot
+        job.json                           status, stages and timings
+    <INGEST_DIR>/<dataset>/checkpoints/    stage artifacts of all versions
+
+The pipeline runs in a child process. Its statistics pools therefore never
+compete with request threads for the GIL, and a job that ignores its cancel
+request can still be terminated. The steps are:
+
+- graphs: processDMR.generate_graph_files, run only when no graph files
+  were uploaded
+- initialize_database
+- create_views
+
+These are the steps setup_database.sh runs by hand. The child reports each
+stage as it starts. Between stages it checks for cancellation.
+
+Once the child succeeds, the job publishes the version. It atomically
+replaces the dataset's manifest entry, which points it at the version's
+database and files. The servers pick up the change on their next request to
+the dataset, while requests already running finish on the previous version.
+Only the newest INGEST_VERSIONS_KEPT versions of a dataset keep their data.
+
+Configuration: INGEST_DIR, INGEST_WORKERS (jobs run at once, default 1),
+INGEST_CANCEL_GRACE_S (seconds before a cancelled child is terminated,
+default 30) and INGEST_VERSIONS_KEPT (default 2).
+"""
+
+import json
+import logging
+import multiprocessing
+import os
+import queue
+import shutil
+import threading
+import time
+import uuid
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import asdict, dataclass, field
+from datetime import datetime
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Optional
+
+from sqlalchemy.engine import make_url
+
+from backend.app.core.datasets import DATASET_NAME, DEFAULT_DATASET, DatasetRegistry
+
+logger = logging.getLogger(__name__)
+
+INGEST_CANCEL_GRACE_S = float(os.getenv("INGEST_CANCEL_GRACE_S", "30"))
+INGEST_VERSIONS_KEPT = int(os.getenv("INGEST_VERSIONS_KEPT", "2"))
+
+UPLOAD_EXTENSIONS = (".xlsx", ".csv", ".txt", ".biclusters", ".bicluster")
+REQUIRED_UPLOADS = ("DSS1.xlsx", "DSS_PAIRWISE.xlsx")
+JOB_FILE = "job.json"
+
+TERMINAL_STATUSES = ("succeeded", "failed", "cancelled")
+
+
+class IngestCancelled(Exception):
+    """Raised inside the pipeline when its job has been cancelled."""
+
+
+@dataclass
+class IngestJob:
+    id: str
+    dataset: str
+    directory: str
+    status: str = "queued"  # queued, running, succeeded, failed, cancelled
+    created_at: float = field(default_factory=time.time)
+    started_at: Optional[float] = None
+    finished_at: Optional[float] = None
+    stage: Optional[str] = None
+    detail: str = ""
+    stages: List[Dict[str, Any]] = field(default_factory=list)
+    files: List[str] = field(default_factory=list)
+    database_url: Optional[str] = None
+    error: Optional[str] = None
+    cancel_requested: bool = False
+    version: int = 0  # bumped on every update, for event streams
+
+    def to_dict(self) -> Dict[str, Any]:
+        data = asdict(self)
+        data.pop("directory")
+        if self.started_at is not None:
+            end = self.finished_at or time.time()
+            data["elapsed_seconds"] = round(end - self.started_at, 3)
+        return data
+
+    def enter_stage(self, stage: str, detail: str, at: float) -> None:
+        """Close the running stage and open ``stage`` (a repeat only updates detail)."""
+        if self.stages and self.stages[-1]["name"] == stage:
+            self.stages[-1]["detail"] = detail
+        else:
+            self.close_stage(at)
+            self.stages.append({"name": stage, "detail": detail, "started_at": at})
+        self.stage, self.detail = stage, detail
+
+    def close_stage(self, at: float) -> None:
+        if self.stages and "seconds" not in self.stages[-1]:
+            self.stages[-1]["seconds"] = round(at - self.stages[-1]["started_at"], 3)
+
+
+def run_pipeline(job_dir: str, env: Dict[str, str], cancel_event, events) -> None:
+    """
+    Child process body: build the dataset version in job_dir.
+
+    Puts ("stage", name, detail, time) events on ``events`` and finally
+    ("done",), ("cancelled",) or ("error", message).
+    """
+    os.environ.pop("DATASET", None)
+    os.environ.update(env)
+
+    def report(stage: str, detail: str = "") -> None:
+        if cancel_event.is_set():
+            raise IngestCancelled()
+        events.put(("stage", stage, detail, time.time()))
+
+    try:
+        from backend.app.core.processDMR import generate_graph_files
+        from backend.app.database.connection import get_db_engine
+        from backend.app.database.management.create_views import create_views
+        from backend.app.database.management.initialize_database import initialize_database
+
+        if not any(Path(job_dir).glob("bipartite_graph_output_*.txt")):
+            report("graphs")
+            generate_graph_files(
+                env["DSS1_FILE"],
+                env["DSS_PAIRWISE_FILE"],
+                job_dir,
+                timeseries_output="bipartite_graph_output_DSS_overall.txt",
+            )
+        initialize_database(progress=report)
+        report("views")
+        create_views(get_db_engine())
+        report("publish")
+        events.put(("done",))
+    except IngestCancelled:
+        events.put(("cancelled",))
+    except Exception as e:
+        events.put(("error", f"{type(e).__name__}: {str(e)}"))
+
+
+class IngestManager:
+    """Queues ingest jobs on a small pool and publishes their results."""
+
+    def __init__(
+        self,
+        root,
+        registry: DatasetRegistry,
+        max_workers: int = 1,
+        pipeline: Callable = run_pipeline,
+        start_method: str = "spawn",
+    ):
+        self.root = Path(root)
+        self.registry = registry
+        self.pipeline = pipeline
+        self.jobs: Dict[str, IngestJob] = {}
+        self._context = multiprocessing.get_context(start_method)
+        self._executor = ThreadPoolExecutor(max_workers=max_workers, thread_name_prefix="ingest")
+        self._cancel_events: Dict[str, Any] = {}
+        self._changed = threading.Condition()
+        self._manifest_lock = threading.Lock()
+        self.root.mkdir(parents=True, exist_ok=True)
+        self._load_history()
+
+    # Job records
+
+    def submit(self, dataset: str, uploads: Dict[str, Any]) -> IngestJob:
+        """
+        Save uploaded files and queue a job; ValueError for a bad request.
+
+        Args:
+            dataset: Name of the dataset to (re)build; not the default dataset
+            uploads: File name -> werkzeug FileStorage, bytes or a path to copy
+        """
+        if not DATASET_NAME.match(dataset or "") or dataset == DEFAULT_DATASET:
+            raise ValueError(f"Invalid dataset name: {dataset!r}")
+        names = set(uploads)
+        missing = [name for name in REQUIRED_UPLOADS if name not in names]
+        if missing:
+            raise ValueError(f"Missing uploads: {missing}")
+        for name in names:
+            if Path(name).name != name or not name.lower().endswith(UPLOAD_EXTENSIONS):
+                raise ValueError(f"Unsupported upload: {name!r}")
+
+        job_id = f"{datetime.now().strftime('%Y%m%d-%H%M%S')}-{uuid.uuid4().hex[:8]}"
+        job_dir = self.root / dataset / job_id
+        job_dir.mkdir(parents=True)
+        for name, upload in uploads.items():
+            target = job_dir / name
+            if hasattr(upload, "save"):
+                upload.save(str(target))
+            elif isinstance(upload, (bytes, bytearray)):
+                target.write_bytes(upload)
+            else:
+                shutil.copyfile(upload, target)
+
+        job = IngestJob(id=job_id, dataset=dataset, directory=str(job_dir), files=sorted(names))
+        job.database_url = self._staging_database_url(dataset, job)
+        with self._changed:
+            self.jobs[job_id] = job
+            self._cancel_events[job_id] = self._context.Event()
+        self._save(job)
+        self._executor.submit(self._run, job)
+        logger.info(f"Queued ingest job {job_id} for dataset {dataset}")
+        return job
+
+    def get(self, job_id: str) -> Optional[IngestJob]:
+        """A job of this process, or one recorded on disk by another."""
+        job = self.jobs.get(job_id)
+        if job is None:
+            for path in self.root.glob(f"*/{job_id}/{JOB_FILE}"):
+                job = self._read(path)
+        return job
+
+    def list(self, dataset: Optional[str] = None) -> List[IngestJob]:
+        jobs = [j for j in self.jobs.values() if dataset is None or j.dataset == dataset]
+        return sorted(jobs, key=lambda j: j.created_at, reverse=True)
+
+    def cancel(self, job_id: str) -> bool:
+        """Ask a queued or running job to stop; False when it already finished."""
+        with self._changed:
+            job = self.jobs.get(job_id)
+            if job is None or job.status in TERMINAL_STATUSES:
+                return False
+            job.cancel_requested = True
+            self._cancel_events[job_id].set()
+            self._update(job)
+        return True
+
+    def wait(self, job_id: str, version: int, timeout: float) -> Optional[IngestJob]:
+        """Block until the job changes past ``version`` or the timeout expires."""
+        with self._changed:
+            self._changed.wait_for(
+                lambda: job_id not in self.jobs or self.jobs[job_id].version > version,
+                timeout=timeout,
+            )
+            return self.jobs.get(job_id)
+
+    def shutdown(self) -> None:
+        for job_id in list(self.jobs):
+            self.cancel(job_id)
+        self._executor.shutdown(wait=True)
+
+    # Execution
+
+    def _run(self, job: IngestJob) -> None:
+        cancel_event = self._cancel_events[job.id]
+        if cancel_event.is_set():
+            self._finish(job, "cancelled")
+            return
+
+        env = self._job_environment(job)
+        events = self._context.Queue()
+        process = self._context.Process(
+            target=self.pipeline,
+            args=(job.directory, env, cancel_event, events),
+            name=f"ingest-{job.id}",
+        )
+        with self._changed:
+            job.status, job.started_at = "running", time.time()
+            job.enter_stage("queued", f"{len(job.files)} files", job.created_at)
+            self._update(job)
+        process.start()
+
+        outcome, error, cancelled_at = None, None, None
+        while outcome is None:
+            try:
+                event = events.get(timeout=0.5)
+            except queue.Empty:
+                event = None
+            if event is None and not process.is_alive():
+                try:
+                    # Anything the child put just before exiting
+                    event = events.get(timeout=1.0)
+                except queue.Empty:
+                    outcome = "failed"
+                    error = f"Ingest process exited with code {process.exitcode}"
+                    break
+            if event is None:
+                if cancel_event.is_set():
+                    cancelled_at = cancelled_at or time.time()
+                    if time.time() - cancelled_at > INGEST_CANCEL_GRACE_S:
+                        process.terminate()
+                        outcome = "cancelled"
+                continue
+            if event[0] == "stage":
+                _, stage, detail, at = event
+                with self._changed:
+                    job.enter_stage(stage, detail, at)
+                    self._update(job)
+            elif event[0] == "done":
+                outcome = "succeeded"
+            elif event[0] == "cancelled":
+                outcome = "cancelled"
+            else:
+                outcome, error = "failed", event[1]
+        process.join(timeout=INGEST_CANCEL_GRACE_S)
+
+        if outcome == "succeeded":
+            try:
+                self.publish(job)
+            except Exception as e:
+                logger.error(f"Publishing ingest job {job.id} failed: {str(e)}")
+                outcome, error = "failed", f"publish: {str(e)}"
+        self._finish(job, outcome, error)
+        if outcome == "succeeded":
+            self._prune(job.dataset)
+
+    def _finish(self, job: IngestJob, status: str, error: Optional[str] = None) -> None:
+        # Clean up first, so a job seen as finished has nothing left to remove
+        if status != "succeeded":
+            self._discard_data(job)
+        with self._changed:
+            job.status, job.error = status, error
+            job.finished_at = time.time()
+            job.close_stage(job.finished_at)
+            self._update(job)
+        logger.info(f"Ingest job {job.id} {status}" + (f": {error}" if error else ""))
+
+    def _job_environment(self, job: IngestJob) -> Dict[str, str]:
+        job_dir = job.directory
+        return {
+            "DATABASE_URL": job.database_url,
+            "DATA_DIR": job_dir,
+            "DSS1_FILE": os.path.join(job_dir, "DSS1.xlsx"),
+            "DSS_PAIRWISE_FILE": os.path.join(job_dir, "DSS_PAIRWISE.xlsx"),
+            "ANALYTICS_DIR": os.path.join(job_dir, "analytics"),
+            "GRAPH_DATA_DIR": os.path.join(job_dir, "graphs"),
+            # Shared by the dataset's versions: unchanged sheets are not parsed again
+            "CHECKPOINT_DIR": str(self.root / job.dataset / "checkpoints"),
+        }
+
+    def _staging_database_url(self, dataset: str, job: IngestJob) -> str:
+        """SQLite file in the job directory, or a new database next to a server one."""
+        try:
+            current = self.registry.config(dataset).database_url
+        except KeyError:
+            current = None
+        if current is None or current.startswith("sqlite"):
+            return f"sqlite:///{os.path.join(job.directory, 'dmr_analysis.db')}"
+
+        from sqlalchemy_utils import create_database, database_exists
+
+        url = make_url(current)
+        base = url.database.split("__v")[0]
+        staged = url.set(database=f"{base}__v{job.id.replace('-', '_')}")
+        if not database_exists(staged):
+            create_database(staged)
+        return staged.render_as_string(hide_password=False)
+
+    # Publishing
+
+    def publish(self, job: IngestJob) -> None:
+        """Point the dataset's manifest entry at the job's version, atomically."""
+        version = self._job_environment(job)
+        manifest_path = self.registry.manifest_path
+        with self._manifest_lock:
+            manifest = {"datasets": {}}
+            if manifest_path.exists():
+                manifest = json.loads(manifest_path.read_text())
+            entry = dict(manifest.setdefault("datasets", {}).get(job.dataset, {}))
+            entry.update(
+                data_dir=version["DATA_DIR"],
+                database_url=version["DATABASE_URL"],
+                analytics_dir=version["ANALYTICS_DIR"],
+                graph_data_dir=version["GRAPH_DATA_DIR"],
+                dss1_file=version["DSS1_FILE"],
+                dss_pairwise_file=version["DSS_PAIRWISE_FILE"],
+            )
+            manifest["datasets"][job.dataset] = entry
+            manifest_path.parent.mkdir(parents=True, exist_ok=True)
+            tmp = manifest_path.with_name(f".{manifest_path.name}.{job.id}.tmp")
+            tmp.write_text(json.dumps(manifest, indent=2))
+            os.replace(tmp, manifest_path)
+        self.registry.refresh(force=True)
+        logger.info(f"Published dataset {job.dataset} version {job.id}")
+
+    def _prune(self, dataset: str) -> None:
+        """Drop the data of all but the newest published versions of a dataset."""
+        published = sorted(
+            (j for j in self._history(dataset) if j.status == "succeeded"),
+            key=lambda j: j.finished_at or 0,
+        )
+        for stale in published[: max(0, len(published) - INGEST_VERSIONS_KEPT)]:
+            self._discard_data(stale)
+
+    def _discard_data(self, job: IngestJob) -> None:
+        """Remove a version's files and database, keeping its job record."""
+        for path in Path(job.directory).iterdir():
+            if path.name == JOB_FILE:
+                continue
+            if path.is_dir():
+                shutil.rmtree(path, ignore_errors=True)
+            else:
+                path.unlink(missing_ok=True)
+        if job.database_url and not job.database_url.startswith("sqlite"):
+            try:
+                from sqlalchemy_utils import database_exists, drop_database
+
+                if database_exists(job.database_url):
+                    drop_database(job.database_url)
+            except Exception as e:
+                logger.warning(f"Could not drop {make_url(job.database_url)!r}: {str(e)}")
+
+    # Persistence
+
+    def _update(self, job: IngestJob) -> None:
+        """Record a change; callers hold self._changed."""
+        job.version += 1
+        self._save(job)
+        self._changed.notify_all()
+
+    def _save(self, job: IngestJob) -> None:
+        path = Path(job.directory) / JOB_FILE
+        tmp = path.with_suffix(".tmp")
+        tmp.write_text(json.dumps(asdict(job), indent=2))
+        os.replace(tmp, path)
+
+    @staticmethod
+    def _read(path: Path) -> Optional[IngestJob]:
+        try:
+            return IngestJob(**json.loads(path.read_text()))
+        except (OSError, ValueError, TypeError):
+            return None
+
+    def _history(self, dataset: str) -> List[IngestJob]:
+        jobs = (self._read(p) for p in (self.root / dataset).glob(f"*/{JOB_FILE}"))
+        return [j for j in jobs if j is not None]
+
+    def _load_history(self) -> None:
+        """Load earlier jobs; ones left unfinished by a restart are marked failed."""
+        for path in self.root.glob(f"*/*/{JOB_FILE}"):
+            job = self._read(path)
+            if job is None:
+                continue
+            if job.status not in TERMINAL_STATUSES:
+                job.status, job.error = "failed", "Interrupted by a server restart"
+                job.finished_at = job.finished_at or time.time()
+                self._save(job)
+            self.jobs[job.id] = job
@@ -1,4 +1,5 @@
 import argparse
+import os
 
 # import sys
 # mport os
@@ -136,11 +137,28 @@ def process_single_dataset(df, output_file, args, gene_id_mapping=None, timepoin
 def main():
     """Main entry point for processing DMR data."""
     args = parse_arguments()
+    generate_graph_files(
+        args.input, "./data/DSS_PAIRWISE.xlsx", ".", timeseries_output=args.output, args=args
+    )
+
 
+def generate_graph_files(
+    dss1_file: str,
+    dss_pairwise_file: str,
+    output_dir: str,
+    timeseries_output: str = "bipartite_graph_output.txt",
+    args=None,
+) -> Dict[str, int]:
+    """
+    Write master_gene_ids.csv and one bipartite graph file per timepoint.
+
+    Returns:
+        The gene id mapping shared by all timepoints
+    """
     print("\nCollecting all unique genes across timepoints...")
 
     # Read sheets from pairwise file
-    pairwise_sheets = get_excel_sheets("./data/DSS_PAIRWISE.xlsx")
+    pairwise_sheets = get_excel_sheets(dss_pairwise_file)
     pairwise_dfs = {}
     all_genes = set()
     max_dmr_id = None  # Will be set based on number of rows
@@ -148,7 +166,7 @@ def main():
     # Process pairwise sheets
     for sheet in pairwise_sheets:
         print(f"\nProcessing sheet: {sheet}")
-        df = read_excel_file("./data/DSS_PAIRWISE.xlsx", sheet_name=sheet)
+        df = read_excel_file(dss_pairwise_file, sheet_name=sheet)
         if df is None:
             continue
         pairwise_dfs[sheet] = df
@@ -158,26 +176,33 @@ def main():
 
     # Process overall DSS1 file
     print("\nProcessing DSS1 file...")
-    df_DSStimeseries = read_excel_file(args.input)
+    df_DSStimeseries = read_excel_file(dss1_file)
     if df_DSStimeseries is not None:
         all_genes.update(get_genes_from_df(df_DSStimeseries))
         max_dmr_id = len(df_DSStimeseries) - 1  # Set max_dmr_id based on number of rows
 
     # Create and write gene mapping
     gene_id_mapping = create_gene_mapping(all_genes)
-    write_gene_mappings(gene_id_mapping, "master_gene_ids.csv", "All_Timepoints")
+    write_gene_mappings(
+        gene_id_mapping, os.path.join(output_dir, "master_gene_ids.csv"), "All_Timepoints"
+    )
 
     # Process each timepoint
     for sheet, df in pairwise_dfs.items():
         print(f"\nProcessing timepoint: {sheet}")
-        output_file = f"bipartite_graph_output_{sheet}.txt"
+        output_file = os.path.join(output_dir, f"bipartite_graph_output_{sheet}.txt")
         process_single_dataset(df, output_file, args, gene_id_mapping, sheet)
 
     # Process overall DSS1 file
     print("\nProcessing DSS1 DSStimeseries file...")
     process_single_dataset(
-        df_DSStimeseries, "bipartite_graph_output.txt", args, gene_id_mapping, "DSS1"
+        df_DSStimeseries,
+        os.path.join(output_dir, timeseries_output),
+        args,
+        gene_id_mapping,
+        "DSS1",
     )
+    return gene_id_mapping
 
 
 def get_genes_from_df(df: pd.DataFrame) -> Set[str]:
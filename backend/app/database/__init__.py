@@ -39,6 +39,9 @@ from .operations import (
     insert_triconnected_component,
     insert_statistics,
     insert_metadata,
+    store_timepoint_statistics,
+    load_timepoint_statistics,
+    get_timepoint_statistics_version,
     insert_relationship,
     insert_component_biclique,
     # Annotation operations
@@ -107,6 +110,9 @@ __all__ = [
     "insert_triconnected_component",
     "insert_statistics",
     "insert_metadata",
+    "store_timepoint_statistics",
+    "load_timepoint_statistics",
+    "get_timepoint_statistics_version",
     "insert_relationship",
     "insert_component_biclique",
     # Annotation operations
@@ -0,0 +1,354 @@
+"""
+Columnar analytics store for ad hoc and LLM-generated SQL.
+
+``export_snapshot`` copies the analytical tables of the serving database into
+Parquet files under a new ``snapshot-<timestamp>`` directory and then points
+``CURRENT`` at it, so a reader never sees a half-written export. Array
+columns are written as integer lists rather than JSON text.
+
+Each snapshot also gets a DuckDB file built from its Parquet files.
+``AnalyticsStore`` opens the current one read-only with external file access
+disabled, so queries see only the snapshot tables, cannot modify them, and
+never touch the OLTP database the UI reads from.
+
+Usage:
+    python -m backend.app.database.analytics export [--dir ./analytics]
+"""
+
+import json
+import logging
+import os
+import shutil
+import sys
+import threading
+import time
+from contextlib import contextmanager
+from contextvars import ContextVar
+from datetime import datetime
+from itertools import groupby
+from pathlib import Path
+from typing import Any, Dict, List, Optional
+
+import pandas as pd
+from sqlalchemy import inspect, text
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_ANALYTICS_DIR = Path("./analytics")
+DEFAULT_ROW_LIMIT = 10000
+SNAPSHOTS_KEPT = 2
+DATABASE_FILE = "analytics.duckdb"
+
+# Table -> columns holding id lists (JSON text on SQLite, integer[] on PostgreSQL)
+EXPORTED_TABLES: Dict[str, List[str]] = {
+    "timepoints": [],
+    "genes": [],
+    "dmrs": [],
+    "edge_details": [],
+    "components": [],
+    "bicliques": ["dmr_ids", "gene_ids"],
+    "component_bicliques": [],
+    "gene_timepoint_annotations": ["biclique_ids"],
+    "dmr_timepoint_annotations": ["biclique_ids"],
+    "dominating_sets": [],
+    "triconnected_components": ["dmr_ids", "gene_ids", "nodes"],
+    "gene_trajectories": [
+        "timepoint_ids",
+        "status",
+        "degree",
+        "component_size",
+        "biclique_count",
+        "dominated_by",
+        "dominated_by_indptr",
+    ],
+}
+
+# Derived views created in DuckDB on top of the exported tables
+ANALYTIC_VIEWS = {
+    "gene_annotations_view": """
+        SELECT g.id AS gene_id, g.symbol, g.description, gta.timepoint_id,
+               t.name AS timepoint, gta.component_id, gta.node_type,
+               gta.gene_type, gta.degree, gta.is_isolate, gta.biclique_ids
+        FROM genes g
+        JOIN gene_timepoint_annotations gta ON g.id = gta.gene_id
+        JOIN timepoints t ON t.id = gta.timepoint_id
+    """,
+    "dmr_annotations_view": """
+        SELECT d.id AS dmr_id, d.dmr_number, d.area_stat, d.chromosome,
+               d.start_position, d.end_position, d.p_value, d.q_value,
+               d.mean_methylation, d.is_hub, dta.timepoint_id,
+               t.name AS timepoint, dta.component_id, dta.node_type,
+               dta.degree, dta.is_isolate, dta.biclique_ids
+        FROM dmrs d
+        JOIN dmr_timepoint_annotations dta ON d.id = dta.dmr_id
+        JOIN timepoints t ON t.id = dta.timepoint_id
+    """,
+}
+
+SCHEMA_NOTES = """\
+Engine: DuckDB (PostgreSQL-like dialect), read-only snapshot of the DMR database.
+List columns (INTEGER[]): use len(col), list_contains(col, x) and unnest(col);
+biclique_ids lists hold biclique indices within the component.
+Gene ids start at 100000; DMR ids are unique across timepoints.
+Join keys: *.timepoint_id -> timepoints.id, *.gene_id -> genes.id,
+*.dmr_id -> dmrs.id, *.component_id -> components.id,
+component_bicliques links components to bicliques.
+gene_trajectories: one row per gene; its lists hold one value per entry of
+timepoint_ids (status bits: 1 present, 2 split, 4 hub, 8 isolate)."""
+
+
+def _id_list(value) -> Optional[List[int]]:
+    """Decode an id-list cell: JSON list, JSON-quoted "1,2" string or a list."""
+    if value is None or (isinstance(value, float) and pd.isna(value)):
+        return None
+    if isinstance(value, str):
+        value = json.loads(value) if value[:1] in "[\"" else value
+    if isinstance(value, str):
+        return [int(v) for v in value.split(",") if v.strip()]
+    return [int(v) for v in value]
+
+
+def build_database(snapshot: Path) -> Path:
+    """Load a snapshot's Parquet files into its DuckDB file and add the views."""
+    import duckdb
+
+    path = snapshot / DATABASE_FILE
+    conn = duckdb.connect(str(path))
+    try:
+        for parquet in sorted(snapshot.glob("*.parquet")):
+            conn.execute(
+                f'CREATE TABLE "{parquet.stem}" AS SELECT * FROM read_parquet(?)',
+                [str(parquet)],
+            )
+        for name, sql in ANALYTIC_VIEWS.items():
+            try:
+                conn.execute(f"CREATE VIEW {name} AS {sql}")
+            except duckdb.Error as e:
+                logger.warning(f"Skipping analytics view {name}: {e}")
+    finally:
+        conn.close()
+    return path
+
+
+def export_snapshot(engine, analytics_dir: Path = DEFAULT_ANALYTICS_DIR) -> Path:
+    """
+    Write the exported tables of ``engine`` as Parquet and make them current.
+
+    Returns:
+        The new snapshot directory
+    """
+    import pyarrow as pa
+    import pyarrow.parquet as pq
+
+    analytics_dir = Path(analytics_dir)
+    snapshot = analytics_dir / f"snapshot-{datetime.now().strftime('%Y%m%d-%H%M%S-%f')}"
+    snapshot.mkdir(parents=True)
+
+    present = set(inspect(engine).get_table_names())
+    manifest = {"created_at": time.time(), "dialect": engine.dialect.name, "tables": {}}
+    with engine.connect() as conn:
+        for table, list_columns in EXPORTED_TABLES.items():
+            if table not in present:
+                continue
+            df = pd.read_sql(text(f"SELECT * FROM {table}"), conn)
+            fields = []
+            for column in df.columns:
+                if column in list_columns:
+                    df[column] = df[column].map(_id_list)
+                    fields.append(pa.field(column, pa.list_(pa.int64())))
+            schema = pa.Schema.from_pandas(df, preserve_index=False)
+            for field in fields:
+                schema = schema.set(schema.get_field_index(field.name), field)
+            pq.write_table(
+                pa.Table.from_pandas(df, schema=schema, preserve_index=False),
+                snapshot / f"{table}.parquet",
+            )
+            manifest["tables"][table] = len(df)
+
+    build_database(snapshot)
+    (snapshot / "manifest.json").write_text(json.dumps(manifest, indent=2))
+    pointer = analytics_dir / "CURRENT"
+    tmp = analytics_dir / "CURRENT.tmp"
+    tmp.write_text(snapshot.name)
+    os.replace(tmp, pointer)
+
+    old = sorted(p for p in analytics_dir.glob("snapshot-*") if p != snapshot)
+    for stale in old[: max(0, len(old) - (SNAPSHOTS_KEPT - 1))]:
+        shutil.rmtree(stale, ignore_errors=True)
+
+    logger.info(f"Exported analytics snapshot {snapshot.name}: {manifest['tables']}")
+    return snapshot
+
+
+class SnapshotCursor:
+    """DuckDB cursor that lets its store close a replaced snapshot once closed."""
+
+    def __init__(self, store: "AnalyticsStore", conn, cursor):
+        self._store = store
+        self._conn = conn
+        self._cursor = cursor
+        self._closed = False
+
+    def __getattr__(self, name):
+        return getattr(self._cursor, name)
+
+    def close(self) -> None:
+        if not self._closed:
+            self._closed = True
+            self._cursor.close()
+            self._store._release(self._conn)
+
+
+class AnalyticsStore:
+    """DuckDB database loaded from the current Parquet snapshot."""
+
+    def __init__(self, analytics_dir: Path = DEFAULT_ANALYTICS_DIR):
+        self.analytics_dir = Path(analytics_dir)
+        self.snapshot: Optional[str] = None
+        self._conn = None
+        self._open_cursors: Dict[int, int] = {}  # id(connection) -> cursors not closed
+        self._retired: Dict[int, Any] = {}  # replaced connections waiting for their cursors
+        self._lock = threading.Lock()
+
+    def current_snapshot(self) -> Optional[str]:
+        pointer = self.analytics_dir / "CURRENT"
+        return pointer.read_text().strip() if pointer.exists() else None
+
+    def _load(self, snapshot: str):
+        import duckdb
+
+        return duckdb.connect(
+            str(self.analytics_dir / snapshot / DATABASE_FILE),
+            read_only=True,
+            config={"enable_external_access": False},
+        )
+
+    def connection(self):
+        """DuckDB cursor on the newest snapshot, reopening when it changes."""
+        snapshot = self.current_snapshot()
+        if snapshot is None:
+            raise FileNotFoundError(
+                f"No analytics snapshot in {self.analytics_dir}; "
+                "run `python -m backend.app.database.analytics export`"
+            )
+        with self._lock:
+            if snapshot != self.snapshot:
+                previous = self._conn
+                self._conn, self.snapshot = self._load(snapshot), snapshot
+                logger.info(f"Opened analytics snapshot {snapshot}")
+                if previous is not None:
+                    # Closing a connection closes its cursors, so wait for them
+                    if self._open_cursors.get(id(previous)):
+                        self._retired[id(previous)] = previous
+                    else:
+                        previous.close()
+            key = id(self._conn)
+            self._open_cursors[key] = self._open_cursors.get(key, 0) + 1
+            return SnapshotCursor(self, self._conn, self._conn.cursor())
+
+    def _release(self, conn) -> None:
+        """A cursor of ``conn`` was closed; close ``conn`` if it was replaced and idle."""
+        with self._lock:
+            key = id(conn)
+            self._open_cursors[key] -= 1
+            if self._open_cursors[key] == 0:
+                del self._open_cursors[key]
+                if self._retired.pop(key, None) is not None:
+                    conn.close()
+
+    def query(
+        self, sql: str, params: Optional[list] = None, row_limit: int = DEFAULT_ROW_LIMIT
+    ) -> Dict[str, Any]:
+        """Run a query; at most ``row_limit`` rows are returned."""
+        cursor = self.connection()
+        try:
+            started = time.perf_counter()
+            cursor.execute(sql, params or [])
+            columns = [d[0] for d in cursor.description] if cursor.description else []
+            rows = cursor.fetchmany(row_limit + 1) if columns else []
+            elapsed_ms = (time.perf_counter() - started) * 1000
+        finally:
+            cursor.close()
+        return {
+            "columns": columns,
+            "rows": [list(r) for r in rows[:row_limit]],
+            "truncated": len(rows) > row_limit,
+            "elapsed_ms": round(elapsed_ms, 3),
+            "snapshot": self.snapshot,
+        }
+
+    def schema_description(self) -> str:
+        """Tables, views and column types of the store, for LLM prompts."""
+        cursor = self.connection()
+        try:
+            rows = cursor.execute(
+                """
+                SELECT c.table_name, t.table_type, c.column_name, c.data_type
+                FROM information_schema.columns c
+                JOIN information_schema.tables t USING (table_schema, table_name)
+                WHERE c.table_schema = 'main'
+                ORDER BY t.table_type, c.table_name, c.ordinal_position
+                """
+            ).fetchall()
+        finally:
+            cursor.close()
+
+        lines = [SCHEMA_NOTES, ""]
+        for (table, table_type), columns in groupby(rows, key=lambda r: r[:2]):
+            kind = "VIEW" if table_type == "VIEW" else "TABLE"
+            lines.append(f"{kind} {table}(")
+            lines.extend(f"    {column} {data_type}" for _, _, column, data_type in columns)
+            lines.append(")")
+        return "\n".join(lines)
+
+
+_store: Optional[AnalyticsStore] = None
+_store_lock = threading.Lock()
+
+# Store of the dataset the current request is scoped to
+_scoped_store: ContextVar[Optional[AnalyticsStore]] = ContextVar(
+    "scoped_analytics_store", default=None
+)
+
+
+@contextmanager
+def use_analytics_store(store: Optional[AnalyticsStore]):
+    """Serve get_analytics_store() from store in this context (None is a no-op)."""
+    if store is None:
+        yield
+        return
+    token = _scoped_store.set(store)
+    try:
+        yield
+    finally:
+        _scoped_store.reset(token)
+
+
+def get_analytics_store() -> AnalyticsStore:
+    """The active dataset's store, else the process-wide one reading ANALYTICS_DIR."""
+    global _store
+    scoped = _scoped_store.get()
+    if scoped is not None:
+        return scoped
+    with _store_lock:
+        if _store is None:
+            _store = AnalyticsStore(Path(os.getenv("ANALYTICS_DIR", str(DEFAULT_ANALYTICS_DIR))))
+        return _store
+
+
+def main():
+    if len(sys.argv) < 2 or sys.argv[1] != "export":
+        print("usage: python -m backend.app.database.analytics export [--dir DIR]")
+        sys.exit(2)
+    analytics_dir = Path(os.getenv("ANALYTICS_DIR", str(DEFAULT_ANALYTICS_DIR)))
+    if "--dir" in sys.argv:
+        analytics_dir = Path(sys.argv[sys.argv.index("--dir") + 1])
+
+    from .connection import get_db_engine
+
+    snapshot = export_snapshot(get_db_engine(), analytics_dir)
+    print(f"Analytics snapshot written to {snapshot}")
+
+
+if __name__ == "__main__":
+    main()
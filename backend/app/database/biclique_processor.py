@@ -10,7 +10,7 @@ from .operations import insert_component
 from .populate_tables import (
     populate_dmr_annotations,
     populate_gene_annotations,
-    populate_bicliques,
+    populate_bicliques_bulk,
 )
 from backend.app.biclique_analysis.reader import read_bicliques_file
 from backend.app.utils.metadata import get_gene_details, get_dmr_details
@@ -138,35 +138,33 @@ def _process_split_component(
         converted_dmrs = {convert_dmr_id(n, timepoint_id) for n in dmrs}
         converted_bicliques.append((converted_dmrs, genes))
 
-    # Populate bicliques and annotations using pre-converted DMR IDs
-    for biclique in converted_bicliques:
-        biclique_id = populate_bicliques(
-            session,
-            timepoint_id=timepoint_id,
-            component_id=comp_id,
-            dmr_nodes=biclique[0],
-            gene_nodes=biclique[1],
-        )
+    # Populate bicliques, then annotate every node once against all of them
+    populate_bicliques_bulk(
+        session,
+        timepoint_id=timepoint_id,
+        component_id=comp_id,
+        bicliques=converted_bicliques,
+    )
 
-        populate_dmr_annotations(
-            session=session,
-            timepoint_id=timepoint_id,
-            component_id=comp_id,
-            graph=comp_subgraph,
-            df=df,
-            is_original=False,
-            bicliques=converted_bicliques,
-        )
+    populate_dmr_annotations(
+        session=session,
+        timepoint_id=timepoint_id,
+        component_id=comp_id,
+        graph=comp_subgraph,
+        df=df,
+        is_original=False,
+        bicliques=converted_bicliques,
+    )
 
-        populate_gene_annotations(
-            session=session,
-            timepoint_id=timepoint_id,
-            component_id=comp_id,
-            graph=comp_subgraph,
-            df=df,
-            is_original=False,
-            bicliques=converted_bicliques,
-        )
+    populate_gene_annotations(
+        session=session,
+        timepoint_id=timepoint_id,
+        component_id=comp_id,
+        graph=comp_subgraph,
+        df=df,
+        is_original=False,
+        bicliques=converted_bicliques,
+    )
 
     return comp_id
 
@@ -0,0 +1,210 @@
+"""Bulk loading for the ingest pipeline.
+
+On PostgreSQL rows are streamed into the target table with ``COPY ... FROM
+STDIN`` from an in-memory text buffer, which avoids one round trip and one ORM
+flush per row. Every other dialect (SQLite in development and tests) falls back
+to a single executemany INSERT through SQLAlchemy Core, so callers do not need
+to care which backend they are talking to.
+"""
+
+import io
+import json
+import math
+from typing import Dict, Iterable, List, Sequence
+
+from sqlalchemy import Table, func, text
+from sqlalchemy.orm import Session
+
+_COPY_ESCAPES = str.maketrans({"\\": "\\\\", "\t": "\\t", "\n": "\\n", "\r": "\\r"})
+
+
+def is_postgres(session: Session) -> bool:
+    return session.get_bind().dialect.name == "postgresql"
+
+
+def format_copy_value(value) -> str:
+    """One field in COPY text format: NULL is \\N, lists become array literals."""
+    if value is None:
+        return "\\N"
+    if isinstance(value, bool):
+        return "t" if value else "f"
+    if isinstance(value, float):
+        return "\\N" if math.isnan(value) else repr(value)
+    if isinstance(value, (list, tuple, set)):
+        return "{" + ",".join(str(int(v)) for v in value) + "}"
+    if isinstance(value, dict):
+        value = json.dumps(value)
+    return str(value).translate(_COPY_ESCAPES)
+
+
+def copy_buffer(rows: Iterable[Sequence]) -> io.StringIO:
+    """Rows rendered as a COPY text-format buffer, rewound for reading."""
+    buffer = io.StringIO()
+    for row in rows:
+        buffer.write("\t".join(format_copy_value(v) for v in row))
+        buffer.write("\n")
+    buffer.seek(0)
+    return buffer
+
+
+def copy_rows(
+    session: Session,
+    table: Table,
+    columns: Sequence[str],
+    rows: Iterable[Sequence],
+    target: str = None,
+) -> int:
+    """
+    Append rows to a table, using COPY FROM STDIN on PostgreSQL.
+
+    Runs inside the session's transaction; the caller commits.
+
+    Args:
+        session: Database session
+        table: Target table (``Model.__table__``)
+        columns: Column names, in the order of the values in each row
+        rows: Iterable of value tuples
+        target: Table name to COPY into instead of ``table`` (a staging table
+            with the same columns)
+
+    Returns:
+        Number of rows written
+    """
+    rows = list(rows)
+    if not rows:
+        return 0
+
+    if is_postgres(session):
+        statement = f"COPY {target or table.name} ({', '.join(columns)}) FROM STDIN"
+        cursor = session.connection().connection.cursor()
+        try:
+            if hasattr(cursor, "copy_expert"):  # psycopg2
+                cursor.copy_expert(statement, copy_buffer(rows))
+            else:  # psycopg 3
+                with cursor.copy(statement) as copy:
+                    copy.write(copy_buffer(rows).getvalue())
+        finally:
+            cursor.close()
+    else:
+        statement = (
+            table.insert()
+            if target is None
+            else text(
+                f"INSERT INTO {target} ({', '.join(columns)}) "
+                f"VALUES ({', '.join(':' + c for c in columns)})"
+            )
+        )
+        session.execute(statement, [dict(zip(columns, row)) for row in rows])
+    return len(rows)
+
+
+def next_ids(session: Session, table: Table, count: int) -> List[int]:
+    """
+    Reserve ``count`` primary keys for rows written with explicit ids.
+
+    On PostgreSQL the ids are drawn from the table's serial sequence, so
+    concurrent loaders and ordinary inserts never get the same id (the ids
+    need not be consecutive). Other dialects number on from the current
+    maximum, which is only safe with a single writer, as on SQLite.
+    """
+    if count <= 0:
+        return []
+    if is_postgres(session):
+        return list(
+            session.execute(
+                text(
+                    f"SELECT nextval(pg_get_serial_sequence('{table.name}', 'id')) "
+                    "FROM generate_series(1, :count)"
+                ),
+                {"count": count},
+            ).scalars()
+        )
+    max_id = session.execute(func.max(table.c.id).select()).scalar() or 0
+    return list(range(max_id + 1, max_id + 1 + count))
+
+
+def upsert_annotations(
+    session: Session, table: Table, key_column: str, rows: List[Dict]
+) -> int:
+    """
+    Insert or merge per-timepoint node annotations in one statement.
+
+    Mirrors ``upsert_dmr_timepoint_annotation`` / ``upsert_gene_timepoint_annotation``:
+    values that are None keep what is stored, and ``biclique_ids`` (a list of
+    ints) is unioned with the stored ids. On PostgreSQL the rows are copied
+    into a temporary staging table and merged with INSERT ... ON CONFLICT; on
+    other dialects each row goes through the per-row upsert.
+
+    Args:
+        session: Database session
+        table: ``dmr_timepoint_annotations`` or ``gene_timepoint_annotations``
+        key_column: "dmr_id" or "gene_id"
+        rows: dicts with timepoint_id, the key column and any annotation columns
+
+    Returns:
+        Number of rows merged
+    """
+    if not rows:
+        return 0
+
+    if not is_postgres(session):
+        from .operations import (
+            upsert_dmr_timepoint_annotation,
+            upsert_gene_timepoint_annotation,
+        )
+
+        upsert = (
+            upsert_dmr_timepoint_annotation
+            if key_column == "dmr_id"
+            else upsert_gene_timepoint_annotation
+        )
+        for row in rows:
+            row = dict(row)
+            ids = row.pop("biclique_ids", None)
+            upsert(
+                session=session,
+                biclique_ids=",".join(str(i) for i in sorted(set(ids))) if ids else None,
+                **row,
+            )
+        return len(rows)
+
+    columns = list(rows[0].keys())
+    stage = f"_stage_{table.name}"
+    session.execute(text(f"DROP TABLE IF EXISTS {stage}"))
+    session.execute(
+        text(f"CREATE TEMP TABLE {stage} (LIKE {table.name} INCLUDING DEFAULTS)")
+    )
+    copy_rows(
+        session,
+        table,
+        columns,
+        ([row.get(c) for c in columns] for row in rows),
+        target=stage,
+    )
+
+    updates = []
+    for column in columns:
+        if column in ("timepoint_id", key_column):
+            continue
+        if column == "biclique_ids":
+            updates.append(
+                "biclique_ids = CASE WHEN cardinality(EXCLUDED.biclique_ids) > 0 "
+                "THEN ARRAY(SELECT DISTINCT u FROM unnest("
+                f"COALESCE({table.name}.biclique_ids, '{{}}') || EXCLUDED.biclique_ids"
+                f") AS u ORDER BY u) ELSE {table.name}.biclique_ids END"
+            )
+        else:
+            updates.append(
+                f"{column} = COALESCE(EXCLUDED.{column}, {table.name}.{column})"
+            )
+    column_list = ", ".join(columns)
+    session.execute(
+        text(
+            f"INSERT INTO {table.name} ({column_list}) "
+            f"SELECT {column_list} FROM {stage} "
+            f"ON CONFLICT (timepoint_id, {key_column}) DO "
+            + (f"UPDATE SET {', '.join(updates)}" if updates else "NOTHING")
+        )
+    )
+    session.execute(text(f"DROP TABLE {stage}"))
+    return len(rows)
@@ -17,6 +17,13 @@ from .models import (
     DMRTimepointAnnotation,
     GeneTimepointAnnotation,
     EdgeDetails,
+    DominatingSet,
+    DecompositionNode,
+    DecompositionMember,
+    GOEnrichmentDMR,
+    GOEnrichmentBiclique,
+    TopGOProcessesDMR,
+    TopGOProcessesBiclique,
 )
 
 
@@ -46,3 +53,33 @@ def clean_database(session: Session):
         session.rollback()
         print(f"Warning: Error cleaning database: {str(e)}")
         raise
+
+
+def clean_timepoint(session: Session, timepoint_id: int):
+    """Delete a timepoint's rows so that it can be loaded again."""
+    bicliques = session.query(Biclique.id).filter(Biclique.timepoint_id == timepoint_id)
+    session.query(Metadata).filter(
+        Metadata.entity_type == "biclique", Metadata.entity_id.in_(bicliques.scalar_subquery())
+    ).delete(synchronize_session=False)
+    # Referencing tables first
+    for model in (
+        TopGOProcessesBiclique,
+        TopGOProcessesDMR,
+        GOEnrichmentBiclique,
+        GOEnrichmentDMR,
+        ComponentBiclique,
+        DominatingSet,
+        DecompositionMember,
+        DecompositionNode,
+        EdgeDetails,
+        DMRTimepointAnnotation,
+        GeneTimepointAnnotation,
+        TriconnectedComponent,
+        Biclique,
+        Component,
+        DMR,
+    ):
+        session.query(model).filter(model.timepoint_id == timepoint_id).delete(
+            synchronize_session=False
+        )
+    session.flush()
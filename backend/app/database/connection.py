@@ -7,10 +7,38 @@ from sqlalchemy.ext.declarative import declarative_base
 from sqlalchemy_utils import database_exists, create_database
 import os
 import logging
+import threading
+from contextlib import contextmanager
+from contextvars import ContextVar
+from typing import Optional
 from ..utils.extensions import app
 
 logger = logging.getLogger(__name__)
 
+_engines = {}
+_engine_lock = threading.Lock()
+
+# Database of the dataset the current request or job is scoped to
+_scoped_database_url: ContextVar[Optional[str]] = ContextVar(
+    "scoped_database_url", default=None
+)
+
+def current_database_url() -> Optional[str]:
+    """Database URL set by use_database for the current context, if any."""
+    return _scoped_database_url.get()
+
+@contextmanager
+def use_database(db_url: Optional[str]):
+    """Route get_db_engine() calls in this context to db_url (None is a no-op)."""
+    if db_url is None:
+        yield
+        return
+    token = _scoped_database_url.set(db_url)
+    try:
+        yield
+    finally:
+        _scoped_database_url.reset(token)
+
 def get_project_root():
     """Get the project root directory."""
     current_dir = os.path.dirname(os.path.abspath(__file__))
@@ -18,17 +46,23 @@ def get_project_root():
     project_root = os.path.dirname(os.path.dirname(os.path.dirname(current_dir)))
     return project_root
 
-def get_db_engine():
+def get_db_engine(db_url: Optional[str] = None):
     """Create and return a database engine.
     
     The database URL is determined in the following order:
-    1. DATABASE_URL environment variable
-    2. Flask app configuration
-    3. Default SQLite database in project root
+    1. The db_url argument
+    2. The dataset database set with use_database
+    3. DATABASE_URL environment variable
+    4. Flask app configuration
+    5. Default SQLite database in project root
     """
-    # First check environment variable
-    db_url = os.environ.get('DATABASE_URL')
-    logger.debug(f"Environment DATABASE_URL: {db_url}")
+    if db_url is None:
+        db_url = _scoped_database_url.get()
+
+    # Then check environment variable
+    if db_url is None:
+        db_url = os.environ.get('DATABASE_URL')
+        logger.debug(f"Environment DATABASE_URL: {db_url}")
     
     # Fall back to Flask app config if available
     if db_url is None and app:
@@ -44,6 +78,17 @@ def get_db_engine():
         db_url = f'sqlite:///{db_path}'
         logger.debug(f"Using default database path: {db_path}")
         
+    # Reuse one engine (and its connection pool) per database URL. In-memory
+    # SQLite gets a fresh engine each time so every caller sees its own database.
+    if ":memory:" not in db_url:
+        with _engine_lock:
+            engine = _engines.get(db_url)
+            if engine is None:
+                logger.info(f"Creating database engine with URL: {db_url}")
+                engine = create_engine(db_url)
+                _engines[db_url] = engine
+        return engine
+
     logger.info(f"Creating database engine with URL: {db_url}")
     
     engine = create_engine(db_url)
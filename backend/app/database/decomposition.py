@@ -0,0 +1,82 @@
+"""Database operations for the decomposition hierarchy index."""
+
+from typing import List, Optional, Sequence, Set, Tuple
+
+import networkx as nx
+from sqlalchemy.orm import Session
+
+from backend.app.core.decomposition_index import DecompositionIndex
+from backend.app.utils.id_mapping import reverse_create_dmr_id
+from .bulk_load import copy_rows
+from .models import Biclique, DecompositionMember, DecompositionNode, TriconnectedComponent
+
+
+def build_timepoint_decomposition(
+    session: Session,
+    timepoint_id: int,
+    original_graph: nx.Graph,
+    components: Sequence[Tuple[Set[int], int]],
+) -> DecompositionIndex:
+    """
+    Decompose a timepoint's original graph, linking the index to its stored rows.
+
+    Args:
+        components: (nodes, components.id) of each stored original component
+    """
+    components = [(nodes, comp_id) for nodes, comp_id in components if len(nodes) > 1]
+    bicliques, biclique_ids = [], []
+    for b in session.query(Biclique).filter(Biclique.timepoint_id == timepoint_id):
+        dmrs = {reverse_create_dmr_id(d, timepoint_id) for d in b.dmr_ids or []}
+        genes = set(b.gene_ids or [])
+        if dmrs and all(n in original_graph for n in dmrs | genes):
+            bicliques.append((dmrs, genes))
+            biclique_ids.append(b.id)
+    block_ids = {
+        frozenset(t.nodes or []): t.id
+        for t in session.query(TriconnectedComponent).filter(
+            TriconnectedComponent.timepoint_id == timepoint_id
+        )
+    }
+    return DecompositionIndex.build(
+        original_graph,
+        components=[nodes for nodes, _ in components],
+        component_ids=[comp_id for _, comp_id in components],
+        bicliques=bicliques,
+        biclique_ids=biclique_ids,
+        block_ids=block_ids,
+    )
+
+
+def store_decomposition_index(
+    session: Session, timepoint_id: int, index: DecompositionIndex
+) -> int:
+    """Replace a timepoint's stored hierarchy; returns the number of hierarchy nodes."""
+    session.query(DecompositionNode).filter_by(timepoint_id=timepoint_id).delete()
+    session.query(DecompositionMember).filter_by(timepoint_id=timepoint_id).delete()
+    copy_rows(
+        session,
+        DecompositionNode.__table__,
+        ("timepoint_id",) + DecompositionIndex.NODE_COLUMNS,
+        ((timepoint_id,) + row for row in index.node_rows()),
+    )
+    copy_rows(
+        session,
+        DecompositionMember.__table__,
+        ("timepoint_id",) + DecompositionIndex.MEMBER_COLUMNS,
+        ((timepoint_id,) + row for row in index.member_rows()),
+    )
+    session.commit()
+    return index.num_nodes
+
+
+def load_decomposition_index(
+    session: Session, timepoint_id: int
+) -> Optional[DecompositionIndex]:
+    """The stored hierarchy of a timepoint, or None if it has none."""
+    nodes: List = (
+        session.query(DecompositionNode).filter_by(timepoint_id=timepoint_id).all()
+    )
+    if not nodes:
+        return None
+    members = session.query(DecompositionMember).filter_by(timepoint_id=timepoint_id).all()
+    return DecompositionIndex.from_rows(nodes, members)
@@ -0,0 +1,57 @@
+"""SQL fragments that differ between the SQLite and PostgreSQL backends.
+
+Array columns (``ArrayType``) are JSON text on SQLite and ``integer[]`` on
+PostgreSQL; these helpers return the expression for either so raw ``text()``
+queries can be written once.
+"""
+
+from typing import Dict
+
+
+def array_length(dialect_name: str, column: str) -> str:
+    """Number of elements in an array column (NULL for NULL)."""
+    if dialect_name == "postgresql":
+        return f"cardinality({column})"
+    return f"json_array_length({column})"
+
+
+def array_contains(dialect_name: str, column: str, value: str) -> str:
+    """Predicate: ``value`` is an element of the array column."""
+    if dialect_name == "postgresql":
+        return f"{value} = ANY({column})"
+    return f"EXISTS (SELECT 1 FROM json_each({column}) WHERE json_each.value = {value})"
+
+
+def distinct_string_agg(dialect_name: str, expression: str) -> str:
+    """Comma-joined distinct values of a text expression within a group."""
+    if dialect_name == "postgresql":
+        return f"string_agg(DISTINCT {expression}, ',')"
+    return f"group_concat(DISTINCT {expression})"
+
+
+def unnest(dialect_name: str, column: str, alias: str) -> str:
+    """FROM item with one row per array element, as ``{alias}.value``."""
+    if dialect_name == "postgresql":
+        return f"unnest({column}) AS {alias}(value)"
+    return f"json_each({column}) AS {alias}"
+
+
+def array_text(dialect_name: str, column: str) -> str:
+    """An array column as text that ``parse_array_string`` reads ("[1,2]" or "1,2")."""
+    if dialect_name == "postgresql":
+        return f"array_to_string({column}, ',')"
+    return column
+
+
+def json_array_agg(dialect_name: str, expression: str) -> str:
+    """JSON array of an expression over a group (NULL on PostgreSQL when empty)."""
+    if dialect_name == "postgresql":
+        return f"json_agg({expression})"
+    return f"json_group_array({expression})"
+
+
+def json_object(dialect_name: str, fields: Dict[str, str]) -> str:
+    """JSON object built from ``{key: expression}``."""
+    function = "json_build_object" if dialect_name == "postgresql" else "json_object"
+    arguments = ", ".join(f"'{key}', {value}" for key, value in fields.items())
+    return f"{function}({arguments})"
@@ -0,0 +1,246 @@
+"""Checkpoints that make ``initialize_database`` resumable.
+
+Two mechanisms:
+
+* Stage artifacts. Expensive results that do not depend on the target
+  database are written to ``CHECKPOINT_DIR/<stage>/<key>.<ext>``:
+  - parsed sheets, as Parquet
+  - statistics, as JSON
+  - significance and stability results with their bicliques, as JSON
+  The key hashes every input of the stage: file contents, parameters and
+  ARTIFACT_VERSION. A run with unchanged inputs loads the artifact instead
+  of recomputing it, so iterating on a late stage skips the Excel parsing
+  and permutation tests before it.
+* A ledger per target database. It records which database stages finished
+  for which inputs. Each timepoint is loaded in a single transaction
+  (``atomic_session``), so a crash leaves the timepoint either complete or
+  absent. A rerun with unchanged inputs (``INGEST_RESUME``, on by default)
+  keeps the schema and continues after the last finished stage instead of
+  starting again from the first sheet.
+"""
+
+import hashlib
+import json
+import os
+import time
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Set, Tuple
+
+import pandas as pd
+from sqlalchemy.orm import Session
+
+import logging
+
+logger = logging.getLogger(__name__)
+
+# Bump when the content or layout of any artifact changes
+ARTIFACT_VERSION = 2
+
+# Artifacts not used by any run for this long are removed after a successful run
+DEFAULT_MAX_AGE_DAYS = 30
+
+_digests: Dict[Tuple[str, int, int], str] = {}
+
+
+def file_digest(path) -> Optional[str]:
+    """SHA-256 of a file's contents (None if it does not exist), memoised by size and mtime."""
+    try:
+        stat = os.stat(path)
+    except OSError:
+        return None
+    memo_key = (os.path.abspath(path), stat.st_size, stat.st_mtime_ns)
+    if memo_key not in _digests:
+        digest = hashlib.sha256()
+        with open(path, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                digest.update(chunk)
+        _digests[memo_key] = digest.hexdigest()
+    return _digests[memo_key]
+
+
+def stage_key(*parts) -> str:
+    """Stable hash of a stage's inputs (digests, parameters, versions)."""
+    payload = json.dumps([ARTIFACT_VERSION, *parts], sort_keys=True, default=str)
+    return hashlib.sha256(payload.encode()).hexdigest()[:32]
+
+
+def encode_bicliques(bicliques: List[Tuple[Set[int], Set[int]]]) -> List[List[List[int]]]:
+    return [[sorted(dmrs), sorted(genes)] for dmrs, genes in bicliques]
+
+
+def decode_bicliques(encoded: List[List[List[int]]]) -> List[Tuple[Set[int], Set[int]]]:
+    return [(set(dmrs), set(genes)) for dmrs, genes in encoded]
+
+
+class CheckpointStore:
+    """Stage artifacts keyed by input hash, written atomically."""
+
+    def __init__(self, directory, max_age_days: float = DEFAULT_MAX_AGE_DAYS):
+        self.directory = Path(directory)
+        self.max_age_days = max_age_days
+        self.hits = 0
+        self.misses = 0
+
+    def _path(self, stage: str, key: str, ext: str) -> Path:
+        return self.directory / stage / f"{key}.{ext}"
+
+    def _found(self, path: Path) -> bool:
+        if not path.exists():
+            return False
+        os.utime(path)  # keeps artifacts in use from being pruned
+        self.hits += 1
+        return True
+
+    @staticmethod
+    def _write(path: Path, write: Callable[[str], None]) -> None:
+        path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = path.with_name(f".{path.name}.{os.getpid()}.tmp")
+        try:
+            write(str(tmp))
+            os.replace(tmp, path)
+        finally:
+            tmp.unlink(missing_ok=True)
+
+    def load_frame(self, stage: str, key: str) -> Optional[pd.DataFrame]:
+        path = self._path(stage, key, "parquet")
+        if self._found(path):
+            df = pd.read_parquet(path)
+            # Parquet reads missing strings back as None; the Excel reader gives NaN
+            for column in df.columns[df.dtypes == object]:
+                df[column] = df[column].where(df[column].notna(), float("nan"))
+            return df
+        path = self._path(stage, key, "pkl")
+        if self._found(path):
+            return pd.read_pickle(path)
+        return None
+
+    def save_frame(self, stage: str, key: str, df: pd.DataFrame) -> None:
+        try:
+            self._write(self._path(stage, key, "parquet"), df.to_parquet)
+        except Exception as e:
+            # Mixed-type columns or non-string headers have no Parquet schema
+            logger.warning(f"{stage} artifact {key} stored as pickle ({str(e)})")
+            self._write(self._path(stage, key, "pkl"), df.to_pickle)
+
+    def load_json(self, stage: str, key: str):
+        path = self._path(stage, key, "json")
+        if not self._found(path):
+            return None
+        with open(path) as f:
+            return json.load(f)
+
+    def save_json(self, stage: str, key: str, data) -> None:
+        def write(tmp: str) -> None:
+            with open(tmp, "w") as f:
+                json.dump(data, f)
+
+        self._write(self._path(stage, key, "json"), write)
+
+    def frame(self, stage: str, key: str, compute: Callable[[], pd.DataFrame]) -> pd.DataFrame:
+        """The stage's DataFrame from its artifact, computing and storing it on a miss."""
+        df = self.load_frame(stage, key)
+        if df is None:
+            self.misses += 1
+            df = compute()
+            self.save_frame(stage, key, df)
+        return df
+
+    def cached_json(self, stage: str, key: str, compute: Callable[[], object]):
+        """Like frame() for JSON-safe results."""
+        data = self.load_json(stage, key)
+        if data is None:
+            self.misses += 1
+            data = compute()
+            self.save_json(stage, key, data)
+        return data
+
+    def ledger(self, database_url: str) -> "IngestLedger":
+        name = hashlib.sha256(str(database_url).encode()).hexdigest()[:12]
+        return IngestLedger(self.directory / f"ledger-{name}.json")
+
+    def prune(self) -> int:
+        """Remove artifacts no run has used for max_age_days."""
+        if not self.directory.exists():
+            return 0
+        cutoff = time.time() - self.max_age_days * 86400
+        removed = 0
+        for stage_dir in self.directory.iterdir():
+            if not stage_dir.is_dir():
+                continue
+            for path in stage_dir.iterdir():
+                if path.stat().st_mtime < cutoff:
+                    path.unlink(missing_ok=True)
+                    removed += 1
+        return removed
+
+
+class IngestLedger:
+    """Database stages finished by an interrupted run, and the inputs they used."""
+
+    def __init__(self, path: Path):
+        self.path = Path(path)
+        self.data: Dict = {}
+
+    def begin(self, run_key: str, resume: bool = True) -> bool:
+        """
+        Continue the unfinished run with the same inputs, or start a new one.
+
+        Returns:
+            True when earlier stages are kept, False for a fresh run
+        """
+        previous = {}
+        if resume and self.path.exists():
+            try:
+                previous = json.loads(self.path.read_text())
+            except (OSError, ValueError):
+                previous = {}
+        if previous.get("run_key") == run_key and not previous.get("complete"):
+            self.data = previous
+            return bool(self.data["stages"])
+        self.data = {"run_key": run_key, "stages": {}, "complete": False}
+        self._save()
+        return False
+
+    def done(self, stage: str, key: Optional[str] = None) -> bool:
+        return self.data["stages"].get(stage) == (key or self.data["run_key"])
+
+    def complete(self, stage: str, key: Optional[str] = None) -> None:
+        self.data["stages"][stage] = key or self.data["run_key"]
+        self._save()
+
+    def finish(self) -> None:
+        self.data["complete"] = True
+        self._save()
+
+    def _save(self) -> None:
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        self.data["updated_at"] = time.time()
+        tmp = self.path.with_suffix(".tmp")
+        tmp.write_text(json.dumps(self.data, indent=2))
+        os.replace(tmp, self.path)
+
+
+@contextmanager
+def atomic_session(engine):
+    """
+    Session whose commit() calls only release savepoints; everything done
+    in the block is committed at its end, or rolled back if it raises.
+    """
+    with engine.connect() as conn:
+        transaction = conn.begin()
+        if conn.dialect.name == "sqlite":
+            # pysqlite defers BEGIN to the first write, which would make the
+            # first savepoint the outer transaction
+            conn.exec_driver_sql("BEGIN")
+        session = Session(bind=conn, join_transaction_mode="create_savepoint")
+        try:
+            yield session
+            session.commit()
+            transaction.commit()
+        except BaseException:
+            session.rollback()
+            transaction.rollback()
+            raise
+        finally:
+            session.close()
@@ -40,11 +40,14 @@ def read_sql_file(filename):
 
 
 def create_views(engine):
-    """Create all database views."""
+    """Create all database views, using the PostgreSQL definitions on PostgreSQL."""
     try:
         # Read SQL files
         drop_views_sql = read_sql_file("drop_views.sql")
-        create_views_sql = read_sql_file("create_views.sql")
+        if engine.dialect.name == "postgresql":
+            create_views_sql = read_sql_file(os.path.join("postgresql", "create_views.sql"))
+        else:
+            create_views_sql = read_sql_file("create_views.sql")
 
         if not drop_views_sql or not create_views_sql:
             raise Exception("Failed to read SQL files")
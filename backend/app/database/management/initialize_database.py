@@ -2,7 +2,7 @@
 
 import os
 import sys
-from typing import Dict, List, Set, Tuple
+from typing import Callable, Dict, List, Optional, Set, Tuple
 
 # import pandas as pd
 # import networkx as nx
@@ -15,13 +15,20 @@ from sqlalchemy.orm import Session
 
 from backend.app.core.data_loader import (
     get_excel_sheets,
+    process_enhancer_info,
     read_excel_file,
     read_gene_mapping,
 )
 
 from backend.app.database import models, connection
-from backend.app.database.operations import get_or_create_timepoint
-from backend.app.database.cleanup import clean_database
+from backend.app.database.operations import (
+    get_edge_sources,
+    get_or_create_timepoint,
+    store_biclique_significance,
+    store_stability_scores,
+    store_timepoint_statistics,
+)
+from backend.app.database.cleanup import clean_database, clean_timepoint
 from backend.app.database.populate_tables import (
     populate_timepoints,
     populate_master_gene_ids,
@@ -33,15 +40,79 @@ from backend.app.database.process_timepoints import (
     process_timepoint_table_data,
 )
 
+from backend.app.biclique_analysis.statistics_engine import (
+    STATISTICS_VERSION,
+    StatisticsJob,
+    run_statistics_engine,
+)
+from backend.app.biclique_analysis.significance import compute_timepoint_significance
+from backend.app.biclique_analysis.stability import (
+    compute_timepoint_stability,
+    parse_source_weights,
+)
+from backend.app.biclique_analysis.node_embeddings import (
+    build_timepoint_index,
+    stored_bicliques,
+)
+from backend.app.database.analytics import DEFAULT_ANALYTICS_DIR, export_snapshot
+from backend.app.database.trajectories import build_gene_trajectories
+from backend.app.utils.graph_io import read_bipartite_graph
 from backend.app.config import get_project_root
+from backend.app.core.datasets import get_dataset_config
+from backend.app.database.management.checkpoints import (
+    CheckpointStore,
+    atomic_session,
+    decode_bicliques,
+    encode_bicliques,
+    file_digest,
+    stage_key,
+)
 
 # Load environment variables from sample.env
 load_dotenv(os.path.join(get_project_root(), "processDMR.env"))
 
 
-def main():
-    """Main entry point for initializing the database."""
+def _sheet_frame(store: CheckpointStore, workbook: str, sheet: str):
+    """read_excel_file through a Parquet artifact of the parsed sheet."""
+
+    def parse():
+        # The derived enhancer sets have no Parquet type; they are rebuilt below
+        return read_excel_file(workbook, sheet_name=sheet).drop(
+            columns=["Processed_Enhancer_Info"]
+        )
+
+    df = store.frame("sheets", stage_key(file_digest(workbook), sheet), parse)
+    df["Processed_Enhancer_Info"] = df[
+        "ENCODE_Enhancer_Interaction(BingRen_Lab)"
+    ].apply(process_enhancer_info)
+    return df
+
+
+def initialize_database(
+    progress: Optional[Callable[..., None]] = None, resume: Optional[bool] = None
+):
+    """
+    Rebuild the database from the spreadsheets and graph files; raises on failure.
+
+    Stages whose inputs are unchanged are loaded from CHECKPOINT_DIR, and a
+    run interrupted with the same inputs continues after its last finished
+    stage (see checkpoints.py).
+
+    Args:
+        progress: Called as progress(stage, detail) when each stage starts;
+            the ingest jobs use it for progress reports and raise from it to
+            cancel between stages
+        resume: Continue an interrupted run (default INGEST_RESUME, true);
+            False always rebuilds the schema
+    """
+    report = progress or (lambda stage, detail="": None)
     try:
+        # DATASET=<name> ingests into that manifest entry's database and files
+        dataset = os.getenv("DATASET")
+        if dataset:
+            os.environ.update(get_dataset_config(dataset).environment())
+            print(f"Initializing dataset {dataset} ({os.environ['DATABASE_URL']})")
+
         # Get paths from environment variables
         data_dir = os.getenv("DATA_DIR", "./data")
         dss1_file = os.getenv("DSS1_FILE", os.path.join(data_dir, "DSS1.xlsx"))
@@ -49,134 +120,341 @@ def main():
         dss_pairwise_file = os.getenv(
             "DSS_PAIRWISE_FILE", os.path.join(data_dir, "DSS_PAIRWISE.xlsx")
         )
-        # Create engine and ensure tables exist
-        engine = connection.get_db_engine()
-        models.Base.metadata.drop_all(engine)  # Drop all existing tables
-        models.Base.metadata.create_all(engine)  # Create fresh tables
+        if resume is None:
+            resume = os.getenv("INGEST_RESUME", "true").lower() in ("1", "true", "yes")
+        store = CheckpointStore(
+            os.getenv("CHECKPOINT_DIR", os.path.join(data_dir, "checkpoints"))
+        )
 
-        with Session(engine) as session:
-            # Clean database (this will now just clear data, not schema)
-            clean_database(session)
+        # Read sheets from both files
+        timeseries_sheet = "DSS_Time_Series"  # The sheet name from DSS1.xlsx
+        pairwise_sheets = get_excel_sheets(dss_pairwise_file)
 
-            # Create views after all tables are populated
+        print(f"Timeseries sheet: {timeseries_sheet}")
+        print(f"Pairwise sheets: {pairwise_sheets}")
 
-            print("\nCollecting all unique genes across timepoints...")
+        # Get start_gene_id from environment
+        start_gene_id = int(os.getenv("START_GENE_ID", "100000"))
+        gene_mapping_path = os.path.join(data_dir, "master_gene_ids.csv")
 
-            # Read sheets from both files
-            timeseries_sheet = "DSS_Time_Series"  # The sheet name from DSS1.xlsx
-            pairwise_sheets = get_excel_sheets(dss_pairwise_file)
+        # (sheet, workbook, timepoint_name, original graph, bicliques) per timepoint
+        sources = [
+            (
+                timeseries_sheet,
+                dss1_file,
+                "DSStimeseries",
+                os.path.join(data_dir, "bipartite_graph_output_DSS_overall.txt"),
+                os.path.join(data_dir, "bipartite_graph_output.txt.biclusters"),
+            )
+        ]
+        for sheet in pairwise_sheets:
+            # Remove _TSS from the end of sheet name for timepoint_name
+            timepoint_name = sheet.replace("_TSS", "") if sheet.endswith("_TSS") else sheet
+            graph_file = os.path.join(data_dir, f"bipartite_graph_output_{sheet}.txt")
+            sources.append(
+                (sheet, dss_pairwise_file, timepoint_name, graph_file, f"{graph_file}.biclusters")
+            )
 
-            print(f"Timeseries sheet: {timeseries_sheet}")
-            print(f"Pairwise sheets: {pairwise_sheets}")
+        # Everything the database contents depend on
+        engine = connection.get_db_engine()
+        mapping_digest = file_digest(gene_mapping_path)
+        run_key = stage_key(
+            str(engine.url),
+            start_gene_id,
+            mapping_digest,
+            [
+                [sheet, file_digest(workbook), file_digest(graph), file_digest(bicliques)]
+                for sheet, workbook, _, graph, bicliques in sources
+            ],
+        )
+        ledger = store.ledger(str(engine.url))
+        resuming = ledger.begin(run_key, resume)
 
-            # Get start_gene_id from environment
-            start_gene_id = int(os.getenv("START_GENE_ID", "100000"))
+        # Create engine and ensure tables exist
+        models.Base.metadata.create_all(engine)
+        with Session(engine) as session:
+            if resuming and session.query(models.Timepoint).first() is None:
+                resuming = ledger.begin(run_key, resume=False)
+            if resuming:
+                print(f"Resuming initialization from {ledger.path}")
 
-            # Populate timepoints with both timeseries and pairwise sheets
-            print("\nPopulating timepoints...")
-            populate_timepoints(
-                session, timeseries_sheet, pairwise_sheets, start_gene_id
-            )
-            session.commit()
-            gene_mapping_path = os.path.join(data_dir, "master_gene_ids.csv")
             gene_id_mapping = read_gene_mapping(gene_mapping_path)
             if gene_id_mapping is None or gene_id_mapping == {}:
                 raise Exception(f"Unable to read gene mapping at {gene_mapping_path}")
-            populate_master_gene_ids(session, gene_id_mapping)
 
-            # Populate genes with initial data
-            print("\nPopulating core genes table...")
-            populate_core_genes(session, gene_id_mapping)
-            session.commit()
-            print(f"Debug: timeseries spreadshet file {dss1_file} ")
+            if ledger.done("genes"):
+                report("schema", "(checkpoint)")
+                report("genes", "(checkpoint)")
+            else:
+                report("schema")
+                models.Base.metadata.drop_all(engine)  # Drop all existing tables
+                models.Base.metadata.create_all(engine)  # Create fresh tables
+                # Clean database (this will now just clear data, not schema)
+                clean_database(session)
+
+                report("genes")
+                print("\nCollecting all unique genes across timepoints...")
+
+                # Populate timepoints with both timeseries and pairwise sheets
+                print("\nPopulating timepoints...")
+                populate_timepoints(
+                    session, timeseries_sheet, pairwise_sheets, start_gene_id
+                )
+                session.commit()
+                populate_master_gene_ids(session, gene_id_mapping)
+
+                # Populate genes with initial data
+                print("\nPopulating core genes table...")
+                populate_core_genes(session, gene_id_mapping)
+                session.commit()
+                ledger.complete("genes")
 
             if not os.path.exists(dss1_file):
                 print(f"Warning: timeseries spreadshet file {dss1_file} not found")
                 raise Exception("DSS1 file not found")
-            df_DSS1 = read_excel_file(dss1_file, sheet_name="DSS_Time_Series")
-            max_dmr_id = 0
-            print("\nProcessing DSS1 data...")
-            if df_DSS1 is not None:
-                print(f"Successfully read DSS1 data with {len(df_DSS1)} rows")
-                max_dmr_id = len(df_DSS1) - 1
-            else:
-                print(f"Unable to read DSS1 from path {dss1_file}")
-                raise Exception("Unable to read DSS1 data")
-            ts_original_graph_file = os.path.join(
-                data_dir, "bipartite_graph_output_DSS_overall.txt"
-            )
-            ts_bicliques_file = os.path.join(
-                data_dir, "bipartite_graph_output.txt.biclusters"
-            )
-            print(ts_original_graph_file)
-            timepoint_id = get_or_create_timepoint(
-                session, sheet_name="DSS_Time_Series"
-            )
-            process_timepoint_table_data(
-                session, timepoint_id, df_DSS1, gene_id_mapping
-            )
-            session.commit()
-            process_bicliques_for_timepoint(
-                session=session,
-                timepoint_id=timepoint_id,
-                timepoint_name="DSStimeseries",
-                original_graph_file=ts_original_graph_file,
-                bicliques_file=ts_bicliques_file,
-                df=df_DSS1,
-                gene_id_mapping=gene_id_mapping,
-                file_format="gene_name",
-            )
-            session.commit()
-            # Process pairwise sheets
-
-            pairwise_dfs = {}
-            for sheet in pairwise_sheets:
-                print(f"\nProcessing sheet: {sheet}")
-                df_sheet = read_excel_file(dss_pairwise_file, sheet_name=sheet)
-                if df_sheet is not None:
-                    pairwise_dfs[sheet] = df_sheet
-                    # all_genes.update(get_genes_from_df(df))
-
-                original_graph_file = os.path.join(
-                    data_dir, "bipartite_graph_output_", f"{sheet}.txt"
-                )
-                bicliques_file = os.path.join(
-                    data_dir, "bipartite_graph_output.txt.", f"{sheet}_bicluster"
-                )
+
+            # Each timepoint is loaded in one transaction: a crash leaves it
+            # absent, and the next run starts at that timepoint
+            statistics_jobs = []
+            for number, (sheet, workbook, timepoint_name, graph_file, bicliques_file) in enumerate(
+                sources, start=1
+            ):
+                detail = f"{sheet} ({number}/{len(sources)})"
                 timepoint_id = get_or_create_timepoint(session, sheet_name=sheet)
-                process_timepoint_table_data(
-                    session=session,
-                    timepoint_id=timepoint_id,
-                    df=df_sheet,
-                    gene_id_mapping=gene_id_mapping,
-                )
-                original_graph_file = os.path.join(
-                    data_dir, f"bipartite_graph_output_{sheet}.txt"
-                )
-                bicliques_file = os.path.join(
-                    data_dir, f"bipartite_graph_output_{sheet}.txt.biclusters"
-                )
-                # Remove _TSS from the end of sheet name for timepoint_name
-                timepoint_name = (
-                    sheet.replace("_TSS", "") if sheet.endswith("_TSS") else sheet
-                )
-                process_bicliques_for_timepoint(
-                    session=session,
-                    timepoint_id=get_or_create_timepoint(session, sheet_name=sheet),
-                    timepoint_name=timepoint_name,
-                    original_graph_file=original_graph_file,
-                    bicliques_file=bicliques_file,
-                    df=df_sheet,
-                    gene_id_mapping=gene_id_mapping,
-                    file_format="gene_name",
-                )
+                # Nothing may hold a write lock while the load runs on its own connection
                 session.commit()
+                if ledger.done(f"timepoint:{sheet}"):
+                    report("timepoints", f"{detail} (checkpoint)")
+                else:
+                    report("timepoints", detail)
+                    print(f"\nProcessing sheet: {sheet}")
+                    df_sheet = _sheet_frame(store, workbook, sheet)
+                    print(f"Read {sheet} with {len(df_sheet)} rows")
+                    with atomic_session(engine) as tp_session:
+                        # Rows of a load that committed before its stage was recorded
+                        clean_timepoint(tp_session, timepoint_id)
+                        process_timepoint_table_data(
+                            session=tp_session,
+                            timepoint_id=timepoint_id,
+                            df=df_sheet,
+                            gene_id_mapping=gene_id_mapping,
+                        )
+                        process_bicliques_for_timepoint(
+                            session=tp_session,
+                            timepoint_id=timepoint_id,
+                            timepoint_name=timepoint_name,
+                            original_graph_file=graph_file,
+                            bicliques_file=bicliques_file,
+                            df=df_sheet,
+                            gene_id_mapping=gene_id_mapping,
+                            file_format="gene_name",
+                        )
+                    ledger.complete(f"timepoint:{sheet}")
+                statistics_jobs.append(
+                    StatisticsJob(
+                        timepoint_id=timepoint_id,
+                        timepoint_name=timepoint_name,
+                        original_graph_file=graph_file,
+                        bicliques_file=bicliques_file,
+                        gene_id_mapping=gene_id_mapping,
+                    )
+                )
             session.commit()
 
-            print("\nDatabase initialization completed successfully")
+            def job_inputs(job):
+                return [
+                    file_digest(job.original_graph_file),
+                    file_digest(job.bicliques_file),
+                    mapping_digest,
+                ]
+
+            # Precompute the statistics pages, one worker per timepoint; the
+            # results of timepoints with unchanged files come from artifacts
+            workers = os.getenv("STATISTICS_WORKERS")
+            if ledger.done("statistics"):
+                report("statistics", "(checkpoint)")
+            else:
+                report("statistics")
+                keys = {
+                    job.timepoint_id: stage_key(STATISTICS_VERSION, job_inputs(job))
+                    for job in statistics_jobs
+                }
+                results = {}
+                for job in statistics_jobs:
+                    cached = store.load_json("statistics", keys[job.timepoint_id])
+                    if cached is not None:
+                        results[job.timepoint_id] = cached
+                missing = [job for job in statistics_jobs if job.timepoint_id not in results]
+                if missing:
+                    computed = run_statistics_engine(
+                        missing, max_workers=int(workers) if workers else None
+                    )
+                    for stats_timepoint_id, stats in computed.items():
+                        if "error" not in stats:
+                            store.save_json("statistics", keys[stats_timepoint_id], stats)
+                    results.update(computed)
+                for stats_timepoint_id, stats in results.items():
+                    if "error" in stats:
+                        print(
+                            f"Warning: statistics failed for timepoint {stats_timepoint_id}: {stats['error']}"
+                        )
+                        continue
+                    store_timepoint_statistics(
+                        session, stats_timepoint_id, stats, STATISTICS_VERSION
+                    )
+                print(
+                    f"Stored statistics for {len(results)} timepoints "
+                    f"({len(statistics_jobs) - len(missing)} from checkpoints)"
+                )
+                ledger.complete("statistics")
+
+            # Permutation p-values of the bicliques (opt in: it draws
+            # NULL_MODEL_SAMPLES degree-preserving null graphs per timepoint)
+            null_samples = int(os.getenv("NULL_MODEL_SAMPLES", "0"))
+            significance_key = stage_key(null_samples)
+            if null_samples > 0 and ledger.done("significance", significance_key):
+                report("significance", "(checkpoint)")
+            elif null_samples > 0:
+                report("significance")
+                for job in statistics_jobs:
+                    try:
+
+                        def compute(job=job):
+                            bicliques, significance = compute_timepoint_significance(
+                                job,
+                                n_null=null_samples,
+                                max_workers=int(workers) if workers else None,
+                            )
+                            return {
+                                "bicliques": encode_bicliques(bicliques),
+                                "significance": significance,
+                            }
+
+                        result = store.cached_json(
+                            "significance", stage_key(job_inputs(job), null_samples), compute
+                        )
+                        annotated = store_biclique_significance(
+                            session,
+                            job.timepoint_id,
+                            decode_bicliques(result["bicliques"]),
+                            result["significance"],
+                        )
+                        print(f"Stored p-values of {annotated} bicliques for {job.timepoint_name}")
+                    except Exception as e:
+                        print(f"Warning: significance failed for {job.timepoint_name}: {str(e)}")
+                ledger.complete("significance", significance_key)
+
+            # Bootstrap stability of dominating DMRs and bicliques (opt in:
+            # STABILITY_REPLICATES perturbed graphs per timepoint)
+            replicates = int(os.getenv("STABILITY_REPLICATES", "0"))
+            stability_settings = [
+                replicates,
+                float(os.getenv("STABILITY_DROP_RATE", "0.1")),
+                float(os.getenv("STABILITY_ADD_RATE", "0")),
+                parse_source_weights(os.getenv("STABILITY_SOURCE_WEIGHTS", "")),
+            ]
+            stability_key = stage_key(stability_settings)
+            if replicates > 0 and ledger.done("stability", stability_key):
+                report("stability", "(checkpoint)")
+            elif replicates > 0:
+                report("stability")
+                for job in statistics_jobs:
+                    try:
+                        # Edge sources weight the drop rate; they come from the
+                        # workbook, which job_inputs does not cover
+                        edge_sources = get_edge_sources(session, job.timepoint_id)
+                        sources_key = stage_key(
+                            sorted((d, g, *sorted(s)) for (d, g), s in edge_sources.items())
+                        )
+
+                        def compute(job=job, edge_sources=edge_sources):
+                            bicliques, stability = compute_timepoint_stability(
+                                job,
+                                n_replicates=replicates,
+                                drop_rate=stability_settings[1],
+                                add_rate=stability_settings[2],
+                                source_weights=stability_settings[3],
+                                edge_sources=edge_sources,
+                                max_workers=int(workers) if workers else None,
+                            )
+                            return {
+                                "bicliques": encode_bicliques(bicliques),
+                                "stability": stability,
+                            }
+
+                        result = store.cached_json(
+                            "stability",
+                            stage_key(job_inputs(job), stability_settings, sources_key),
+                            compute,
+                        )
+                        stability = result["stability"]
+                        annotated = store_stability_scores(
+                            session,
+                            job.timepoint_id,
+                            decode_bicliques(result["bicliques"]),
+                            stability,
+                        )
+                        print(
+                            f"Stored stability of {len(stability['dmrs'])} DMRs and "
+                            f"{annotated} bicliques for {job.timepoint_name}"
+                        )
+                    except Exception as e:
+                        print(f"Warning: stability failed for {job.timepoint_name}: {str(e)}")
+                ledger.complete("stability", stability_key)
+
+            # Pivot the per-timepoint gene annotations into trajectories
+            report("trajectories")
+            print(f"Stored trajectories of {build_gene_trajectories(session)} genes")
+
+            # Embedding indexes for the similarity routes, which only read them
+            report("similarity")
+            embeddings_root = os.path.join(
+                os.getenv("GRAPH_DATA_DIR", os.path.join(data_dir, "graphs")), "embeddings"
+            )
+            for job in statistics_jobs:
+                if not os.path.exists(job.original_graph_file):
+                    continue
+                try:
+                    index = build_timepoint_index(
+                        read_bipartite_graph(
+                            job.original_graph_file, timepoint=job.timepoint_name
+                        ),
+                        job.timepoint_id,
+                        embeddings_root,
+                        bicliques=stored_bicliques(session, job.timepoint_id),
+                    )
+                    print(f"Built similarity index of {len(index)} items for {job.timepoint_name}")
+                except Exception as e:
+                    print(f"Warning: similarity index failed for {job.timepoint_name}: {str(e)}")
+
+        # Columnar snapshot for analytical / LLM-generated queries
+        report("analytics")
+        try:
+            snapshot = export_snapshot(
+                engine, os.getenv("ANALYTICS_DIR", str(DEFAULT_ANALYTICS_DIR))
+            )
+            print(f"Exported analytics snapshot to {snapshot}")
+        except ImportError as e:
+            print(f"Warning: analytics snapshot skipped ({e})")
+
+        ledger.finish()
+        removed = store.prune()
+        print(
+            f"Checkpoints: {store.hits} artifacts reused, {store.misses} computed"
+            + (f", {removed} expired artifacts removed" if removed else "")
+        )
+        print("\nDatabase initialization completed successfully")
 
     except Exception as e:
         print(f"An error occurred during database initialization: {str(e)}")
+        raise
+
+
+def main():
+    """Main entry point for initializing the database."""
+    try:
+        initialize_database()
+    except Exception:
         sys.exit(1)
 
 
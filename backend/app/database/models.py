@@ -10,13 +10,17 @@ from sqlalchemy import (
     String,
     Text,
     ForeignKey,
+    ForeignKeyConstraint,
     ARRAY,
     Float,
     Boolean,
     UniqueConstraint,
     Index,
     JSON,
+    event,
+    DDL,
 )
+from sqlalchemy.dialects import postgresql
 from sqlalchemy.types import TypeDecorator, TEXT
 from sqlalchemy.ext.declarative import declarative_base
 from sqlalchemy.orm import relationship
@@ -26,19 +30,52 @@ Base = declarative_base()
 
 
 class ArrayType(TypeDecorator):
-    """Convert between Python list and string stored in database."""
+    """
+    Convert between Python list and string stored in database.
+
+    On PostgreSQL the column is a native ``integer[]`` instead (``jsonb`` when
+    ``nested=True``, for lists of pairs), so membership can use ``= ANY`` and
+    GIN indexes. ``csv=True`` marks columns the application reads and writes as
+    comma-separated strings ("1,4,7"); those are parsed into the array on the
+    way in and joined back on the way out so callers see the same value on
+    either backend.
+    """
 
     impl = TEXT
+    cache_ok = True
+
+    def __init__(self, nested: bool = False, csv: bool = False):
+        super().__init__()
+        self.nested = nested
+        self.csv = csv
+
+    def load_dialect_impl(self, dialect):
+        if dialect.name == "postgresql":
+            if self.nested:
+                return dialect.type_descriptor(postgresql.JSONB())
+            return dialect.type_descriptor(postgresql.ARRAY(Integer))
+        return dialect.type_descriptor(TEXT())
 
     def process_bind_param(self, value, dialect):
         if value is None:
             return None
-        return json.dumps(value)
+        if dialect.name != "postgresql":
+            return json.dumps(value)
+        if self.nested:
+            return value
+        if isinstance(value, str):
+            value = value.strip().strip("[]")
+            return [int(v) for v in value.split(",") if v.strip()]
+        return [int(v) for v in value]
 
     def process_result_value(self, value, dialect):
         if value is None:
             return None
-        return json.loads(value)
+        if dialect.name != "postgresql":
+            return json.loads(value)
+        if self.csv:
+            return ",".join(str(v) for v in value)
+        return list(value)
 
 
 class Timepoint(Base):
@@ -81,7 +118,24 @@ class GeneTimepointAnnotation(Base):
     node_type = Column(String(30), nullable=True)
     gene_type = Column(String(30), nullable=True)
     is_isolate = Column(Boolean, default=False)
-    biclique_ids = Column(ArrayType, nullable=True)
+    biclique_ids = Column(ArrayType(csv=True), nullable=True)
+
+
+# A gene's annotations across all timepoints, pivoted at ingest so that a
+# trajectory is one primary key read. Every array has one entry per entry of
+# timepoint_ids; dominated_by holds the dominating DMRs of all timepoints back
+# to back, timepoint i owning dominated_by[dominated_by_indptr[i]:dominated_by_indptr[i + 1]].
+class GeneTrajectory(Base):
+    __tablename__ = "gene_trajectories"
+    gene_id = Column(Integer, ForeignKey("genes.id"), primary_key=True)
+    timepoint_ids = Column(ArrayType, nullable=False)
+    status = Column(ArrayType, nullable=False)  # bit flags, see database.trajectories
+    degree = Column(ArrayType, nullable=False)
+    component_size = Column(ArrayType, nullable=False)
+    biclique_count = Column(ArrayType, nullable=False)
+    dominated_by = Column(ArrayType, nullable=False)
+    dominated_by_indptr = Column(ArrayType, nullable=False)
+    timepoint_count = Column(Integer)  # timepoints the gene is annotated in
 
 
 # AI MasterGeneID is a table separte to Genes. It should be used to find the ID for genes
@@ -137,7 +191,7 @@ class DMRTimepointAnnotation(Base):
     node_type = Column(String(30), nullable=True)
     gene_type = Column(String(30), nullable=True)
     is_isolate = Column(Boolean, default=False)
-    biclique_ids = Column(ArrayType, nullable=True)
+    biclique_ids = Column(ArrayType(csv=True), nullable=True)
 
 
 class Metadata(Base):
@@ -223,7 +277,7 @@ class TriconnectedComponent(Base):
 
     # Component structure
     nodes = Column(ArrayType)  # Store actual nodes in component
-    separation_pairs = Column(ArrayType)  # Store pairs that separate component
+    separation_pairs = Column(ArrayType(nested=True))  # Store pairs that separate component
 
     # Additional statistics
     avg_dmrs = Column(Float)  # Average DMRs for interesting components
@@ -233,7 +287,7 @@ class TriconnectedComponent(Base):
 class Statistic(Base):
     __tablename__ = "statistics"
     id = Column(Integer, primary_key=True)
-    category = Column(String(50))
+    category = Column(String(50), index=True)
     key = Column(String(255))
     value = Column(Text)
 
@@ -267,6 +321,28 @@ class EdgeDetails(Base):
     gene = relationship("Gene", backref="edge_details")
     timepoint = relationship("Timepoint", backref="edge_details")
 
+    # Covering indexes for the per-DMR / per-gene edge lookups of a timepoint
+    __table_args__ = (
+        Index(
+            "ix_edge_details_timepoint_dmr",
+            "timepoint_id",
+            "dmr_id",
+            "gene_id",
+            "edge_type",
+            "edit_type",
+            "distance_from_tss",
+        ),
+        Index(
+            "ix_edge_details_timepoint_gene",
+            "timepoint_id",
+            "gene_id",
+            "dmr_id",
+            "edge_type",
+            "edit_type",
+            "distance_from_tss",
+        ),
+    )
+
 
 class GeneDetails(Base):
     __tablename__ = "gene_details"
@@ -330,24 +406,38 @@ class GOEnrichmentBiclique(Base):
 class TopGOProcessesDMR(Base):
     __tablename__ = "top_go_processes_dmr"
 
-    dmr_id = Column(Integer, ForeignKey("go_enrichment_dmr.dmr_id"), primary_key=True)
+    dmr_id = Column(Integer, primary_key=True)
     timepoint_id = Column(Integer, ForeignKey("timepoints.id"), primary_key=True)
     termId = Column(String(50), primary_key=True)
     pValue = Column(Float)
     enrichmentScore = Column(Float)
 
+    # go_enrichment_dmr is keyed by (dmr_id, timepoint_id); PostgreSQL rejects
+    # a foreign key to dmr_id alone
+    __table_args__ = (
+        ForeignKeyConstraint(
+            ["dmr_id", "timepoint_id"],
+            ["go_enrichment_dmr.dmr_id", "go_enrichment_dmr.timepoint_id"],
+        ),
+    )
+
 
 class TopGOProcessesBiclique(Base):
     __tablename__ = "top_go_processes_biclique"
 
-    biclique_id = Column(
-        Integer, ForeignKey("go_enrichment_biclique.biclique_id"), primary_key=True
-    )
+    biclique_id = Column(Integer, primary_key=True)
     timepoint_id = Column(Integer, ForeignKey("timepoints.id"), primary_key=True)
     termId = Column(String(50), primary_key=True)
     pValue = Column(Float)
     enrichmentScore = Column(Float)
 
+    __table_args__ = (
+        ForeignKeyConstraint(
+            ["biclique_id", "timepoint_id"],
+            ["go_enrichment_biclique.biclique_id", "go_enrichment_biclique.timepoint_id"],
+        ),
+    )
+
 
 class GeneReference(Base):
     __tablename__ = "gene_references"
@@ -378,6 +468,33 @@ class DominatingSet(Base):
     dmr = relationship("DMR", back_populates="dominating_set_entries")
 
 
+# Decomposition hierarchy of a timepoint's original graph (see
+# core/decomposition_index.py): component -> block -> SPQR node -> biclique.
+# Positions, parents and links are positions within the timepoint; member
+# node ids are raw graph node ids.
+class DecompositionNode(Base):
+    __tablename__ = "decomposition_nodes"
+    timepoint_id = Column(Integer, ForeignKey("timepoints.id"), primary_key=True)
+    position = Column(Integer, primary_key=True)
+    level = Column(String(20), nullable=False)  # component, block, spqr, biclique
+    kind = Column(String(20), nullable=False)  # block/bridge, S/P/R/U, ...
+    parent = Column(Integer)  # position of the parent node
+    link = Column(Integer)  # parent in the block-cut tree or SPQR tree
+    link_a = Column(Integer)  # cut vertex / separation pair shared with link
+    link_b = Column(Integer)
+    source_id = Column(Integer)  # components.id, triconnected_components.id or bicliques.id
+    member_start = Column(Integer, nullable=False)  # slice of decomposition_members
+    member_stop = Column(Integer, nullable=False)
+
+
+class DecompositionMember(Base):
+    __tablename__ = "decomposition_members"
+    timepoint_id = Column(Integer, ForeignKey("timepoints.id"), primary_key=True)
+    position = Column(Integer, primary_key=True)
+    node_id = Column(Integer, nullable=False)
+    flags = Column(Integer, nullable=False)  # 1 gene, 2 cut vertex / separation pair node
+
+
 from typing import Optional
 from pydantic import BaseModel
 
@@ -403,6 +520,23 @@ class EnsemblGenes(BaseModel):
         orm_mode = True
 
 
+# GIN indexes for membership tests (= ANY / @>) on the PostgreSQL array columns
+for _table, _column in (
+    (Biclique.__table__, "dmr_ids"),
+    (Biclique.__table__, "gene_ids"),
+    (DMRTimepointAnnotation.__table__, "biclique_ids"),
+    (GeneTimepointAnnotation.__table__, "biclique_ids"),
+):
+    event.listen(
+        _table,
+        "after_create",
+        DDL(
+            f"CREATE INDEX IF NOT EXISTS ix_{_table.name}_{_column}_gin "
+            f"ON {_table.name} USING GIN ({_column})"
+        ).execute_if(dialect="postgresql"),
+    )
+
+
 def create_tables(engine):
     """Create all tables in the database."""
     Base.metadata.create_all(engine)
@@ -1,11 +1,12 @@
 """Core database operations for DMR analysis system."""
 
 import networkx as nx
-from typing import Set, Dict, List, Tuple, Any
+from typing import Set, Dict, List, Optional, Tuple, Any
 from flask import current_app
 from os import environ
 from sqlalchemy import and_, func
 from backend.app.biclique_analysis.classifier import classify_biclique
+from backend.app.utils.id_mapping import convert_dmr_id, create_dmr_id
 from .models import GeneTimepointAnnotation, DMRTimepointAnnotation, EdgeDetails
 from .models import TriconnectedComponent
 from .models import (
@@ -16,6 +17,7 @@ from .models import (
 )
 
 from sqlalchemy.orm import Session
+from .connection import current_database_url
 from .models import (
     Timepoint,
     Gene,
@@ -30,6 +32,8 @@ from .models import (
     DominatingSet,
 )
 import os
+import json
+from datetime import datetime
 from sqlalchemy import create_engine
 
 
@@ -38,15 +42,18 @@ def get_db_engine(database_url=None):
 
     Args:
         database_url: Optional database URL. If not provided, will try to get from:
-            1. Environment variable DATABASE_URL
-            2. Default value of sqlite:///dmr_analysis.db
+            1. The dataset database set with connection.use_database
+            2. Environment variable DATABASE_URL
+            3. Default value of sqlite:///dmr_analysis.db
 
     Returns:
         SQLAlchemy engine instance
     """
-    # Get database URL from args, env, or default
+    # Get database URL from args, dataset scope, env, or default
     if database_url is None:
-        database_url = os.environ.get("DATABASE_URL", "sqlite:///dmr_analysis.db")
+        database_url = current_database_url() or os.environ.get(
+            "DATABASE_URL", "sqlite:///dmr_analysis.db"
+        )
 
     print(f"Connecting to database at: {database_url}")  # Debug print
 
@@ -286,6 +293,208 @@ def insert_metadata(
     session.commit()
 
 
+def get_timepoint_statistics_category(timepoint_id: int) -> str:
+    """Statistic.category under which a timepoint's precomputed summary is stored."""
+    return f"timepoint_{timepoint_id}"
+
+
+# Statistic keys beside the sections of a timepoint's summary
+STATISTICS_VERSION_KEY = "statistics_version"
+STATISTICS_COMPUTED_AT_KEY = "statistics_computed_at"
+
+
+def store_timepoint_statistics(
+    session: Session, timepoint_id: int, stats: Dict, version: int
+):
+    """Replace the precomputed statistics of a timepoint.
+
+    Each top-level section (coverage, edge_coverage, components, ...) is one
+    Statistic row holding JSON; the version and computation time are two more
+    rows of the same category.
+    """
+    category = get_timepoint_statistics_category(timepoint_id)
+    session.query(Statistic).filter(Statistic.category == category).delete()
+
+    session.add_all(
+        Statistic(category=category, key=key, value=json.dumps(value))
+        for key, value in stats.items()
+    )
+    session.add_all(
+        [
+            Statistic(category=category, key=STATISTICS_VERSION_KEY, value=json.dumps(version)),
+            Statistic(
+                category=category,
+                key=STATISTICS_COMPUTED_AT_KEY,
+                value=json.dumps(datetime.utcnow().isoformat()),
+            ),
+        ]
+    )
+    session.commit()
+
+
+def load_timepoint_statistics(session: Session, timepoint_id: int) -> Dict:
+    """Load the precomputed statistics of a timepoint ({} if none stored)."""
+    rows = (
+        session.query(Statistic.key, Statistic.value)
+        .filter(
+            Statistic.category == get_timepoint_statistics_category(timepoint_id),
+            Statistic.key.notin_([STATISTICS_VERSION_KEY, STATISTICS_COMPUTED_AT_KEY]),
+        )
+        .all()
+    )
+    return {row.key: json.loads(row.value) for row in rows}
+
+
+def get_timepoint_statistics_version(session: Session, timepoint_id: int) -> Optional[int]:
+    """Version of a timepoint's stored statistics, or None if none are stored."""
+    value = (
+        session.query(Statistic.value)
+        .filter(
+            Statistic.category == get_timepoint_statistics_category(timepoint_id),
+            Statistic.key == STATISTICS_VERSION_KEY,
+        )
+        .scalar()
+    )
+    return None if value is None else json.loads(value)
+
+
+# Biclique Metadata key -> field of the per-biclique result it is read from
+BICLIQUE_SIGNIFICANCE_FIELDS = {
+    "null_p_value": "p_value",
+    "null_mean_common_genes": "null_mean_common_genes",
+}
+BICLIQUE_STABILITY_FIELDS = {
+    "stability_survival_rate": "survival_rate",
+    "stability_cell_retention": "mean_cell_retention",
+}
+BICLIQUE_SIGNIFICANCE_KEYS = list(BICLIQUE_SIGNIFICANCE_FIELDS)
+BICLIQUE_STABILITY_KEYS = list(BICLIQUE_STABILITY_FIELDS)
+
+
+def _store_biclique_scores(
+    session: Session,
+    timepoint_id: int,
+    bicliques: List[Tuple[Set[int], Set[int]]],
+    result: Dict,
+    fields: Dict[str, str],
+    category_suffix: str,
+    statistic_key: str,
+) -> int:
+    """Store per-biclique scores as Metadata and the rest of ``result`` as a Statistic.
+
+    ``bicliques`` hold graph node ids, as computed on the timepoint's original
+    graph; they are matched to the stored bicliques through ``convert_dmr_id``,
+    as ``_process_split_component`` stores them. Earlier values of the same
+    keys are replaced.
+
+    Returns:
+        Number of bicliques annotated
+    """
+    stored = {
+        (frozenset(b.dmr_ids or []), frozenset(b.gene_ids or [])): b.id
+        for b in session.query(Biclique).filter(Biclique.timepoint_id == timepoint_id)
+    }
+    session.query(Metadata).filter(
+        Metadata.entity_type == "biclique",
+        Metadata.entity_id.in_(list(stored.values())),
+        Metadata.key.in_(list(fields)),
+    ).delete(synchronize_session=False)
+
+    annotated = 0
+    for (dmrs, genes), scores in zip(bicliques, result["bicliques"]):
+        key = (frozenset(convert_dmr_id(d, timepoint_id) for d in dmrs), frozenset(genes))
+        biclique_id = stored.get(key)
+        if biclique_id is None:
+            continue
+        session.add_all(
+            Metadata(
+                entity_type="biclique",
+                entity_id=biclique_id,
+                key=key_name,
+                value=repr(scores[field]),
+            )
+            for key_name, field in fields.items()
+        )
+        annotated += 1
+
+    category = f"{get_timepoint_statistics_category(timepoint_id)}_{category_suffix}"
+    session.query(Statistic).filter(Statistic.category == category).delete()
+    summary = {k: v for k, v in result.items() if k != "bicliques"}
+    summary["computed_at"] = datetime.utcnow().isoformat()
+    session.add(Statistic(category=category, key=statistic_key, value=json.dumps(summary)))
+    session.commit()
+    return annotated
+
+
+def store_biclique_significance(
+    session: Session,
+    timepoint_id: int,
+    bicliques: List[Tuple[Set[int], Set[int]]],
+    significance: Dict,
+) -> int:
+    """Store permutation p-values of a timepoint's bicliques.
+
+    ``significance`` is the result of ``compute_biclique_significance`` for
+    ``bicliques``. Each matching stored biclique gets biclique Metadata rows
+    (see BICLIQUE_SIGNIFICANCE_FIELDS). The size-level results and run
+    settings go in one Statistic row under ``timepoint_<id>_significance``.
+
+    Returns:
+        Number of bicliques annotated
+    """
+    return _store_biclique_scores(
+        session,
+        timepoint_id,
+        bicliques,
+        significance,
+        BICLIQUE_SIGNIFICANCE_FIELDS,
+        "significance",
+        "biclique_significance",
+    )
+
+
+def store_stability_scores(
+    session: Session,
+    timepoint_id: int,
+    bicliques: List[Tuple[Set[int], Set[int]]],
+    stability: Dict,
+) -> int:
+    """Store bootstrap stability scores of a timepoint's DMRs and bicliques.
+
+    ``stability`` is the result of ``compute_stability`` for ``bicliques``.
+    Each matching stored biclique gets biclique Metadata rows (see
+    BICLIQUE_STABILITY_FIELDS). The per-DMR selection frequencies, coverage
+    summary and run settings go in one Statistic row under
+    ``timepoint_<id>_stability``.
+
+    Returns:
+        Number of bicliques annotated
+    """
+    return _store_biclique_scores(
+        session,
+        timepoint_id,
+        bicliques,
+        stability,
+        BICLIQUE_STABILITY_FIELDS,
+        "stability",
+        "stability",
+    )
+
+
+def get_edge_sources(session: Session, timepoint_id: int) -> Dict[Tuple[int, int], Set[str]]:
+    """Source of each of a timepoint's edges, keyed by (graph DMR node, gene id).
+
+    edge_details stores the workbook DMR_No.; the graph numbers that DMR
+    ``create_dmr_id(DMR_No. - 1, timepoint)``.
+    """
+    return {
+        (create_dmr_id(dmr_id - 1, timepoint_id), gene_id): {edge_type}
+        for dmr_id, gene_id, edge_type in session.query(
+            EdgeDetails.dmr_id, EdgeDetails.gene_id, EdgeDetails.edge_type
+        ).filter(EdgeDetails.timepoint_id == timepoint_id, EdgeDetails.edge_type.isnot(None))
+    }
+
+
 def insert_relationship(
     session: Session,
     source_type: str,
@@ -736,7 +945,8 @@ def get_component_data(session: Session, component_id: int) -> Dict:
 def update_edge_details(timepoint_id: int, updates: List[Tuple[int, int, str]]) -> None:
     """
     Update the edge_details table: for each tuple (dmr_id, gene_id, edge_type),
-    set the edge_type field accordingly.
+    record the classification in the edit_type field; the source edge_type
+    is kept.
     """
     engine = get_db_engine()
     with Session(engine) as session:
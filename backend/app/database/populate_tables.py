@@ -9,6 +9,7 @@ import pandas as pd
 from sqlalchemy.orm import Session
 from sqlalchemy import and_, func
 from .models import EdgeDetails
+from .bulk_load import copy_rows, next_ids, upsert_annotations
 from backend.app.database.cleanup import clean_edge_details
 from backend.app.utils.id_mapping import create_dmr_id, convert_dmr_id, reverse_create_dmr_id 
 
@@ -465,6 +466,40 @@ def populate_bicliques(
     return biclique_id
 
 
+def populate_bicliques_bulk(
+    session: Session,
+    timepoint_id: int,
+    component_id: int,
+    bicliques: List[Tuple[Set[int], Set[int]]],
+) -> List[int]:
+    """Populate all bicliques of a component and their component links at once."""
+    biclique_ids = next_ids(session, Biclique.__table__, len(bicliques))
+    copy_rows(
+        session,
+        Biclique.__table__,
+        ["id", "timepoint_id", "component_id", "category", "dmr_ids", "gene_ids"],
+        (
+            (
+                biclique_id,
+                timepoint_id,
+                component_id,
+                classify_biclique(set(dmrs), set(genes)).name.lower(),
+                list(dmrs),
+                list(genes),
+            )
+            for biclique_id, (dmrs, genes) in zip(biclique_ids, bicliques)
+        ),
+    )
+    copy_rows(
+        session,
+        ComponentBiclique.__table__,
+        ["timepoint_id", "component_id", "biclique_id"],
+        ((timepoint_id, component_id, b) for b in biclique_ids),
+    )
+    session.commit()
+    return biclique_ids
+
+
 def populate_gene_annotations(
     session: Session,
     timepoint_id: int,
@@ -479,43 +514,44 @@ def populate_gene_annotations(
 
     gene_nodes = {n for n, d in graph.nodes(data=True) if d["bipartite"] == 1}
 
+    # Gene type from DataFrame
+    gene_type = None
+    if "Gene_Symbol_Nearby" in df.columns:
+        gene_type = "Nearby"
+    elif "ENCODE_Enhancer_Interaction(BingRen_Lab)" in df.columns:
+        gene_type = "Enhancer"
+    elif "ENCODE_Promoter_Interaction(BingRen_Lab)" in df.columns:
+        gene_type = "Promoter"
+
+    participation = defaultdict(list)
+    if not is_original and bicliques:
+        for idx, (_, genes) in enumerate(bicliques):
+            for gene in genes:
+                participation[gene].append(idx)
+
+    rows = []
     for gene in gene_nodes:
-        # Basic properties
         degree = graph.degree(gene)
-        is_isolate = degree == 0
-
-        # Get gene type from DataFrame
-        gene_type = None
-        if "Gene_Symbol_Nearby" in df.columns:
-            gene_type = "Nearby"
-        elif "ENCODE_Enhancer_Interaction(BingRen_Lab)" in df.columns:
-            gene_type = "Enhancer"
-        elif "ENCODE_Promoter_Interaction(BingRen_Lab)" in df.columns:
-            gene_type = "Promoter"
-
         # Determine if split gene in split graph
         node_type = "regular_gene"
-        biclique_ids = None
-        if not is_original and bicliques:
-            participating_bicliques = [
-                idx for idx, (_, genes) in enumerate(bicliques) if gene in genes
-            ]
-            if len(participating_bicliques) > 1:
-                node_type = "split_gene"
-            biclique_ids = ",".join(map(str, participating_bicliques))
-
-        upsert_gene_timepoint_annotation(
-            session=session,
-            timepoint_id=timepoint_id,
-            gene_id=gene,
-            component_id=component_id,
-            degree=degree,
-            node_type=node_type,
-            gene_type=gene_type,
-            is_isolate=is_isolate,
-            biclique_ids=biclique_ids,
+        if len(participation.get(gene, ())) > 1:
+            node_type = "split_gene"
+        rows.append(
+            {
+                "timepoint_id": timepoint_id,
+                "gene_id": gene,
+                "component_id": component_id,
+                "degree": degree,
+                "node_type": node_type,
+                "gene_type": gene_type,
+                "is_isolate": degree == 0,
+                "biclique_ids": participation.get(gene) or None,
+            }
         )
 
+    upsert_annotations(session, GeneTimepointAnnotation.__table__, "gene_id", rows)
+    session.commit()
+
 
 def populate_dmr_annotations(
     session: Session,
@@ -529,6 +565,13 @@ def populate_dmr_annotations(
 ) -> None:
     """Populate DMR annotations for a component."""
 
+    participation = defaultdict(list)
+    if not is_original and bicliques:
+        for idx, (dmrs, _) in enumerate(bicliques):
+            for dmr in dmrs:
+                participation[dmr].append(idx)
+
+    rows = []
     for n, d in graph.nodes(data=True):
         if d["bipartite"] == 0:
             # For split and original graphs add 1 to node_id to get the eqiv table_id
@@ -536,29 +579,21 @@ def populate_dmr_annotations(
             converted_id = convert_dmr_id(n, timepoint_id, is_original=is_original)
             degree = graph.degree(n)
             is_isolate = degree == 0
-
-            # Get biclique participation if this is split graph
-            biclique_ids = None
-            if not is_original and bicliques:
-                participating_bicliques = [
-                    # idx for idx, (dmrs, _) in enumerate(bicliques) if n in dmrs
-                    idx
-                    for idx, (dmrs, _) in enumerate(bicliques)
-                    if converted_id in dmrs
-                ]
-                biclique_ids = ",".join(map(str, participating_bicliques))
-
-            upsert_dmr_timepoint_annotation(
-                session=session,
-                timepoint_id=timepoint_id,
-                dmr_id=converted_id,
-                component_id=component_id,
-                degree=degree,
-                node_type="isolated" if is_isolate else "regular",
-                is_isolate=is_isolate,
-                biclique_ids=biclique_ids,
+            rows.append(
+                {
+                    "timepoint_id": timepoint_id,
+                    "dmr_id": converted_id,
+                    "component_id": component_id,
+                    "degree": degree,
+                    "node_type": "isolated" if is_isolate else "regular",
+                    "is_isolate": is_isolate,
+                    "biclique_ids": participation.get(converted_id) or None,
+                }
             )
 
+    upsert_annotations(session, DMRTimepointAnnotation.__table__, "dmr_id", rows)
+    session.commit()
+
 
 def populate_statistics(session: Session, statistics: dict):
     """Populate statistics table."""
@@ -726,10 +761,33 @@ def populate_edge_details(
                                 aggregated_edges[key] = edge
     else:
         print("ERROR : Can't found ENCODE_Promoter_Interaction column")
-    for edge in aggregated_edges.values():
-        session.add(edge)
-
+    columns = [
+        "dmr_id",
+        "gene_id",
+        "timepoint_id",
+        "edge_type",
+        "distance_from_tss",
+        "description",
+    ]
     try:
+        copy_rows(
+            session,
+            EdgeDetails.__table__,
+            columns,
+            (
+                (
+                    int(edge.dmr_id),
+                    int(edge.gene_id),
+                    edge.timepoint_id,
+                    edge.edge_type,
+                    None
+                    if edge.distance_from_tss is None or pd.isna(edge.distance_from_tss)
+                    else int(edge.distance_from_tss),
+                    None if pd.isna(edge.description) else edge.description,
+                )
+                for edge in aggregated_edges.values()
+            ),
+        )
         session.commit()
         print("Edge details populated successfully")
     except Exception as e:
@@ -25,6 +25,7 @@ from backend.app.biclique_analysis.triconnected import (
 )
 from backend.app.database.biclique_processor import process_bicliques_db
 from .operations import insert_triconnected_component
+from .decomposition import build_timepoint_decomposition, store_decomposition_index
 from backend.app.database.operations import (
     upsert_dmr_timepoint_annotation,
     upsert_gene_timepoint_annotation,
@@ -197,6 +198,7 @@ def process_bicliques_for_timepoint(
 
     # Process connected components in original graph
     print("\nProcessing connected components in original graph...")
+    stored_components = []
     for comp_idx, component in enumerate(nx.connected_components(original_graph)):
         comp_subgraph = original_graph.subgraph(component)
 
@@ -223,6 +225,7 @@ def process_bicliques_for_timepoint(
         # Tag nodes with component ID
         for node in component:
             original_graph.nodes[node]["component_id"] = comp_id
+        stored_components.append((component, comp_id))
 
         # Process triconnected components
         process_triconnected_components(
@@ -249,6 +252,13 @@ def process_bicliques_for_timepoint(
     else:
         print("Skipping biclique processing - no bicliques file available")
 
+    # Persist the component -> block -> SPQR -> biclique hierarchy
+    index = build_timepoint_decomposition(
+        session, timepoint_id, original_graph, stored_components
+    )
+    stored = store_decomposition_index(session, timepoint_id, index)
+    print(f"Stored decomposition hierarchy: {stored} nodes")
+
     session.commit()
 
 
@@ -0,0 +1,273 @@
+"""Opt-in per-request SQL profiling.
+
+When enabled (``SQL_PROFILE=true``), SQLAlchemy cursor events are timed for
+every statement run while a Flask request is active. Each request gets a
+profile with the statement count, total SQL time, its slowest statements and
+statement fingerprints (the SQL with literals and IN-lists collapsed) that
+repeat, which is how an N+1 loop shows up. Statements slower than
+``SQL_PROFILE_EXPLAIN_MS`` also get their query plan captured. A summary goes
+into ``X-SQL-*`` response headers; recent profiles are kept in memory and
+served by ``routes/debug_routes.py`` under ``/debug/requests``.
+"""
+
+import re
+import threading
+import time
+import uuid
+from collections import Counter, OrderedDict
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+from flask import g, has_request_context, request
+from sqlalchemy import event
+from sqlalchemy.engine import Engine
+
+import logging
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_HISTORY = 200
+DEFAULT_REPEAT_THRESHOLD = 5
+SLOWEST_KEPT = 5
+
+_WHITESPACE = re.compile(r"\s+")
+_STRING_LITERAL = re.compile(r"'(?:[^']|'')*'")
+_NUMBER_LITERAL = re.compile(r"\b\d+(?:\.\d+)?\b")
+_PLACEHOLDER_LIST = re.compile(r"\(\s*(?:\?|%\(\w+\)s|%s|:\w+)(?:\s*,\s*(?:\?|%\(\w+\)s|%s|:\w+))*\s*\)")
+
+
+def fingerprint(statement: str) -> str:
+    """SQL text with literals and placeholder lists collapsed, for grouping."""
+    sql = _WHITESPACE.sub(" ", statement).strip()
+    sql = _STRING_LITERAL.sub("?", sql)
+    sql = _NUMBER_LITERAL.sub("?", sql)
+    return _PLACEHOLDER_LIST.sub("(?+)", sql)
+
+
+@dataclass
+class StatementRecord:
+    statement: str
+    duration_ms: float
+    plan: Optional[List[str]] = None
+
+    def to_dict(self) -> Dict:
+        record = {"statement": self.statement, "duration_ms": round(self.duration_ms, 3)}
+        if self.plan is not None:
+            record["plan"] = self.plan
+        return record
+
+
+@dataclass
+class RequestProfile:
+    request_id: str
+    method: str
+    path: str
+    started: float = field(default_factory=time.time)
+    statement_count: int = 0
+    sql_time_ms: float = 0.0
+    slowest: List[StatementRecord] = field(default_factory=list)
+    fingerprints: Counter = field(default_factory=Counter)
+    plans: List[StatementRecord] = field(default_factory=list)
+    status_code: Optional[int] = None
+    duration_ms: Optional[float] = None
+
+    def record(self, statement: str, duration_ms: float, plan=None) -> None:
+        self.statement_count += 1
+        self.sql_time_ms += duration_ms
+        self.fingerprints[fingerprint(statement)] += 1
+        entry = StatementRecord(statement, duration_ms, plan)
+        if plan is not None:
+            self.plans.append(entry)
+        self.slowest.append(entry)
+        self.slowest.sort(key=lambda r: r.duration_ms, reverse=True)
+        del self.slowest[SLOWEST_KEPT:]
+
+    def repeated(self, threshold: int) -> List[Dict]:
+        """Fingerprints run at least ``threshold`` times, most frequent first."""
+        return [
+            {"fingerprint": fp, "count": count}
+            for fp, count in self.fingerprints.most_common()
+            if count >= threshold
+        ]
+
+    def to_dict(self, threshold: int) -> Dict:
+        return {
+            "request_id": self.request_id,
+            "method": self.method,
+            "path": self.path,
+            "status_code": self.status_code,
+            "duration_ms": round(self.duration_ms or 0.0, 3),
+            "statement_count": self.statement_count,
+            "sql_time_ms": round(self.sql_time_ms, 3),
+            "distinct_statements": len(self.fingerprints),
+            "repeated_statements": self.repeated(threshold),
+            "slowest": [r.to_dict() for r in self.slowest],
+            "plans": [r.to_dict() for r in self.plans],
+        }
+
+
+class SQLProfiler:
+    """Collects RequestProfiles for a Flask app and keeps the most recent ones."""
+
+    def __init__(
+        self,
+        history: int = DEFAULT_HISTORY,
+        repeat_threshold: int = DEFAULT_REPEAT_THRESHOLD,
+        explain_ms: Optional[float] = None,
+    ):
+        self.history = history
+        self.repeat_threshold = repeat_threshold
+        self.explain_ms = explain_ms
+        self.profiles: "OrderedDict[str, RequestProfile]" = OrderedDict()
+        self._lock = threading.Lock()
+        self._start_key = f"sql_profile_start_{id(self)}"
+
+    # Flask hooks
+
+    def start_request(self) -> None:
+        g.sql_profiler = self
+        g.sql_profile = RequestProfile(
+            request_id=uuid.uuid4().hex[:12], method=request.method, path=request.path
+        )
+
+    def finish_request(self, response):
+        if g.get("sql_profiler") is not self:
+            return response
+        g.pop("sql_profiler")
+        profile = g.pop("sql_profile")
+        profile.status_code = response.status_code
+        profile.duration_ms = (time.time() - profile.started) * 1000
+
+        repeated = profile.repeated(self.repeat_threshold)
+        response.headers["X-SQL-Profile-Id"] = profile.request_id
+        response.headers["X-SQL-Count"] = str(profile.statement_count)
+        response.headers["X-SQL-Time-ms"] = f"{profile.sql_time_ms:.3f}"
+        if repeated:
+            response.headers["X-SQL-Repeated"] = str(repeated[0]["count"])
+            logger.warning(
+                f"Possible N+1 in {profile.method} {profile.path}: "
+                f"{repeated[0]['count']}x {repeated[0]['fingerprint'][:200]}"
+            )
+
+        with self._lock:
+            self.profiles[profile.request_id] = profile
+            while len(self.profiles) > self.history:
+                self.profiles.popitem(last=False)
+        return response
+
+    # SQLAlchemy hooks
+
+    def _active(self) -> bool:
+        return has_request_context() and g.get("sql_profiler") is self
+
+    def before_execute(self, conn, cursor, statement, parameters, context, executemany):
+        if self._active():
+            conn.info.setdefault(self._start_key, []).append(time.perf_counter())
+
+    def after_execute(self, conn, cursor, statement, parameters, context, executemany):
+        starts = conn.info.get(self._start_key)
+        if not starts:
+            return
+        duration_ms = (time.perf_counter() - starts.pop()) * 1000
+        profile = g.get("sql_profile") if self._active() else None
+        if profile is None:
+            return
+
+        plan = None
+        if (
+            self.explain_ms is not None
+            and duration_ms >= self.explain_ms
+            and not executemany
+        ):
+            plan = self.explain(conn, statement, parameters)
+        profile.record(statement, duration_ms, plan)
+
+    def on_error(self, exception_context) -> None:
+        """Drop the start time of a statement that raised instead of finishing."""
+        conn = exception_context.connection
+        starts = conn.info.get(self._start_key) if conn is not None else None
+        if starts:
+            starts.pop()
+
+    @staticmethod
+    def explain(conn, statement: str, parameters) -> Optional[List[str]]:
+        """Query plan of a SELECT, run on the raw DBAPI connection (no events)."""
+        if not statement.lstrip().upper().startswith(("SELECT", "WITH")):
+            return None
+        prefix = {
+            "sqlite": "EXPLAIN QUERY PLAN ",
+            "postgresql": "EXPLAIN ",
+        }.get(conn.dialect.name)
+        if prefix is None:
+            return None
+        try:
+            cursor = conn.connection.dbapi_connection.cursor()
+            try:
+                cursor.execute(prefix + statement, parameters)
+                return [" | ".join(str(col) for col in row) for row in cursor.fetchall()]
+            finally:
+                cursor.close()
+        except Exception as e:
+            logger.debug(f"EXPLAIN failed: {e}")
+            return None
+
+    # Lookup
+
+    def get(self, request_id: str) -> Optional[Dict]:
+        with self._lock:
+            profile = self.profiles.get(request_id)
+        return profile.to_dict(self.repeat_threshold) if profile else None
+
+    def recent(self, limit: int = 50) -> List[Dict]:
+        with self._lock:
+            profiles = list(self.profiles.values())[-limit:]
+        return [
+            {
+                "request_id": p.request_id,
+                "method": p.method,
+                "path": p.path,
+                "status_code": p.status_code,
+                "statement_count": p.statement_count,
+                "sql_time_ms": round(p.sql_time_ms, 3),
+                "max_repeats": max(p.fingerprints.values(), default=0),
+            }
+            for p in reversed(profiles)
+        ]
+
+
+def init_sql_profiler(app) -> Optional[SQLProfiler]:
+    """
+    Attach the profiler to an app when SQL_PROFILE is set in its config.
+
+    Config keys: SQL_PROFILE, SQL_PROFILE_HISTORY, SQL_PROFILE_REPEAT_THRESHOLD,
+    SQL_PROFILE_EXPLAIN_MS (unset = no query plans) and SQL_PROFILE_TOKEN, the
+    X-Admin-Token the /debug/requests routes require (unset = routes closed).
+    """
+    if not app.config.get("SQL_PROFILE"):
+        return None
+    if not app.config.get("SQL_PROFILE_TOKEN"):
+        logger.warning(
+            "SQL_PROFILE is set without SQL_PROFILE_TOKEN; /debug/requests stays closed"
+        )
+
+    explain_ms = app.config.get("SQL_PROFILE_EXPLAIN_MS")
+    profiler = SQLProfiler(
+        history=int(app.config.get("SQL_PROFILE_HISTORY") or DEFAULT_HISTORY),
+        repeat_threshold=int(
+            app.config.get("SQL_PROFILE_REPEAT_THRESHOLD") or DEFAULT_REPEAT_THRESHOLD
+        ),
+        explain_ms=float(explain_ms) if explain_ms not in (None, "") else None,
+    )
+    app.before_request(profiler.start_request)
+    app.after_request(profiler.finish_request)
+    event.listen(Engine, "before_cursor_execute", profiler.before_execute)
+    event.listen(Engine, "after_cursor_execute", profiler.after_execute)
+    event.listen(Engine, "handle_error", profiler.on_error)
+    app.extensions["sql_profiler"] = profiler
+
+    from ..routes.debug_routes import debug_bp
+
+    if debug_bp.name not in app.blueprints:
+        app.register_blueprint(debug_bp)
+    logger.info("SQL profiling enabled")
+    return profiler
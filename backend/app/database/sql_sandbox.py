@@ -0,0 +1,391 @@
+"""
+Cost-guarded execution of untrusted (LLM-generated or ad hoc) SQL.
+
+Every query goes through the same steps, and each step can reject it with a
+``SandboxRejection`` that says why, so an agent can rewrite the query and try
+again:
+
+1. Static checks: one statement, and it must be a SELECT or WITH query.
+2. A per-user concurrency slot.
+3. A pre-flight EXPLAIN. The plan's estimated cost and any cartesian products
+   or full scans of large tables are checked against the limits.
+4. Execution on a read-only connection with a time budget. DuckDB is
+   interrupted from a timer thread; SQLite is stopped by a progress handler.
+5. Rows are fetched in batches and the result is cut off once the row or
+   byte limit is reached.
+
+Two backends are supported: the DuckDB analytics snapshot (``DuckDBBackend``),
+where LLM SQL normally runs, and a read-only SQLite file (``SQLiteBackend``).
+"""
+
+import json
+import os
+import re
+import sqlite3
+import threading
+import time
+from dataclasses import asdict, dataclass, field
+from typing import Any, Dict, List, Optional
+
+FETCH_BATCH = 500
+
+_COMMENTS = re.compile(r"--[^\n]*|/\*.*?\*/", re.S)
+_STRINGS = re.compile(r"'(?:[^']|'')*'|\"(?:[^\"]|\"\")*\"")
+_READ_ONLY_START = re.compile(r"^\s*(SELECT|WITH)\b", re.I)
+# "FROM genes g", "JOIN dmrs AS d", ", timepoints t": the query plan names aliases
+_TABLE_ALIAS = re.compile(r"(?:\bFROM|\bJOIN|,)\s+(\w+)(?:\s+(?:AS\s+)?(\w+))?", re.I)
+_FORBIDDEN = re.compile(
+    r"\b(INSERT|UPDATE|DELETE|MERGE|CREATE|DROP|ALTER|ATTACH|DETACH|PRAGMA|COPY|"
+    r"EXPORT|IMPORT|INSTALL|LOAD|VACUUM|REINDEX|SET|CALL)\b",
+    re.I,
+)
+
+
+@dataclass
+class SandboxLimits:
+    time_budget_s: float = 5.0
+    max_rows: int = 10000
+    max_bytes: int = 4 * 1024 * 1024
+    max_estimated_cost: float = 5e7  # sum of estimated rows over plan operators
+    max_cross_product_rows: float = 1e6
+    max_full_scan_rows: int = 200000  # most rows a plan may read from one table scan
+    max_concurrent_per_user: int = 2
+
+
+class SandboxRejection(Exception):
+    """A query was refused or stopped; ``reason`` is a stable machine code."""
+
+    def __init__(self, reason: str, message: str, details: Optional[Dict] = None):
+        super().__init__(message)
+        self.reason = reason
+        self.message = message
+        self.details = details or {}
+
+    def to_dict(self) -> Dict[str, Any]:
+        return {"reason": self.reason, "message": self.message, "details": self.details}
+
+
+@dataclass
+class PlanCheck:
+    estimated_cost: float = 0.0
+    cross_products: List[Dict] = field(default_factory=list)
+    full_scans: List[Dict] = field(default_factory=list)
+    plan: List[str] = field(default_factory=list)
+
+
+def check_statement(sql: str) -> str:
+    """Validate that ``sql`` is a single read-only query; returns it stripped."""
+    stripped = _COMMENTS.sub(" ", sql).strip().rstrip(";").strip()
+    if not stripped:
+        raise SandboxRejection("empty", "No SQL statement given")
+    bare = _STRINGS.sub("''", stripped)
+    if ";" in bare:
+        raise SandboxRejection(
+            "multiple_statements", "Only a single statement may be run at a time"
+        )
+    if not _READ_ONLY_START.match(bare):
+        raise SandboxRejection("not_read_only", "Only SELECT / WITH queries are allowed")
+    forbidden = _FORBIDDEN.search(bare)
+    if forbidden:
+        raise SandboxRejection(
+            "not_read_only",
+            f"Keyword {forbidden.group(1).upper()} is not allowed in sandboxed queries",
+        )
+    return stripped
+
+
+class DuckDBBackend:
+    """The read-only DuckDB analytics snapshot."""
+
+    name = "duckdb"
+
+    def __init__(self, store=None):
+        # None follows get_analytics_store(), i.e. the request's dataset
+        self.store = store
+
+    def connect(self):
+        if self.store is None:
+            from .analytics import get_analytics_store
+
+            return get_analytics_store().connection()
+        return self.store.connection()
+
+    def explain(self, conn, sql: str, params) -> PlanCheck:
+        rows = conn.execute("EXPLAIN (FORMAT JSON) " + sql, params or []).fetchall()
+        check = PlanCheck()
+        for _, plan_json in rows:
+            for node in json.loads(plan_json):
+                self._walk(node, check)
+        return check
+
+    def _walk(self, node: Dict, check: PlanCheck) -> float:
+        child_rows = [self._walk(child, check) for child in node.get("children", [])]
+        info = node.get("extra_info") or {}
+        try:
+            rows = float(info.get("Estimated Cardinality", 0) or 0)
+        except (TypeError, ValueError):
+            rows = 0.0
+        name = node.get("name", "")
+        check.plan.append(f"{name} ~{int(rows)} rows")
+        if name == "SEQ_SCAN":
+            # Estimated rows left after any pushed-down filters
+            table = str(info.get("Table", "")).rsplit(".", 1)[-1]
+            check.full_scans.append({"table": table, "rows": int(rows)})
+        if name in ("CROSS_PRODUCT", "NESTED_LOOP_JOIN", "BLOCKWISE_NL_JOIN"):
+            pairs = 1.0
+            for r in child_rows:
+                pairs *= max(r, 1.0)
+            check.cross_products.append({"operator": name, "pairs": pairs})
+            rows = max(rows, pairs)
+        check.estimated_cost += rows
+        return rows
+
+    def arm(self, conn, deadline: float):
+        timer = threading.Timer(max(deadline - time.monotonic(), 0), conn.interrupt)
+        timer.daemon = True
+        timer.start()
+        return timer
+
+    def disarm(self, conn, timer) -> None:
+        timer.cancel()
+
+    @staticmethod
+    def is_interrupt(error: Exception) -> bool:
+        return "interrupt" in str(error).lower()
+
+
+class SQLiteBackend:
+    """A SQLite database file opened read-only."""
+
+    name = "sqlite"
+
+    def __init__(self, path: str):
+        self.path = path
+        self._table_rows: Dict[str, int] = {}
+
+    def connect(self):
+        conn = sqlite3.connect(f"file:{self.path}?mode=ro", uri=True, check_same_thread=False)
+        conn.execute("PRAGMA query_only = 1")
+        return conn
+
+    def _rows(self, conn, table: str) -> int:
+        if table not in self._table_rows:
+            try:
+                count = conn.execute(f'SELECT count(*) FROM "{table}"').fetchone()[0]
+            except sqlite3.Error:
+                count = 0
+            self._table_rows[table] = count
+        return self._table_rows[table]
+
+    def explain(self, conn, sql: str, params) -> PlanCheck:
+        rows = conn.execute("EXPLAIN QUERY PLAN " + sql, params or []).fetchall()
+        aliases = {
+            alias: table for table, alias in _TABLE_ALIAS.findall(sql) if alias
+        }
+        check = PlanCheck()
+        # Joined tables appear as successive loops, each nested in the previous
+        depth_rows: List[float] = []
+        for _, _, _, detail in rows:
+            check.plan.append(detail)
+            match = re.match(r"(SCAN|SEARCH) (?:TABLE )?(\w+)", detail)
+            if not match:
+                continue
+            table = aliases.get(match.group(2), match.group(2))
+            table_rows = self._rows(conn, table)
+            full_scan = match.group(1) == "SCAN" and "COVERING INDEX" not in detail
+            # A SEARCH narrows by an index; count it as a handful of rows per loop
+            loop_rows = table_rows if full_scan else min(table_rows, 10)
+            outer = depth_rows[-1] if depth_rows else 1.0
+            if full_scan:
+                check.full_scans.append({"table": table, "rows": table_rows})
+                if depth_rows and outer > 1:
+                    check.cross_products.append(
+                        {"operator": "nested SCAN " + table, "pairs": outer * table_rows}
+                    )
+            depth_rows.append(outer * max(loop_rows, 1))
+            check.estimated_cost += outer * max(loop_rows, 1)
+        return check
+
+    def arm(self, conn, deadline: float):
+        conn.set_progress_handler(lambda: int(time.monotonic() > deadline), 10000)
+        return None
+
+    def disarm(self, conn, timer) -> None:
+        conn.set_progress_handler(None, 0)
+
+    @staticmethod
+    def is_interrupt(error: Exception) -> bool:
+        return isinstance(error, sqlite3.OperationalError) and "interrupt" in str(error)
+
+
+class SQLSandbox:
+    """Runs untrusted queries on one backend within ``SandboxLimits``."""
+
+    def __init__(self, backend, limits: Optional[SandboxLimits] = None):
+        self.backend = backend
+        self.limits = limits or SandboxLimits()
+        # Running queries per user; a user with none running has no entry
+        self._running: Dict[str, int] = {}
+        self._running_lock = threading.Lock()
+
+    def _acquire(self, user: str) -> bool:
+        with self._running_lock:
+            running = self._running.get(user, 0)
+            if running >= self.limits.max_concurrent_per_user:
+                return False
+            self._running[user] = running + 1
+            return True
+
+    def _release(self, user: str) -> None:
+        with self._running_lock:
+            running = self._running.pop(user) - 1
+            if running:
+                self._running[user] = running
+
+    def _check_plan(self, check: PlanCheck) -> None:
+        limits = self.limits
+        for product in check.cross_products:
+            if product["pairs"] > limits.max_cross_product_rows:
+                raise SandboxRejection(
+                    "cartesian_product",
+                    f"Plan contains a cartesian/nested-loop join over ~{int(product['pairs'])} "
+                    "row pairs; add a join condition on indexed or key columns",
+                    {"operator": product["operator"], "pairs": product["pairs"]},
+                )
+        for scan in check.full_scans:
+            if scan["rows"] > limits.max_full_scan_rows:
+                raise SandboxRejection(
+                    "full_scan",
+                    f"Plan scans all {scan['rows']} rows of {scan['table']}; "
+                    "filter on an indexed column",
+                    scan,
+                )
+        if check.estimated_cost > limits.max_estimated_cost:
+            raise SandboxRejection(
+                "too_expensive",
+                f"Estimated cost {int(check.estimated_cost)} exceeds "
+                f"{int(limits.max_estimated_cost)}; narrow the query or aggregate earlier",
+                {"estimated_cost": check.estimated_cost, "plan": check.plan},
+            )
+
+    def execute(
+        self,
+        sql: str,
+        params: Optional[list] = None,
+        user: str = "anonymous",
+        row_limit: Optional[int] = None,
+    ) -> Dict:
+        """
+        Run ``sql`` within the limits.
+
+        Args:
+            sql: A single SELECT / WITH query
+            params: Positional parameters
+            user: Key for the per-user concurrency limit
+            row_limit: Lower row limit for this query (capped at ``max_rows``)
+
+        Returns:
+            Dict with columns, rows, truncated, truncation_reason ("rows",
+            "bytes" or None), bytes, elapsed_ms and estimated_cost
+
+        Raises:
+            SandboxRejection: the query was refused or stopped
+        """
+        statement = check_statement(sql)
+        if not self._acquire(user):
+            raise SandboxRejection(
+                "concurrency_limit",
+                f"User already has {self.limits.max_concurrent_per_user} queries running",
+            )
+        try:
+            conn = self.backend.connect()
+            try:
+                try:
+                    check = self.backend.explain(conn, statement, params)
+                except Exception as e:
+                    raise SandboxRejection("invalid_sql", str(e)) from e
+                self._check_plan(check)
+                max_rows = min(row_limit or self.limits.max_rows, self.limits.max_rows)
+                return self._run(conn, statement, params, check, max_rows)
+            finally:
+                conn.close()
+        finally:
+            self._release(user)
+
+    def _run(self, conn, statement: str, params, check: PlanCheck, max_rows: int) -> Dict:
+        limits = self.limits
+        started = time.monotonic()
+        deadline = started + limits.time_budget_s
+        timer = self.backend.arm(conn, deadline)
+        rows: List[list] = []
+        size = 0
+        truncation = None
+        try:
+            cursor = conn.execute(statement, params or [])
+            columns = [d[0] for d in cursor.description] if cursor.description else []
+            while columns and truncation is None:
+                batch = cursor.fetchmany(FETCH_BATCH)
+                if not batch:
+                    break
+                for row in batch:
+                    row = list(row)
+                    row_size = len(json.dumps(row, default=str))
+                    if len(rows) >= max_rows:
+                        truncation = "rows"
+                        break
+                    if size + row_size > limits.max_bytes:
+                        truncation = "bytes"
+                        break
+                    rows.append(row)
+                    size += row_size
+        except SandboxRejection:
+            raise
+        except Exception as e:
+            if self.backend.is_interrupt(e) or time.monotonic() >= deadline:
+                raise SandboxRejection(
+                    "timeout",
+                    f"Query exceeded the {limits.time_budget_s}s time budget",
+                    {"time_budget_s": limits.time_budget_s},
+                ) from e
+            raise SandboxRejection("execution_error", str(e)) from e
+        finally:
+            self.backend.disarm(conn, timer)
+
+        return {
+            "columns": columns,
+            "rows": rows,
+            "truncated": truncation is not None,
+            "truncation_reason": truncation,
+            "bytes": size,
+            "elapsed_ms": round((time.monotonic() - started) * 1000, 3),
+            "estimated_cost": check.estimated_cost,
+        }
+
+    def describe_limits(self) -> Dict[str, Any]:
+        return asdict(self.limits)
+
+
+# HTTP status for each rejection reason; anything else is a 400
+REJECTION_STATUS = {"concurrency_limit": 429, "timeout": 408}
+
+_sandbox: Optional[SQLSandbox] = None
+_sandbox_lock = threading.Lock()
+
+
+def limits_from_env() -> SandboxLimits:
+    """Limits with overrides from SQL_SANDBOX_<FIELD> environment variables."""
+    limits = SandboxLimits()
+    for name, value in asdict(limits).items():
+        override = os.getenv(f"SQL_SANDBOX_{name.upper()}")
+        if override:
+            setattr(limits, name, type(value)(float(override)))
+    return limits
+
+
+def get_sandbox() -> SQLSandbox:
+    """Process-wide sandbox over the analytics store."""
+    global _sandbox
+    with _sandbox_lock:
+        if _sandbox is None:
+            _sandbox = SQLSandbox(DuckDBBackend(), limits_from_env())
+        return _sandbox
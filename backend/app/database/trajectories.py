@@ -0,0 +1,257 @@
+"""
+Cross-timepoint gene trajectories.
+
+``build_gene_trajectories`` pivots gene_timepoint_annotations, with the size
+of each gene's component and the dominating DMRs adjacent to it, into one
+gene_trajectories row per gene holding an array per metric over all
+timepoints. It runs at the end of ingest, so ``get_gene_trajectory`` is a
+single primary key read and ``trajectory_frame`` exports the whole
+gene x timepoint matrix from one table scan.
+
+Usage:
+    python -m backend.app.database.trajectories export OUT.parquet|OUT.csv
+"""
+
+import sys
+from pathlib import Path
+from typing import Dict, Iterator, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+from sqlalchemy.orm import Session
+
+from .bulk_load import copy_rows
+from .models import (
+    Component,
+    DominatingSet,
+    EdgeDetails,
+    Gene,
+    GeneTimepointAnnotation,
+    GeneTrajectory,
+    Timepoint,
+)
+
+# Bits of the per-timepoint status
+PRESENT = 1  # annotated in the timepoint
+SPLIT = 2  # split gene: in more than one biclique
+HUB = 4  # degree at or above the HUB_QUANTILE of the timepoint's gene degrees
+ISOLATE = 8
+STATUS_FLAGS = {"present": PRESENT, "split": SPLIT, "hub": HUB, "isolate": ISOLATE}
+HUB_QUANTILE = 0.95
+
+METRICS = ("status", "degree", "component_size", "biclique_count")
+COLUMNS = (
+    ("gene_id", "timepoint_ids")
+    + METRICS
+    + ("dominated_by", "dominated_by_indptr", "timepoint_count")
+)
+
+
+def _list_length(value) -> int:
+    """Entries of an id list, read either as a list or as a "1,2" string (NaN if NULL)."""
+    if isinstance(value, float):
+        return 0
+    if isinstance(value, str):
+        return sum(1 for v in value.split(",") if v.strip())
+    return len(value or ())
+
+
+def compute_gene_trajectories(session: Session) -> Dict[str, np.ndarray]:
+    """
+    Gene x timepoint matrices of every annotated gene.
+
+    Returns:
+        ``gene_ids`` (G), ``timepoint_ids`` (T), a (G, T) matrix per entry of
+        METRICS, ``dominated_count`` (G, T) and ``dominated_by``, the
+        dominating DMR ids ordered by gene, timepoint and id
+    """
+    timepoint_ids = np.array(
+        [t for (t,) in session.query(Timepoint.id).order_by(Timepoint.id)], dtype=np.int64
+    )
+    annotations = pd.DataFrame(
+        session.query(
+            GeneTimepointAnnotation.gene_id,
+            GeneTimepointAnnotation.timepoint_id,
+            GeneTimepointAnnotation.degree,
+            GeneTimepointAnnotation.node_type,
+            GeneTimepointAnnotation.is_isolate,
+            GeneTimepointAnnotation.biclique_ids,
+            Component.size,
+        )
+        .outerjoin(Component, Component.id == GeneTimepointAnnotation.component_id)
+        .all(),
+        columns=[
+            "gene_id", "timepoint_id", "degree", "node_type", "is_isolate", "biclique_ids", "size"
+        ],
+    )
+    gene_ids, g = np.unique(annotations["gene_id"].to_numpy(np.int64), return_inverse=True)
+    t = np.searchsorted(timepoint_ids, annotations["timepoint_id"].to_numpy(np.int64))
+    shape = (gene_ids.size, timepoint_ids.size)
+
+    degree = annotations["degree"].fillna(0).to_numpy(np.int64)
+    status = (
+        PRESENT
+        | np.where(annotations["node_type"].eq("split_gene").to_numpy(), SPLIT, 0)
+        | np.where(annotations["is_isolate"].fillna(False).to_numpy(bool), ISOLATE, 0)
+    )
+    threshold = np.full(timepoint_ids.size, np.inf)
+    for i in np.unique(t):
+        threshold[i] = np.quantile(degree[t == i], HUB_QUANTILE)
+    status |= np.where((degree > 0) & (degree >= threshold[t]), HUB, 0)
+
+    values = {
+        "status": status,
+        "degree": degree,
+        "component_size": annotations["size"].fillna(0).to_numpy(np.int64),
+        "biclique_count": np.fromiter(
+            (_list_length(v) for v in annotations["biclique_ids"]), np.int64, len(annotations)
+        ),
+    }
+    result = {"gene_ids": gene_ids, "timepoint_ids": timepoint_ids}
+    for metric in METRICS:
+        matrix = np.zeros(shape, dtype=np.int64)
+        matrix[g, t] = values[metric]
+        result[metric] = matrix
+
+    # Dominating DMRs sharing an edge with each gene
+    dominated = np.array(
+        session.query(EdgeDetails.gene_id, EdgeDetails.timepoint_id, DominatingSet.dmr_id)
+        .join(
+            DominatingSet,
+            (DominatingSet.timepoint_id == EdgeDetails.timepoint_id)
+            & (DominatingSet.dmr_id == EdgeDetails.dmr_id),
+        )
+        .all(),
+        dtype=np.int64,
+    ).reshape(-1, 3)
+    dg = np.searchsorted(gene_ids, dominated[:, 0])
+    dt = np.searchsorted(timepoint_ids, dominated[:, 1])
+    known = (dg < gene_ids.size) & (dt < timepoint_ids.size)
+    known[known] &= (gene_ids[dg[known]] == dominated[known, 0]) & (
+        timepoint_ids[dt[known]] == dominated[known, 1]
+    )
+    dominated, dg, dt = dominated[known], dg[known], dt[known]
+    order = np.lexsort((dominated[:, 2], dt, dg))
+    result["dominated_by"] = dominated[order, 2]
+    result["dominated_count"] = np.bincount(
+        dg * timepoint_ids.size + dt, minlength=gene_ids.size * timepoint_ids.size
+    ).reshape(shape)
+    return result
+
+
+def trajectory_rows(trajectories: Dict[str, np.ndarray]) -> Iterator[Tuple]:
+    """gene_trajectories rows in COLUMNS order."""
+    counts = trajectories["dominated_count"]
+    indptr = np.zeros((counts.shape[0], counts.shape[1] + 1), dtype=np.int64)
+    np.cumsum(counts, axis=1, out=indptr[:, 1:])
+    ends = np.cumsum(indptr[:, -1])
+    starts = ends - indptr[:, -1]
+    present = np.count_nonzero(trajectories["status"] & PRESENT, axis=1)
+    dominated_by = trajectories["dominated_by"].tolist()
+    timepoint_ids = trajectories["timepoint_ids"].tolist()
+    metrics = [trajectories[metric].tolist() for metric in METRICS]
+    for i, gene_id in enumerate(trajectories["gene_ids"].tolist()):
+        yield (
+            (gene_id, timepoint_ids)
+            + tuple(matrix[i] for matrix in metrics)
+            + (dominated_by[starts[i] : ends[i]], indptr[i].tolist(), int(present[i]))
+        )
+
+
+def build_gene_trajectories(session: Session) -> int:
+    """Rebuild gene_trajectories from the annotations; returns the number of genes."""
+    trajectories = compute_gene_trajectories(session)
+    session.query(GeneTrajectory).delete()
+    written = copy_rows(session, GeneTrajectory.__table__, COLUMNS, trajectory_rows(trajectories))
+    session.commit()
+    return written
+
+
+def get_gene_trajectory(session: Session, gene_id: int) -> Optional[Dict]:
+    """A gene's metrics per timepoint, or None if it has no trajectory."""
+    row = session.get(GeneTrajectory, gene_id)
+    if row is None:
+        return None
+    indptr = row.dominated_by_indptr
+    timepoints = []
+    for i, timepoint_id in enumerate(row.timepoint_ids):
+        status = row.status[i]
+        timepoints.append(
+            {
+                "timepoint_id": timepoint_id,
+                **{name: bool(status & flag) for name, flag in STATUS_FLAGS.items()},
+                "degree": row.degree[i],
+                "component_size": row.component_size[i],
+                "biclique_count": row.biclique_count[i],
+                "dominated_by": row.dominated_by[indptr[i] : indptr[i + 1]],
+            }
+        )
+    return {
+        "gene_id": row.gene_id,
+        "timepoint_count": row.timepoint_count,
+        "timepoints": timepoints,
+    }
+
+
+def trajectory_frame(session: Session) -> pd.DataFrame:
+    """
+    All trajectories as one wide frame, a row per gene.
+
+    Columns are gene_id, symbol, timepoint_count and ``<metric>_<timepoint>``
+    for each metric; ``dominated_by_<timepoint>`` joins the DMR ids with ";".
+    """
+    rows = (
+        session.query(*[getattr(GeneTrajectory, c) for c in COLUMNS], Gene.symbol)
+        .outerjoin(Gene, Gene.id == GeneTrajectory.gene_id)
+        .order_by(GeneTrajectory.gene_id)
+        .all()
+    )
+    names = dict(session.query(Timepoint.id, Timepoint.name))
+    frame = pd.DataFrame(
+        {
+            "gene_id": [r.gene_id for r in rows],
+            "symbol": [r.symbol for r in rows],
+            "timepoint_count": [r.timepoint_count for r in rows],
+        }
+    )
+    if not rows:
+        return frame
+    timepoints = [names.get(t, str(t)) for t in rows[0].timepoint_ids]
+    columns = {}
+    for metric in METRICS:
+        matrix = np.array([getattr(r, metric) for r in rows], dtype=np.int64)
+        for i, name in enumerate(timepoints):
+            columns[f"{metric}_{name}"] = matrix[:, i]
+    for i, name in enumerate(timepoints):
+        columns[f"dominated_by_{name}"] = [
+            ";".join(map(str, r.dominated_by[r.dominated_by_indptr[i] : r.dominated_by_indptr[i + 1]]))
+            for r in rows
+        ]
+    return pd.concat([frame, pd.DataFrame(columns)], axis=1)
+
+
+def export_gene_trajectories(session: Session, path: Path) -> int:
+    """Write trajectory_frame as Parquet, or CSV unless the path ends in .parquet."""
+    frame = trajectory_frame(session)
+    path = Path(path)
+    if path.suffix == ".parquet":
+        frame.to_parquet(path, index=False)
+    else:
+        frame.to_csv(path, index=False)
+    return len(frame)
+
+
+def main():
+    if len(sys.argv) < 3 or sys.argv[1] != "export":
+        print("usage: python -m backend.app.database.trajectories export OUT.parquet|OUT.csv")
+        sys.exit(2)
+
+    from .connection import get_db_engine
+
+    with Session(get_db_engine()) as session:
+        written = export_gene_trajectories(session, Path(sys.argv[2]))
+    print(f"Exported trajectories of {written} genes to {sys.argv[2]}")
+
+
+if __name__ == "__main__":
+    main()
@@ -7,12 +7,16 @@ import time
 from typing import List, Dict, Optional, Any
 import requests
 from pathlib import Path
-import json
-from functools import lru_cache
 import logging
 from dotenv import load_dotenv
 import os
 
+from .result_cache import (
+    canonical_gene_list,
+    enrichment_cache_key,
+    get_enrichment_cache,
+)
+
 # Load configuration
 load_dotenv(Path("./processDMRs.env"))
 
@@ -21,8 +25,8 @@ DAVID_API_KEY = os.getenv("DAVID_API_KEY")
 
 # Constants
 DAVID_BASE_URL = "https://david.ncifcrf.gov/api.jsp"
-CACHE_DIR = Path("./cache/david")
-CACHE_DIR.mkdir(parents=True, exist_ok=True)
+DAVID_METHOD = "david_chartReport"
+DAVID_ANNOTATIONS = "GOTERM_BP_DIRECT,GOTERM_CC_DIRECT,GOTERM_MF_DIRECT"
 
 logger = logging.getLogger(__name__)
 
@@ -31,29 +35,24 @@ class DAVIDError(Exception):
     pass
 
 def get_cache_key(gene_ids: List[str], species: str) -> str:
-    """Generate a unique cache key for a gene list."""
-    genes_str = "_".join(sorted(gene_ids))
-    return f"{species}_{hash(genes_str)}"
+    """Generate a stable, content-addressed cache key for a gene list."""
+    return enrichment_cache_key(gene_ids, species, DAVID_METHOD, DAVID_ANNOTATIONS)
 
-@lru_cache(maxsize=128)
 def load_cached_results(cache_key: str) -> Optional[Dict]:
     """Load cached enrichment results if they exist."""
-    cache_file = CACHE_DIR / f"{cache_key}.json"
-    if cache_file.exists():
-        try:
-            with open(cache_file, 'r') as f:
-                return json.load(f)
-        except json.JSONDecodeError:
-            logger.error(f"Failed to load cache file: {cache_file}")
-            return None
-    return None
-
-def save_to_cache(cache_key: str, data: Dict) -> None:
+    return get_enrichment_cache().get(cache_key)
+
+def save_to_cache(cache_key: str, data: Dict, gene_ids: List[str], species: str) -> None:
     """Save enrichment results to cache."""
-    cache_file = CACHE_DIR / f"{cache_key}.json"
     try:
-        with open(cache_file, 'w') as f:
-            json.dump(data, f)
+        get_enrichment_cache().put(
+            cache_key,
+            data,
+            DAVID_METHOD,
+            species,
+            DAVID_ANNOTATIONS,
+            len(canonical_gene_list(gene_ids)),
+        )
     except Exception as e:
         logger.error(f"Failed to save to cache: {e}")
 
@@ -81,7 +80,7 @@ def submit_gene_list(gene_ids: List[str], species: str = "mouse") -> str:
             "genes": ",".join(gene_ids),
             "species": "mouse" if species.lower() == "mouse" else "human",
             "tool": "chartReport",
-            "annot": "GOTERM_BP_DIRECT,GOTERM_CC_DIRECT,GOTERM_MF_DIRECT"
+            "annot": DAVID_ANNOTATIONS
         }
         
         response = requests.post(DAVID_BASE_URL, data=payload)
@@ -198,24 +197,18 @@ def run_enrichment_analysis(
     if not gene_ids:
         raise DAVIDError("Empty gene list provided")
 
-    cache_key = get_cache_key(gene_ids, species)
-    
-    if use_cache:
-        cached_results = load_cached_results(cache_key)
-        if cached_results:
-            logger.info(f"Using cached results for {cache_key}")
-            return cached_results
+    def analyse(genes: List[str]) -> Dict[str, List[Dict]]:
+        job_id = submit_gene_list(genes, species)
+        raw_results = get_enrichment_results(job_id)
+        return process_enrichment_results(raw_results)
 
     try:
-        job_id = submit_gene_list(gene_ids, species)
-        raw_results = get_enrichment_results(job_id)
-        processed_results = process_enrichment_results(raw_results)
-        
-        if use_cache:
-            save_to_cache(cache_key, processed_results)
-            
-        return processed_results
-        
+        if not use_cache:
+            return analyse(canonical_gene_list(gene_ids))
+        return get_enrichment_cache().get_or_compute(
+            gene_ids, species, DAVID_METHOD, DAVID_ANNOTATIONS, analyse
+        )
+
     except Exception as e:
         logger.error(f"Enrichment analysis failed: {e}")
         raise DAVIDError(f"Enrichment analysis failed: {e}")
@@ -29,6 +29,7 @@ from ..schemas import (
 )
 from ..database.models import Biclique
 from .ncbi_utils import fetch_ncbi_gene_ids
+from .result_cache import get_enrichment_cache
 
 Base = declarative_base()
 
@@ -183,7 +184,7 @@ def get_stored_biclique_enrichment(
 
 def fetch_david_enrichment(ncbi_ids: List[str]) -> Dict[str, Any]:
     """
-    Fetch GO enrichment data from DAVID API
+    Fetch GO enrichment data from DAVID API, through the shared result cache
 
     Args:
         ncbi_ids: List of NCBI gene IDs
@@ -191,6 +192,18 @@ def fetch_david_enrichment(ncbi_ids: List[str]) -> Dict[str, Any]:
     Returns:
         Dictionary containing enrichment results
     """
+    try:
+        cache = get_enrichment_cache()
+    except Exception as e:
+        logger.error(f"Enrichment cache unavailable: {str(e)}")
+        return _fetch_david_enrichment(ncbi_ids)
+    return cache.get_or_compute(
+        ncbi_ids, "unspecified", "david_api", "GOTERM_BP_ALL", _fetch_david_enrichment
+    )
+
+
+def _fetch_david_enrichment(ncbi_ids: List[str]) -> Dict[str, Any]:
+    """Uncached DAVID request behind fetch_david_enrichment."""
     # DAVID API endpoint
     api_url = "https://david.ncifcrf.gov/api.jsp"
 
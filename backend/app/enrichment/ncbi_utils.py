@@ -20,7 +20,7 @@ from typing import Dict, List, Optional, Union
 from urllib.error import HTTPError
 from ..database.models import Gene, GeneDetails
 from sqlalchemy.orm import Session
-from functools import lru_cache
+from ..utils.memory_accounting import inspectable_lru_cache
 from Bio import Entrez
 import logging
 from dataclasses import dataclass
@@ -155,7 +155,7 @@ def rate_limit():
     time.sleep(RATE_LIMIT)
 
 
-@lru_cache(maxsize=CACHE_SIZE)
+@inspectable_lru_cache(maxsize=CACHE_SIZE)
 def fetch_gene_id(gene_symbol: str, organism: str = "mouse", session: Optional[Session] = None, gene_id: Optional[int] = None) -> Optional[str]:
     """
     Fetch NCBI Gene ID for a given gene symbol.
@@ -204,7 +204,7 @@ def fetch_gene_id(gene_symbol: str, organism: str = "mouse", session: Optional[S
         raise NCBIError(f"NCBI API error for gene {gene_symbol}: {str(e)}")
 
 
-@lru_cache(maxsize=CACHE_SIZE)
+@inspectable_lru_cache(maxsize=CACHE_SIZE)
 def fetch_gene_details(gene_id: str) -> Optional[GeneInfo]:
     """
     Fetch detailed information for a gene using its NCBI Gene ID.
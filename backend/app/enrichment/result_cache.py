@@ -0,0 +1,225 @@
+"""
+Content-addressed cache for enrichment results.
+
+Results are keyed by the SHA-256 of a canonical description of the request
+(sorted, de-duplicated gene ids, species, method and annotation version), so
+the same gene set maps to the same key in every process and after restarts.
+Records are zlib-compressed JSON rows in one SQLite file shared by the web
+workers and batch jobs; the least recently used rows are evicted once the
+stored payloads exceed the configured size.
+"""
+
+import hashlib
+import json
+import logging
+import os
+import sqlite3
+import threading
+import time
+import zlib
+from pathlib import Path
+from typing import Any, Callable, Dict, Iterable, Optional
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_CACHE_PATH = Path("./cache/enrichment_cache.db")
+DEFAULT_MAX_BYTES = 256 * 1024 * 1024
+LOCK_STRIPES = 64  # fixed set of fill locks shared by all keys
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS enrichment_cache (
+    cache_key TEXT PRIMARY KEY,
+    method TEXT NOT NULL,
+    species TEXT NOT NULL,
+    annotation_version TEXT NOT NULL,
+    gene_count INTEGER NOT NULL,
+    payload BLOB NOT NULL,
+    size INTEGER NOT NULL,
+    created_at REAL NOT NULL,
+    last_access REAL NOT NULL
+);
+CREATE INDEX IF NOT EXISTS ix_enrichment_cache_last_access
+    ON enrichment_cache (last_access);
+"""
+
+
+def canonical_gene_list(gene_ids: Iterable) -> list:
+    """Sorted unique gene ids as strings, independent of input order and type."""
+    return sorted({str(g).strip() for g in gene_ids if str(g).strip()})
+
+
+def enrichment_cache_key(
+    gene_ids: Iterable, species: str, method: str, annotation_version: str
+) -> str:
+    """Stable SHA-256 key for an enrichment request."""
+    canonical = json.dumps(
+        {
+            "genes": canonical_gene_list(gene_ids),
+            "species": species.lower(),
+            "method": method,
+            "annotation_version": annotation_version,
+        },
+        sort_keys=True,
+        separators=(",", ":"),
+    )
+    return hashlib.sha256(canonical.encode("utf-8")).hexdigest()
+
+
+class EnrichmentCache:
+    """SQLite-backed, size-bounded store of compressed enrichment results."""
+
+    def __init__(self, path: Path = DEFAULT_CACHE_PATH, max_bytes: int = DEFAULT_MAX_BYTES):
+        self.path = Path(path)
+        self.max_bytes = max_bytes
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        self._local = threading.local()
+        self._key_locks = [threading.Lock() for _ in range(LOCK_STRIPES)]
+        with self._connect() as conn:
+            conn.executescript(SCHEMA)
+
+    def _connect(self) -> sqlite3.Connection:
+        """One connection per thread; WAL lets other processes read while one writes."""
+        conn = getattr(self._local, "conn", None)
+        if conn is None:
+            conn = sqlite3.connect(self.path, timeout=30)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute("PRAGMA synchronous=NORMAL")
+            self._local.conn = conn
+        return conn
+
+    def get(self, cache_key: str) -> Optional[Dict]:
+        conn = self._connect()
+        row = conn.execute(
+            "SELECT payload FROM enrichment_cache WHERE cache_key = ?", (cache_key,)
+        ).fetchone()
+        if row is None:
+            return None
+        try:
+            data = json.loads(zlib.decompress(row[0]).decode("utf-8"))
+        except (zlib.error, ValueError) as e:
+            logger.error(f"Dropping unreadable enrichment cache record {cache_key}: {e}")
+            with conn:
+                conn.execute(
+                    "DELETE FROM enrichment_cache WHERE cache_key = ?", (cache_key,)
+                )
+            return None
+        with conn:
+            conn.execute(
+                "UPDATE enrichment_cache SET last_access = ? WHERE cache_key = ?",
+                (time.time(), cache_key),
+            )
+        return data
+
+    def put(
+        self,
+        cache_key: str,
+        data: Dict,
+        method: str,
+        species: str,
+        annotation_version: str,
+        gene_count: int,
+    ) -> None:
+        payload = zlib.compress(json.dumps(data).encode("utf-8"))
+        now = time.time()
+        conn = self._connect()
+        with conn:
+            conn.execute(
+                """
+                INSERT OR REPLACE INTO enrichment_cache
+                    (cache_key, method, species, annotation_version, gene_count,
+                     payload, size, created_at, last_access)
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+                """,
+                (
+                    cache_key,
+                    method,
+                    species.lower(),
+                    annotation_version,
+                    gene_count,
+                    payload,
+                    len(payload),
+                    now,
+                    now,
+                ),
+            )
+            self._evict(conn, keep=cache_key)
+
+    def _evict(self, conn: sqlite3.Connection, keep: str) -> None:
+        """Delete least recently used records (never ``keep``) until under max_bytes."""
+        total = conn.execute(
+            "SELECT COALESCE(SUM(size), 0) FROM enrichment_cache"
+        ).fetchone()[0]
+        if total <= self.max_bytes:
+            return
+        excess = total - self.max_bytes
+        freed = 0
+        doomed = []
+        for cache_key, size in conn.execute(
+            "SELECT cache_key, size FROM enrichment_cache WHERE cache_key != ? "
+            "ORDER BY last_access",
+            (keep,),
+        ):
+            doomed.append((cache_key,))
+            freed += size
+            if freed >= excess:
+                break
+        conn.executemany("DELETE FROM enrichment_cache WHERE cache_key = ?", doomed)
+        logger.info(f"Evicted {len(doomed)} enrichment cache records ({freed} bytes)")
+
+    def stats(self) -> Dict[str, int]:
+        count, total = self._connect().execute(
+            "SELECT COUNT(*), COALESCE(SUM(size), 0) FROM enrichment_cache"
+        ).fetchone()
+        return {"records": count, "bytes": total, "max_bytes": self.max_bytes}
+
+    def _lock_for(self, cache_key: str) -> threading.Lock:
+        """Fill lock of a key; keys sharing a stripe only serialise their misses."""
+        return self._key_locks[int(cache_key[:8], 16) % LOCK_STRIPES]
+
+    def get_or_compute(
+        self,
+        gene_ids: Iterable,
+        species: str,
+        method: str,
+        annotation_version: str,
+        compute: Callable[[list], Dict[str, Any]],
+    ) -> Dict[str, Any]:
+        """
+        Return the cached result for a gene set, computing and storing it on a miss.
+
+        Concurrent requests for the same key in this process wait for the first
+        one instead of enriching again. Empty results are not cached, so a
+        failed lookup is retried next time.
+        """
+        genes = canonical_gene_list(gene_ids)
+        cache_key = enrichment_cache_key(genes, species, method, annotation_version)
+
+        cached = self.get(cache_key)
+        if cached is not None:
+            logger.info(f"Using cached {method} enrichment {cache_key[:12]}")
+            return cached
+
+        with self._lock_for(cache_key):
+            cached = self.get(cache_key)
+            if cached is not None:
+                return cached
+            result = compute(genes)
+            if result:
+                self.put(cache_key, result, method, species, annotation_version, len(genes))
+            return result
+
+
+_cache: Optional[EnrichmentCache] = None
+_cache_lock = threading.Lock()
+
+
+def get_enrichment_cache() -> EnrichmentCache:
+    """Process-wide cache, configured by ENRICHMENT_CACHE_PATH / ENRICHMENT_CACHE_MAX_MB."""
+    global _cache
+    with _cache_lock:
+        if _cache is None:
+            path = Path(os.getenv("ENRICHMENT_CACHE_PATH", str(DEFAULT_CACHE_PATH)))
+            max_mb = os.getenv("ENRICHMENT_CACHE_MAX_MB")
+            max_bytes = int(float(max_mb) * 1024 * 1024) if max_mb else DEFAULT_MAX_BYTES
+            _cache = EnrichmentCache(path, max_bytes)
+        return _cache
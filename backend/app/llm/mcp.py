@@ -106,14 +106,61 @@ class SearchAgent(Agent):
         return await self._generate(self.context + [{"role": "user", "content": str(input_data)}])
 
 class SQLAgent(Agent):
-    """Specialized agent for database operations"""
-    def __init__(self, config: MCPConfig):
+    """
+    Specialized agent for database operations.
+
+    Generated SQL targets the DuckDB analytics snapshot, never the serving
+    database; the snapshot's schema description is the agent's system context.
+    """
+    def __init__(self, config: MCPConfig, analytics_store=None):
         super().__init__(config, AgentRole.SQL)
-        
+        self.analytics_store = analytics_store
+        self.schema_snapshot: Optional[str] = None
+        self.sandbox = None
+
+    def _refresh_schema(self) -> None:
+        """Describe the current snapshot's schema in the system context."""
+        if self.analytics_store is None:
+            from ..database.analytics import get_analytics_store
+            self.analytics_store = get_analytics_store()
+        snapshot = self.analytics_store.current_snapshot()
+        if snapshot is None or snapshot == self.schema_snapshot:
+            return
+        schema = self.analytics_store.schema_description()
+        self.context = [m for m in self.context if m.get("name") != "analytics_schema"]
+        self.context.insert(0, {
+            "role": "system",
+            "name": "analytics_schema",
+            "content": f"Write DuckDB SQL against this schema:\n{schema}",
+        })
+        self.schema_snapshot = snapshot
+
     async def process(self, input_data: Any) -> str:
-        # Add SQL-specific processing logic
+        self._refresh_schema()
         return await self._generate(self.context + [{"role": "user", "content": str(input_data)}])
 
+    def execute(self, sql: str, row_limit: Optional[int] = None) -> Dict[str, Any]:
+        """
+        Run generated SQL on the analytics snapshot through the SQL sandbox.
+
+        A rejected query is returned as {"rejected": {...}} rather than raised,
+        so the reason can be fed back to the model for another attempt.
+        """
+        from ..database.sql_sandbox import (
+            DuckDBBackend,
+            SandboxRejection,
+            SQLSandbox,
+            limits_from_env,
+        )
+
+        self._refresh_schema()
+        if self.sandbox is None:
+            self.sandbox = SQLSandbox(DuckDBBackend(self.analytics_store), limits_from_env())
+        try:
+            return self.sandbox.execute(sql, user=f"agent:{id(self)}", row_limit=row_limit)
+        except SandboxRejection as e:
+            return {"rejected": e.to_dict()}
+
 class BioInformaticsAgent(Agent):
     """Specialized agent for bioinformatics analysis"""
     def __init__(self, config: MCPConfig):
@@ -126,46 +173,46 @@ class BioInformaticsAgent(Agent):
 class MCPManager:
     """Manager class for MCP functionality"""
 
-        def __init__(self):
-            self._active_config: Optional[MCPConfig] = None
-            self._agents: Dict[AgentRole, Agent] = {}
-            
-        def configure(self, config: MCPConfig) -> None:
-            """Configure the LiteLLM settings and initialize agents"""
-            self._active_config = config
-            
-            # Initialize specialized agents
-            # Map agents to appropriate model tiers
-            researcher_config = MCPConfig(
-                model_tier=ModelTier.MAIN,
-                capabilities=[ModelCapability.RESEARCH]
-            )
-            search_config = MCPConfig(
-                model_tier=ModelTier.SEARCH,
-                capabilities=[ModelCapability.SEARCH]
-            )
-            sql_config = MCPConfig(
-                model_tier=ModelTier.MAIN,
-                capabilities=[ModelCapability.SQL]
-            )
-            bio_config = MCPConfig(
-                model_tier=ModelTier.MAIN,
-                capabilities=[ModelCapability.BIO]
-            )
-
-            self._agents = {
-                AgentRole.RESEARCHER: ResearchAgent(researcher_config),
-                AgentRole.SEARCH: SearchAgent(search_config),
-                AgentRole.SQL: SQLAgent(sql_config),
-                AgentRole.BIOINFORMATICS: BioInformaticsAgent(bio_config)
-            }
-
-        def get_agent(self, role: AgentRole) -> Agent:
-            """Get an agent for a specific role"""
-            if not self._active_config:
-                raise RuntimeError("No configuration set")
-            return self._agents.get(role) or self._agents[AgentRole.GENERAL]
+    def __init__(self):
+        self._active_config: Optional[MCPConfig] = None
+        self._agents: Dict[AgentRole, Agent] = {}
+        
+    def configure(self, config: MCPConfig) -> None:
+        """Configure the LiteLLM settings and initialize agents"""
+        self._active_config = config
         
+        # Initialize specialized agents
+        # Map agents to appropriate model tiers
+        researcher_config = MCPConfig(
+            model_tier=ModelTier.MAIN,
+            capabilities=[ModelCapability.RESEARCH]
+        )
+        search_config = MCPConfig(
+            model_tier=ModelTier.SEARCH,
+            capabilities=[ModelCapability.SEARCH]
+        )
+        sql_config = MCPConfig(
+            model_tier=ModelTier.MAIN,
+            capabilities=[ModelCapability.SQL]
+        )
+        bio_config = MCPConfig(
+            model_tier=ModelTier.MAIN,
+            capabilities=[ModelCapability.BIO]
+        )
+
+        self._agents = {
+            AgentRole.RESEARCHER: ResearchAgent(researcher_config),
+            AgentRole.SEARCH: SearchAgent(search_config),
+            AgentRole.SQL: SQLAgent(sql_config),
+            AgentRole.BIOINFORMATICS: BioInformaticsAgent(bio_config)
+        }
+
+    def get_agent(self, role: AgentRole) -> Agent:
+        """Get an agent for a specific role"""
+        if not self._active_config:
+            raise RuntimeError("No configuration set")
+        return self._agents.get(role) or self._agents[AgentRole.GENERAL]
+    
     async def generate(self, prompt: str, **kwargs) -> str:
         """Generate completion using LiteLLM"""
         if not self._active_config:
@@ -0,0 +1,142 @@
+# File : __init__.py
+# Description : Optional native kernels for the hot graph algorithms
+"""Native (C++) kernels for the hot graph algorithms, with pure-Python fallbacks.
+
+The extension ``_kernels`` is built by ``backend/setup.py``::
+
+    cd backend && python setup.py build_ext --inplace
+
+and is picked up at import time. When it is missing (or ``DMR_NATIVE=0`` is
+set) ``available()`` is False and every caller keeps using its Python
+implementation, which remains the reference the kernels are tested against.
+
+Graphs are handed over as CSR arrays (``to_csr``) and edge sets as the packed
+int64 keys of ``edge_keys``; the array kernels release the GIL while running.
+"""
+
+import os
+from typing import Dict, List, Sequence, Set, Tuple
+
+import networkx as nx
+import numpy as np
+
+if os.getenv("DMR_NATIVE", "1").lower() in ("0", "false", "no", "off"):
+    _kernels = None
+else:
+    try:
+        from . import _kernels
+    except ImportError:
+        _kernels = None
+
+
+def available() -> bool:
+    """Whether the compiled kernels are in use."""
+    return _kernels is not None
+
+
+def to_csr(graph: nx.Graph) -> Tuple[List[int], np.ndarray, np.ndarray]:
+    """
+    Adjacency of a graph as CSR arrays.
+
+    Returns:
+        Tuple of (nodes in graph order, int64 indptr, int64 indices) where
+        indices are positions into the node list
+    """
+    nodes = list(graph.nodes())
+    position = {node: i for i, node in enumerate(nodes)}
+    degrees = np.fromiter((d for _, d in graph.degree(nodes)), dtype=np.int64, count=len(nodes))
+    indptr = np.zeros(len(nodes) + 1, dtype=np.int64)
+    np.cumsum(degrees, out=indptr[1:])
+    indices = np.fromiter(
+        (position[neighbour] for node in nodes for neighbour in graph.adj[node]),
+        dtype=np.int64,
+        count=int(indptr[-1]),
+    )
+    return nodes, indptr, indices
+
+
+def rb_domination(graph: nx.Graph, area: Dict[int, float]) -> Set[int]:
+    """
+    Minimal red-blue dominating set, see rb_domination.greedy_rb_domination.
+
+    Args:
+        graph: Bipartite graph with ``bipartite`` node attributes (1 = gene)
+        area: Area statistic per DMR used to break utility ties, default 1.0
+    """
+    nodes, indptr, indices = to_csr(graph)
+    is_gene = np.fromiter(
+        (graph.nodes[n]["bipartite"] == 1 for n in nodes), dtype=np.int8, count=len(nodes)
+    )
+    areas = np.fromiter((area.get(n, 1.0) for n in nodes), dtype=np.float64, count=len(nodes))
+    node_ids = np.asarray(nodes, dtype=np.int64)
+    chosen = rb_domination_arrays(indptr, indices, is_gene, areas, node_ids)
+    return {nodes[i] for i in chosen.tolist()}
+
+
+def rb_domination_arrays(
+    indptr: np.ndarray,
+    indices: np.ndarray,
+    is_gene: np.ndarray,
+    area: np.ndarray,
+    node_ids: np.ndarray,
+) -> np.ndarray:
+    """rb_domination on prepared CSR arrays; returns the chosen node positions."""
+    return np.frombuffer(
+        _kernels.rb_domination(indptr, indices, is_gene, area, node_ids), dtype=np.int64
+    )
+
+
+def connected_components(graph: nx.Graph) -> Tuple[List[int], np.ndarray]:
+    """
+    Component label of every node, numbered in order of first appearance.
+
+    Returns:
+        Tuple of (nodes in graph order, int64 labels)
+    """
+    nodes, indptr, indices = to_csr(graph)
+    labels = np.frombuffer(_kernels.connected_components(indptr, indices), dtype=np.int64)
+    return nodes, labels
+
+
+def classify_edge_keys(
+    original: np.ndarray, biclique: np.ndarray, simple: np.ndarray
+) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Split sorted, unique edge keys by membership.
+
+    Returns:
+        Tuple of (bool mask over ``original`` marking edges that are in
+        ``biclique`` or ``simple``, sorted keys of ``biclique`` missing from
+        ``original``)
+    """
+    permanent, missing = _kernels.classify_edge_keys(
+        np.ascontiguousarray(original, dtype=np.int64),
+        np.ascontiguousarray(biclique, dtype=np.int64),
+        np.ascontiguousarray(simple, dtype=np.int64),
+    )
+    return (
+        np.frombuffer(permanent, dtype=np.int8).astype(bool),
+        np.frombuffer(missing, dtype=np.int64),
+    )
+
+
+def edge_coverage_counts(graph_keys: np.ndarray, cell_keys: np.ndarray) -> Tuple[int, int, int]:
+    """(single, multiple, uncovered) counts of graph edges over biclique cells."""
+    return _kernels.edge_coverage_counts(
+        np.ascontiguousarray(graph_keys, dtype=np.int64),
+        np.ascontiguousarray(cell_keys, dtype=np.int64),
+    )
+
+
+def parse_biclique_lines(
+    lines: Sequence[str], start: int, max_dmr_id: int, gene_id_mapping: Dict[str, int]
+) -> Tuple[List[Tuple[Set[int], Set[int]]], List[str]]:
+    """
+    Tokenize cluster lines from ``start`` on, as reader.parse_bicliques does.
+
+    Returns:
+        Tuple of (bicliques, lowercased gene tokens missing from the mapping)
+    """
+    if not isinstance(lines, list):
+        lines = list(lines)
+    return _kernels.parse_biclique_lines(lines, start, max_dmr_id, gene_id_mapping)
@@ -0,0 +1,513 @@
+// File _kernels.cpp
+//
+// Native kernels for the hot graph algorithms (see backend/app/native/__init__.py).
+//
+// Written against the plain CPython API so the only build requirement is a
+// C++17 compiler. Array arguments are C-contiguous buffers (numpy arrays) of
+// int64 / int8 / float64, and array results are returned as bytes that the
+// Python wrapper views with np.frombuffer. Kernels that only touch the
+// copied arrays run with the GIL released.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// RAII view of a C-contiguous buffer with a fixed item size.
+class ArrayView {
+  public:
+    ArrayView() { std::memset(&view_, 0, sizeof(view_)); }
+    ~ArrayView() {
+        if (view_.obj) PyBuffer_Release(&view_);
+    }
+    ArrayView(const ArrayView &) = delete;
+    ArrayView &operator=(const ArrayView &) = delete;
+
+    bool open(PyObject *obj, Py_ssize_t itemsize, const char *name) {
+        if (PyObject_GetBuffer(obj, &view_, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) {
+            return false;
+        }
+        if (view_.itemsize != itemsize) {
+            PyErr_Format(PyExc_TypeError, "%s: expected %zd-byte items, got %zd", name,
+                         itemsize, view_.itemsize);
+            return false;
+        }
+        return true;
+    }
+
+    Py_ssize_t size() const { return view_.itemsize ? view_.len / view_.itemsize : 0; }
+
+    template <typename T>
+    const T *data() const {
+        return static_cast<const T *>(view_.buf);
+    }
+
+  private:
+    Py_buffer view_;
+};
+
+template <typename T>
+PyObject *to_bytes(const std::vector<T> &values) {
+    return PyBytes_FromStringAndSize(reinterpret_cast<const char *>(values.data()),
+                                     static_cast<Py_ssize_t>(values.size() * sizeof(T)));
+}
+
+// ---------------------------------------------------------------------------
+// Red-blue domination
+// ---------------------------------------------------------------------------
+
+struct Candidate {
+    int64_t utility;
+    double area;
+    int64_t node_id;
+    int64_t pos;
+};
+
+// Heap order of the Python implementation: most new genes, then largest
+// area, then smallest DMR id.
+struct CandidateLess {
+    bool operator()(const Candidate &a, const Candidate &b) const {
+        if (a.utility != b.utility) return a.utility < b.utility;
+        if (a.area != b.area) return a.area < b.area;
+        return a.node_id > b.node_id;
+    }
+};
+
+std::vector<int64_t> rb_domination(const int64_t *indptr, const int64_t *indices,
+                                   const int8_t *is_gene, const double *area,
+                                   const int64_t *node_ids, int64_t n) {
+    std::vector<char> dominated(n, 0), chosen(n, 0), active(n, 0);
+    std::vector<int64_t> utility(n, 0);
+    int64_t genes_total = 0, genes_dominated = 0;
+
+    auto dominate_neighbours = [&](int64_t dmr, std::vector<int64_t> *newly) {
+        for (int64_t k = indptr[dmr]; k < indptr[dmr + 1]; ++k) {
+            int64_t gene = indices[k];
+            if (!dominated[gene]) {
+                dominated[gene] = 1;
+                ++genes_dominated;
+                if (newly) newly->push_back(gene);
+            }
+        }
+    };
+
+    // Degree-1 genes force their only DMR into the set
+    for (int64_t v = 0; v < n; ++v) {
+        if (!is_gene[v]) continue;
+        ++genes_total;
+        if (indptr[v + 1] - indptr[v] == 1) {
+            int64_t dmr = indices[indptr[v]];
+            if (!chosen[dmr]) {
+                chosen[dmr] = 1;
+                dominate_neighbours(dmr, nullptr);
+            }
+        }
+    }
+
+    std::priority_queue<Candidate, std::vector<Candidate>, CandidateLess> heap;
+    for (int64_t v = 0; v < n; ++v) {
+        if (is_gene[v] || chosen[v]) continue;
+        int64_t count = 0;
+        for (int64_t k = indptr[v]; k < indptr[v + 1]; ++k) count += !dominated[indices[k]];
+        if (count) {
+            utility[v] = count;
+            active[v] = 1;
+            heap.push({count, area[v], node_ids[v], v});
+        }
+    }
+
+    std::vector<int64_t> newly, affected;
+    while (!heap.empty() && genes_dominated < genes_total) {
+        Candidate top = heap.top();
+        heap.pop();
+        // Stale entry: chosen already or utility has dropped since the push
+        if (!active[top.pos] || utility[top.pos] != top.utility) continue;
+
+        chosen[top.pos] = 1;
+        active[top.pos] = 0;
+        newly.clear();
+        affected.clear();
+        dominate_neighbours(top.pos, &newly);
+        for (int64_t gene : newly) {
+            for (int64_t k = indptr[gene]; k < indptr[gene + 1]; ++k) {
+                int64_t dmr = indices[k];
+                if (active[dmr]) {
+                    --utility[dmr];
+                    affected.push_back(dmr);
+                }
+            }
+        }
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+        for (int64_t dmr : affected) {
+            if (utility[dmr] > 0) {
+                heap.push({utility[dmr], area[dmr], node_ids[dmr], dmr});
+            } else {
+                active[dmr] = 0;
+            }
+        }
+    }
+
+    // Drop every DMR whose genes are all dominated by another chosen DMR
+    std::vector<int64_t> cover(n, 0);
+    for (int64_t v = 0; v < n; ++v) {
+        if (!chosen[v]) continue;
+        for (int64_t k = indptr[v]; k < indptr[v + 1]; ++k) ++cover[indices[k]];
+    }
+    std::vector<int64_t> result;
+    for (int64_t v = 0; v < n; ++v) {
+        if (!chosen[v]) continue;
+        bool redundant = true;
+        for (int64_t k = indptr[v]; k < indptr[v + 1] && redundant; ++k) {
+            redundant = cover[indices[k]] >= 2;
+        }
+        if (!redundant) result.push_back(v);
+    }
+    return result;
+}
+
+PyObject *py_rb_domination(PyObject *, PyObject *args) {
+    PyObject *indptr_obj, *indices_obj, *gene_obj, *area_obj, *ids_obj;
+    if (!PyArg_ParseTuple(args, "OOOOO", &indptr_obj, &indices_obj, &gene_obj, &area_obj,
+                          &ids_obj)) {
+        return nullptr;
+    }
+    ArrayView indptr, indices, is_gene, area, ids;
+    if (!indptr.open(indptr_obj, 8, "indptr") || !indices.open(indices_obj, 8, "indices") ||
+        !is_gene.open(gene_obj, 1, "is_gene") || !area.open(area_obj, 8, "area") ||
+        !ids.open(ids_obj, 8, "node_ids")) {
+        return nullptr;
+    }
+    int64_t n = is_gene.size();
+    if (indptr.size() != n + 1 || area.size() != n || ids.size() != n) {
+        PyErr_SetString(PyExc_ValueError, "rb_domination: inconsistent array lengths");
+        return nullptr;
+    }
+
+    std::vector<int64_t> result;
+    Py_BEGIN_ALLOW_THREADS;
+    result = rb_domination(indptr.data<int64_t>(), indices.data<int64_t>(),
+                           is_gene.data<int8_t>(), area.data<double>(), ids.data<int64_t>(),
+                           n);
+    Py_END_ALLOW_THREADS;
+    return to_bytes(result);
+}
+
+// ---------------------------------------------------------------------------
+// Connected components
+// ---------------------------------------------------------------------------
+
+PyObject *py_connected_components(PyObject *, PyObject *args) {
+    PyObject *indptr_obj, *indices_obj;
+    if (!PyArg_ParseTuple(args, "OO", &indptr_obj, &indices_obj)) return nullptr;
+    ArrayView indptr, indices;
+    if (!indptr.open(indptr_obj, 8, "indptr") || !indices.open(indices_obj, 8, "indices")) {
+        return nullptr;
+    }
+    int64_t n = indptr.size() - 1;
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "connected_components: empty indptr");
+        return nullptr;
+    }
+
+    std::vector<int64_t> labels(n, -1);
+    const int64_t *ptr = indptr.data<int64_t>();
+    const int64_t *idx = indices.data<int64_t>();
+    Py_BEGIN_ALLOW_THREADS;
+    // Labels are numbered in order of each component's first node
+    std::vector<int64_t> stack;
+    int64_t next = 0;
+    for (int64_t start = 0; start < n; ++start) {
+        if (labels[start] >= 0) continue;
+        labels[start] = next;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int64_t v = stack.back();
+            stack.pop_back();
+            for (int64_t k = ptr[v]; k < ptr[v + 1]; ++k) {
+                if (labels[idx[k]] < 0) {
+                    labels[idx[k]] = next;
+                    stack.push_back(idx[k]);
+                }
+            }
+        }
+        ++next;
+    }
+    Py_END_ALLOW_THREADS;
+    return to_bytes(labels);
+}
+
+// ---------------------------------------------------------------------------
+// Edge classification and coverage over packed edge keys
+// ---------------------------------------------------------------------------
+
+bool contains(const int64_t *sorted, int64_t n, int64_t key) {
+    return std::binary_search(sorted, sorted + n, key);
+}
+
+PyObject *py_classify_edge_keys(PyObject *, PyObject *args) {
+    PyObject *orig_obj, *bic_obj, *simple_obj;
+    if (!PyArg_ParseTuple(args, "OOO", &orig_obj, &bic_obj, &simple_obj)) return nullptr;
+    ArrayView original, biclique, simple;
+    if (!original.open(orig_obj, 8, "original") || !biclique.open(bic_obj, 8, "biclique") ||
+        !simple.open(simple_obj, 8, "simple")) {
+        return nullptr;
+    }
+
+    // All three arrays are sorted and unique
+    const int64_t *o = original.data<int64_t>(), *b = biclique.data<int64_t>(),
+                  *s = simple.data<int64_t>();
+    int64_t no = original.size(), nb = biclique.size(), ns = simple.size();
+    std::vector<int8_t> permanent(no, 0);
+    std::vector<int64_t> false_negatives;
+    Py_BEGIN_ALLOW_THREADS;
+    int64_t j = 0;
+    for (int64_t i = 0; i < no; ++i) {
+        while (j < nb && b[j] < o[i]) false_negatives.push_back(b[j++]);
+        bool in_biclique = j < nb && b[j] == o[i];
+        if (in_biclique) ++j;
+        permanent[i] = in_biclique || contains(s, ns, o[i]);
+    }
+    while (j < nb) false_negatives.push_back(b[j++]);
+    Py_END_ALLOW_THREADS;
+
+    PyObject *status = to_bytes(permanent);
+    PyObject *missing = to_bytes(false_negatives);
+    if (!status || !missing) {
+        Py_XDECREF(status);
+        Py_XDECREF(missing);
+        return nullptr;
+    }
+    return Py_BuildValue("(NN)", status, missing);
+}
+
+PyObject *py_edge_coverage_counts(PyObject *, PyObject *args) {
+    PyObject *graph_obj, *cell_obj;
+    if (!PyArg_ParseTuple(args, "OO", &graph_obj, &cell_obj)) return nullptr;
+    ArrayView graph_keys, cell_keys;
+    if (!graph_keys.open(graph_obj, 8, "graph_keys") || !cell_keys.open(cell_obj, 8, "cell_keys")) {
+        return nullptr;
+    }
+
+    const int64_t *g = graph_keys.data<int64_t>();
+    int64_t ng = graph_keys.size();
+    std::vector<int64_t> cells(cell_keys.data<int64_t>(),
+                               cell_keys.data<int64_t>() + cell_keys.size());
+    int64_t single = 0, multiple = 0, covered = 0;
+    Py_BEGIN_ALLOW_THREADS;
+    std::sort(cells.begin(), cells.end());
+    // graph_keys is sorted and unique: merge and count cell multiplicity
+    size_t c = 0;
+    for (int64_t i = 0; i < ng; ++i) {
+        while (c < cells.size() && cells[c] < g[i]) ++c;
+        size_t start = c;
+        while (c < cells.size() && cells[c] == g[i]) ++c;
+        size_t count = c - start;
+        if (count) {
+            ++covered;
+            if (count == 1) ++single; else ++multiple;
+        }
+    }
+    Py_END_ALLOW_THREADS;
+    return Py_BuildValue("(LLL)", static_cast<long long>(single),
+                         static_cast<long long>(multiple),
+                         static_cast<long long>(ng - covered));
+}
+
+// ---------------------------------------------------------------------------
+// Biclique file parsing
+// ---------------------------------------------------------------------------
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Mirror int(token) for ASCII tokens: optional sign, digits, single
+// underscores between digits. ``big`` is set when the value overflows int64
+// and the caller has to fall back to a Python int.
+bool parse_int(const std::string &token, int64_t *value, bool *big) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < token.size() && (token[i] == '+' || token[i] == '-')) negative = token[i++] == '-';
+    if (i >= token.size()) return false;
+    uint64_t acc = 0;
+    bool previous_digit = false;
+    *big = false;
+    for (; i < token.size(); ++i) {
+        char c = token[i];
+        if (c >= '0' && c <= '9') {
+            int64_t digit = c - '0';
+            if (acc > static_cast<uint64_t>((INT64_MAX - digit) / 10)) {
+                *big = true;  // keep scanning so malformed tokens are still rejected
+            } else if (!*big) {
+                acc = acc * 10 + digit;
+            }
+            previous_digit = true;
+        } else if (c == '_' && previous_digit && i + 1 < token.size()) {
+            previous_digit = false;
+        } else {
+            return false;
+        }
+    }
+    if (!previous_digit) return false;
+    *value = negative ? -static_cast<int64_t>(acc) : static_cast<int64_t>(acc);
+    return true;
+}
+
+PyObject *py_parse_biclique_lines(PyObject *, PyObject *args) {
+    PyObject *lines, *mapping;
+    Py_ssize_t start;
+    long long max_dmr_id;
+    if (!PyArg_ParseTuple(args, "O!nLO!", &PyList_Type, &lines, &start, &max_dmr_id,
+                          &PyDict_Type, &mapping)) {
+        return nullptr;
+    }
+
+    PyObject *bicliques = PyList_New(0);
+    PyObject *unknown = PyList_New(0);
+    if (!bicliques || !unknown) goto error;
+
+    for (Py_ssize_t line_idx = start; line_idx < PyList_GET_SIZE(lines); ++line_idx) {
+        PyObject *line = PyList_GET_ITEM(lines, line_idx);
+        Py_ssize_t length;
+        const char *text = PyUnicode_AsUTF8AndSize(line, &length);
+        if (!text) goto error;
+
+        PyObject *dmrs = PySet_New(nullptr);
+        PyObject *genes = PySet_New(nullptr);
+        if (!dmrs || !genes) {
+            Py_XDECREF(dmrs);
+            Py_XDECREF(genes);
+            goto error;
+        }
+
+        Py_ssize_t pos = 0;
+        bool failed = false;
+        while (pos < length && !failed) {
+            while (pos < length && is_space(text[pos])) ++pos;
+            Py_ssize_t end = pos;
+            bool ascii = true;
+            while (end < length && !is_space(text[end])) {
+                ascii &= static_cast<unsigned char>(text[end]) < 0x80;
+                ++end;
+            }
+            if (end == pos) break;
+            std::string token(text + pos, end - pos);
+            pos = end;
+
+            PyObject *key;
+            if (ascii) {
+                std::transform(token.begin(), token.end(), token.begin(), [](char c) {
+                    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+                });
+                int64_t value;
+                bool big;
+                if (parse_int(token, &value, &big)) {
+                    PyObject *number = big ? PyLong_FromString(token.c_str(), nullptr, 10)
+                                           : PyLong_FromLongLong(value);
+                    int below = -1;
+                    if (number) {
+                        PyObject *limit = PyLong_FromLongLong(max_dmr_id);
+                        below = limit ? PyObject_RichCompareBool(number, limit, Py_LT) : -1;
+                        Py_XDECREF(limit);
+                    }
+                    failed = below < 0 || (below && PySet_Add(dmrs, number) < 0);
+                    Py_XDECREF(number);
+                    continue;
+                }
+                key = PyUnicode_FromStringAndSize(token.data(), token.size());
+            } else {
+                // Leave Unicode digits and case folding to int() and str.lower()
+                PyObject *raw = PyUnicode_FromStringAndSize(token.data(), token.size());
+                key = raw ? PyObject_CallMethod(raw, "lower", nullptr) : nullptr;
+                Py_XDECREF(raw);
+                if (key) {
+                    PyObject *number = PyLong_FromUnicodeObject(key, 10);
+                    if (number) {
+                        PyObject *limit = PyLong_FromLongLong(max_dmr_id);
+                        int below = limit ? PyObject_RichCompareBool(number, limit, Py_LT) : -1;
+                        Py_XDECREF(limit);
+                        failed = below < 0 || (below && PySet_Add(dmrs, number) < 0);
+                        Py_DECREF(number);
+                        Py_DECREF(key);
+                        continue;
+                    }
+                    if (!PyErr_ExceptionMatches(PyExc_ValueError)) {
+                        failed = true;
+                        Py_DECREF(key);
+                        continue;
+                    }
+                    PyErr_Clear();
+                }
+            }
+            if (!key) {
+                failed = true;
+                break;
+            }
+            PyObject *gene_id = PyDict_GetItemWithError(mapping, key);
+            if (gene_id) {
+                failed = PySet_Add(genes, gene_id) < 0;
+            } else if (PyErr_Occurred()) {
+                failed = true;
+            } else {
+                failed = PyList_Append(unknown, key) < 0;
+            }
+            Py_DECREF(key);
+        }
+
+        if (!failed && PySet_GET_SIZE(dmrs) && PySet_GET_SIZE(genes)) {
+            PyObject *pair = PyTuple_Pack(2, dmrs, genes);
+            failed = !pair || PyList_Append(bicliques, pair) < 0;
+            Py_XDECREF(pair);
+        }
+        Py_DECREF(dmrs);
+        Py_DECREF(genes);
+        if (failed) goto error;
+    }
+    return Py_BuildValue("(NN)", bicliques, unknown);
+
+error:
+    Py_XDECREF(bicliques);
+    Py_XDECREF(unknown);
+    return nullptr;
+}
+
+PyMethodDef methods[] = {
+    {"rb_domination", py_rb_domination, METH_VARARGS,
+     "rb_domination(indptr, indices, is_gene, area, node_ids) -> bytes of int64 positions"},
+    {"connected_components", py_connected_components, METH_VARARGS,
+     "connected_components(indptr, indices) -> bytes of int64 labels"},
+    {"classify_edge_keys", py_classify_edge_keys, METH_VARARGS,
+     "classify_edge_keys(original, biclique, simple) -> (int8 permanent flags, int64 false "
+     "negative keys)"},
+    {"edge_coverage_counts", py_edge_coverage_counts, METH_VARARGS,
+     "edge_coverage_counts(graph_keys, cell_keys) -> (single, multiple, uncovered)"},
+    {"parse_biclique_lines", py_parse_biclique_lines, METH_VARARGS,
+     "parse_biclique_lines(lines, start, max_dmr_id, gene_id_mapping) -> (bicliques, "
+     "unknown gene tokens)"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef module = {
+    PyModuleDef_HEAD_INIT,
+    "_kernels",
+    "Native graph kernels for the DMR analysis backend.",
+    -1,
+    methods,
+    nullptr,  // m_slots
+    nullptr,  // m_traverse
+    nullptr,  // m_clear
+    nullptr,  // m_free
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit__kernels(void) { return PyModule_Create(&module); }
@@ -0,0 +1,109 @@
+# File : benchmark.py
+# Description : Native vs Python timings for the graph kernels
+"""
+Time each native kernel against its Python reference on a random graph.
+
+    python -m backend.app.native.benchmark --dmrs 20000 --genes 8000 --edges 60000
+"""
+
+import argparse
+import time
+from unittest import mock
+
+import networkx as nx
+import numpy as np
+import pandas as pd
+
+from backend.app import native
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.biclique_analysis.edge_classification import classify_edges
+from backend.app.biclique_analysis.reader import parse_bicliques
+from backend.app.biclique_analysis.statistics import calculate_edge_coverage
+from backend.app.core.graph_manager import ComponentMapping
+from backend.app.core.rb_domination import greedy_rb_domination
+
+
+def build_inputs(n_dmrs: int, n_genes: int, n_edges: int, n_bicliques: int, seed: int):
+    rng = np.random.default_rng(seed)
+    graph = nx.Graph()
+    graph.add_nodes_from(range(n_dmrs), bipartite=0)
+    graph.add_nodes_from(range(START_GENE_ID, START_GENE_ID + n_genes), bipartite=1)
+    graph.add_edges_from(
+        zip(
+            rng.integers(0, n_dmrs, n_edges).tolist(),
+            (START_GENE_ID + rng.integers(0, n_genes, n_edges)).tolist(),
+        )
+    )
+
+    bicliques = []
+    for _ in range(n_bicliques):
+        dmrs = rng.choice(n_dmrs, size=rng.integers(1, 6), replace=False)
+        genes = START_GENE_ID + rng.choice(n_genes, size=rng.integers(1, 8), replace=False)
+        bicliques.append((set(dmrs.tolist()), set(genes.tolist())))
+
+    biclique_graph = nx.Graph()
+    biclique_graph.add_nodes_from(graph.nodes(data=True))
+    for dmrs, genes in bicliques:
+        biclique_graph.add_edges_from((d, g) for d in dmrs for g in genes)
+
+    split_graph = graph.copy()
+    split_graph.remove_edges_from(list(graph.edges())[::4])
+
+    df = pd.DataFrame(
+        {"DMR_No.": np.arange(1, n_dmrs + 1), "Area_Stat": rng.random(n_dmrs)}
+    )
+    mapping = {f"gene_{i}": START_GENE_ID + i for i in range(n_genes)}
+    lines = ["# Clusters"] + [
+        " ".join([str(d) for d in dmrs] + [f"Gene_{g - START_GENE_ID}" for g in genes])
+        for dmrs, genes in bicliques
+    ]
+    return graph, split_graph, biclique_graph, bicliques, df, mapping, lines
+
+
+def best_of(repeat: int, fn) -> float:
+    timings = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        timings.append(time.perf_counter() - start)
+    return min(timings)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--dmrs", type=int, default=20000)
+    parser.add_argument("--genes", type=int, default=8000)
+    parser.add_argument("--edges", type=int, default=60000)
+    parser.add_argument("--bicliques", type=int, default=5000)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    if not native.available():
+        raise SystemExit("Native kernels are not built: cd backend && python setup.py build_ext --inplace")
+
+    graph, split_graph, biclique_graph, bicliques, df, mapping, lines = build_inputs(
+        args.dmrs, args.genes, args.edges, args.bicliques, args.seed
+    )
+    cases = {
+        "greedy_rb_domination": lambda: greedy_rb_domination(graph, df, "Area_Stat"),
+        "ComponentMapping": lambda: ComponentMapping(graph, split_graph),
+        "classify_edges": lambda: classify_edges(graph, biclique_graph, {}, bicliques),
+        "calculate_edge_coverage": lambda: calculate_edge_coverage(bicliques, graph),
+        "parse_bicliques": lambda: parse_bicliques(lines, args.dmrs, mapping),
+    }
+
+    results = []
+    for name, fn in cases.items():
+        native_time = best_of(args.repeat, fn)
+        with mock.patch.object(native, "_kernels", None):
+            python_time = best_of(args.repeat, fn)
+        results.append((name, python_time, native_time))
+
+    print(f"\n{'kernel':<26}{'python s':>12}{'native s':>12}{'speedup':>10}")
+    for name, python_time, native_time in results:
+        print(f"{name:<26}{python_time:>12.4f}{native_time:>12.4f}{python_time / native_time:>9.1f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,67 @@
+from flask import Blueprint, jsonify, current_app, request
+
+from ..database.analytics import DEFAULT_ROW_LIMIT, get_analytics_store
+from ..database.sql_sandbox import REJECTION_STATUS, SandboxRejection, get_sandbox
+
+analytics_bp = Blueprint("analytics_routes", __name__, url_prefix="/api/analytics")
+
+
+@analytics_bp.route("/schema", methods=["GET"])
+def get_analytics_schema():
+    """Schema description of the analytics snapshot, as given to the SQL agent."""
+    try:
+        store = get_analytics_store()
+        return jsonify(
+            {
+                "status": "success",
+                "snapshot": store.current_snapshot(),
+                "schema": store.schema_description(),
+            }
+        )
+    except FileNotFoundError as e:
+        return jsonify({"status": "error", "message": str(e)}), 404
+    except Exception as e:
+        current_app.logger.error(f"Error describing analytics schema: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@analytics_bp.route("/query", methods=["POST"])
+def run_analytics_query():
+    """
+    Run analytical SQL against the DuckDB snapshot instead of the serving DB.
+
+    Queries go through the SQL sandbox. A rejected query returns its
+    ``reason`` code and message so the caller can rewrite it and retry.
+    Concurrency is limited per client address. The client-supplied
+    X-User-Id header is not trusted for this, since a new value per request
+    would get around the limit.
+
+    Body: {"sql": "...", "params": [...], "row_limit": 1000}
+    """
+    data = request.get_json(silent=True) or {}
+    sql = data.get("sql")
+    if not isinstance(sql, str) or not sql.strip():
+        return jsonify({"status": "error", "message": "sql is required"}), 400
+    try:
+        row_limit = max(1, min(int(data.get("row_limit", DEFAULT_ROW_LIMIT)), DEFAULT_ROW_LIMIT))
+    except (TypeError, ValueError):
+        return jsonify({"status": "error", "message": "row_limit must be an integer"}), 400
+
+    user = request.remote_addr or "anonymous"
+    try:
+        result = get_sandbox().execute(sql, data.get("params"), user=user, row_limit=row_limit)
+        return jsonify(
+            {"status": "success", "snapshot": get_analytics_store().snapshot, **result}
+        )
+    except SandboxRejection as e:
+        current_app.logger.error(f"Analytics query rejected ({e.reason}): {e.message}")
+        return (
+            jsonify({"status": "error", "message": e.message, "rejection": e.to_dict()}),
+            REJECTION_STATUS.get(e.reason, 400),
+        )
+    except FileNotFoundError as e:
+        return jsonify({"status": "error", "message": str(e)}), 404
+    except Exception as e:
+        # Query errors go back to the caller so the agent can correct its SQL
+        current_app.logger.error(f"Analytics query failed: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 400
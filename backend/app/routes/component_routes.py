@@ -3,6 +3,7 @@ from flask import Blueprint, jsonify, request, current_app
 from ..biclique_analysis.edge_classification import classify_edges
 from pydantic import ValidationError
 from ..utils.id_mapping import reverse_create_dmr_id
+from ..core.datasets import get_graph_manager
 from ..schemas import (
     ComponentSummarySchema,
     ComponentDetailsSchema,
@@ -14,13 +15,22 @@ from ..schemas import (
     DominatingSetSchema,
     EdgeStatsSchema,
 )
-from ..utils.id_mapping import create_dmr_id
+from ..utils.id_mapping import create_dmr_id, convert_dmr_id
+from ..core.decomposition_index import KINDS, LEVELS, NONE
 from flask_cors import CORS
 from ..utils.extensions import app
 from ..database import get_db_engine, get_db_session
 from sqlalchemy.orm import Session
 from sqlalchemy import func, text
 from ..database.models import Timepoint
+from ..database.dialect import (
+    array_contains,
+    array_text,
+    distinct_string_agg,
+    json_array_agg,
+    json_object,
+    unnest,
+)
 from typing import List, Dict, Any
 
 component_bp = Blueprint("component_routes", __name__, url_prefix="/api/component")
@@ -30,16 +40,25 @@ component_bp = Blueprint("component_routes", __name__, url_prefix="/api/componen
 def parse_array_string(arr_str):
     if not arr_str:
         return []
+    if isinstance(arr_str, (list, tuple)):  # json columns on PostgreSQL
+        return [int(x) for x in arr_str]
     cleaned = arr_str.replace("[", "").replace("]", "").strip()
     return [int(x.strip()) for x in cleaned.split(",") if x.strip()]
 
 
+def parse_json_value(value):
+    """A JSON query column: text on SQLite, already decoded on PostgreSQL."""
+    if value is None:
+        return []
+    return json.loads(value) if isinstance(value, str) else value
+
+
 @component_bp.route("/components/<int:timepoint_id>/summary", methods=["GET"])
 def get_component_summary_by_timepoint(timepoint_id):
     app.logger.info(f"Processing summary request for timepoint_id={timepoint_id}")
     try:
         # Get graph manager and initialize mapping
-        graph_manager = current_app.graph_manager
+        graph_manager = get_graph_manager()
 
         # Load and validate graphs first
         original_graph = graph_manager.get_original_graph(timepoint_id)
@@ -95,7 +114,8 @@ def get_component_summary_by_timepoint(timepoint_id):
                 ), 404
 
             # Modified query to ensure all fields match the Pydantic model
-            query = text("""
+            categories = distinct_string_agg(engine.dialect.name, "b.category")
+            query = text(f"""
                 SELECT 
                     c.id as component_id,
                     c.timepoint_id,
@@ -108,7 +128,7 @@ def get_component_summary_by_timepoint(timepoint_id):
                     COALESCE(c.edge_count, 0) as edge_count,
                     COALESCE(c.density, 0.0) as density,
                     COALESCE(COUNT(DISTINCT cb.biclique_id), 0) as biclique_count,
-                    COALESCE(group_concat(DISTINCT b.category), '') as biclique_categories
+                    COALESCE({categories}, '') as biclique_categories
                 FROM components c
                 JOIN timepoints t ON c.timepoint_id = t.id
                 LEFT JOIN component_bicliques cb ON c.id = cb.component_id 
@@ -208,12 +228,30 @@ def get_component_details(timepoint_id, component_id):
     )
     try:
         # Get graph manager for later use
-        graph_manager = current_app.graph_manager
+        graph_manager = get_graph_manager()
 
         engine = get_db_engine()
         with Session(engine) as session:
             # Get the component details including bicliques
-            query = text("""
+            dialect = engine.dialect.name
+            biclique_json = json_object(
+                dialect,
+                {
+                    "biclique_id": "bi.biclique_id",
+                    "category": "bi.category",
+                    "dmr_ids": array_text(dialect, "bi.dmr_ids"),
+                    "gene_ids": array_text(dialect, "bi.gene_ids"),
+                },
+            )
+            dominating_json = json_object(
+                dialect,
+                {
+                    "dmr_id": "di.dmr_id",
+                    "dominated_gene_count": "di.dominated_gene_count",
+                    "utility_score": "di.utility_score",
+                },
+            )
+            query = text(f"""
             WITH component_info AS (
                 SELECT 
                     cd.timepoint_id,
@@ -250,42 +288,23 @@ def get_component_details(timepoint_id, component_id):
                     FROM dominating_sets ds
                     WHERE ds.timepoint_id = :timepoint_id
                     AND ds.dmr_id IN (
-                        SELECT CAST(trim(value) AS INTEGER)
-                        FROM json_each(
-                            CASE 
-                                WHEN json_valid((SELECT all_dmr_ids FROM component_info))
-                                THEN (SELECT all_dmr_ids FROM component_info)
-                                ELSE json_array((SELECT all_dmr_ids FROM component_info))
-                            END
-                        )
+                        SELECT m.value
+                        FROM bicliques b2, {unnest(dialect, "b2.dmr_ids", "m")}
+                        WHERE b2.component_id = :component_id
+                        AND b2.timepoint_id = :timepoint_id
                     )
                 )
                 SELECT 
                     ci.*,
-                    CASE 
-                        WHEN bi.biclique_id IS NULL THEN '[]'
-                        ELSE json_group_array(
-                            json_object(
-                                'biclique_id', bi.biclique_id,
-                                'category', bi.category,
-                                'dmr_ids', bi.dmr_ids,
-                                'gene_ids', bi.gene_ids
-                            )
-                        ) 
-                    END as bicliques,
                     (
-                        SELECT json_group_array(
-                            json_object(
-                                'dmr_id', dmr_id,
-                                'dominated_gene_count', dominated_gene_count,
-                                'utility_score', utility_score
-                            )
-                        )
-                        FROM dominating_info
+                        SELECT {json_array_agg(dialect, biclique_json)}
+                        FROM biclique_info bi
+                    ) as bicliques,
+                    (
+                        SELECT {json_array_agg(dialect, dominating_json)}
+                        FROM dominating_info di
                     ) as dominating_sets
                 FROM component_info ci
-                LEFT JOIN biclique_info bi ON ci.component_id = bi.component_id
-                GROUP BY ci.component_id
             """)
 
             result = session.execute(
@@ -345,7 +364,7 @@ def get_component_details(timepoint_id, component_id):
             edge_sources = {}  # Initialize empty edge sources dictionary
 
             # Parse bicliques JSON string to get table format
-            bicliques_data = json.loads(result.bicliques) if result.bicliques else []
+            bicliques_data = parse_json_value(result.bicliques)
             table_bicliques = [BicliqueMemberSchema(**b) for b in bicliques_data]
 
             # Convert table bicliques to raw networkx format
@@ -440,46 +459,36 @@ def get_component_details(timepoint_id, component_id):
                 f"Edge statistics for component {component_id}: {edge_stats}"
             )
 
-            # Get DMR metadata from graph manager
-            dmr_metadata = graph_manager.get_dmr_metadata(timepoint_id)
-
             # Calculate edge statistics for this specific component
             edge_sources = {}  # Initialize empty edge sources dictionary
             
             # Parse bicliques JSON string to get table format
-            bicliques_data = json.loads(result.bicliques) if result.bicliques else []
+            bicliques_data = parse_json_value(result.bicliques)
             table_bicliques = [BicliqueMemberSchema(**b) for b in bicliques_data]
             
             # Convert table bicliques to raw networkx format and track biclique IDs
             raw_bicliques = []
             biclique_edge_stats = []
-                        # Update dmr_metadata edge_type based on classifications
+            # Record edge types based on classifications
             updates = []
             for cls_type in ["permanent", "false_positive", "false_negative"]:
                 for edge_tuple in classification_result["classifications"].get(cls_type, []):
                     dmr_id, gene_id = edge_tuple
                     updates.append((dmr_id, gene_id, cls_type))
-                    if dmr_id in dmr_metadata:
-                        for rec in dmr_metadata[dmr_id]["edge_details"]:
-                            if rec.get("gene_id") == gene_id:
-                                rec["edge_type"] = cls_type
 
-            # Update edge details in database
+            # Update edge details in database and in the in-memory edge index
             from backend.app.database.operations import update_edge_details
 
             update_edge_details(timepoint_id, updates)
+            graph_manager.update_edit_types(timepoint_id, updates)
 
             try:
                 # Parse bicliques
-                bicliques_data = (
-                    json.loads(result.bicliques) if result.bicliques else []
-                )
+                bicliques_data = parse_json_value(result.bicliques)
                 bicliques = [BicliqueMemberSchema(**b) for b in bicliques_data]
 
                 # Parse dominating sets
-                dominating_sets_data = (
-                    json.loads(result.dominating_sets) if result.dominating_sets else []
-                )
+                dominating_sets_data = parse_json_value(result.dominating_sets)
                 dominating_sets = {
                     str(ds["dmr_id"]): DominatingSetSchema(**ds)
                     for ds in dominating_sets_data
@@ -508,11 +517,10 @@ def get_component_details(timepoint_id, component_id):
                 )
 
                 # Add DMR details summary
-                graph_manager = current_app.graph_manager
-                dmr_metadata = graph_manager.get_dmr_metadata(timepoint_id)
+                graph_manager = get_graph_manager()
+                edge_counts = graph_manager.get_edge_index(timepoint_id).dmr_edge_counts()
                 summary_lines = []
-                for dmr_id, meta in dmr_metadata.items():
-                    count = len(meta.get("edge_details", []))
+                for dmr_id, count in edge_counts.items():
                     summary_lines.append(
                         f"DMR_{dmr_id}: {count} edge{'s' if count != 1 else ''}"
                     )
@@ -547,7 +555,7 @@ def get_component_edge_stats(timepoint_id, component_id):
     )
     try:
         # Get graph manager for later use
-        graph_manager = current_app.graph_manager
+        graph_manager = get_graph_manager()
 
         # Get the component nodes
         engine = get_db_engine()
@@ -713,13 +721,14 @@ def get_gene_symbols():
         engine = get_db_engine()
         with Session(engine) as session:
             # Modified query to get genes through component_bicliques
-            query = text("""
+            gene_in_biclique = array_contains(engine.dialect.name, "b.gene_ids", "g.id")
+            query = text(f"""
                 WITH component_genes AS (
                     SELECT DISTINCT
                         g.id as gene_id,
                         COUNT(DISTINCT cb.biclique_id) as biclique_count
                     FROM genes g
-                    JOIN bicliques b ON instr(b.gene_ids, g.id) > 0
+                    JOIN bicliques b ON {gene_in_biclique}
                     JOIN component_bicliques cb ON b.id = cb.biclique_id
                     WHERE cb.component_id = :component_id
                     AND cb.timepoint_id = :timepoint_id
@@ -793,20 +802,14 @@ def get_gene_annotations():
 
         engine = get_db_engine()
         with Session(engine) as session:
-            # Modified query for SQLite using json_each to split the array
-            query = text("""
-                WITH RECURSIVE split(gene_id, rest) AS (
-                    SELECT '', all_gene_ids || ',' FROM component_details_view 
-                    WHERE timepoint_id = :timepoint_id AND component_id = :component_id
-                    UNION ALL
-                    SELECT substr(rest, 0, instr(rest, ',')),
-                           substr(rest, instr(rest, ',') + 1)
-                    FROM split WHERE rest <> ''
-                ),
-                component_genes AS (
-                    SELECT CAST(gene_id AS INTEGER) as gene_id 
-                    FROM split 
-                    WHERE gene_id <> ''
+            # Genes of the component: every gene of its bicliques
+            gene_element = unnest(engine.dialect.name, "b.gene_ids", "m")
+            query = text(f"""
+                WITH component_genes AS (
+                    SELECT DISTINCT m.value AS gene_id
+                    FROM bicliques b, {gene_element}
+                    WHERE b.timepoint_id = :timepoint_id
+                    AND b.component_id = :component_id
                 )
                 SELECT 
                     g.id as gene_id,
@@ -984,6 +987,7 @@ def get_component_details_by_timepoint(timepoint_id):
         engine = get_db_engine()
 
         with Session(engine) as session:
+            # all_dmr_ids / all_gene_ids are already distinct JSON arrays in the view
             query = text("""
                 SELECT 
                     cd.timepoint_id,
@@ -993,10 +997,8 @@ def get_component_details_by_timepoint(timepoint_id):
                     cd.categories,
                     cd.total_dmr_count,
                     cd.total_gene_count,
-                    (SELECT json_group_array(DISTINCT value) 
-                     FROM json_each(cd.all_dmr_ids)) AS all_dmr_ids,
-                    (SELECT json_group_array(DISTINCT value) 
-                     FROM json_each(cd.all_gene_ids)) AS all_gene_ids
+                    cd.all_dmr_ids,
+                    cd.all_gene_ids
                 FROM component_details_view cd
                 WHERE cd.timepoint_id = :timepoint_id 
                 AND LOWER(cd.graph_type) = 'split'
@@ -1019,12 +1021,8 @@ def get_component_details_by_timepoint(timepoint_id):
                     "categories": row.categories,
                     "total_dmr_count": row.total_dmr_count,
                     "total_gene_count": row.total_gene_count,
-                    "all_dmr_ids": row.all_dmr_ids.split(",")
-                    if row.all_dmr_ids
-                    else [],
-                    "all_gene_ids": row.all_gene_ids.split(",")
-                    if row.all_gene_ids
-                    else [],
+                    "all_dmr_ids": parse_array_string(row.all_dmr_ids),
+                    "all_gene_ids": parse_array_string(row.all_gene_ids),
                 }
                 try:
                     # Validate with Pydantic
@@ -1040,3 +1038,98 @@ def get_component_details_by_timepoint(timepoint_id):
 
     except Exception as e:
         return jsonify({"status": "error", "message": str(e)}), 500
+
+
+def _hierarchy_node(index, timepoint_id: int, position: int, depth: int = 0) -> Dict:
+    """A decomposition hierarchy node with table DMR ids, and its subtree to ``depth``."""
+    node = index.describe(position)
+    dmrs = set(node["dmrs"])
+
+    def table_id(n):
+        return convert_dmr_id(n, timepoint_id) if n in dmrs else n
+
+    node["dmrs"] = [table_id(n) for n in node["dmrs"]]
+    node["separators"] = [table_id(n) for n in node["separators"]]
+    node["link_nodes"] = [table_id(n) for n in node["link_nodes"]]
+    if depth > 0:
+        node["children"] = [
+            _hierarchy_node(index, timepoint_id, int(child), depth - 1)
+            for child in index.children(position)
+        ]
+    return node
+
+
+def _hierarchy_summary(index, position: int) -> Dict:
+    source_id = int(index.source_id[position])
+    return {
+        "position": int(position),
+        "level": LEVELS[index.level[position]],
+        "kind": KINDS[index.kind[position]],
+        "source_id": None if source_id == NONE else source_id,
+    }
+
+
+@component_bp.route("/<int:timepoint_id>/<int:component_id>/hierarchy", methods=["GET"])
+def get_component_hierarchy(timepoint_id, component_id):
+    """Blocks, SPQR nodes and bicliques of an original graph component."""
+    try:
+        depth = request.args.get("depth", default=3, type=int)
+        index = get_graph_manager().get_decomposition_index(timepoint_id)
+        if index is None:
+            return jsonify(
+                {"status": "error", "message": f"No graph for timepoint {timepoint_id}"}
+            ), 404
+        position = index.find("component", component_id)
+        if position is None:
+            return jsonify(
+                {
+                    "status": "error",
+                    "message": f"Component {component_id} not in the decomposition of timepoint {timepoint_id}",
+                }
+            ), 404
+        return jsonify(
+            {"status": "success", "data": _hierarchy_node(index, timepoint_id, position, depth)}
+        )
+    except Exception as e:
+        app.logger.error(f"Error getting component hierarchy: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@component_bp.route("/<int:timepoint_id>/hierarchy/<int:position>", methods=["GET"])
+def get_hierarchy_node(timepoint_id, position):
+    """One hierarchy node with its ancestors and children, for drilling down."""
+    try:
+        index = get_graph_manager().get_decomposition_index(timepoint_id)
+        if index is None or not 0 <= position < index.num_nodes:
+            return jsonify(
+                {"status": "error", "message": f"No hierarchy node {position}"}
+            ), 404
+        node = _hierarchy_node(index, timepoint_id, position)
+        node["ancestors"] = [_hierarchy_summary(index, p) for p in index.ancestors(position)]
+        node["children"] = [_hierarchy_summary(index, p) for p in index.children(position)]
+        return jsonify({"status": "success", "data": node})
+    except Exception as e:
+        app.logger.error(f"Error getting hierarchy node: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@component_bp.route("/<int:timepoint_id>/hierarchy/dmr/<int:dmr_id>", methods=["GET"])
+def get_dmr_hierarchy(timepoint_id, dmr_id):
+    """Every hierarchy node containing a DMR (table id), outermost first."""
+    try:
+        index = get_graph_manager().get_decomposition_index(timepoint_id)
+        if index is None:
+            return jsonify(
+                {"status": "error", "message": f"No graph for timepoint {timepoint_id}"}
+            ), 404
+        raw_id = reverse_create_dmr_id(dmr_id, timepoint_id)
+        positions = sorted(int(p) for p in index.containing(raw_id))
+        return jsonify(
+            {
+                "status": "success",
+                "data": [_hierarchy_summary(index, p) for p in positions],
+            }
+        )
+    except Exception as e:
+        app.logger.error(f"Error getting DMR hierarchy: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
@@ -0,0 +1,76 @@
+from flask import Blueprint, jsonify, current_app, request
+
+from ..core.datasets import activate
+
+dataset_bp = Blueprint("dataset_routes", __name__, url_prefix="/api/datasets")
+
+
+@dataset_bp.route("", methods=["GET"])
+def list_datasets():
+    """Configured datasets with their load state and graph memory use."""
+    try:
+        registry = current_app.datasets
+        return jsonify(
+            {
+                "status": "success",
+                "data": [registry.get(name).status() for name in registry.names()],
+            }
+        )
+    except Exception as e:
+        current_app.logger.error(f"Error listing datasets: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@dataset_bp.route("/reload", methods=["POST"])
+def reload_datasets():
+    """Re-read the dataset manifest now instead of on its next change."""
+    try:
+        current_app.datasets.refresh(force=True)
+        return jsonify({"status": "success", "data": current_app.datasets.names()})
+    except ValueError as e:
+        return jsonify({"status": "error", "message": str(e)}), 400
+    except Exception as e:
+        current_app.logger.error(f"Error reloading datasets: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@dataset_bp.route("/<string:dataset>/status", methods=["GET"])
+def get_dataset_status(dataset):
+    try:
+        return jsonify({"status": "success", "data": current_app.datasets.get(dataset).status()})
+    except KeyError:
+        return jsonify({"status": "error", "message": f"Unknown dataset {dataset}"}), 404
+
+
+@dataset_bp.route("/<string:dataset>/unload", methods=["POST"])
+def unload_dataset(dataset):
+    """Free a dataset's graphs and caches; they are rebuilt on its next request."""
+    unloaded = current_app.datasets.unload(dataset)
+    return jsonify({"status": "success", "data": {"dataset": dataset, "unloaded": unloaded}})
+
+
+@dataset_bp.route("/<string:dataset>/<path:subpath>", methods=["GET", "POST"])
+def dispatch_dataset_route(dataset, subpath):
+    """
+    Serve /api/datasets/<dataset>/<subpath> with the /api/<subpath> route,
+    scoped to the dataset's database, graphs, caches and analytics snapshot.
+    """
+    try:
+        scoped = current_app.datasets.get(dataset)
+    except KeyError:
+        return jsonify({"status": "error", "message": f"Unknown dataset {dataset}"}), 404
+
+    adapter = current_app.url_map.bind_to_environ(request.environ)
+    # Raises NotFound / MethodNotAllowed like any unmatched request
+    endpoint, args = adapter.match(f"/api/{subpath}", method=request.method)
+    if endpoint.startswith(f"{dataset_bp.name}."):
+        return jsonify({"status": "error", "message": "Datasets cannot be nested"}), 404
+
+    try:
+        scoped.graph_manager  # first request: read the dataset's timepoints
+    except Exception as e:
+        current_app.logger.error(f"Error opening dataset {dataset}: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 503
+
+    with activate(scoped):
+        return current_app.view_functions[endpoint](**args)
@@ -0,0 +1,201 @@
+from flask import Blueprint, jsonify, current_app, request, send_file
+
+from ..utils.cpu_profiler import admin_authorized
+from ..utils.memory_accounting import DEFAULT_DIFF_LIMIT, DEFAULT_TRACE_FRAMES, memory_report
+
+debug_bp = Blueprint("debug_routes", __name__, url_prefix="/debug")
+
+
+def get_profiler():
+    """The SQL profiler, or None when it is disabled or the caller is not an admin."""
+    profiler = current_app.extensions.get("sql_profiler")
+    if profiler is None or not admin_authorized(current_app.config.get("SQL_PROFILE_TOKEN")):
+        return None
+    return profiler
+
+
+def get_cpu_profiler():
+    """The CPU profiler, or None when it is disabled or the caller is not an admin."""
+    profiler = current_app.extensions.get("cpu_profiler")
+    if profiler is None or not profiler.authorized():
+        return None
+    return profiler
+
+
+@debug_bp.route("/requests", methods=["GET"])
+def list_request_profiles():
+    """Most recent profiled requests, newest first."""
+    profiler = get_profiler()
+    if profiler is None:
+        return jsonify({"status": "error", "message": "SQL profiling is disabled"}), 404
+    limit = request.args.get("limit", 50, type=int)
+    return jsonify({"status": "success", "requests": profiler.recent(limit)})
+
+
+@debug_bp.route("/requests/<string:request_id>", methods=["GET"])
+def get_request_profile(request_id):
+    """Full SQL profile of one request, by its X-SQL-Profile-Id."""
+    profiler = get_profiler()
+    if profiler is None:
+        return jsonify({"status": "error", "message": "SQL profiling is disabled"}), 404
+    profile = profiler.get(request_id)
+    if profile is None:
+        return jsonify({"status": "error", "message": "Unknown request id"}), 404
+    return jsonify({"status": "success", "data": profile})
+
+
+@debug_bp.route("/profiles", methods=["GET"])
+def list_cpu_profiles():
+    """Stored CPU profiles, newest first."""
+    profiler = get_cpu_profiler()
+    if profiler is None:
+        return jsonify({"status": "error", "message": "CPU profiling is disabled"}), 404
+    limit = request.args.get("limit", 50, type=int)
+    return jsonify({"status": "success", "profiles": profiler.store.recent(limit)})
+
+
+@debug_bp.route("/profiles/<string:profile_id>", methods=["GET"])
+def get_cpu_profile(profile_id):
+    """Speedscope file of one request, by its X-CPU-Profile-Id."""
+    profiler = get_cpu_profiler()
+    if profiler is None:
+        return jsonify({"status": "error", "message": "CPU profiling is disabled"}), 404
+    path = profiler.store.profile_path(profile_id)
+    if path is None:
+        return jsonify({"status": "error", "message": "Unknown profile id"}), 404
+    return send_file(
+        path,
+        mimetype="application/json",
+        as_attachment=request.args.get("download", type=int) == 1,
+        download_name=f"{profile_id}.speedscope.json",
+    )
+
+
+@debug_bp.route("/profiles/<string:profile_id>/summary", methods=["GET"])
+def get_cpu_profile_summary(profile_id):
+    """Request details and the functions with the most self time."""
+    profiler = get_cpu_profiler()
+    if profiler is None:
+        return jsonify({"status": "error", "message": "CPU profiling is disabled"}), 404
+    meta = profiler.store.meta(profile_id)
+    if meta is None:
+        return jsonify({"status": "error", "message": "Unknown profile id"}), 404
+    return jsonify({"status": "success", "data": meta})
+
+
+def get_snapshot_store():
+    """The snapshot store, or None when it is disabled or the caller is not an admin."""
+    store = current_app.extensions.get("memory_snapshots")
+    if store is None or not admin_authorized(current_app.config.get("MEMORY_DEBUG_TOKEN")):
+        return None
+    return store
+
+
+def _loaded_graph_managers():
+    """GraphManager of every loaded dataset (just the app's one without a registry)."""
+    registry = getattr(current_app, "datasets", None)
+    if registry is None:
+        manager = getattr(current_app, "graph_manager", None)
+        return {"default": manager} if manager is not None else {}
+    managers = {}
+    for name in registry.names():
+        dataset = registry.get(name)
+        if dataset.loaded:
+            managers[name] = dataset.graph_manager
+    return managers
+
+
+def _group_by():
+    group_by = request.args.get("group_by", "lineno")
+    if group_by not in ("lineno", "filename", "traceback"):
+        raise ValueError(f"Unknown group_by {group_by}")
+    return group_by
+
+
+@debug_bp.route("/memory", methods=["GET"])
+def get_memory_report():
+    """
+    Bytes per dataset, timepoint and structure, per cache, and for the process.
+
+    ``?deep=0`` estimates NetworkX graphs from their size instead of walking them.
+    """
+    store = get_snapshot_store()
+    if store is None:
+        return jsonify({"status": "error", "message": "Memory debugging is disabled"}), 404
+    try:
+        deep = request.args.get("deep", "1").lower() not in ("0", "false", "no")
+        report = memory_report(_loaded_graph_managers(), deep=deep)
+        report["tracemalloc"] = store.status()
+        return jsonify({"status": "success", "data": report})
+    except Exception as e:
+        current_app.logger.error(f"Error building memory report: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@debug_bp.route("/memory/tracemalloc", methods=["POST"])
+def control_tracemalloc():
+    """Start (``action=start``, optional ``frames``) or stop (``action=stop``) tracing."""
+    store = get_snapshot_store()
+    if store is None:
+        return jsonify({"status": "error", "message": "Memory debugging is disabled"}), 404
+    action = request.args.get("action", "start")
+    if action == "start":
+        frames = request.args.get("frames", DEFAULT_TRACE_FRAMES, type=int)
+        return jsonify({"status": "success", "data": store.start(max(1, frames))})
+    if action == "stop":
+        return jsonify({"status": "success", "data": store.stop()})
+    return jsonify({"status": "error", "message": f"Unknown action {action}"}), 400
+
+
+@debug_bp.route("/memory/snapshots", methods=["GET", "POST"])
+def memory_snapshots():
+    """List snapshots, or take one (POST, optional ``label``)."""
+    store = get_snapshot_store()
+    if store is None:
+        return jsonify({"status": "error", "message": "Memory debugging is disabled"}), 404
+    if request.method == "GET":
+        return jsonify({"status": "success", "data": store.status()["snapshots"]})
+    try:
+        return jsonify({"status": "success", "data": store.take(request.args.get("label"))})
+    except RuntimeError as e:
+        return jsonify({"status": "error", "message": str(e)}), 409
+
+
+@debug_bp.route("/memory/snapshots/<int:snapshot_id>", methods=["GET"])
+def get_memory_snapshot(snapshot_id):
+    """Largest allocation sites of one snapshot."""
+    store = get_snapshot_store()
+    if store is None:
+        return jsonify({"status": "error", "message": "Memory debugging is disabled"}), 404
+    try:
+        limit = request.args.get("limit", DEFAULT_DIFF_LIMIT, type=int)
+        return jsonify({"status": "success", "data": store.top(snapshot_id, _group_by(), limit)})
+    except KeyError:
+        return jsonify({"status": "error", "message": "Unknown snapshot id"}), 404
+    except ValueError as e:
+        return jsonify({"status": "error", "message": str(e)}), 400
+
+
+@debug_bp.route("/memory/snapshots/<int:old_id>/diff/<string:new_id>", methods=["GET"])
+def diff_memory_snapshots(old_id, new_id):
+    """
+    Allocation growth from one snapshot to another.
+
+    ``new_id`` may be ``now`` to take a fresh snapshot and diff against it.
+    """
+    store = get_snapshot_store()
+    if store is None:
+        return jsonify({"status": "error", "message": "Memory debugging is disabled"}), 404
+    try:
+        group_by = _group_by()
+        limit = request.args.get("limit", DEFAULT_DIFF_LIMIT, type=int)
+        if new_id == "now":
+            new_id = store.take("now")["id"]
+        diff = store.diff(old_id, int(new_id), group_by, limit)
+        return jsonify({"status": "success", "data": diff})
+    except KeyError:
+        return jsonify({"status": "error", "message": "Unknown snapshot id"}), 404
+    except RuntimeError as e:
+        return jsonify({"status": "error", "message": str(e)}), 409
+    except ValueError as e:
+        return jsonify({"status": "error", "message": str(e)}), 400
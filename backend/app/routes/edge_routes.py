@@ -1,41 +1,105 @@
-from flask import Blueprint, jsonify, current_app
+from flask import Blueprint, jsonify, current_app, request
 from typing import List, Dict, Any
+import numpy as np
 from sqlalchemy import select
 from sqlalchemy.orm import Session
 
 from ..database.models import EdgeDetails, Gene
 from ..database.connection import get_db_engine
+from ..core.datasets import get_graph_manager
 
 edge_bp = Blueprint('edge_routes', __name__)
 
+# Keep each IN (...) list under SQLite's default bound-parameter limit
+EDGE_BATCH_CHUNK = 900
+
+
+def query_edge_details(
+    db: Session, timepoint_id: int, key_column, ids: List[int], with_description=True
+) -> List[Dict[str, Any]]:
+    """
+    Edge details of many DMRs or genes of a timepoint, gene symbols joined in.
+
+    Args:
+        db: Open session
+        timepoint_id: Timepoint to read
+        key_column: EdgeDetails.dmr_id or EdgeDetails.gene_id
+        ids: Ids to match against key_column
+        with_description: Include the free-text description; without it the
+            rows are read from the (timepoint_id, dmr_id/gene_id) covering index
+    """
+    columns = [
+        EdgeDetails.dmr_id,
+        EdgeDetails.gene_id,
+        Gene.symbol.label("gene_symbol"),
+        EdgeDetails.edge_type,
+        EdgeDetails.edit_type,
+        EdgeDetails.distance_from_tss,
+    ]
+    if with_description:
+        columns.append(EdgeDetails.description)
+
+    result = []
+    ids = sorted(set(ids))
+    for start in range(0, len(ids), EDGE_BATCH_CHUNK):
+        stmt = (
+            select(*columns)
+            .outerjoin(Gene, Gene.id == EdgeDetails.gene_id)
+            .where(
+                EdgeDetails.timepoint_id == timepoint_id,
+                key_column.in_(ids[start:start + EDGE_BATCH_CHUNK]),
+            )
+            .order_by(key_column)
+        )
+        result.extend(dict(row._mapping) for row in db.execute(stmt))
+    return result
+
+
+def lookup_edge_details(
+    timepoint_id: int, key: str, ids: List[int], with_description=True
+) -> List[Dict[str, Any]]:
+    """
+    Edge details of DMRs (key "dmr_id") or genes (key "gene_id").
+
+    Served from the GraphManager's in-memory edge index when the app has one,
+    otherwise read from the database.
+    """
+    graph_manager = get_graph_manager()
+    if graph_manager is None:
+        key_column = EdgeDetails.dmr_id if key == "dmr_id" else EdgeDetails.gene_id
+        engine = get_db_engine()
+        with Session(engine) as db:
+            return query_edge_details(
+                db, timepoint_id, key_column, ids, with_description
+            )
+
+    index = graph_manager.get_edge_index(timepoint_id)
+    rows_of = index.dmr_rows if key == "dmr_id" else index.gene_rows
+    row_lists = [rows_of(i) for i in sorted(set(ids))]
+    edges = index.records(np.concatenate(row_lists)) if row_lists else []
+    if not with_description:
+        for edge in edges:
+            del edge["description"]
+    return edges
+
+
+def group_edges(edges: List[Dict[str, Any]], key: str) -> Dict[str, List[Dict[str, Any]]]:
+    grouped = {}
+    for edge in edges:
+        grouped.setdefault(str(edge[key]), []).append(edge)
+    return grouped
+
+
 @edge_bp.route("/timepoint/<int:timepoint_id>/dmr/<int:dmr_id>")
 def get_dmr_edge_details(timepoint_id: int, dmr_id: int):
     """Get edge details for a specific DMR in a timepoint."""
     try:
-        engine = get_db_engine()
-        with Session(engine) as db:
-            edges = db.query(EdgeDetails).filter(
-                EdgeDetails.timepoint_id == timepoint_id,
-                EdgeDetails.dmr_id == dmr_id
-            ).all()
-
-            if not edges:
-                return jsonify({"status": "error", "message": "No edge details found"}), 404
-
-            result = []
-            for edge in edges:
-                gene = db.get(Gene, edge.gene_id)
-                result.append({
-                    "dmr_id": edge.dmr_id,
-                    "gene_id": edge.gene_id,
-                    "gene_symbol": gene.symbol if gene else None,
-                    "edge_type": edge.edge_type,
-                    "edit_type": edge.edit_type,
-                    "distance_from_tss": edge.distance_from_tss,
-                    "description": edge.description
-                })
-
-            return jsonify({"status": "success", "edges": result})
+        result = lookup_edge_details(timepoint_id, "dmr_id", [dmr_id])
+
+        if not result:
+            return jsonify({"status": "error", "message": "No edge details found"}), 404
+
+        return jsonify({"status": "success", "edges": result})
 
     except Exception as e:
         current_app.logger.error(f"Error getting DMR edge details: {str(e)}")
@@ -45,32 +109,45 @@ def get_dmr_edge_details(timepoint_id: int, dmr_id: int):
 def get_gene_edge_details(timepoint_id: int, gene_id: int):
     """Get edge details for a specific gene in a timepoint."""
     try:
-        engine = get_db_engine()
-        with Session(engine) as db:
-            edges = db.query(EdgeDetails).filter(
-                EdgeDetails.timepoint_id == timepoint_id,
-                EdgeDetails.gene_id == gene_id
-            ).all()
-
-            if not edges:
-                return jsonify({"status": "error", "message": "No edge details found"}), 404
-
-            result = []
-            for edge in edges:
-                gene = db.get(Gene, edge.gene_id)
-                result.append({
-                    "dmr_id": edge.dmr_id,
-                    "gene_id": edge.gene_id,
-                    "gene_symbol": gene.symbol if gene else None,
-                    "edge_type": edge.edge_type,
-                    "edit_type": edge.edit_type,
-                    "distance_from_tss": edge.distance_from_tss,
-                    "description": edge.description
-                })
-
-            return jsonify({"status": "success", "edges": result})
+        result = lookup_edge_details(timepoint_id, "gene_id", [gene_id])
+
+        if not result:
+            return jsonify({"status": "error", "message": "No edge details found"}), 404
+
+        return jsonify({"status": "success", "edges": result})
 
     except Exception as e:
         current_app.logger.error(f"Error getting gene edge details: {str(e)}")
         return jsonify({"status": "error", "message": str(e)}), 500
 
+@edge_bp.route("/timepoint/<int:timepoint_id>/batch", methods=["POST"])
+def get_batch_edge_details(timepoint_id: int):
+    """
+    Get edge details for many DMRs or genes of a timepoint in one request.
+
+    Body: {"dmr_ids": [...]} or {"gene_ids": [...]}. The response maps each
+    requested id that has edges to its list of edges; descriptions are left
+    out so a database lookup stays on the covering index.
+    """
+    try:
+        data = request.get_json(silent=True) or {}
+        if "dmr_ids" in data:
+            key, ids = "dmr_id", data["dmr_ids"]
+        elif "gene_ids" in data:
+            key, ids = "gene_id", data["gene_ids"]
+        else:
+            return jsonify(
+                {"status": "error", "message": "Provide dmr_ids or gene_ids"}
+            ), 400
+
+        try:
+            ids = [int(i) for i in ids]
+        except (TypeError, ValueError):
+            return jsonify({"status": "error", "message": "Ids must be integers"}), 400
+
+        edges = lookup_edge_details(timepoint_id, key, ids, with_description=False)
+        return jsonify({"status": "success", "edges": group_edges(edges, key)})
+
+    except Exception as e:
+        current_app.logger.error(f"Error getting batch edge details: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
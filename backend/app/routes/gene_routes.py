@@ -1,7 +1,10 @@
-from flask import Blueprint, jsonify, current_app
+import io
+
+from flask import Blueprint, jsonify, current_app, request, send_file
 from sqlalchemy.orm import Session
 from ..database.connection import get_db_engine
 from ..database.models import GeneDetails
+from ..database.trajectories import get_gene_trajectory, trajectory_frame
 
 gene_bp = Blueprint("gene_routes", __name__, url_prefix="/api/genes")
 
@@ -25,3 +28,47 @@ def get_gene_details(gene_id: int):
     except Exception as e:
         current_app.logger.error(f"Error retrieving gene details: {str(e)}")
         return jsonify({"error": "Internal server error", "status": 500}), 500
+
+
+@gene_bp.route("/<int:gene_id>/trajectory", methods=["GET"])
+def get_trajectory(gene_id: int):
+    """A gene's degree, component size, bicliques, status and dominating DMRs per timepoint."""
+    try:
+        with Session(get_db_engine()) as session:
+            trajectory = get_gene_trajectory(session, gene_id)
+        if trajectory is None:
+            return jsonify(
+                {"status": "error", "message": f"No trajectory for gene {gene_id}"}
+            ), 404
+        return jsonify({"status": "success", "data": trajectory})
+    except Exception as e:
+        current_app.logger.error(f"Error retrieving gene trajectory: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@gene_bp.route("/trajectories/export", methods=["GET"])
+def export_trajectories():
+    """The gene x timepoint matrix of all genes, as ?format=csv (default) or parquet."""
+    fmt = request.args.get("format", "csv")
+    if fmt not in ("csv", "parquet"):
+        return jsonify({"status": "error", "message": "format must be csv or parquet"}), 400
+    try:
+        with Session(get_db_engine()) as session:
+            frame = trajectory_frame(session)
+        buffer = io.BytesIO()
+        if fmt == "parquet":
+            frame.to_parquet(buffer, index=False)
+            mimetype = "application/vnd.apache.parquet"
+        else:
+            buffer.write(frame.to_csv(index=False).encode())
+            mimetype = "text/csv"
+        buffer.seek(0)
+        return send_file(
+            buffer,
+            mimetype=mimetype,
+            as_attachment=True,
+            download_name=f"gene_trajectories.{fmt}",
+        )
+    except Exception as e:
+        current_app.logger.error(f"Error exporting gene trajectories: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
@@ -1,5 +1,7 @@
 import json
 import time
+import threading
+from collections import OrderedDict
 from flask import jsonify, current_app, Blueprint
 
 # from backend.app.database.models import EdgeDetails, Gene
@@ -7,7 +9,7 @@ from typing import Dict
 from plotly.utils import PlotlyJSONEncoder
 
 from sqlalchemy.orm import Session
-from sqlalchemy import text
+from sqlalchemy import bindparam, text
 import networkx as nx
 
 from pydantic import ValidationError
@@ -19,6 +21,8 @@ from ..schemas import (
     #    DmrAnnotationViewSchema,
 )
 from ..database.connection import get_db_engine
+from ..database.dialect import array_text, json_array_agg, json_object
+from ..core.datasets import current_dataset_name, get_graph_manager
 
 # from ..visualization.core import create_biclique_visualization
 # from ..visualization.graph_layout_biclique import CircularBicliqueLayout
@@ -55,6 +59,46 @@ def parse_id_string(id_str):
 
 graph_bp = Blueprint("graph_routes", __name__, url_prefix="/api/graph")
 
+# Rendered component graphs only change when the database is rebuilt, so keep
+# the most recent ones in memory (shared by every route that renders them).
+# Each dataset has its own cache so one cohort's traffic cannot evict another's.
+RENDER_CACHE_SIZE = 64
+_render_caches: Dict[str, OrderedDict] = {}
+_render_cache_lock = threading.Lock()
+
+
+def get_cached_render(timepoint_id: int, component_id: int):
+    """Return a previously rendered component graph, or None."""
+    key = (timepoint_id, component_id)
+    with _render_cache_lock:
+        cache = _render_caches.get(current_dataset_name())
+        if cache is None or key not in cache:
+            return None
+        cache.move_to_end(key)
+        return cache[key]
+
+
+def cache_render(timepoint_id: int, component_id: int, vis_dict: Dict):
+    """Store a rendered component graph, evicting the least recently used."""
+    with _render_cache_lock:
+        cache = _render_caches.setdefault(current_dataset_name(), OrderedDict())
+        cache[(timepoint_id, component_id)] = vis_dict
+        cache.move_to_end((timepoint_id, component_id))
+        while len(cache) > RENDER_CACHE_SIZE:
+            cache.popitem(last=False)
+
+
+def clear_render_cache(dataset: str = None):
+    """
+    Drop cached renders of a dataset (all by default). Registered with
+    DatasetRegistry.on_reset, so publishing or unloading a dataset clears it.
+    """
+    with _render_cache_lock:
+        if dataset is None:
+            _render_caches.clear()
+        else:
+            _render_caches.pop(dataset, None)
+
 
 @graph_bp.route("/<int:timepoint_id>/<int:component_id>", methods=["GET"])
 def get_component_graph(timepoint_id, component_id):
@@ -63,6 +107,10 @@ def get_component_graph(timepoint_id, component_id):
         f"Fetching graph for timepoint={timepoint_id}, component={component_id}"
     )
 
+    cached = get_cached_render(timepoint_id, component_id)
+    if cached is not None:
+        return jsonify(cached)
+
     try:
         # Get timepoint name from database
         engine = get_db_engine()
@@ -101,7 +149,7 @@ def get_component_graph(timepoint_id, component_id):
             all_component_nodes = raw_dmr_ids.union(all_gene_ids)
 
             # Get component subgraphs directly from graph manager
-            graph_manager = current_app.graph_manager
+            graph_manager = get_graph_manager()
             original_graph_component = graph_manager.get_original_graph_component(
                 timepoint_id, all_component_nodes
             )
@@ -219,28 +267,34 @@ def get_component_graph(timepoint_id, component_id):
                 "Graph validation passed - bipartite structure maintained"
             )
 
-            # Get component data
+            # Get component data; JSON columns are cast to text on every backend
+            dialect = session.get_bind().dialect.name
+            biclique_json = json_object(
+                dialect,
+                {
+                    "biclique_id": "b.id",
+                    "category": "b.category",
+                    "dmr_ids": array_text(dialect, "b.dmr_ids"),
+                    "gene_ids": array_text(dialect, "b.gene_ids"),
+                },
+            )
             query = text(
-                """
+                f"""
                 SELECT 
                     c.component_id,
                     c.timepoint_id,
-                    c.all_dmr_ids as dmr_ids,
-                    c.all_gene_ids as gene_ids,
+                    CAST(c.all_dmr_ids AS TEXT) as dmr_ids,
+                    CAST(c.all_gene_ids AS TEXT) as gene_ids,
                     c.graph_type,
                     c.categories, 
-                    (
-                        SELECT json_group_array(
-                            json_object(
-                                'biclique_id', b.id,
-                                'category', b.category,
-                                'dmr_ids', b.dmr_ids,
-                                'gene_ids', b.gene_ids
-                            )
-                        )
-                        FROM bicliques b
-                        WHERE b.component_id = c.component_id
-                        AND b.timepoint_id = c.timepoint_id
+                    COALESCE(
+                        (
+                            SELECT CAST({json_array_agg(dialect, biclique_json)} AS TEXT)
+                            FROM bicliques b
+                            WHERE b.component_id = c.component_id
+                            AND b.timepoint_id = c.timepoint_id
+                        ),
+                        '[]'
                     ) as bicliques
                 FROM component_details_view c
                 WHERE c.timepoint_id = :timepoint_id 
@@ -644,25 +698,13 @@ def get_component_graph(timepoint_id, component_id):
                     SELECT ds.dmr_id
                     FROM dominating_sets ds
                     WHERE ds.timepoint_id = :timepoint_id
-                    AND ds.dmr_id IN (
-                        SELECT CAST(trim(value) AS INTEGER)
-                        FROM json_each(
-                            CASE 
-                                WHEN json_valid(:dmr_ids)
-                                THEN :dmr_ids
-                                ELSE json_array(:dmr_ids)
-                            END
-                        )
-                    )
+                    AND ds.dmr_id IN :dmr_ids
                 """
-                )
-
-                # Get the DMR IDs as a JSON array string
-                dmr_ids_json = json.dumps(list(final_dmrs))
+                ).bindparams(bindparam("dmr_ids", expanding=True))
 
                 dominating_set_results = session.execute(
                     dominating_set_query,
-                    {"timepoint_id": timepoint_id, "dmr_ids": dmr_ids_json},
+                    {"timepoint_id": timepoint_id, "dmr_ids": [int(d) for d in final_dmrs]},
                 ).fetchall()
 
                 dominating_set = {int(row.dmr_id) for row in dominating_set_results}
@@ -850,6 +892,7 @@ def get_component_graph(timepoint_id, component_id):
             converted = convert_plotly_object(vis_dict)
             if converted is None:
                 converted = vis_dict
+            cache_render(timepoint_id, component_id, converted)
             return jsonify(converted)
 
     except Exception as e:
@@ -860,4 +903,4 @@ def get_component_graph(timepoint_id, component_id):
                 "details": str(e) if current_app.debug else "Internal server error",
                 "status": 500,
             }
-        )
+        ), 500
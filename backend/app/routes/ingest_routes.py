@@ -0,0 +1,111 @@
+import json
+import os
+import threading
+
+from flask import Blueprint, jsonify, current_app, request, Response, stream_with_context
+from werkzeug.utils import secure_filename
+
+from ..core.ingest_jobs import TERMINAL_STATUSES, IngestManager
+
+ingest_bp = Blueprint("ingest_routes", __name__, url_prefix="/api/ingest")
+
+# Seconds between keep-alive comments on an idle event stream
+EVENT_KEEPALIVE_S = 15
+
+_manager_lock = threading.Lock()
+
+
+def get_ingest_manager() -> IngestManager:
+    """The app's ingest manager, created on first use."""
+    with _manager_lock:
+        manager = getattr(current_app, "ingest_manager", None)
+        if manager is None:
+            root = os.getenv(
+                "INGEST_DIR", os.path.join(current_app.config.get("DATA_DIR", "./data"), "ingest")
+            )
+            manager = IngestManager(
+                root,
+                current_app.datasets,
+                max_workers=int(os.getenv("INGEST_WORKERS", "1")),
+            )
+            current_app.ingest_manager = manager
+        return manager
+
+
+@ingest_bp.route("/jobs", methods=["POST"])
+def create_ingest_job():
+    """
+    Upload workbooks and queue a job that rebuilds and publishes a dataset.
+
+    Multipart form: ``dataset`` (name), ``dss1`` and ``dss_pairwise``
+    workbooks, and optionally ``files`` (gene mapping, bipartite graph and
+    biclique files, kept under their own names).
+    """
+    uploads = {}
+    for field, name in (("dss1", "DSS1.xlsx"), ("dss_pairwise", "DSS_PAIRWISE.xlsx")):
+        if field in request.files:
+            uploads[name] = request.files[field]
+    for upload in request.files.getlist("files"):
+        uploads[secure_filename(upload.filename or "")] = upload
+
+    try:
+        job = get_ingest_manager().submit(request.form.get("dataset", ""), uploads)
+        return jsonify({"status": "success", "data": job.to_dict()}), 202
+    except ValueError as e:
+        return jsonify({"status": "error", "message": str(e)}), 400
+    except Exception as e:
+        current_app.logger.error(f"Error creating ingest job: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@ingest_bp.route("/jobs", methods=["GET"])
+def list_ingest_jobs():
+    jobs = get_ingest_manager().list(request.args.get("dataset"))
+    return jsonify({"status": "success", "data": [job.to_dict() for job in jobs]})
+
+
+@ingest_bp.route("/jobs/<string:job_id>", methods=["GET"])
+def get_ingest_job(job_id):
+    """Status, current stage and per-stage timings of a job."""
+    job = get_ingest_manager().get(job_id)
+    if job is None:
+        return jsonify({"status": "error", "message": "Job not found"}), 404
+    return jsonify({"status": "success", "data": job.to_dict()})
+
+
+@ingest_bp.route("/jobs/<string:job_id>/cancel", methods=["POST"])
+def cancel_ingest_job(job_id):
+    manager = get_ingest_manager()
+    if manager.get(job_id) is None:
+        return jsonify({"status": "error", "message": "Job not found"}), 404
+    if not manager.cancel(job_id):
+        return jsonify({"status": "error", "message": "Job has already finished"}), 409
+    return jsonify({"status": "success", "data": manager.get(job_id).to_dict()})
+
+
+@ingest_bp.route("/jobs/<string:job_id>/events", methods=["GET"])
+def stream_ingest_job(job_id):
+    """Server-sent events with the job record on every change, until it finishes."""
+    manager = get_ingest_manager()
+    if manager.get(job_id) is None:
+        return jsonify({"status": "error", "message": "Job not found"}), 404
+
+    def events():
+        version = -1
+        while True:
+            job = manager.wait(job_id, version, timeout=EVENT_KEEPALIVE_S)
+            if job is None:
+                return
+            if job.version == version:
+                yield ": keep-alive\n\n"
+                continue
+            version = job.version
+            yield f"data: {json.dumps(job.to_dict())}\n\n"
+            if job.status in TERMINAL_STATUSES:
+                return
+
+    return Response(
+        stream_with_context(events()),
+        mimetype="text/event-stream",
+        headers={"Cache-Control": "no-cache", "X-Accel-Buffering": "no"},
+    )
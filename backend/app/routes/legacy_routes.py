@@ -0,0 +1,102 @@
+"""Compatibility routes for clients of the old root-level app_db.py server.
+
+The legacy server exposed components by their global ``components.id`` and
+returned bare JSON bodies. These routes keep those URLs and response shapes,
+but answer them from the main app's pooled engine, SQL-side counts and the
+graph route's render cache instead of a separate Flask app.
+"""
+
+from flask import Blueprint, jsonify, current_app
+from sqlalchemy import text
+from sqlalchemy.orm import Session
+
+from ..database.connection import get_db_engine
+from ..database.dialect import array_length
+from .graph_routes import get_component_graph
+
+legacy_bp = Blueprint("legacy_routes", __name__, url_prefix="/api")
+
+
+@legacy_bp.route("/timepoint/<int:timepoint_id>/components", methods=["GET"])
+def get_timepoint_components(timepoint_id):
+    """Get components for a specific timepoint."""
+    engine = get_db_engine()
+    with Session(engine) as session:
+        rows = session.execute(
+            text(
+                """
+                SELECT id, graph_type, category, size, dmr_count,
+                       gene_count, edge_count, density
+                FROM components
+                WHERE timepoint_id = :timepoint_id
+                """
+            ),
+            {"timepoint_id": timepoint_id},
+        ).fetchall()
+        return jsonify([dict(row._mapping) for row in rows])
+
+
+@legacy_bp.route("/component/<int:component_id>", methods=["GET"])
+def get_component(component_id):
+    """Get detailed information about a specific component."""
+    engine = get_db_engine()
+    with Session(engine) as session:
+        component = session.execute(
+            text(
+                """
+                SELECT id, graph_type, category, size, dmr_count,
+                       gene_count, edge_count, density
+                FROM components
+                WHERE id = :component_id
+                """
+            ),
+            {"component_id": component_id},
+        ).first()
+        if not component:
+            return jsonify({"error": "Component not found"}), 404
+
+        # Count array members in SQL rather than decoding every biclique row
+        dialect_name = engine.dialect.name
+        bicliques = session.execute(
+            text(
+                f"""
+                SELECT id, category,
+                       COALESCE({array_length(dialect_name, "dmr_ids")}, 0) AS dmr_count,
+                       COALESCE({array_length(dialect_name, "gene_ids")}, 0) AS gene_count
+                FROM bicliques
+                WHERE component_id = :component_id
+                ORDER BY id
+                """
+            ),
+            {"component_id": component_id},
+        ).fetchall()
+
+        result = dict(component._mapping)
+        result["bicliques"] = [dict(b._mapping) for b in bicliques]
+        return jsonify(result)
+
+
+@legacy_bp.route("/component/<int:component_id>/visualization", methods=["GET"])
+def get_component_visualization(component_id):
+    """Get visualization data for a component addressed by its global id."""
+    try:
+        engine = get_db_engine()
+        with Session(engine) as session:
+            timepoint_id = session.execute(
+                text("SELECT timepoint_id FROM components WHERE id = :component_id"),
+                {"component_id": component_id},
+            ).scalar()
+        if timepoint_id is None:
+            return jsonify({"error": "Component not found"}), 404
+
+        response = get_component_graph(timepoint_id, component_id)
+        status = 200
+        if isinstance(response, tuple):
+            response, status = response
+        if status != 200:
+            return response, status
+
+        return jsonify({"visualization": response.get_json()})
+    except Exception as e:
+        current_app.logger.error(f"Error in legacy visualization route: {str(e)}")
+        return jsonify({"error": str(e)}), 500
@@ -3,6 +3,8 @@ import os
 import json
 from pathlib import Path
 
+from ..database.analytics import get_analytics_store
+
 llm_bp = Blueprint('llm', __name__, url_prefix='/api/llm')
 
 # Sample data for development
@@ -22,7 +24,7 @@ def create_error_response(message, status_code=500, details=None, error_type=Non
         "status": status_code,
         "error_type": error_type or "UnknownError"
     }
-    if details and app_config.get('DEBUG', False):
+    if details and current_app.config.get('DEBUG', False):
         response["details"] = str(details)
     return jsonify(response), status_code
 
@@ -44,7 +46,7 @@ def list_prompts():
 def get_prompt(prompt_id):
     """Get a specific prompt by ID"""
     try:
-        prompt = prompt_manager.get_prompt(prompt_id)
+        prompt = SAMPLE_PROMPTS[prompt_id]
         return jsonify({
             'status': 'success',
             'prompt': prompt
@@ -91,35 +93,29 @@ def analyze_data():
     if not data or 'prompt_id' not in data:
         return create_error_response('No prompt ID provided', 400, error_type='ValidationError')
     
+    prompt = SAMPLE_PROMPTS.get(data['prompt_id'])
+    if prompt is None:
+        return create_error_response(
+            f"Unknown prompt {data['prompt_id']}", 404, error_type='ValidationError'
+        )
+    parameters = dict(data.get('parameters') or {})
+    
     try:
-        # Load and validate prompt XML
-        prompt = prompt_manager.get_prompt(data['prompt_id'])
-        parameters = data.get('parameters', {})
-        
-        # Add schema information if needed
+        # Add schema information if needed; generated SQL runs on the analytics snapshot
         if data.get('include_schema', False):
-            schema_info = db_utils.get_schema_info()
-            parameters['schema'] = schema_info
-        
-        # Process the prompt with provided parameters
-        processed_prompt = prompt_manager.process_prompt(prompt, parameters)
-        
-        # Get response from LLM
-        response = mcp_client.analyze(
-            prompt=processed_prompt,
-            provider=data.get('provider', llm_config.get('DEFAULT_PROVIDER', 'openai')),
-            model=data.get('model', llm_config.get('DEFAULT_MODEL', 'gpt-3.5-turbo')),
-            max_tokens=llm_config.get('MAX_TOKENS', 2000)
-        )
+            parameters['schema'] = get_analytics_store().schema_description()
         
+        # Mock response for development
         return jsonify({
             'status': 'success',
-            'analysis': response
+            'analysis': {
+                'prompt': prompt,
+                'parameters': parameters,
+                'model': data.get('model', 'gpt-3.5-turbo')
+            }
         })
-    except XMLParseError as e:
-        return create_error_response('Invalid prompt XML format', 400, e, 'XMLError')
-    except ValueError as e:
-        return create_error_response(str(e), 400, e, 'ValidationError')
+    except FileNotFoundError as e:
+        return create_error_response(str(e), 503, e, 'SnapshotError')
     except Exception as e:
         return create_error_response('Analysis failed', 500, e, 'ProcessingError')
 
@@ -0,0 +1,93 @@
+from flask import Blueprint, jsonify, current_app, send_file, Response
+import json
+import os
+
+from ..core.datasets import get_graph_data_dir
+from ..visualization.overview_tiles import OVERVIEW_METADATA_FILE, get_tile_path
+
+overview_bp = Blueprint("overview_routes", __name__, url_prefix="/api/overview")
+
+# Tile URLs carry the build id, so a URL always names the same bytes
+TILE_CACHE_CONTROL = "public, max-age=86400, immutable"
+
+
+def get_overview_root() -> str:
+    """Root directory holding the per-timepoint overview tiles."""
+    return os.path.join(get_graph_data_dir(), "overview")
+
+
+# metadata path -> (mtime, metadata), reread when a rebuild replaces the file
+_metadata_cache = {}
+
+
+def load_overview_metadata(timepoint_id):
+    """The overview.json of a timepoint, or None if no overview is built."""
+    metadata_path = os.path.join(
+        get_overview_root(), str(timepoint_id), OVERVIEW_METADATA_FILE
+    )
+    try:
+        mtime = os.stat(metadata_path).st_mtime_ns
+    except FileNotFoundError:
+        return None
+    cached = _metadata_cache.get(metadata_path)
+    if cached is None or cached[0] != mtime:
+        with open(metadata_path) as f:
+            metadata = json.load(f)
+        # Builds written before build ids existed are told apart by mtime
+        metadata.setdefault("build_id", str(mtime))
+        cached = (mtime, metadata)
+        _metadata_cache[metadata_path] = cached
+    return cached[1]
+
+
+@overview_bp.route("/<int:timepoint_id>/metadata", methods=["GET"])
+def get_overview_metadata(timepoint_id):
+    """Get the canvas size, zoom range and tile index of a timepoint overview."""
+    try:
+        metadata = load_overview_metadata(timepoint_id)
+        if metadata is None:
+            return jsonify(
+                {
+                    "status": "error",
+                    "message": f"No overview tiles built for timepoint {timepoint_id}",
+                }
+            ), 404
+        return jsonify({"status": "success", "data": metadata})
+    except Exception as e:
+        current_app.logger.error(f"Error reading overview metadata: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@overview_bp.route(
+    "/<int:timepoint_id>/tiles/<string:build_id>/<int:z>/<int:x>/<int:y>", methods=["GET"]
+)
+def get_overview_tile(timepoint_id, build_id, z, x, y):
+    """
+    Serve a precomputed, gzip-compressed overview tile as-is.
+
+    ``build_id`` comes from the metadata; tiles of any other build are gone.
+    """
+    metadata = load_overview_metadata(timepoint_id)
+    if metadata is None:
+        return jsonify(
+            {
+                "status": "error",
+                "message": f"No overview tiles built for timepoint {timepoint_id}",
+            }
+        ), 404
+    if build_id != metadata["build_id"]:
+        return jsonify(
+            {
+                "status": "error",
+                "message": f"Overview build {build_id} was replaced; reload the metadata",
+            }
+        ), 404
+    tile_path = get_tile_path(os.path.join(get_overview_root(), str(timepoint_id)), z, x, y)
+    if f"{z}/{x}/{y}" not in metadata["tiles"] or not os.path.exists(tile_path):
+        # Empty regions of the quadtree are never written
+        return Response(status=204)
+
+    response = send_file(tile_path, mimetype="application/json", conditional=True)
+    response.headers["Content-Encoding"] = "gzip"
+    response.headers["Cache-Control"] = TILE_CACHE_CONTROL
+    return response
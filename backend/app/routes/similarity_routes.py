@@ -0,0 +1,81 @@
+from flask import Blueprint, jsonify, current_app, request
+import os
+import time
+
+from ..biclique_analysis.node_embeddings import (
+    BICLIQUE,
+    DMR,
+    GENE,
+    KINDS_BY_NAME,
+    get_similarity_index,
+)
+from ..core.datasets import get_graph_data_dir
+from ..utils.id_mapping import convert_dmr_id, reverse_create_dmr_id
+
+similarity_bp = Blueprint("similarity_routes", __name__, url_prefix="/api/similarity")
+
+MAX_K = 200
+
+
+def get_embedding_root() -> str:
+    """Root directory holding the per-timepoint embedding indexes."""
+    return os.path.join(get_graph_data_dir(), "embeddings")
+
+
+@similarity_bp.route("/<int:timepoint_id>/similar/<int:node_id>", methods=["GET"])
+def get_similar(timepoint_id, node_id):
+    """
+    Most similar DMRs, genes or bicliques to a node.
+
+    DMRs are table ids, as in every other route; the index holds original
+    graph node ids, so they are translated both ways here.
+
+    Query parameters:
+        k: number of results (default 10, at most 200)
+        type: only return "dmr", "gene" or "biclique" items
+        source: "biclique" when node_id is a biclique id
+    """
+    index = get_similarity_index(os.path.join(get_embedding_root(), str(timepoint_id)))
+    if index is None:
+        return jsonify(
+            {
+                "status": "error",
+                "message": f"No similarity index built for timepoint {timepoint_id}",
+            }
+        ), 404
+
+    item_type = request.args.get("type")
+    if item_type is not None and item_type not in KINDS_BY_NAME:
+        return jsonify({"status": "error", "message": f"Unknown type {item_type}"}), 400
+    k = min(max(request.args.get("k", 10, type=int), 1), MAX_K)
+    source_kind = BICLIQUE if request.args.get("source") == "biclique" else None
+
+    try:
+        started = time.perf_counter()
+        query_id = node_id
+        if source_kind is None:
+            source_kind = GENE if index.row(node_id, GENE) is not None else DMR
+            if source_kind == DMR:
+                query_id = reverse_create_dmr_id(node_id, timepoint_id)
+        results = index.similar(
+            query_id, k, KINDS_BY_NAME.get(item_type), source_kind=source_kind
+        )
+        if results is None:
+            return jsonify(
+                {"status": "error", "message": f"Node {node_id} is not in the index"}
+            ), 404
+        for result in results:
+            if result["type"] == "dmr":
+                result["id"] = convert_dmr_id(result["id"], timepoint_id)
+        return jsonify(
+            {
+                "status": "success",
+                "data": results,
+                "elapsed_ms": round((time.perf_counter() - started) * 1000, 3),
+            }
+        )
+    except ValueError as e:
+        return jsonify({"status": "error", "message": str(e)}), 404
+    except Exception as e:
+        current_app.logger.error(f"Error in similarity search: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
@@ -0,0 +1,118 @@
+from flask import Blueprint, jsonify, current_app
+from sqlalchemy import text
+from sqlalchemy.orm import Session
+
+from ..database.connection import get_db_engine
+from ..database.models import Timepoint
+from ..database.operations import load_timepoint_statistics
+
+statistics_bp = Blueprint("statistics_routes", __name__)
+
+
+def get_component_lists(session: Session, timepoint_id: int):
+    """Interesting and complex components of a timepoint, as the stats tabs list them."""
+    rows = session.execute(
+        text(
+            """
+            SELECT id, graph_type, category, size,
+                   dmr_count AS dmrs, gene_count AS genes
+            FROM components
+            WHERE timepoint_id = :timepoint_id
+            AND category IN ('interesting', 'complex')
+            ORDER BY size DESC
+            """
+        ),
+        {"timepoint_id": timepoint_id},
+    ).fetchall()
+    components = [dict(row._mapping) for row in rows]
+    return (
+        [c for c in components if c["category"] == "interesting"],
+        [c for c in components if c["category"] == "complex"],
+    )
+
+
+def timepoint_statistics_response(session: Session, timepoint_id: int):
+    stats = load_timepoint_statistics(session, timepoint_id)
+    if not stats:
+        return jsonify(
+            {
+                "status": "error",
+                "message": f"No statistics computed for timepoint {timepoint_id}",
+            }
+        ), 404
+
+    interesting, complex_components = get_component_lists(session, timepoint_id)
+    return jsonify(
+        {
+            "status": "success",
+            "data": {
+                "stats": stats,
+                "interesting_components": interesting,
+                "complex_components": complex_components,
+                "bicliques": stats.get("graph_info", {}).get("total_bicliques", 0),
+            },
+        }
+    )
+
+
+@statistics_bp.route("/api/statistics/timepoint/<int:timepoint_id>", methods=["GET"])
+def get_timepoint_statistics(timepoint_id):
+    """Serve the precomputed statistics of a timepoint."""
+    try:
+        engine = get_db_engine()
+        with Session(engine) as session:
+            return timepoint_statistics_response(session, timepoint_id)
+    except Exception as e:
+        current_app.logger.error(f"Error loading timepoint statistics: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@statistics_bp.route("/stats/timepoint/<string:timepoint_name>", methods=["GET"])
+def get_timepoint_statistics_by_name(timepoint_name):
+    """Loader used by the tabs in templates/statistics.html."""
+    try:
+        engine = get_db_engine()
+        with Session(engine) as session:
+            timepoint = (
+                session.query(Timepoint.id)
+                .filter(
+                    (Timepoint.name == timepoint_name)
+                    | (Timepoint.sheet_name == timepoint_name)
+                )
+                .first()
+            )
+            if timepoint is None:
+                return jsonify(
+                    {"status": "error", "message": "Timepoint not found"}
+                ), 404
+            return timepoint_statistics_response(session, timepoint.id)
+    except Exception as e:
+        current_app.logger.error(f"Error loading timepoint statistics: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
+
+
+@statistics_bp.route("/api/statistics/overall", methods=["GET"])
+def get_overall_statistics():
+    """Totals across all timepoints, summed from the stored per-timepoint rows."""
+    try:
+        engine = get_db_engine()
+        with Session(engine) as session:
+            timepoint_ids = [t.id for t in session.query(Timepoint.id).all()]
+            totals = {"total_dmrs": 0, "total_genes": 0, "total_edges": 0}
+            computed = 0
+            for timepoint_id in timepoint_ids:
+                graph_info = load_timepoint_statistics(session, timepoint_id).get(
+                    "graph_info"
+                )
+                if not graph_info:
+                    continue
+                computed += 1
+                for key in totals:
+                    totals[key] += graph_info.get(key, 0)
+
+            totals["timepoint_count"] = len(timepoint_ids)
+            totals["timepoints_with_statistics"] = computed
+            return jsonify({"status": "success", "data": totals})
+    except Exception as e:
+        current_app.logger.error(f"Error loading overall statistics: {str(e)}")
+        return jsonify({"status": "error", "message": str(e)}), 500
@@ -0,0 +1,88 @@
+import io
+
+from flask import Blueprint, jsonify, current_app, request, send_file, url_for
+from sqlalchemy.orm import Session
+
+from ..database.connection import get_db_engine
+from ..core.datasets import get_graph_manager, scoped_url
+from ..database.models import Timepoint
+
+timepoint_bp = Blueprint("timepoint_routes", __name__, url_prefix="/api/timepoints")
+
+GRAPH_TYPES = ("original", "split")
+
+
+@timepoint_bp.route("/<int:timepoint_id>", methods=["GET"])
+def get_timepoint(timepoint_id):
+    """Get a timepoint with summary statistics of its graphs.
+
+    Node and edge data is never embedded here; clients that need the whole
+    graph download the binary arrays from the ``graph`` endpoint.
+    """
+    engine = get_db_engine()
+    with Session(engine) as session:
+        timepoint = session.get(Timepoint, timepoint_id)
+        if timepoint is None:
+            return jsonify({"error": "Timepoint not found"}), 404
+
+        response_data = {
+            "id": timepoint.id,
+            "name": timepoint.name,
+            "description": timepoint.description,
+            "graphs": None,
+            "downloads": {
+                graph_type: scoped_url(
+                    url_for(
+                        "timepoint_routes.get_timepoint_graph",
+                        timepoint_id=timepoint_id,
+                        type=graph_type,
+                    )
+                )
+                for graph_type in GRAPH_TYPES
+            },
+        }
+
+    try:
+        response_data["graphs"] = get_graph_manager().get_timepoint_graph_summary(
+            timepoint_id
+        )
+    except Exception as e:
+        current_app.logger.error(f"Error summarising graphs: {str(e)}")
+        # Don't fail the whole request if graph data is unavailable
+        response_data["graph_error"] = str(e)
+
+    return jsonify(response_data)
+
+
+@timepoint_bp.route("/<int:timepoint_id>/graph", methods=["GET"])
+def get_timepoint_graph(timepoint_id):
+    """Download a timepoint graph as binary CSR arrays.
+
+    See core/graph_arrays.py for the layout. Range requests are honoured so a
+    client can read the header and section table first and then fetch only
+    the sections it needs.
+    """
+    graph_type = request.args.get("type", "original")
+    if graph_type not in GRAPH_TYPES:
+        return jsonify({"error": f"Unknown graph type: {graph_type}"}), 400
+
+    try:
+        graph_manager = get_graph_manager()
+        data = graph_manager.get_graph_array_bytes(timepoint_id, graph_type)
+        etag = graph_manager.get_graph_array_etag(timepoint_id, graph_type)
+    except Exception as e:
+        current_app.logger.error(f"Error building graph arrays: {str(e)}")
+        return jsonify({"error": str(e)}), 500
+    if data is None:
+        return jsonify({"error": "Graph not loaded for timepoint"}), 404
+
+    response = send_file(
+        io.BytesIO(data),
+        mimetype="application/octet-stream",
+        as_attachment=True,
+        download_name=f"timepoint_{timepoint_id}_{graph_type}.dmrg",
+        conditional=True,
+        etag=etag,
+        max_age=3600,
+    )
+    return response
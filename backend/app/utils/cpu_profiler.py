@@ -0,0 +1,462 @@
+"""Opt-in per-request CPU profiling.
+
+When enabled (``CPU_PROFILE=true`` and a ``CPU_PROFILE_TOKEN`` is set), a
+request with ``?profile=cpu`` or an ``X-Profile: cpu`` header, plus the token
+in ``X-Admin-Token``, runs under a profiler. Two modes are available:
+
+* ``cpu`` (alias ``sample``): a helper thread snapshots the request thread's
+  Python stack every ``CPU_PROFILE_INTERVAL_MS``. Overhead is small, so
+  timings are close to an unprofiled request. Time spent in C code (SQLite,
+  pydantic-core, numpy) is charged to the Python frame that called it.
+* ``trace``: every Python and C call is recorded with ``sys.setprofile``.
+  The timeline is exact, but the request runs several times slower, so use
+  it for call structure rather than absolute numbers.
+
+Each profile is written as a speedscope file (open it at
+https://www.speedscope.app or with ``speedscope <file>``) into
+``CPU_PROFILE_DIR``. That directory is bounded by ``CPU_PROFILE_HISTORY``
+files and ``CPU_PROFILE_MAX_MB``, oldest first. Responses link to the file
+through ``X-CPU-Profile-*`` headers, and ``routes/debug_routes.py`` serves
+profiles and their top-function summaries under ``/debug/profiles``. Only the
+view itself is profiled: the body of a streamed response is produced after
+the profile has been closed.
+"""
+
+import hmac
+import json
+import os
+import re
+import sys
+import threading
+import time
+import uuid
+from typing import Dict, List, Optional, Tuple
+
+from flask import g, request, jsonify
+
+import logging
+
+logger = logging.getLogger(__name__)
+
+
+def admin_authorized(token: Optional[str]) -> bool:
+    """Whether the request carries ``token`` in X-Admin-Token (never without a token)."""
+    if not token:
+        return False
+    supplied = request.headers.get("X-Admin-Token", "")
+    return hmac.compare_digest(supplied.encode(), token.encode())
+
+DEFAULT_INTERVAL_MS = 5.0
+DEFAULT_HISTORY = 50
+DEFAULT_MAX_MB = 200
+DEFAULT_MAX_ACTIVE = 2
+DEFAULT_MAX_EVENTS = 2_000_000
+SUMMARY_FUNCTIONS = 15
+
+MODES = {"cpu": "sample", "sample": "sample", "trace": "trace"}
+SPEEDSCOPE_SCHEMA = "https://www.speedscope.app/file-format-schema.json"
+PROFILE_SUFFIX = ".speedscope.json"
+META_SUFFIX = ".meta.json"
+
+_PROFILE_ID = re.compile(r"^[0-9a-f]{12}$")
+
+
+class FrameTable:
+    """Speedscope's shared frame list, one entry per distinct function."""
+
+    def __init__(self):
+        self.frames: List[Dict] = []
+        self._index: Dict[Tuple, int] = {}
+
+    def _add(self, key: Tuple, frame: Dict) -> int:
+        index = self._index.get(key)
+        if index is None:
+            index = self._index[key] = len(self.frames)
+            self.frames.append(frame)
+        return index
+
+    def code(self, code) -> int:
+        return self._add(
+            (code.co_filename, code.co_firstlineno, code.co_qualname),
+            {"name": code.co_qualname, "file": code.co_filename, "line": code.co_firstlineno},
+        )
+
+    def builtin(self, func) -> int:
+        module = getattr(func, "__module__", None) or ""
+        name = getattr(func, "__qualname__", None) or repr(func)
+        full_name = f"{module}.{name}" if module else name
+        return self._add(("<builtin>", full_name), {"name": full_name, "file": "<builtin>"})
+
+
+class StackSampler:
+    """Samples one thread's Python stack from a helper thread."""
+
+    mode = "sample"
+
+    def __init__(self, thread_id: int, interval_ms: float = DEFAULT_INTERVAL_MS):
+        self.thread_id = thread_id
+        self.interval_s = interval_ms / 1000
+        self.table = FrameTable()
+        self.samples: List[List[int]] = []
+        self.weights: List[float] = []
+        self._stop = threading.Event()
+        self._thread = threading.Thread(target=self._run, name="cpu-profile-sampler", daemon=True)
+
+    def start(self) -> None:
+        self.started = self._last = time.perf_counter()
+        self._thread.start()
+
+    def stop(self) -> None:
+        self._stop.set()
+        self._thread.join()
+        self.ended = time.perf_counter()
+
+    def _run(self) -> None:
+        while not self._stop.wait(self.interval_s):
+            self._sample()
+
+    def _sample(self) -> None:
+        frame = sys._current_frames().get(self.thread_id)
+        now = time.perf_counter()
+        stack = []
+        while frame is not None:
+            stack.append(self.table.code(frame.f_code))
+            frame = frame.f_back
+        del frame
+        if stack:
+            stack.reverse()
+            self.samples.append(stack)
+            # Wall time since the last sample; late wake-ups (GIL) are weighted up
+            self.weights.append((now - self._last) * 1000)
+        self._last = now
+
+    def to_speedscope_profile(self, name: str) -> Dict:
+        return {
+            "type": "sampled",
+            "name": name,
+            "unit": "milliseconds",
+            "startValue": 0,
+            "endValue": (self.ended - self.started) * 1000,
+            "samples": self.samples,
+            "weights": self.weights,
+        }
+
+    def function_times(self) -> Tuple[Dict[int, float], Dict[int, float]]:
+        """Self and inclusive milliseconds per frame index."""
+        self_ms: Dict[int, float] = {}
+        total_ms: Dict[int, float] = {}
+        for stack, weight in zip(self.samples, self.weights):
+            self_ms[stack[-1]] = self_ms.get(stack[-1], 0.0) + weight
+            for index in set(stack):
+                total_ms[index] = total_ms.get(index, 0.0) + weight
+        return self_ms, total_ms
+
+
+class CallTracer:
+    """Records every call and return on the current thread via sys.setprofile."""
+
+    mode = "trace"
+
+    def __init__(self, max_events: int = DEFAULT_MAX_EVENTS):
+        self.max_events = max_events
+        self.table = FrameTable()
+        self.events: List[Dict] = []
+        self.truncated = False
+        self._open: List[int] = []
+        self._end_at: Optional[float] = None
+
+    def start(self) -> None:
+        self.started = time.perf_counter()
+        sys.setprofile(self._hook)
+
+    def stop(self) -> None:
+        sys.setprofile(None)
+        self.ended = time.perf_counter()
+        at = self._end_at if self._end_at is not None else (self.ended - self.started) * 1000
+        while self._open:
+            self.events.append({"type": "C", "frame": self._open.pop(), "at": at})
+
+    def _hook(self, frame, event, arg) -> None:
+        at = (time.perf_counter() - self.started) * 1000
+        if event in ("return", "c_return", "c_exception"):
+            # Frames entered before start() return into an empty stack
+            if self._open:
+                self.events.append({"type": "C", "frame": self._open.pop(), "at": at})
+            return
+        if event == "call":
+            index = self.table.code(frame.f_code)
+        elif event == "c_call":
+            index = self.table.builtin(arg)
+        else:
+            return
+        if len(self.events) >= self.max_events:
+            self.truncated = True
+            self._end_at = at
+            sys.setprofile(None)
+            return
+        self._open.append(index)
+        self.events.append({"type": "O", "frame": index, "at": at})
+
+    def to_speedscope_profile(self, name: str) -> Dict:
+        return {
+            "type": "evented",
+            "name": name,
+            "unit": "milliseconds",
+            "startValue": 0,
+            "endValue": (self.ended - self.started) * 1000,
+            "events": self.events,
+        }
+
+    def function_times(self) -> Tuple[Dict[int, float], Dict[int, float]]:
+        self_ms: Dict[int, float] = {}
+        total_ms: Dict[int, float] = {}
+        stack: List[List] = []  # [frame, opened_at, child_ms]
+        depth: Dict[int, int] = {}
+        for event in self.events:
+            index = event["frame"]
+            if event["type"] == "O":
+                stack.append([index, event["at"], 0.0])
+                depth[index] = depth.get(index, 0) + 1
+                continue
+            index, opened_at, child_ms = stack.pop()
+            duration = event["at"] - opened_at
+            self_ms[index] = self_ms.get(index, 0.0) + duration - child_ms
+            depth[index] -= 1
+            if not depth[index]:  # count recursive calls once
+                total_ms[index] = total_ms.get(index, 0.0) + duration
+            if stack:
+                stack[-1][2] += duration
+        return self_ms, total_ms
+
+
+def summarize(profiler, limit: int = SUMMARY_FUNCTIONS) -> List[Dict]:
+    """Functions with the most self time, with their inclusive time."""
+    self_ms, total_ms = profiler.function_times()
+    top = sorted(self_ms.items(), key=lambda item: item[1], reverse=True)[:limit]
+    return [
+        {
+            **profiler.table.frames[index],
+            "self_ms": round(ms, 3),
+            "total_ms": round(total_ms.get(index, ms), 3),
+        }
+        for index, ms in top
+    ]
+
+
+class ProfileStore:
+    """Speedscope files on disk, capped by count and total size."""
+
+    def __init__(self, directory: str, max_profiles: int = DEFAULT_HISTORY, max_bytes: int = DEFAULT_MAX_MB * 1024 * 1024):
+        self.directory = directory
+        self.max_profiles = max_profiles
+        self.max_bytes = max_bytes
+        self._lock = threading.Lock()
+        os.makedirs(directory, exist_ok=True)
+
+    def _path(self, profile_id: str, suffix: str) -> Optional[str]:
+        if not _PROFILE_ID.match(profile_id):
+            return None
+        return os.path.join(self.directory, profile_id + suffix)
+
+    def profile_path(self, profile_id: str) -> Optional[str]:
+        path = self._path(profile_id, PROFILE_SUFFIX)
+        return path if path and os.path.exists(path) else None
+
+    def save(self, profile_id: str, speedscope: Dict, meta: Dict) -> None:
+        for suffix, data in ((PROFILE_SUFFIX, speedscope), (META_SUFFIX, meta)):
+            path = self._path(profile_id, suffix)
+            with open(path + ".tmp", "w") as f:
+                json.dump(data, f, separators=(",", ":"))
+            os.replace(path + ".tmp", path)
+        self.prune()
+
+    def _entries(self) -> List[Tuple[float, str, int]]:
+        """(mtime, id, bytes) of stored profiles, oldest first."""
+        entries = []
+        for filename in os.listdir(self.directory):
+            if not filename.endswith(PROFILE_SUFFIX):
+                continue
+            try:
+                stat = os.stat(os.path.join(self.directory, filename))
+            except FileNotFoundError:  # pruned by another worker
+                continue
+            entries.append((stat.st_mtime, filename[: -len(PROFILE_SUFFIX)], stat.st_size))
+        return sorted(entries)
+
+    def prune(self) -> None:
+        with self._lock:
+            entries = self._entries()
+            total = sum(size for _, _, size in entries)
+            while entries and (len(entries) > self.max_profiles or total > self.max_bytes):
+                _, profile_id, size = entries.pop(0)
+                total -= size
+                for suffix in (PROFILE_SUFFIX, META_SUFFIX):
+                    try:
+                        os.remove(self._path(profile_id, suffix))
+                    except FileNotFoundError:
+                        pass
+
+    def meta(self, profile_id: str) -> Optional[Dict]:
+        path = self._path(profile_id, META_SUFFIX)
+        try:
+            with open(path) as f:
+                return json.load(f)
+        except (TypeError, FileNotFoundError, ValueError):
+            return None
+
+    def recent(self, limit: int = 50) -> List[Dict]:
+        profiles = []
+        for _, profile_id, size in reversed(self._entries()[-limit:]):
+            meta = self.meta(profile_id) or {"profile_id": profile_id}
+            meta.pop("summary", None)
+            profiles.append({**meta, "bytes": size})
+        return profiles
+
+
+class CPUProfiler:
+    """Runs flagged requests of a Flask app under a sampler or tracer."""
+
+    def __init__(
+        self,
+        store: ProfileStore,
+        token: str,
+        interval_ms: float = DEFAULT_INTERVAL_MS,
+        max_active: int = DEFAULT_MAX_ACTIVE,
+        max_events: int = DEFAULT_MAX_EVENTS,
+    ):
+        self.store = store
+        self.token = token
+        self.interval_ms = interval_ms
+        self.max_events = max_events
+        self._slots = threading.BoundedSemaphore(max_active)
+
+    def authorized(self) -> bool:
+        return admin_authorized(self.token)
+
+    # Flask hooks
+
+    def start_request(self):
+        flag = request.args.get("profile") or request.headers.get("X-Profile")
+        if not flag:
+            return None
+        mode = MODES.get(flag.lower())
+        if mode is None:
+            return jsonify({"status": "error", "message": f"Unknown profile mode {flag}"}), 400
+        if not self.authorized():
+            logger.warning(f"Rejected CPU profile request for {request.path} from {request.remote_addr}")
+            return jsonify({"status": "error", "message": "Profiling requires a valid X-Admin-Token"}), 403
+        if not self._slots.acquire(blocking=False):
+            g.cpu_profile_busy = True
+            return None
+
+        if mode == "trace":
+            profiler = CallTracer(self.max_events)
+        else:
+            profiler = StackSampler(threading.get_ident(), self.interval_ms)
+        g.cpu_profiler = self
+        g.cpu_profile = profiler
+        profiler.start()
+        return None
+
+    def _stop(self):
+        """Stop the active profile of this request, if any, and free its slot."""
+        if g.get("cpu_profiler") is not self:
+            return None
+        g.pop("cpu_profiler")
+        profiler = g.pop("cpu_profile")
+        profiler.stop()
+        self._slots.release()
+        return profiler
+
+    def finish_request(self, response):
+        if g.pop("cpu_profile_busy", False):
+            response.headers["X-CPU-Profile"] = "busy"
+            return response
+        profiler = self._stop()
+        if profiler is None:
+            return response
+
+        profile_id = uuid.uuid4().hex[:12]
+        name = f"{request.method} {request.full_path.rstrip('?')}"
+        duration_ms = (profiler.ended - profiler.started) * 1000
+        sql_profile = g.get("sql_profile")
+        meta = {
+            "profile_id": profile_id,
+            "mode": profiler.mode,
+            "method": request.method,
+            "path": request.path,
+            "status_code": response.status_code,
+            "started": time.time() - duration_ms / 1000,
+            "duration_ms": round(duration_ms, 3),
+            "truncated": getattr(profiler, "truncated", False),
+            "sql_profile_id": sql_profile.request_id if sql_profile is not None else None,
+            "summary": summarize(profiler),
+        }
+        speedscope = {
+            "$schema": SPEEDSCOPE_SCHEMA,
+            "name": name,
+            "exporter": "dmr-analysis cpu_profiler",
+            "activeProfileIndex": 0,
+            "shared": {"frames": profiler.table.frames},
+            "profiles": [profiler.to_speedscope_profile(name)],
+        }
+        try:
+            self.store.save(profile_id, speedscope, meta)
+        except OSError as e:
+            logger.error(f"Could not store CPU profile for {request.path}: {e}")
+            return response
+
+        response.headers["X-CPU-Profile-Id"] = profile_id
+        response.headers["X-CPU-Profile-Url"] = f"/debug/profiles/{profile_id}"
+        response.headers["X-CPU-Profile-Mode"] = profiler.mode
+        response.headers["X-CPU-Time-ms"] = f"{duration_ms:.3f}"
+        return response
+
+    def teardown_request(self, exc=None) -> None:
+        # after_request is skipped when a response could not be built
+        self._stop()
+
+
+def init_cpu_profiler(app) -> Optional[CPUProfiler]:
+    """
+    Attach the profiler to an app when CPU_PROFILE is set in its config.
+
+    Config keys: CPU_PROFILE, CPU_PROFILE_TOKEN (required), CPU_PROFILE_DIR,
+    CPU_PROFILE_HISTORY, CPU_PROFILE_MAX_MB, CPU_PROFILE_INTERVAL_MS,
+    CPU_PROFILE_MAX_ACTIVE and CPU_PROFILE_MAX_EVENTS (trace mode).
+    """
+    if not app.config.get("CPU_PROFILE"):
+        return None
+    token = app.config.get("CPU_PROFILE_TOKEN")
+    if not token:
+        logger.warning("CPU_PROFILE is set without CPU_PROFILE_TOKEN; CPU profiling stays off")
+        return None
+
+    directory = app.config.get("CPU_PROFILE_DIR") or os.path.join(
+        app.config.get("DATA_DIR", "./data"), "profiles"
+    )
+    store = ProfileStore(
+        directory,
+        max_profiles=int(app.config.get("CPU_PROFILE_HISTORY") or DEFAULT_HISTORY),
+        max_bytes=int(
+            float(app.config.get("CPU_PROFILE_MAX_MB") or DEFAULT_MAX_MB) * 1024 * 1024
+        ),
+    )
+    profiler = CPUProfiler(
+        store,
+        token,
+        interval_ms=float(app.config.get("CPU_PROFILE_INTERVAL_MS") or DEFAULT_INTERVAL_MS),
+        max_active=int(app.config.get("CPU_PROFILE_MAX_ACTIVE") or DEFAULT_MAX_ACTIVE),
+        max_events=int(app.config.get("CPU_PROFILE_MAX_EVENTS") or DEFAULT_MAX_EVENTS),
+    )
+    app.before_request(profiler.start_request)
+    app.after_request(profiler.finish_request)
+    app.teardown_request(profiler.teardown_request)
+    app.extensions["cpu_profiler"] = profiler
+
+    from ..routes.debug_routes import debug_bp
+
+    if debug_bp.name not in app.blueprints:
+        app.register_blueprint(debug_bp)
+    logger.info(f"CPU profiling enabled, profiles in {directory}")
+    return profiler
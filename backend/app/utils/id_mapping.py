@@ -1,4 +1,6 @@
-from typing import Set, Dict
+from contextlib import contextmanager
+from contextvars import ContextVar
+from typing import Set, Dict, Optional
 from backend.app.utils.constants import START_GENE_ID
 
 # Preloaded dictionary of DMR_ID_OFFSET values from the Timepoint table;
@@ -14,6 +16,34 @@ TIMEPOINT_OFFSETS = {
     8: 70000,
 }
 
+# Offsets of the dataset the current request or job is scoped to; other
+# datasets number their timepoints independently of TIMEPOINT_OFFSETS.
+_scoped_offsets: ContextVar[Optional[Dict[int, int]]] = ContextVar(
+    "scoped_timepoint_offsets", default=None
+)
+
+
+@contextmanager
+def use_timepoint_offsets(offsets: Optional[Dict[int, int]]):
+    """Resolve timepoint ids against offsets in this context (None is a no-op)."""
+    if offsets is None:
+        yield
+        return
+    token = _scoped_offsets.set(offsets)
+    try:
+        yield
+    finally:
+        _scoped_offsets.reset(token)
+
+
+def get_timepoint_offset(timepoint: int) -> int:
+    """DMR id offset of a timepoint id in the active dataset."""
+    offsets = _scoped_offsets.get() or TIMEPOINT_OFFSETS
+    try:
+        return offsets[timepoint]
+    except KeyError:
+        raise ValueError(f"Unknown timepoint_id {timepoint} in TIMEPOINT_OFFSETS")
+
 
 # Cache for timepoint offsets
 def convert_dmr_id(
@@ -34,10 +64,7 @@ def reverse_create_dmr_id(
     """Convert a table DMR ID back to the raw (0-indexed) node ID by subtracting the timepoint offset."""
     if not isinstance(timepoint, int):
         raise TypeError("Expected timepoint to be an int")
-    try:
-        offset = TIMEPOINT_OFFSETS[timepoint]
-    except KeyError:
-        raise ValueError(f"Unknown timepoint_id {timepoint} in TIMEPOINT_OFFSETS")
+    offset = get_timepoint_offset(timepoint)
     return converted_id - offset - 1
 
 
@@ -50,10 +77,7 @@ def create_dmr_id(dmr_num: int, timepoint: int or str, first_gene_id: int = 0) -
             f"create_dmr_id: Expected timepoint to be int or str, got {type(timepoint)}: {timepoint}"
         )
     if isinstance(timepoint, int):
-        try:
-            offset = TIMEPOINT_OFFSETS[timepoint]
-        except KeyError:
-            raise ValueError(f"Unknown timepoint_id {timepoint} in TIMEPOINT_OFFSETS")
+        offset = get_timepoint_offset(timepoint)
     else:
         # Define fixed offsets for each timepoint
         timepoint_offsets = {
@@ -0,0 +1,418 @@
+"""Memory accounting for graph managers and in-process caches.
+
+``memory_report()`` attributes the process's large structures to their
+owners. It reports per dataset and timepoint (NetworkX graphs, component
+mappings, CSR arrays and their serialised form, edge details index) and per
+cache (NCBI ``lru_cache``s, rendered component graphs, enrichment results).
+Array-backed structures are sized exactly from their buffers. Everything
+else is walked object by object (``deep_sizeof``) with one ``seen`` set for
+the whole report, so an object reachable from several structures is counted
+once, for the first owner in report order. Graphs come before the mappings
+and caches that reference them. ``deep=False`` replaces the graph walk
+with the per-node/per-edge estimate the memory budget uses, which is
+instant but rough.
+
+For leak hunting, ``SnapshotStore`` keeps a few tracemalloc snapshots and
+diffs any two of them. Tracing slows allocation, so it is started and
+stopped on demand. Both are served under ``/debug/memory`` by
+``routes/debug_routes.py`` when ``MEMORY_DEBUG`` and ``MEMORY_DEBUG_TOKEN``
+are set, to requests carrying that token in ``X-Admin-Token``.
+"""
+
+import functools
+import gc
+import sys
+import threading
+import time
+import tracemalloc
+import types
+from collections import OrderedDict
+from typing import Dict, Optional, Set
+
+import logging
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_SNAPSHOTS_KEPT = 5
+DEFAULT_TRACE_FRAMES = 10
+DEFAULT_DIFF_LIMIT = 25
+
+# Shared program state, not data owned by whatever references it
+_NOT_OWNED = (
+    type,
+    types.ModuleType,
+    types.FunctionType,
+    types.BuiltinFunctionType,
+    types.MethodType,
+    types.CodeType,
+    types.FrameType,
+)
+
+_TRACE_EXCLUDES = (
+    tracemalloc.Filter(False, tracemalloc.__file__),
+    tracemalloc.Filter(False, "<frozen importlib._bootstrap>"),
+    tracemalloc.Filter(False, "<frozen importlib._bootstrap_external>"),
+    tracemalloc.Filter(False, "<unknown>"),
+)
+
+
+def deep_sizeof(obj, seen: Optional[Set[int]] = None) -> int:
+    """
+    Bytes reachable from obj that are not already in seen.
+
+    Follows gc referents, which covers containers, instance dicts, slots
+    and C types such as lru_cache entries. Modules, classes, functions and
+    frames are not followed. numpy arrays are counted by getsizeof, which
+    includes the buffer when the array owns it; views lead to their base.
+    """
+    if seen is None:
+        seen = set()
+    total = 0
+    stack = [obj]
+    while stack:
+        current = stack.pop()
+        if id(current) in seen or isinstance(current, _NOT_OWNED):
+            continue
+        seen.add(id(current))
+        total += sys.getsizeof(current)
+        stack.extend(gc.get_referents(current))
+    return total
+
+
+def array_bytes(arrays, seen: Set[int]) -> int:
+    """Exact buffer size of an array-backed structure with an ``nbytes`` property."""
+    if arrays is None or id(arrays) in seen:
+        return 0
+    seen.add(id(arrays))
+    return int(arrays.nbytes)
+
+
+def _graph_bytes(graph, deep: bool, seen: Set[int]) -> int:
+    from backend.app.core.graph_manager import estimate_graph_bytes
+
+    if graph is None:
+        return 0
+    return deep_sizeof(graph, seen) if deep else estimate_graph_bytes(graph)
+
+
+def timepoint_report(manager, timepoint_id: int, deep: bool, seen: Set[int]) -> Dict[str, int]:
+    """Bytes held by each structure a GraphManager keeps for one timepoint."""
+    report = {
+        "original_graph": _graph_bytes(manager.original_graphs.get(timepoint_id), deep, seen),
+        "split_graph": _graph_bytes(manager.split_graphs.get(timepoint_id), deep, seen),
+        "graph_arrays": sum(
+            array_bytes(manager.graph_arrays.get((timepoint_id, t)), seen)
+            for t in ("original", "split")
+        ),
+        "serialized_arrays": sum(
+            len(manager.graph_array_bytes.get((timepoint_id, t), b""))
+            for t in ("original", "split")
+        ),
+        "component_mapping": 0,
+        "edge_index": 0,
+        "decomposition_index": array_bytes(
+            manager.decomposition_indexes.get(timepoint_id), seen
+        ),
+    }
+    mapping = manager.component_mappings.get(timepoint_id)
+    if mapping is not None:
+        report["component_mapping"] = deep_sizeof(mapping, seen)
+    edge_index = manager.edge_indexes.get(timepoint_id)
+    if edge_index is not None:
+        report["edge_index"] = array_bytes(edge_index, seen) + deep_sizeof(
+            edge_index.vocabularies, seen
+        )
+    report["total"] = sum(report.values())
+    return report
+
+
+def graph_manager_report(manager, deep: bool = True, seen: Optional[Set[int]] = None) -> Dict:
+    """Per-timepoint bytes of a GraphManager, with its memory budget."""
+    seen = set() if seen is None else seen
+    timepoint_ids = sorted(
+        set(manager.original_graphs)
+        | set(manager.split_graphs)
+        | set(manager.component_mappings)
+        | set(manager.edge_indexes)
+        | set(manager.decomposition_indexes)
+        | {tp for tp, _ in list(manager.graph_arrays)}
+    )
+    timepoints = {tp: timepoint_report(manager, tp, deep, seen) for tp in timepoint_ids}
+    return {
+        "budget_bytes": manager.memory_budget,
+        "budget_estimate_bytes": manager.memory_usage()["total_bytes"],
+        "total_bytes": sum(t["total"] for t in timepoints.values()),
+        "timepoints": timepoints,
+    }
+
+
+def inspectable_lru_cache(maxsize: int = 128):
+    """
+    functools.lru_cache with the same cache_info()/cache_clear(), plus
+    cache_entries() so the cached results can be sized. (The C lru_cache
+    keeps its results where neither Python nor the gc can reach them.)
+    """
+
+    def decorator(func):
+        entries: "OrderedDict" = OrderedDict()
+        lock = threading.RLock()
+        stats = {"hits": 0, "misses": 0}
+
+        @functools.wraps(func)
+        def wrapper(*args, **kwargs):
+            key = functools._make_key(args, kwargs, False)
+            with lock:
+                if key in entries:
+                    entries.move_to_end(key)
+                    stats["hits"] += 1
+                    return entries[key]
+                stats["misses"] += 1
+            result = func(*args, **kwargs)
+            with lock:
+                entries[key] = result
+                while len(entries) > maxsize:
+                    entries.popitem(last=False)
+            return result
+
+        def cache_info():
+            with lock:
+                return functools._CacheInfo(stats["hits"], stats["misses"], maxsize, len(entries))
+
+        def cache_clear():
+            with lock:
+                entries.clear()
+                stats.update(hits=0, misses=0)
+
+        def cache_entries() -> Dict:
+            with lock:
+                return dict(entries)
+
+        wrapper.cache_info = cache_info
+        wrapper.cache_clear = cache_clear
+        wrapper.cache_entries = cache_entries
+        return wrapper
+
+    return decorator
+
+
+def lru_cache_report(func, seen: Set[int]) -> Dict:
+    """Hit statistics of an LRU-cached function plus the bytes of its entries."""
+    info = func.cache_info()
+    entries = func.cache_entries() if hasattr(func, "cache_entries") else None
+    return {
+        "entries": info.currsize,
+        "max_entries": info.maxsize,
+        "hits": info.hits,
+        "misses": info.misses,
+        # None for a stdlib lru_cache, whose results cannot be reached
+        "bytes": (
+            sum(deep_sizeof(k, seen) + deep_sizeof(v, seen) for k, v in entries.items())
+            if entries is not None
+            else None
+        ),
+    }
+
+
+def cache_report(seen: Set[int]) -> Dict:
+    """Process-wide caches. Modules that were never imported have nothing to report."""
+    caches = {}
+
+    ncbi = sys.modules.get("backend.app.enrichment.ncbi_utils")
+    if ncbi is not None:
+        for name in ("fetch_gene_id", "fetch_gene_details"):
+            caches[f"ncbi.{name}"] = lru_cache_report(getattr(ncbi, name), seen)
+
+    graph_routes = sys.modules.get("backend.app.routes.graph_routes")
+    if graph_routes is not None:
+        with graph_routes._render_cache_lock:
+            caches["component_renders"] = {
+                name: {"entries": len(cache), "bytes": deep_sizeof(cache, seen)}
+                for name, cache in graph_routes._render_caches.items()
+            }
+
+    result_cache = sys.modules.get("backend.app.enrichment.result_cache")
+    if result_cache is not None and result_cache._cache is not None:
+        # load_cached_results reads this SQLite file; only page cache is in memory
+        caches["enrichment_results"] = {**result_cache._cache.stats(), "storage": "disk"}
+
+    return caches
+
+
+def process_memory() -> Dict[str, Optional[int]]:
+    """Resident and peak resident set size of this process (Linux), plus tracemalloc totals."""
+    usage = {"rss_bytes": None, "peak_rss_bytes": None}
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                key, _, value = line.partition(":")
+                if key in ("VmRSS", "VmHWM"):
+                    field = "rss_bytes" if key == "VmRSS" else "peak_rss_bytes"
+                    usage[field] = int(value.split()[0]) * 1024
+    except OSError:
+        import resource
+
+        # ru_maxrss is in bytes on macOS, kilobytes elsewhere
+        scale = 1 if sys.platform == "darwin" else 1024
+        usage["peak_rss_bytes"] = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * scale
+    if tracemalloc.is_tracing():
+        usage["traced_bytes"], usage["traced_peak_bytes"] = tracemalloc.get_traced_memory()
+    return usage
+
+
+def memory_report(datasets: Dict[str, object], deep: bool = True) -> Dict:
+    """
+    Accounted bytes of every loaded graph manager and process-wide cache.
+
+    Args:
+        datasets: Dataset name to GraphManager, for managers that are loaded
+        deep: Walk NetworkX graphs object by object instead of estimating
+    """
+    started = time.perf_counter()
+    seen: Set[int] = set()
+    managers = {
+        name: graph_manager_report(manager, deep, seen) for name, manager in datasets.items()
+    }
+    caches = cache_report(seen)
+
+    def cache_bytes(entry: Dict) -> int:
+        if "bytes" in entry and entry.get("storage") != "disk":
+            return entry["bytes"] or 0
+        return sum(cache_bytes(v) for v in entry.values() if isinstance(v, dict))
+
+    accounted = sum(m["total_bytes"] for m in managers.values()) + cache_bytes(caches)
+    return {
+        "method": "deep" if deep else "estimate",
+        "process": process_memory(),
+        "accounted_bytes": accounted,
+        "datasets": managers,
+        "caches": caches,
+        "elapsed_ms": round((time.perf_counter() - started) * 1000, 3),
+    }
+
+
+def _statistic(stat, group_by: str) -> Dict:
+    if group_by == "traceback":
+        location = [f"{frame.filename}:{frame.lineno}" for frame in stat.traceback]
+    else:
+        frame = stat.traceback[0]
+        location = frame.filename if group_by == "filename" else f"{frame.filename}:{frame.lineno}"
+    entry = {"location": location, "size_bytes": stat.size, "count": stat.count}
+    if hasattr(stat, "size_diff"):
+        entry.update(size_diff_bytes=stat.size_diff, count_diff=stat.count_diff)
+    return entry
+
+
+class SnapshotStore:
+    """The most recent tracemalloc snapshots, diffable by id."""
+
+    def __init__(self, keep: int = DEFAULT_SNAPSHOTS_KEPT):
+        self.keep = keep
+        self.snapshots: "OrderedDict[int, Dict]" = OrderedDict()
+        self._next_id = 1
+        self._lock = threading.Lock()
+
+    def status(self) -> Dict:
+        status = {
+            "tracing": tracemalloc.is_tracing(),
+            "frames": tracemalloc.get_traceback_limit(),
+            "snapshots": [self._describe(s) for s in self.snapshots.values()],
+        }
+        if status["tracing"]:
+            status["traced_bytes"], status["traced_peak_bytes"] = tracemalloc.get_traced_memory()
+        return status
+
+    def start(self, frames: int = DEFAULT_TRACE_FRAMES) -> Dict:
+        if not tracemalloc.is_tracing():
+            tracemalloc.start(frames)
+            logger.info(f"tracemalloc started ({frames} frames)")
+        return self.status()
+
+    def stop(self) -> Dict:
+        """Stop tracing and drop the snapshots, which are useless without it."""
+        with self._lock:
+            self.snapshots.clear()
+        if tracemalloc.is_tracing():
+            tracemalloc.stop()
+            logger.info("tracemalloc stopped")
+        return self.status()
+
+    @staticmethod
+    def _describe(entry: Dict) -> Dict:
+        return {key: entry[key] for key in ("id", "label", "taken_at", "traced_bytes")}
+
+    def take(self, label: Optional[str] = None) -> Dict:
+        """Snapshot the traced allocations; raises RuntimeError when not tracing."""
+        if not tracemalloc.is_tracing():
+            raise RuntimeError("tracemalloc is not tracing; start it first")
+        snapshot = tracemalloc.take_snapshot().filter_traces(_TRACE_EXCLUDES)
+        with self._lock:
+            entry = {
+                "id": self._next_id,
+                "label": label,
+                "taken_at": time.time(),
+                "traced_bytes": sum(stat.size for stat in snapshot.statistics("filename")),
+                "snapshot": snapshot,
+            }
+            self._next_id += 1
+            self.snapshots[entry["id"]] = entry
+            while len(self.snapshots) > self.keep:
+                self.snapshots.popitem(last=False)
+        return self._describe(entry)
+
+    def get(self, snapshot_id: int) -> Dict:
+        with self._lock:
+            entry = self.snapshots.get(snapshot_id)
+        if entry is None:
+            raise KeyError(snapshot_id)
+        return entry
+
+    def top(self, snapshot_id: int, group_by: str = "lineno", limit: int = DEFAULT_DIFF_LIMIT) -> Dict:
+        entry = self.get(snapshot_id)
+        stats = entry["snapshot"].statistics(group_by)[:limit]
+        return {**self._describe(entry), "top": [_statistic(s, group_by) for s in stats]}
+
+    def diff(
+        self,
+        old_id: int,
+        new_id: int,
+        group_by: str = "lineno",
+        limit: int = DEFAULT_DIFF_LIMIT,
+    ) -> Dict:
+        """Allocation sites that grew (or shrank) the most between two snapshots."""
+        old, new = self.get(old_id), self.get(new_id)
+        stats = new["snapshot"].compare_to(old["snapshot"], group_by)
+        return {
+            "old": self._describe(old),
+            "new": self._describe(new),
+            "size_diff_bytes": sum(stat.size_diff for stat in stats),
+            "top": [_statistic(s, group_by) for s in stats[:limit]],
+        }
+
+
+def init_memory_debug(app) -> Optional[SnapshotStore]:
+    """
+    Serve /debug/memory when MEMORY_DEBUG is set in the app config.
+
+    Config keys: MEMORY_DEBUG, MEMORY_DEBUG_TOKEN (required),
+    MEMORY_SNAPSHOTS_KEPT and MEMORY_TRACE_FRAMES (start tracing at startup
+    with this many frames; unset = on demand).
+    """
+    if not app.config.get("MEMORY_DEBUG"):
+        return None
+    if not app.config.get("MEMORY_DEBUG_TOKEN"):
+        logger.warning(
+            "MEMORY_DEBUG is set without MEMORY_DEBUG_TOKEN; memory debugging stays off"
+        )
+        return None
+    store = SnapshotStore(int(app.config.get("MEMORY_SNAPSHOTS_KEPT") or DEFAULT_SNAPSHOTS_KEPT))
+    frames = app.config.get("MEMORY_TRACE_FRAMES")
+    if frames:
+        store.start(int(frames))
+    app.extensions["memory_snapshots"] = store
+
+    from ..routes.debug_routes import debug_bp
+
+    if debug_bp.name not in app.blueprints:
+        app.register_blueprint(debug_bp)
+    logger.info("Memory debugging enabled")
+    return store
@@ -0,0 +1,435 @@
+# File overview_tiles.py
+# Author: Peter Shaw
+#
+"""Offline pipeline for the whole-timepoint overview map.
+
+Every connected component of a timepoint graph is laid out on its own, the
+layouts are shelf-packed into one global canvas and the canvas is cut into a
+quadtree of level-of-detail tiles:
+
+- density tiles: a coarse grid of DMR/gene counts, used at low zoom where a
+  tile would contain too many nodes to draw individually
+- node tiles: the actual nodes and edges of the tile, used once a tile holds at
+  most ``max_nodes_per_tile`` nodes (or the maximum zoom is reached).
+
+Only density tiles are subdivided further, so each node tile is a leaf and the
+client over-zooms it. Tiles are written as gzipped JSON files under
+``<output_root>/<timepoint_id>/<z>/<x>/<y>.json.gz`` next to an
+``overview.json`` metadata file, and are served as static files by
+``routes/overview_routes.py``. Each build is written to a fresh directory and
+swapped in whole, so tiles of an earlier layout never outlive it.
+
+The layout of a large timepoint takes minutes, so tiles are built offline:
+    python -m backend.app.visualization.overview_tiles --graph FILE --timepoint-id N
+"""
+
+import argparse
+import gzip
+import json
+import math
+import os
+import shutil
+import uuid
+from typing import Dict, List, Tuple
+
+import networkx as nx
+import numpy as np
+
+import logging
+
+logger = logging.getLogger(__name__)
+
+# Tile coordinates are quantized to integers in [0, TILE_EXTENT) like vector tiles
+TILE_EXTENT = 4096
+DENSITY_BINS = 32
+MAX_NODES_PER_TILE = 400
+MAX_ZOOM = 10
+NODE_SPACING = 1.0
+COMPONENT_PADDING = 2.0
+SPRING_ITERATIONS = 50
+OVERVIEW_METADATA_FILE = "overview.json"
+
+
+def layout_component(
+    graph: nx.Graph, nodes: List[int], seed: int = 42
+) -> Tuple[np.ndarray, float]:
+    """
+    Lay out a single connected component in a local square box.
+
+    Args:
+        graph: Graph containing the component
+        nodes: Nodes of the component, in the order positions are returned
+        seed: Random seed for the spring layout
+
+    Returns:
+        Tuple of (positions array of shape (n, 2), side length of the box)
+    """
+    n = len(nodes)
+    side = max(math.sqrt(n) * NODE_SPACING * 2, NODE_SPACING)
+
+    if n == 1:
+        return np.full((1, 2), side / 2), side
+    if n == 2:
+        return np.array([[0.0, side / 2], [side, side / 2]]), side
+
+    pos = nx.spring_layout(
+        graph.subgraph(nodes), seed=seed, iterations=SPRING_ITERATIONS
+    )
+    xy = np.array([pos[node] for node in nodes], dtype=np.float64)
+
+    # Normalise into [0, side] keeping the aspect ratio
+    xy -= xy.min(axis=0)
+    extent = xy.max()
+    if extent > 0:
+        xy *= side / extent
+    return xy, side
+
+
+def pack_components(sides: List[float]) -> Tuple[np.ndarray, float]:
+    """
+    Shelf-pack square component boxes into a square canvas.
+
+    Args:
+        sides: Box side lengths, expected in descending order
+
+    Returns:
+        Tuple of (offsets array of shape (k, 2), canvas side length)
+    """
+    padded = np.asarray(sides, dtype=np.float64) + COMPONENT_PADDING
+    target_width = max(math.sqrt(float(np.sum(padded**2))), float(padded.max()))
+
+    offsets = np.zeros((len(sides), 2), dtype=np.float64)
+    cursor_x = 0.0
+    shelf_y = 0.0
+    shelf_height = 0.0
+    for i, box in enumerate(padded):
+        if cursor_x > 0 and cursor_x + box > target_width:
+            shelf_y += shelf_height
+            cursor_x = 0.0
+            shelf_height = 0.0
+        offsets[i] = (cursor_x, shelf_y)
+        cursor_x += box
+        shelf_height = max(shelf_height, box)
+
+    canvas_size = max(target_width, shelf_y + shelf_height)
+    return offsets, canvas_size
+
+
+def build_global_layout(graph: nx.Graph) -> Dict:
+    """
+    Lay out and pack every non-trivial component of a graph.
+
+    Isolated nodes are skipped, matching ComponentMapping.
+
+    Returns:
+        Dictionary of node arrays (ids, x, y, node_type, component),
+        edge index arrays, per-component boxes and the canvas size
+    """
+    connected = graph.subgraph([n for n, d in graph.degree() if d > 0])
+    components = sorted(
+        (sorted(c) for c in nx.connected_components(connected)),
+        key=len,
+        reverse=True,
+    )
+    if not components:
+        raise ValueError("Graph has no edges to lay out")
+
+    layouts = [layout_component(connected, comp) for comp in components]
+    offsets, canvas_size = pack_components([side for _, side in layouts])
+
+    node_ids = np.concatenate([np.asarray(c, dtype=np.int64) for c in components])
+    xy = np.concatenate([xy + offsets[i] for i, (xy, _) in enumerate(layouts)])
+    component = np.repeat(
+        np.arange(len(components), dtype=np.int32), [len(c) for c in components]
+    )
+    node_type = np.array(
+        [connected.nodes[n].get("bipartite", 0) for n in node_ids], dtype=np.int8
+    )
+
+    index = {int(n): i for i, n in enumerate(node_ids)}
+    edges = np.array(
+        [(index[u], index[v]) for u, v in connected.edges()], dtype=np.int64
+    ).reshape(-1, 2)
+
+    boxes = []
+    for i, comp in enumerate(components):
+        x0, y0 = offsets[i]
+        side = layouts[i][1]
+        types = node_type[component == i]
+        boxes.append(
+            [
+                i,
+                round(float(x0), 3),
+                round(float(y0), 3),
+                round(float(x0 + side), 3),
+                round(float(y0 + side), 3),
+                int(np.count_nonzero(types == 0)),
+                int(np.count_nonzero(types == 1)),
+            ]
+        )
+
+    return {
+        "node_ids": node_ids,
+        "x": xy[:, 0],
+        "y": xy[:, 1],
+        "node_type": node_type,
+        "component": component,
+        "edges": edges,
+        "components": boxes,
+        "canvas_size": canvas_size,
+    }
+
+
+def _adjacency(num_nodes: int, edges: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """Build a CSR adjacency (indptr, indices) over node indices."""
+    src = np.concatenate([edges[:, 0], edges[:, 1]])
+    dst = np.concatenate([edges[:, 1], edges[:, 0]])
+    order = np.argsort(src, kind="stable")
+    indptr = np.zeros(num_nodes + 1, dtype=np.int64)
+    np.cumsum(np.bincount(src, minlength=num_nodes), out=indptr[1:])
+    return indptr, dst[order]
+
+
+def _quantize(values: np.ndarray, origin: float, span: float) -> np.ndarray:
+    """Map world coordinates to integer tile coordinates."""
+    return np.rint((values - origin) / span * TILE_EXTENT).astype(np.int64)
+
+
+def _density_tile(layout: Dict, idx: np.ndarray, x0: float, y0: float, span: float):
+    """Aggregate the nodes of a tile into a sparse DMR/gene count grid."""
+    bx = np.clip(
+        ((layout["x"][idx] - x0) / span * DENSITY_BINS).astype(np.int64),
+        0,
+        DENSITY_BINS - 1,
+    )
+    by = np.clip(
+        ((layout["y"][idx] - y0) / span * DENSITY_BINS).astype(np.int64),
+        0,
+        DENSITY_BINS - 1,
+    )
+    cell = by * DENSITY_BINS + bx
+    is_gene = layout["node_type"][idx] == 1
+    dmr_counts = np.bincount(cell[~is_gene], minlength=DENSITY_BINS**2)
+    gene_counts = np.bincount(cell[is_gene], minlength=DENSITY_BINS**2)
+    occupied = np.flatnonzero(dmr_counts + gene_counts)
+
+    return {
+        "mode": "density",
+        "bins": DENSITY_BINS,
+        "node_count": int(idx.size),
+        "cells": [
+            [
+                int(c % DENSITY_BINS),
+                int(c // DENSITY_BINS),
+                int(dmr_counts[c]),
+                int(gene_counts[c]),
+            ]
+            for c in occupied
+        ],
+    }
+
+
+def _node_tile(
+    layout: Dict,
+    adjacency: Tuple[np.ndarray, np.ndarray],
+    idx: np.ndarray,
+    x0: float,
+    y0: float,
+    span: float,
+):
+    """Emit the full nodes and incident edges of a tile."""
+    indptr, indices = adjacency
+    local = np.full(layout["node_ids"].size, -1, dtype=np.int64)
+    local[idx] = np.arange(idx.size)
+
+    degrees = indptr[idx + 1] - indptr[idx]
+    src = np.repeat(idx, degrees)
+    dst = np.concatenate([indices[indptr[i] : indptr[i + 1]] for i in idx])
+
+    inside = local[dst] >= 0
+    # Keep each inside edge once, and every edge leaving the tile
+    internal = inside & (src < dst)
+    external = ~inside
+
+    return {
+        "mode": "nodes",
+        "node_count": int(idx.size),
+        "nodes": {
+            "id": layout["node_ids"][idx].tolist(),
+            "x": _quantize(layout["x"][idx], x0, span).tolist(),
+            "y": _quantize(layout["y"][idx], y0, span).tolist(),
+            "type": layout["node_type"][idx].tolist(),
+            "component": layout["component"][idx].tolist(),
+        },
+        "edges": np.column_stack([local[src[internal]], local[dst[internal]]])
+        .astype(np.int64)
+        .tolist(),
+        "external_edges": np.column_stack(
+            [
+                local[src[external]],
+                _quantize(layout["x"][dst[external]], x0, span),
+                _quantize(layout["y"][dst[external]], y0, span),
+            ]
+        )
+        .astype(np.int64)
+        .tolist(),
+    }
+
+
+def build_tiles(
+    layout: Dict,
+    max_zoom: int = MAX_ZOOM,
+    max_nodes_per_tile: int = MAX_NODES_PER_TILE,
+):
+    """
+    Generate the level-of-detail quadtree for a packed layout.
+
+    Yields:
+        (z, x, y, tile_dict) for every non-empty tile
+    """
+    canvas = layout["canvas_size"]
+    adjacency = _adjacency(layout["node_ids"].size, layout["edges"])
+    stack = [(0, 0, 0, np.arange(layout["node_ids"].size))]
+
+    while stack:
+        z, x, y, idx = stack.pop()
+        span = canvas / (2**z)
+        x0, y0 = x * span, y * span
+
+        if idx.size <= max_nodes_per_tile or z >= max_zoom:
+            tile = _node_tile(layout, adjacency, idx, x0, y0, span)
+        else:
+            tile = _density_tile(layout, idx, x0, y0, span)
+            # Split the node set between the four children
+            half = span / 2
+            cx = (layout["x"][idx] >= x0 + half).astype(np.int64)
+            cy = (layout["y"][idx] >= y0 + half).astype(np.int64)
+            quadrant = cy * 2 + cx
+            for q in range(4):
+                child = idx[quadrant == q]
+                if child.size:
+                    stack.append((z + 1, 2 * x + q % 2, 2 * y + q // 2, child))
+
+        tile.update({"z": z, "x": x, "y": y, "extent": TILE_EXTENT})
+        yield z, x, y, tile
+
+
+def get_tile_path(output_dir: str, z: int, x: int, y: int) -> str:
+    """Path of a single tile file inside a timepoint overview directory."""
+    return os.path.join(output_dir, str(z), str(x), f"{y}.json.gz")
+
+
+def write_overview(
+    graph: nx.Graph,
+    output_dir: str,
+    timepoint_id: int = None,
+    max_zoom: int = MAX_ZOOM,
+    max_nodes_per_tile: int = MAX_NODES_PER_TILE,
+) -> Dict:
+    """
+    Run the full pipeline for one graph and write tiles plus metadata.
+
+    The tiles are written next to ``output_dir`` and replace it once
+    complete, together with every tile of the previous build.
+
+    Args:
+        graph: Bipartite graph of the whole timepoint
+        output_dir: Directory for this timepoint's tiles
+        timepoint_id: Timepoint the graph belongs to (stored in metadata)
+        max_zoom: Deepest zoom level to generate
+        max_nodes_per_tile: Node budget above which a tile is aggregated
+
+    Returns:
+        The metadata dictionary written to overview.json
+    """
+    print(f"\nBuilding overview tiles in {output_dir}")
+    output_dir = os.path.normpath(output_dir)
+    staging = f"{output_dir}.building-{os.getpid()}"
+    shutil.rmtree(staging, ignore_errors=True)
+    layout = build_global_layout(graph)
+    print(f"Packed {len(layout['components'])} components into canvas")
+    print(f"Canvas size: {layout['canvas_size']:.1f}")
+
+    tiles = {}
+    largest_tile = 0
+    for z, x, y, tile in build_tiles(layout, max_zoom, max_nodes_per_tile):
+        path = get_tile_path(staging, z, x, y)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        payload = gzip.compress(
+            json.dumps(tile, separators=(",", ":")).encode("utf-8")
+        )
+        with open(path, "wb") as f:
+            f.write(payload)
+        tiles[f"{z}/{x}/{y}"] = tile["mode"]
+        largest_tile = max(largest_tile, len(payload))
+
+    metadata = {
+        # Part of every tile URL, so caches never mix tiles of two builds
+        "build_id": uuid.uuid4().hex[:16],
+        "timepoint_id": timepoint_id,
+        "canvas_size": layout["canvas_size"],
+        "extent": TILE_EXTENT,
+        "density_bins": DENSITY_BINS,
+        "max_zoom": max(int(k.split("/")[0]) for k in tiles),
+        "max_nodes_per_tile": max_nodes_per_tile,
+        "node_count": int(layout["node_ids"].size),
+        "edge_count": int(layout["edges"].shape[0]),
+        # [component_index, x0, y0, x1, y1, dmr_count, gene_count]
+        "components": layout["components"],
+        "tiles": tiles,
+    }
+    with open(os.path.join(staging, OVERVIEW_METADATA_FILE), "w") as f:
+        json.dump(metadata, f, separators=(",", ":"))
+
+    # Swap the finished build in; readers briefly see no overview, never a mixed one
+    previous = f"{output_dir}.previous-{os.getpid()}"
+    if os.path.exists(output_dir):
+        os.replace(output_dir, previous)
+    os.replace(staging, output_dir)
+    shutil.rmtree(previous, ignore_errors=True)
+
+    print(f"Wrote {len(tiles)} tiles (largest {largest_tile} bytes compressed)")
+    return metadata
+
+
+def parse_arguments():
+    """Parse command line arguments."""
+    parser = argparse.ArgumentParser(
+        description="Build level-of-detail overview tiles for a timepoint graph",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter,
+    )
+    parser.add_argument(
+        "--graph", required=True, help="Path to bipartite_graph_output_*.txt file"
+    )
+    parser.add_argument(
+        "--timepoint-id", type=int, required=True, help="Timepoint ID in database"
+    )
+    parser.add_argument(
+        "--output-dir",
+        default=os.path.join("data", "graphs", "overview"),
+        help="Root directory for overview tiles (GRAPH_DATA_DIR/overview)",
+    )
+    parser.add_argument("--max-zoom", type=int, default=MAX_ZOOM)
+    parser.add_argument(
+        "--max-nodes-per-tile", type=int, default=MAX_NODES_PER_TILE
+    )
+    return parser.parse_args()
+
+
+def main():
+    """Build overview tiles from a graph file."""
+    from ..utils.graph_io import read_bipartite_graph
+
+    args = parse_arguments()
+    graph = read_bipartite_graph(args.graph)
+    write_overview(
+        graph,
+        os.path.join(args.output_dir, str(args.timepoint_id)),
+        args.timepoint_id,
+        max_zoom=args.max_zoom,
+        max_nodes_per_tile=args.max_nodes_per_tile,
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -1,7 +1,17 @@
-from setuptools import setup, find_packages
+from setuptools import Extension, setup, find_packages
 
 setup(
     name="backend",
     packages=find_packages(),
     include_package_data=True,
+    # Optional: without a compiler the Python implementations are used
+    ext_modules=[
+        Extension(
+            "app.native._kernels",
+            ["app/native/_kernels.cpp"],
+            language="c++",
+            extra_compile_args=["-O3", "-std=c++17"],
+            optional=True,
+        )
+    ],
 )
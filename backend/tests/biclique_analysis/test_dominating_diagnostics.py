@@ -0,0 +1,104 @@
+import random
+import unittest
+
+import networkx as nx
+
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.biclique_analysis.component_analyzer import ComponentAnalyzer
+
+
+def random_instance(seed, n_dmrs=30, n_genes=25):
+    """Random bipartite graph with bicliques drawn from its DMR neighbourhoods."""
+    rng = random.Random(seed)
+    dmrs = list(range(n_dmrs))
+    genes = list(range(START_GENE_ID, START_GENE_ID + n_genes))
+
+    graph = nx.Graph()
+    graph.add_nodes_from(dmrs, bipartite=0)
+    graph.add_nodes_from(genes, bipartite=1)
+    for _ in range(45):
+        graph.add_edge(rng.choice(dmrs), rng.choice(genes))
+
+    bicliques = []
+    for gene in genes:
+        neighbours = set(graph.neighbors(gene))
+        if neighbours:
+            bicliques.append((neighbours, {gene}))
+    dominating_set = set(rng.sample(dmrs, 12))
+    return graph, bicliques, dominating_set
+
+
+class TestDominatingDiagnostics(unittest.TestCase):
+    def test_matches_brute_force(self):
+        for seed in range(8):
+            graph, bicliques, ds = random_instance(seed)
+            analyzer = ComponentAnalyzer(graph, {"bicliques": bicliques})
+            diagnostics = analyzer.diagnose_dominating_set(ds)
+            with self.subTest(seed=seed):
+                genes = {n for n, d in graph.nodes(data=True) if d["bipartite"] == 1}
+                dominators = {g: set(graph.neighbors(g)) & ds for g in genes}
+
+                self.assertEqual(
+                    diagnostics["undominated_genes"],
+                    sorted(g for g in genes if not dominators[g]),
+                )
+                for gene, dmr in diagnostics["certificate"].items():
+                    self.assertIn(dmr, dominators[gene])
+                self.assertEqual(
+                    diagnostics["dominator_counts"],
+                    {g: len(d) for g, d in dominators.items()},
+                )
+
+                components = list(nx.connected_components(graph))
+                self.assertEqual(diagnostics["num_components"], len(components))
+                self.assertEqual(
+                    sorted(diagnostics["component_sizes"].values()),
+                    sorted(len(c & ds) for c in components if c & ds),
+                )
+                self.assertEqual(
+                    len(diagnostics["components_without_ds"]),
+                    sum(1 for c in components if not c & ds),
+                )
+
+                self.assertEqual(
+                    diagnostics["redundant_bicliques"],
+                    [
+                        (idx, dmrs & ds)
+                        for idx, (dmrs, _) in enumerate(bicliques)
+                        if len(dmrs & ds) > 1
+                    ],
+                )
+
+                removable = [
+                    d
+                    for d in sorted(ds)
+                    if all(len(dominators[g]) > 1 for g in graph.neighbors(d))
+                ]
+                self.assertEqual(diagnostics["removable_dmrs"], removable)
+
+    def test_stats_and_validation(self):
+        graph = nx.Graph()
+        graph.add_nodes_from([1, 2, 3], bipartite=0)
+        genes = [START_GENE_ID, START_GENE_ID + 1]
+        graph.add_nodes_from(genes, bipartite=1)
+        graph.add_edges_from([(1, genes[0]), (2, genes[0]), (2, genes[1])])
+        graph.add_edge(3, START_GENE_ID + 2)
+        graph.nodes[START_GENE_ID + 2]["bipartite"] = 1
+        bicliques = [({1, 2}, {genes[0]}), ({2}, {genes[1]}), ({3}, {START_GENE_ID + 2})]
+        analyzer = ComponentAnalyzer(graph, {"bicliques": bicliques})
+
+        stats = analyzer.get_dominating_set_stats({1, 2})
+        self.assertEqual(stats["genes_dominated"], 2)
+        self.assertEqual(stats["undominated_genes"], [START_GENE_ID + 2])
+        self.assertEqual(stats["removable_dmrs"], [1])
+        self.assertEqual(stats["components_with_ds"], 1)
+        self.assertEqual(stats["components_without_ds"], 1)
+        self.assertEqual(stats["redundancy_analysis"]["bicliques_with_multiple_ds"], 1)
+
+        with self.assertRaises(ValueError):
+            analyzer.validate_dominating_set({1, 2})
+        self.assertTrue(analyzer.validate_dominating_set({2, 3}))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,169 @@
+import random
+import unittest
+from collections import Counter
+
+import networkx as nx
+import numpy as np
+
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.biclique_analysis.edge_keys import (
+    graph_edge_keys,
+    pack_edge_keys,
+    participation_distribution,
+    unpack_edge_keys,
+)
+from backend.app.biclique_analysis.reader import (
+    calculate_coverage,
+    calculate_edge_distribution,
+)
+from backend.app.biclique_analysis.statistics import (
+    calculate_coverage_statistics,
+    calculate_edge_coverage,
+    calculate_node_participation,
+)
+
+
+def random_instance(seed, n_dmrs=40, n_genes=30, n_bicliques=25):
+    """Random bipartite graph plus bicliques, some of whose cells are not edges."""
+    rng = random.Random(seed)
+    dmrs = list(range(n_dmrs))
+    genes = list(range(START_GENE_ID, START_GENE_ID + n_genes))
+
+    graph = nx.Graph()
+    graph.add_nodes_from(dmrs, bipartite=0)
+    graph.add_nodes_from(genes, bipartite=1)
+
+    bicliques = []
+    for _ in range(n_bicliques):
+        b_dmrs = set(rng.sample(dmrs, rng.randint(1, 5)))
+        b_genes = set(rng.sample(genes, rng.randint(1, 4)))
+        bicliques.append((b_dmrs, b_genes))
+        graph.add_edges_from(
+            (d, g) for d in b_dmrs for g in b_genes if rng.random() < 0.9
+        )
+    # Edges no biclique covers
+    for _ in range(30):
+        graph.add_edge(rng.choice(dmrs), rng.choice(genes))
+    return graph, bicliques
+
+
+# Reference implementations: the per-cell loops the array versions replaced
+
+
+def reference_participation(node_sets):
+    counts = Counter(node for nodes in node_sets for node in nodes)
+    return dict(sorted(Counter(counts.values()).items()))
+
+
+def reference_edge_coverage(bicliques, graph):
+    edge_coverage = {}
+    for dmr_nodes, gene_nodes in bicliques:
+        for dmr in dmr_nodes:
+            for gene in gene_nodes:
+                if graph.has_edge(dmr, gene):
+                    edge = tuple(sorted([dmr, gene]))
+                    edge_coverage[edge] = edge_coverage.get(edge, 0) + 1
+    counts = list(edge_coverage.values())
+    return (
+        sum(1 for c in counts if c == 1),
+        sum(1 for c in counts if c > 1),
+        graph.number_of_edges() - len(edge_coverage),
+    )
+
+
+def reference_cell_coverage(bicliques):
+    covered, multiple = set(), set()
+    for dmr_nodes, gene_nodes in bicliques:
+        for dmr in dmr_nodes:
+            for gene in gene_nodes:
+                edge = (min(dmr, gene), max(dmr, gene))
+                if edge in covered:
+                    multiple.add(edge)
+                covered.add(edge)
+    return len(covered - multiple), len(multiple), len(covered)
+
+
+def reference_edge_distribution(bicliques, graph):
+    distribution = {}
+    for idx, (dmr_nodes, gene_nodes) in enumerate(bicliques):
+        for dmr in dmr_nodes:
+            for gene in gene_nodes:
+                if graph.has_edge(dmr, gene):
+                    distribution.setdefault((dmr, gene), []).append(idx)
+    return distribution
+
+
+class TestEdgeKeys(unittest.TestCase):
+    def test_pack_is_orientation_independent(self):
+        u = np.array([3, START_GENE_ID + 7])
+        v = np.array([START_GENE_ID + 7, 3])
+        keys = pack_edge_keys(u, v)
+        self.assertEqual(keys[0], keys[1])
+        low, high = unpack_edge_keys(keys)
+        self.assertEqual((low[0], high[0]), (3, START_GENE_ID + 7))
+
+    def test_graph_edge_keys(self):
+        graph = nx.Graph([(1, START_GENE_ID), (START_GENE_ID, 2)])
+        self.assertEqual(graph_edge_keys(graph).size, 2)
+        self.assertEqual(graph_edge_keys(nx.Graph()).size, 0)
+
+    def test_participation_distribution(self):
+        self.assertEqual(
+            participation_distribution([{1, 2}, {2, 3}, {2}, set()]), {1: 2, 3: 1}
+        )
+        self.assertEqual(participation_distribution([]), {})
+
+
+class TestArrayStatisticsMatchLoops(unittest.TestCase):
+    def test_random_instances(self):
+        for seed in range(10):
+            graph, bicliques = random_instance(seed)
+            with self.subTest(seed=seed):
+                dmr_sets = [d for d, _ in bicliques]
+                gene_sets = [g for _, g in bicliques]
+
+                participation = calculate_node_participation(bicliques)
+                self.assertEqual(participation["dmrs"], reference_participation(dmr_sets))
+                self.assertEqual(
+                    participation["genes"], reference_participation(gene_sets)
+                )
+
+                single, multiple, uncovered = reference_edge_coverage(bicliques, graph)
+                edges = calculate_edge_coverage(bicliques, graph)
+                self.assertEqual(edges["single_coverage"], single)
+                self.assertEqual(edges["multiple_coverage"], multiple)
+                self.assertEqual(edges["uncovered"], uncovered)
+                self.assertEqual(edges["total"], graph.number_of_edges())
+
+                single, multiple, covered = reference_cell_coverage(bicliques)
+                stats = calculate_coverage_statistics(bicliques, graph)
+                self.assertEqual(stats["edges"]["single_coverage"], single)
+                self.assertEqual(stats["edges"]["multiple_coverage"], multiple)
+                self.assertEqual(
+                    stats["edges"]["uncovered"], graph.number_of_edges() - covered
+                )
+                self.assertEqual(
+                    stats["dmrs"]["participation"], reference_participation(dmr_sets)
+                )
+
+                coverage = calculate_coverage(bicliques, graph)
+                self.assertEqual(
+                    coverage["dmrs"]["covered"], len(set().union(*dmr_sets))
+                )
+                self.assertEqual(coverage["genes"]["total"], 30)
+
+                self.assertEqual(
+                    calculate_edge_distribution(bicliques, graph),
+                    reference_edge_distribution(bicliques, graph),
+                )
+
+    def test_no_bicliques(self):
+        graph, _ = random_instance(0)
+        edges = calculate_edge_coverage([], graph)
+        self.assertEqual(edges["uncovered"], graph.number_of_edges())
+        self.assertEqual(calculate_node_participation([]), {"dmrs": {}, "genes": {}})
+        self.assertEqual(calculate_edge_distribution([], graph), {})
+
+
+if __name__ == "__main__":
+    unittest.main()
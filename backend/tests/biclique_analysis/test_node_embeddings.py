@@ -0,0 +1,156 @@
+import os
+import tempfile
+import unittest
+from unittest import mock
+
+import networkx as nx
+import numpy as np
+from flask import Flask
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app.database.models import Base, Biclique, Timepoint
+from backend.app.routes import similarity_routes
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.utils.id_mapping import convert_dmr_id
+from backend.app.biclique_analysis import node_embeddings
+from backend.app.biclique_analysis.node_embeddings import (
+    BICLIQUE,
+    DMR,
+    GENE,
+    SimilarityIndex,
+    get_similarity_index,
+    stored_bicliques,
+)
+
+TIMEPOINT = 2  # non-zero DMR id offset
+
+
+def make_graph(num_blocks=6, dmrs=5, genes=4):
+    """Disjoint complete bipartite blocks, an isolated gene and a bridging edge."""
+    graph = nx.Graph()
+    blocks = []
+    for b in range(num_blocks):
+        dmr_nodes = [b * dmrs + i for i in range(dmrs)]
+        gene_nodes = [START_GENE_ID + b * genes + i for i in range(genes)]
+        graph.add_nodes_from(dmr_nodes, bipartite=0)
+        graph.add_nodes_from(gene_nodes, bipartite=1)
+        graph.add_edges_from((d, g) for d in dmr_nodes for g in gene_nodes)
+        blocks.append((set(dmr_nodes), set(gene_nodes)))
+    graph.add_edge(0, START_GENE_ID + genes)
+    graph.add_node(START_GENE_ID + 999, bipartite=1)
+    return graph, blocks
+
+
+class TestNodeEmbeddings(unittest.TestCase):
+    def setUp(self):
+        self.graph, self.blocks = make_graph()
+        self.bicliques = {10 + i: block for i, block in enumerate(self.blocks)}
+        self.index = SimilarityIndex.build(self.graph, self.bicliques, dimensions=8)
+
+    def test_vectors_are_unit_float32(self):
+        self.assertEqual(self.index.vectors.dtype, np.float32)
+        norms = np.linalg.norm(self.index.vectors, axis=1)
+        np.testing.assert_allclose(norms, 1.0, atol=1e-5)
+        # Isolated nodes are not embedded
+        self.assertIsNone(self.index.row(START_GENE_ID + 999))
+        self.assertEqual(len(self.index), 30 + 24 + 6)
+
+    def test_genes_of_a_block_are_most_similar(self):
+        gene = START_GENE_ID + 9  # block 2
+        results = self.index.similar(gene, k=3, kind=GENE)
+        self.assertEqual(len(results), 3)
+        self.assertNotIn(gene, [r["id"] for r in results])
+        self.assertEqual({r["id"] for r in results}, self.blocks[2][1] - {gene})
+        self.assertTrue(all(r["type"] == "gene" for r in results))
+        scores = [r["similarity"] for r in results]
+        self.assertEqual(scores, sorted(scores, reverse=True))
+
+    def test_biclique_queries(self):
+        nearest = self.index.similar(12, k=1, kind=BICLIQUE, source_kind=BICLIQUE)
+        self.assertEqual(len(nearest), 1)
+        self.assertNotEqual(nearest[0]["id"], 12)
+        members = self.index.similar(12, k=5, kind=DMR, source_kind=BICLIQUE)
+        self.assertEqual({r["id"] for r in members}, self.blocks[2][0])
+        self.assertIsNone(self.index.similar(5000, k=1))
+
+    def test_approximate_index_matches_exact(self):
+        if node_embeddings.hnswlib is None:
+            self.skipTest("hnswlib not installed")
+        ann = SimilarityIndex.build(self.graph, self.bicliques, dimensions=8, use_ann=True)
+        self.assertIsNotNone(ann.ann)
+        for node in (3, START_GENE_ID + 5):
+            exact = {r["id"] for r in self.index.similar(node, k=3, kind=DMR)}
+            approx = {r["id"] for r in ann.similar(node, k=3, kind=DMR)}
+            self.assertEqual(exact, approx)
+
+    def test_save_and_load(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            directory = os.path.join(tmp, "1")
+            self.index.save(directory)
+            loaded = get_similarity_index(directory)
+            self.assertIs(loaded, get_similarity_index(directory))
+            np.testing.assert_array_equal(loaded.vectors, self.index.vectors)
+            self.assertEqual(
+                loaded.similar(START_GENE_ID, k=5), self.index.similar(START_GENE_ID, k=5)
+            )
+            self.assertIsNone(get_similarity_index(os.path.join(tmp, "missing")))
+
+
+class TestStoredBicliques(unittest.TestCase):
+    def setUp(self):
+        self.graph, self.blocks = make_graph()
+        engine = create_engine("sqlite://")
+        Base.metadata.create_all(engine)
+        with Session(engine) as session:
+            session.add(Timepoint(id=TIMEPOINT, name="P21-P28", sheet_name="P21-P28_TSS"))
+            for i, (dmrs, genes) in enumerate(self.blocks):
+                session.add(
+                    Biclique(
+                        id=10 + i,
+                        timepoint_id=TIMEPOINT,
+                        dmr_ids=sorted(convert_dmr_id(d, TIMEPOINT) for d in dmrs),
+                        gene_ids=sorted(genes),
+                    )
+                )
+            session.commit()
+            self.bicliques = stored_bicliques(session, TIMEPOINT)
+        engine.dispose()
+        self.index = SimilarityIndex.build(self.graph, self.bicliques, dimensions=8)
+
+    def test_members_are_graph_nodes(self):
+        self.assertEqual(self.bicliques, {10 + i: b for i, b in enumerate(self.blocks)})
+        members = self.index.similar(12, k=5, kind=DMR, source_kind=BICLIQUE)
+        self.assertEqual({r["id"] for r in members}, self.blocks[2][0])
+
+    def test_route_takes_and_returns_table_ids(self):
+        app = Flask(__name__)
+        app.register_blueprint(similarity_routes.similarity_bp)
+        client = app.test_client()
+        with tempfile.TemporaryDirectory() as tmp, mock.patch.object(
+            similarity_routes, "get_embedding_root", lambda: tmp
+        ):
+            self.index.save(os.path.join(tmp, str(TIMEPOINT)))
+            dmr = convert_dmr_id(6, TIMEPOINT)  # block 1
+            response = client.get(f"/api/similarity/{TIMEPOINT}/similar/{dmr}?type=dmr&k=4")
+            self.assertEqual(response.status_code, 200)
+            self.assertEqual(
+                {r["id"] for r in response.get_json()["data"]},
+                {convert_dmr_id(d, TIMEPOINT) for d in self.blocks[1][0]} - {dmr},
+            )
+            response = client.get(
+                f"/api/similarity/{TIMEPOINT}/similar/12?source=biclique&type=dmr&k=5"
+            )
+            self.assertEqual(
+                {r["id"] for r in response.get_json()["data"]},
+                {convert_dmr_id(d, TIMEPOINT) for d in self.blocks[2][0]},
+            )
+            gene = START_GENE_ID + 9
+            response = client.get(f"/api/similarity/{TIMEPOINT}/similar/{gene}?type=gene&k=3")
+            self.assertEqual(
+                {r["id"] for r in response.get_json()["data"]}, self.blocks[2][1] - {gene}
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,118 @@
+import unittest
+
+import networkx as nx
+import numpy as np
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.utils.id_mapping import convert_dmr_id
+from backend.app.biclique_analysis.significance import (
+    EdgeArrays,
+    compute_biclique_significance,
+    swap_edges,
+)
+from backend.app.database.models import Base, Biclique, Metadata, Statistic, Timepoint
+from backend.app.database.operations import store_biclique_significance
+
+
+def planted_graph(seed=0, n_dmrs=300, n_genes=200, edges=600):
+    """Sparse random bipartite graph with a planted K(4,5) on DMRs 0-3."""
+    rng = np.random.default_rng(seed)
+    graph = nx.Graph()
+    graph.add_nodes_from(range(n_dmrs), bipartite=0)
+    graph.add_nodes_from(range(START_GENE_ID, START_GENE_ID + n_genes), bipartite=1)
+    for d, g in zip(rng.integers(0, n_dmrs, edges), rng.integers(0, n_genes, edges)):
+        graph.add_edge(int(d), START_GENE_ID + int(g))
+    planted = (set(range(4)), set(range(START_GENE_ID, START_GENE_ID + 5)))
+    graph.add_edges_from((d, g) for d in planted[0] for g in planted[1])
+    return graph, planted
+
+
+class TestEdgeSwaps(unittest.TestCase):
+    def test_swaps_preserve_degrees_without_multi_edges(self):
+        graph, _ = planted_graph()
+        edges = EdgeArrays.from_graph(graph)
+        gene = swap_edges(
+            edges.dmr, edges.gene, len(edges.gene_ids), 10, np.random.default_rng(1)
+        )
+        keys = edges.dmr * len(edges.gene_ids) + gene
+        self.assertEqual(len(np.unique(keys)), len(keys))
+        np.testing.assert_array_equal(
+            np.bincount(gene, minlength=len(edges.gene_ids)),
+            np.bincount(edges.gene, minlength=len(edges.gene_ids)),
+        )
+        # Most edges have moved
+        self.assertGreater(np.mean(gene != edges.gene), 0.5)
+
+
+class TestBicliqueSignificance(unittest.TestCase):
+    def setUp(self):
+        self.graph, planted = planted_graph()
+        star_dmr = next(n for n in range(4, 300) if self.graph.degree(n) >= 2)
+        self.bicliques = [
+            planted,
+            ({star_dmr}, set(self.graph.neighbors(star_dmr))),
+        ]
+
+    def test_planted_biclique_is_significant(self):
+        result = compute_biclique_significance(
+            self.graph, self.bicliques, n_null=60, max_workers=1
+        )
+        planted, star = result["bicliques"]
+        self.assertEqual(planted["observed_common_genes"], 5)
+        self.assertLess(planted["null_mean_common_genes"], 1)
+        self.assertAlmostEqual(planted["p_value"], 1 / 61)
+        # A single DMR's neighbourhood is fixed by its degree
+        self.assertEqual(star["p_value"], 1.0)
+        self.assertEqual(result["sizes"]["K(2,5)"]["p_value"], 1 / 61)
+        self.assertIn("K(4,2)", result["sizes"])
+
+    def test_results_do_not_depend_on_worker_count(self):
+        inline = compute_biclique_significance(
+            self.graph, self.bicliques, n_null=30, max_workers=1, seed=7
+        )
+        parallel = compute_biclique_significance(
+            self.graph, self.bicliques, n_null=30, max_workers=2, seed=7
+        )
+        self.assertEqual(inline, parallel)
+
+    def test_store_p_values(self):
+        engine = create_engine("sqlite://")
+        Base.metadata.create_all(engine)
+        result = compute_biclique_significance(
+            self.graph, self.bicliques, n_null=10, max_workers=1
+        )
+        with Session(engine) as session:
+            session.add(Timepoint(id=1, name="DSS1", sheet_name="DSS1"))
+            dmrs, genes = self.bicliques[0]
+            session.add(
+                Biclique(
+                    id=5,
+                    timepoint_id=1,
+                    dmr_ids=sorted(convert_dmr_id(d, 1) for d in dmrs),
+                    gene_ids=sorted(genes),
+                )
+            )
+            session.commit()
+
+            self.assertEqual(store_biclique_significance(session, 1, self.bicliques, result), 1)
+            # Storing again replaces the previous values
+            store_biclique_significance(session, 1, self.bicliques, result)
+            values = {
+                m.key: m.value
+                for m in session.query(Metadata).filter(Metadata.entity_id == 5)
+            }
+            self.assertEqual(float(values["null_p_value"]), 1 / 11)
+            self.assertEqual(len(values), 2)
+            self.assertEqual(
+                session.query(Statistic)
+                .filter(Statistic.category == "timepoint_1_significance")
+                .count(),
+                1,
+            )
+        engine.dispose()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,118 @@
+import unittest
+from unittest import mock
+
+import networkx as nx
+import numpy as np
+import pandas as pd
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app import native
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.utils.id_mapping import convert_dmr_id
+from backend.app.biclique_analysis.stability import compute_stability, parse_source_weights
+from backend.app.core.rb_domination import greedy_rb_domination
+from backend.app.database.models import Base, Biclique, Metadata, Statistic, Timepoint
+from backend.app.database.operations import store_stability_scores
+
+
+def noisy_graph(seed=0, n_dmrs=60, n_genes=50, edges=120):
+    """Random sparse edges tagged "enhancer" plus a K(3,4) tagged "nearby"."""
+    rng = np.random.default_rng(seed)
+    graph = nx.Graph()
+    graph.add_nodes_from(range(n_dmrs), bipartite=0)
+    graph.add_nodes_from(range(START_GENE_ID, START_GENE_ID + n_genes), bipartite=1)
+    sources = {}
+    for d, g in zip(rng.integers(3, n_dmrs, edges), rng.integers(4, n_genes, edges)):
+        graph.add_edge(int(d), START_GENE_ID + int(g))
+        sources[(int(d), START_GENE_ID + int(g))] = {"enhancer"}
+    block = ({0, 1, 2}, {START_GENE_ID + i for i in range(4)})
+    for d in block[0]:
+        for g in block[1]:
+            graph.add_edge(d, g)
+            sources[(d, g)] = {"nearby"}
+    graph.graph["edge_sources"] = sources
+    return graph, block
+
+
+class TestStability(unittest.TestCase):
+    def setUp(self):
+        self.graph, self.block = noisy_graph()
+        self.bicliques = [self.block, ({5}, set(self.graph.neighbors(5)))]
+
+    def test_unperturbed_replicates_reproduce_the_base_result(self):
+        result = compute_stability(
+            self.graph, self.bicliques, n_replicates=4, drop_rate=0.0, max_workers=1
+        )
+        base = greedy_rb_domination(self.graph, pd.DataFrame({"DMR_No.": range(1, 61)}))
+        self.assertEqual(result["dmrs"], {d: 1.0 for d in base})
+        self.assertEqual([b["survival_rate"] for b in result["bicliques"]], [1.0, 1.0])
+        self.assertEqual(result["coverage"]["std"], 0.0)
+
+    def test_source_weights_protect_edges(self):
+        weights = parse_source_weights("nearby=0, enhancer = 1.5")
+        self.assertEqual(weights, {"nearby": 0.0, "enhancer": 1.5})
+        result = compute_stability(
+            self.graph,
+            self.bicliques,
+            n_replicates=30,
+            drop_rate=0.5,
+            add_rate=0.2,
+            source_weights=weights,
+            max_workers=1,
+        )
+        block, star = result["bicliques"]
+        self.assertEqual(block["survival_rate"], 1.0)
+        self.assertLess(star["mean_cell_retention"], 0.6)
+        self.assertTrue(all(0 < f <= 1 for f in result["dmrs"].values()))
+
+    def test_results_do_not_depend_on_worker_count(self):
+        kwargs = dict(n_replicates=25, drop_rate=0.3, add_rate=0.1, seed=3)
+        inline = compute_stability(self.graph, self.bicliques, max_workers=1, **kwargs)
+        parallel = compute_stability(self.graph, self.bicliques, max_workers=2, **kwargs)
+        self.assertEqual(inline, parallel)
+        if native.available():
+            with mock.patch.object(native, "_kernels", None):
+                fallback = compute_stability(self.graph, self.bicliques, max_workers=1, **kwargs)
+            self.assertEqual(fallback, inline)
+
+    def test_store_stability_scores(self):
+        engine = create_engine("sqlite://")
+        Base.metadata.create_all(engine)
+        result = compute_stability(
+            self.graph, self.bicliques, n_replicates=5, max_workers=1
+        )
+        with Session(engine) as session:
+            session.add(Timepoint(id=1, name="DSS1", sheet_name="DSS1"))
+            dmrs, genes = self.block
+            session.add(
+                Biclique(
+                    id=7,
+                    timepoint_id=1,
+                    dmr_ids=sorted(convert_dmr_id(d, 1) for d in dmrs),
+                    gene_ids=sorted(genes),
+                )
+            )
+            session.commit()
+
+            self.assertEqual(store_stability_scores(session, 1, self.bicliques, result), 1)
+            store_stability_scores(session, 1, self.bicliques, result)
+            values = {
+                m.key: float(m.value)
+                for m in session.query(Metadata).filter(Metadata.entity_id == 7)
+            }
+            self.assertEqual(
+                values["stability_survival_rate"], result["bicliques"][0]["survival_rate"]
+            )
+            self.assertEqual(len(values), 2)
+            self.assertEqual(
+                session.query(Statistic)
+                .filter(Statistic.category == "timepoint_1_stability")
+                .count(),
+                1,
+            )
+        engine.dispose()
+
+
+if __name__ == "__main__":
+    unittest.main()
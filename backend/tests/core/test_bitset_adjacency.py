@@ -0,0 +1,122 @@
+import unittest
+from unittest import mock
+
+import networkx as nx
+import numpy as np
+import pandas as pd
+
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.biclique_analysis import edge_classification
+from backend.app.biclique_analysis.edge_classification import classify_edges
+from backend.app.core import rb_domination
+from backend.app.core.bitset_adjacency import BitsetAdjacency, dense_components, popcount
+from backend.app.core.rb_domination import greedy_rb_domination_python
+
+
+def dense_block(seed, n_dmrs=70, n_genes=90, density=0.3, dmr_offset=0, gene_offset=0):
+    rng = np.random.default_rng(seed)
+    graph = nx.Graph()
+    dmrs = range(dmr_offset, dmr_offset + n_dmrs)
+    genes = range(START_GENE_ID + gene_offset, START_GENE_ID + gene_offset + n_genes)
+    graph.add_nodes_from(dmrs, bipartite=0)
+    graph.add_nodes_from(genes, bipartite=1)
+    mask = rng.random((n_dmrs, n_genes)) < density
+    for i, j in zip(*np.nonzero(mask)):
+        graph.add_edge(dmrs[i], genes[j])
+    # A degree-1 gene exercises the forced choice
+    graph.add_edge(dmrs[0], START_GENE_ID + gene_offset + n_genes)
+    graph.nodes[START_GENE_ID + gene_offset + n_genes]["bipartite"] = 1
+    return graph
+
+
+class TestBitsetKernels(unittest.TestCase):
+    def setUp(self):
+        self.graph = dense_block(0)
+        self.bits = BitsetAdjacency.from_graph(self.graph)
+
+    def test_popcount_and_degrees(self):
+        words = np.array([0, 1, 2**63, 2**64 - 1], dtype=np.uint64)
+        np.testing.assert_array_equal(popcount(words), [0, 1, 1, 64])
+        degrees = dict(zip(self.bits.dmr_ids.tolist(), self.bits.degrees().tolist()))
+        self.assertEqual(degrees, {d: self.graph.degree(d) for d in self.bits.dmr_ids.tolist()})
+
+    def test_common_neighbor_counts(self):
+        dmrs = [3, 0, 41, 7]
+        counts = self.bits.common_neighbor_counts(dmrs)
+        for i, a in enumerate(dmrs):
+            for j, b in enumerate(dmrs):
+                shared = set(self.graph.neighbors(a)) & set(self.graph.neighbors(b))
+                self.assertEqual(counts[i, j], len(shared))
+
+    def test_maximal_biclique(self):
+        dmrs, genes = self.bits.maximal_biclique([5, 9])
+        expected_genes = set(self.graph.neighbors(5)) & set(self.graph.neighbors(9))
+        self.assertEqual(genes, expected_genes)
+        self.assertEqual(
+            dmrs, {d for d in self.bits.dmr_ids.tolist() if expected_genes <= set(self.graph[d])}
+        )
+        self.assertEqual(self.bits.cell_count(dmrs, genes), len(dmrs) * len(genes))
+        with self.assertRaises(KeyError):
+            self.bits.maximal_biclique([10**6])
+
+    def test_greedy_domination_matches_reference(self):
+        for seed in range(4):
+            graph = dense_block(seed, density=0.05 + 0.1 * seed)
+            df = pd.DataFrame(
+                {
+                    "DMR_No.": np.arange(1, 71),
+                    "Area_Stat": np.random.default_rng(seed).integers(0, 3, 70).astype(float),
+                }
+            )
+            area = dict(zip(df["DMR_No."] - 1, df["Area_Stat"]))
+            self.assertEqual(
+                BitsetAdjacency.from_graph(graph).greedy_domination(area),
+                greedy_rb_domination_python(graph, df, area_col="Area_Stat"),
+            )
+
+
+class TestDenseDispatch(unittest.TestCase):
+    def setUp(self):
+        # One dense block next to a sparse path-like component
+        self.graph = dense_block(1)
+        sparse = [(200 + i, START_GENE_ID + 500 + i // 2) for i in range(40)]
+        self.graph.add_nodes_from((d for d, _ in sparse), bipartite=0)
+        self.graph.add_nodes_from((g for _, g in sparse), bipartite=1)
+        self.graph.add_edges_from(sparse)
+
+    def test_dense_components(self):
+        dense = dense_components(self.graph)
+        self.assertEqual(len(dense), 1)
+        self.assertIn(0, dense[0])
+        self.assertNotIn(200, dense[0])
+
+    def test_domination_splits_dense_components(self):
+        df = pd.DataFrame({"DMR_No.": np.arange(1, 241)})
+        with mock.patch.object(
+            BitsetAdjacency, "greedy_domination", autospec=True, side_effect=BitsetAdjacency.greedy_domination
+        ) as kernel:
+            result = rb_domination.greedy_rb_domination(self.graph, df)
+        kernel.assert_called_once()
+        self.assertEqual(result, greedy_rb_domination_python(self.graph, df))
+
+    def test_classify_edges_counts(self):
+        graph = dense_block(2)
+        rng = np.random.default_rng(2)
+        bicliques = [
+            (set(rng.choice(70, 4, replace=False).tolist()),
+             set((START_GENE_ID + rng.choice(90, 5, replace=False)).tolist()))
+            for _ in range(10)
+        ] + [({3}, set(graph.neighbors(3)))]
+        biclique_graph = nx.Graph()
+        biclique_graph.add_nodes_from(graph.nodes(data=True))
+        for dmrs, genes in bicliques[:-1]:
+            biclique_graph.add_edges_from((d, g) for d in dmrs for g in genes)
+
+        result = classify_edges(graph, biclique_graph, {}, bicliques)
+        with mock.patch.object(edge_classification, "is_dense", return_value=False):
+            expected = classify_edges(graph, biclique_graph, {}, bicliques)
+        self.assertEqual(result["stats"], expected["stats"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,153 @@
+"""Tests for opt-in per-request CPU profiling."""
+
+import json
+import time
+
+import pytest
+from flask import Flask, jsonify
+
+from backend.app.utils.cpu_profiler import (
+    DEFAULT_HISTORY,
+    ProfileStore,
+    init_cpu_profiler,
+)
+
+TOKEN = "secret"
+ADMIN = {"X-Admin-Token": TOKEN}
+
+
+def classify(n):
+    total = 0
+    for i in range(n):
+        total += sum(j * j for j in range(200))
+    return total
+
+
+def serialize(n):
+    return [json.dumps({"i": i, "values": list(range(50))}) for i in range(n)]
+
+
+@pytest.fixture
+def app(tmp_path):
+    app = Flask(__name__)
+    app.config.update(
+        CPU_PROFILE=True,
+        CPU_PROFILE_TOKEN=TOKEN,
+        CPU_PROFILE_DIR=str(tmp_path / "profiles"),
+        CPU_PROFILE_INTERVAL_MS=1,
+        CPU_PROFILE_HISTORY=3,
+    )
+
+    @app.route("/component")
+    def component():
+        deadline = time.perf_counter() + 0.15
+        while time.perf_counter() < deadline:
+            classify(20)
+        serialize(200)
+        return jsonify({"ok": True})
+
+    init_cpu_profiler(app)
+    return app
+
+
+def test_disabled_without_token():
+    app = Flask(__name__)
+    app.config.update(CPU_PROFILE=True)
+    assert init_cpu_profiler(app) is None
+    assert "cpu_profiler" not in app.extensions
+
+
+def test_config_from_environment(tmp_path):
+    """configure_app passes unset variables as None and set ones as strings."""
+    app = Flask(__name__)
+    app.config.update(
+        CPU_PROFILE=True,
+        CPU_PROFILE_TOKEN=TOKEN,
+        CPU_PROFILE_DIR=str(tmp_path / "profiles"),
+        CPU_PROFILE_HISTORY=None,
+        CPU_PROFILE_MAX_MB="0.5",
+        CPU_PROFILE_INTERVAL_MS="2.5",
+        CPU_PROFILE_MAX_EVENTS="100",
+    )
+    profiler = init_cpu_profiler(app)
+    assert profiler.store.max_profiles == DEFAULT_HISTORY
+    assert profiler.store.max_bytes == 512 * 1024
+    assert (profiler.interval_ms, profiler.max_events) == (2.5, 100)
+
+
+def test_unflagged_and_unauthorized_requests(app):
+    client = app.test_client()
+    response = client.get("/component")
+    assert response.status_code == 200
+    assert "X-CPU-Profile-Id" not in response.headers
+
+    assert client.get("/component?profile=cpu").status_code == 403
+    assert client.get("/component", headers={"X-Profile": "cpu", "X-Admin-Token": "x"}).status_code == 403
+    assert client.get("/component?profile=gpu", headers=ADMIN).status_code == 400
+    assert client.get("/debug/profiles").status_code == 404
+
+
+def test_sampled_profile(app):
+    client = app.test_client()
+    response = client.get("/component?profile=cpu", headers=ADMIN)
+    assert response.status_code == 200
+    assert response.headers["X-CPU-Profile-Mode"] == "sample"
+    profile_id = response.headers["X-CPU-Profile-Id"]
+    assert response.headers["X-CPU-Profile-Url"] == f"/debug/profiles/{profile_id}"
+
+    speedscope = client.get(f"/debug/profiles/{profile_id}", headers=ADMIN).get_json()
+    frames = speedscope["shared"]["frames"]
+    profile = speedscope["profiles"][0]
+    assert profile["type"] == "sampled"
+    assert len(profile["samples"]) == len(profile["weights"]) > 10
+    assert all(0 <= i < len(frames) for stack in profile["samples"] for i in stack)
+
+    summary = client.get(f"/debug/profiles/{profile_id}/summary", headers=ADMIN).get_json()["data"]
+    assert summary["path"] == "/component"
+    by_name = {f["name"]: f for f in summary["summary"]}
+    # Most of the time is in the generator inside classify, under component
+    assert "classify.<locals>.<genexpr>" in by_name or "classify" in by_name
+    assert summary["summary"][0]["self_ms"] <= summary["summary"][0]["total_ms"]
+
+
+def test_traced_profile(app):
+    client = app.test_client()
+    response = client.get("/component", headers={"X-Profile": "trace", **ADMIN})
+    assert response.headers["X-CPU-Profile-Mode"] == "trace"
+    profile_id = response.headers["X-CPU-Profile-Id"]
+
+    speedscope = client.get(f"/debug/profiles/{profile_id}", headers=ADMIN).get_json()
+    frames = speedscope["shared"]["frames"]
+    events = speedscope["profiles"][0]["events"]
+    # Events are balanced and properly nested
+    stack = []
+    for event in events:
+        if event["type"] == "O":
+            stack.append(event["frame"])
+        else:
+            assert stack.pop() == event["frame"]
+    assert stack == []
+    names = {frames[e["frame"]]["name"] for e in events}
+    assert {"app.<locals>.component", "classify", "serialize", "dumps"} <= names
+
+    summary = client.get(f"/debug/profiles/{profile_id}/summary", headers=ADMIN).get_json()["data"]
+    totals = {f["name"]: f["total_ms"] for f in summary["summary"]}
+    assert summary["mode"] == "trace"
+    assert not summary["truncated"]
+    assert any(name.startswith("classify") for name in totals)
+
+
+def test_store_is_bounded(app, tmp_path):
+    client = app.test_client()
+    ids = [
+        client.get("/component?profile=cpu", headers=ADMIN).headers["X-CPU-Profile-Id"]
+        for _ in range(4)
+    ]
+    listed = client.get("/debug/profiles", headers=ADMIN).get_json()["profiles"]
+    assert sorted(p["profile_id"] for p in listed) == sorted(ids[1:])
+    assert client.get(f"/debug/profiles/{ids[0]}", headers=ADMIN).status_code == 404
+    assert client.get("/debug/profiles/../../etc", headers=ADMIN).status_code == 404
+
+    store = ProfileStore(str(tmp_path / "small"), max_profiles=10, max_bytes=1)
+    store.save("0123456789ab", {"profiles": []}, {"profile_id": "0123456789ab"})
+    assert store.recent() == []
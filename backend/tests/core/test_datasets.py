@@ -0,0 +1,157 @@
+import json
+import os
+import tempfile
+import unittest
+from unittest import mock
+
+import networkx as nx
+from flask import Flask
+from sqlalchemy.orm import Session
+
+from backend.app.core.datasets import (
+    DatasetConfig,
+    DatasetRegistry,
+    activate,
+    get_graph_manager,
+)
+from backend.app.core.graph_manager import GraphManager, estimate_graph_bytes
+from backend.app.database.connection import get_db_engine
+from backend.app.database.models import Base, EdgeDetails, Gene, Timepoint
+from backend.app.routes.dataset_routes import dataset_bp
+from backend.app.routes.edge_routes import edge_bp
+from backend.app.utils.id_mapping import reverse_create_dmr_id
+
+
+def make_database(path, dmr_id_offset, gene_symbol):
+    """Two timepoints; DMR 1 of the first has a single edge to gene_symbol."""
+    url = f"sqlite:///{path}"
+    engine = get_db_engine(url)
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add(Timepoint(id=1, name="P21-P28", sheet_name="P21-P28_TSS", dmr_id_offset=dmr_id_offset))
+        session.add(Timepoint(id=2, name="P21-P40", sheet_name="P21-P40_TSS", dmr_id_offset=dmr_id_offset + 500))
+        session.add(Gene(id=10, symbol=gene_symbol))
+        session.add(EdgeDetails(dmr_id=1, gene_id=10, timepoint_id=1, edge_type="promoter"))
+        session.commit()
+    return url
+
+
+class TestDatasetRoutes(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.original_env = dict(os.environ)
+        os.environ["DATABASE_URL"] = make_database(
+            os.path.join(self.tmp.name, "default.db"), 0, "DefaultGene"
+        )
+        self.manifest = os.path.join(self.tmp.name, "datasets.json")
+
+        self.app = Flask(__name__)
+        self.app.register_blueprint(edge_bp, url_prefix="/api/edge-details")
+        self.app.register_blueprint(dataset_bp)
+        self.app.datasets = DatasetRegistry(self.manifest)
+        self.client = self.app.test_client()
+
+    def tearDown(self):
+        os.environ.clear()
+        os.environ.update(self.original_env)
+        self.tmp.cleanup()
+
+    def add_dataset(self, name, gene_symbol, **entry):
+        data_dir = os.path.join(self.tmp.name, name)
+        os.makedirs(data_dir)
+        make_database(os.path.join(data_dir, "dmr_analysis.db"), 1000, gene_symbol)
+        manifest = {"datasets": {}}
+        if os.path.exists(self.manifest):
+            with open(self.manifest) as f:
+                manifest = json.load(f)
+        manifest["datasets"][name] = {"data_dir": data_dir, **entry}
+        with open(self.manifest, "w") as f:
+            json.dump(manifest, f)
+        self.app.datasets.refresh(force=True)
+
+    def genes(self, url):
+        response = self.client.get(url)
+        self.assertEqual(response.status_code, 200, response.get_json())
+        return [e["gene_symbol"] for e in response.get_json()["edges"]]
+
+    def test_routes_are_scoped_to_dataset(self):
+        self.add_dataset("cohort_b", "CohortGene")
+        self.assertEqual(self.genes("/api/edge-details/timepoint/1/dmr/1"), ["DefaultGene"])
+        self.assertEqual(
+            self.genes("/api/datasets/cohort_b/edge-details/timepoint/1/dmr/1"), ["CohortGene"]
+        )
+        # Nothing leaks out of the request scope
+        with self.app.app_context():
+            self.assertIsNone(get_graph_manager())
+
+    def test_dataset_added_without_restart(self):
+        url = "/api/datasets/cohort_c/edge-details/timepoint/1/dmr/1"
+        self.assertEqual(self.client.get(url).status_code, 404)
+        self.add_dataset("cohort_c", "LateGene", timepoints=[1])
+        self.assertEqual(self.genes(url), ["LateGene"])
+
+        status = self.client.get("/api/datasets/cohort_c/status").get_json()["data"]
+        self.assertTrue(status["loaded"])
+        self.assertEqual(status["timepoints"], [1])
+        self.assertEqual(status["loaded_timepoints"], [])
+
+        self.client.post("/api/datasets/cohort_c/unload")
+        self.assertFalse(self.client.get("/api/datasets/cohort_c/status").get_json()["data"]["loaded"])
+
+    def test_invalid_manifest(self):
+        with self.assertRaises(ValueError):
+            DatasetConfig.from_dict("bad name", {"data_dir": "/tmp"})
+        with self.assertRaises(ValueError):
+            DatasetConfig.from_dict("cohort", {"data_dir": "/tmp", "dss_file": "x"})
+        with open(self.manifest, "w") as f:
+            f.write("{not json")
+        self.assertEqual(self.client.post("/api/datasets/reload").status_code, 400)
+
+    def test_timepoint_offsets_follow_dataset(self):
+        self.add_dataset("cohort_b", "CohortGene")
+        dataset = self.app.datasets.get("cohort_b")
+        self.assertEqual(reverse_create_dmr_id(10001, 2), 0)
+        with self.app.app_context(), activate(dataset):
+            self.assertEqual(reverse_create_dmr_id(10001, 2), 8500)
+            with self.assertRaises(ValueError):
+                reverse_create_dmr_id(1, 3)
+
+
+class TestGraphMemoryBudget(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.url = make_database(os.path.join(self.tmp.name, "budget.db"), 0, "Gene")
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_least_recently_used_timepoint_is_evicted(self):
+        graph = nx.complete_bipartite_graph(20, 30)
+
+        def fake_load(manager, timepoint_id):
+            manager.original_graphs[timepoint_id] = graph
+            manager.split_graphs[timepoint_id] = graph
+
+        one_timepoint = 2 * estimate_graph_bytes(graph)
+        config = {
+            "DATA_DIR": self.tmp.name,
+            "GRAPH_PRELOAD": False,
+            "GRAPH_MEMORY_BUDGET_MB": 1.5 * one_timepoint / (1024 * 1024),
+        }
+        with mock.patch.object(GraphManager, "_load_graphs", fake_load):
+            manager = GraphManager(config=config, database_url=self.url)
+            self.assertEqual(manager.original_graphs, {})
+
+            manager.get_original_graph(1)
+            manager.get_original_graph(2)
+            self.assertEqual(sorted(manager.original_graphs), [2])
+            manager.get_split_graph(1)
+            self.assertEqual(sorted(manager.original_graphs), [1])
+
+        usage = manager.memory_usage()
+        self.assertEqual(usage["total_bytes"], one_timepoint)
+        self.assertLessEqual(usage["total_bytes"], usage["budget_bytes"])
+
+
+if __name__ == "__main__":
+    unittest.main()
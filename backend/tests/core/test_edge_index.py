@@ -0,0 +1,168 @@
+import tempfile
+import threading
+import time
+import unittest
+from pathlib import Path
+from types import SimpleNamespace
+from unittest import mock
+
+from flask import Flask
+from sqlalchemy import create_engine
+
+from backend.app.core import graph_manager as graph_manager_module
+from backend.app.core.edge_index import EdgeDetailsIndex
+from backend.app.core.graph_manager import GraphManager
+from backend.app.database.models import Base
+from backend.app.routes.edge_routes import edge_bp
+
+
+def make_rows():
+    """Edge details rows as returned by GraphManager.get_edge_index's query."""
+    rows = [
+        (2, 11, "Xyz2", "permanent", None, 500, None),
+        (1, 11, "Xyz2", "promoter", "added", -50, "near"),
+        (1, 10, "Abc1", "promoter", None, 100, "near"),
+        (3, 11, "Xyz2", "enhancer", None, None, None),
+    ]
+    fields = (
+        "dmr_id",
+        "gene_id",
+        "gene_symbol",
+        "edge_type",
+        "edit_type",
+        "distance_from_tss",
+        "description",
+    )
+    return [SimpleNamespace(**dict(zip(fields, row))) for row in rows]
+
+
+class TestEdgeDetailsIndex(unittest.TestCase):
+    def setUp(self):
+        self.index = EdgeDetailsIndex.from_rows(make_rows())
+
+    def test_dmr_slices(self):
+        self.assertEqual(self.index.num_edges, 4)
+        edges = self.index.dmr_edges(1)
+        self.assertEqual([e["gene_id"] for e in edges], [10, 11])
+        self.assertEqual(
+            edges[1],
+            {
+                "dmr_id": 1,
+                "gene_id": 11,
+                "gene_symbol": "Xyz2",
+                "edge_type": "promoter",
+                "edit_type": "added",
+                "distance_from_tss": -50,
+                "description": "near",
+            },
+        )
+        self.assertIsNone(self.index.dmr_edges(3)[0]["distance_from_tss"])
+        self.assertEqual(self.index.dmr_edges(99), [])
+
+    def test_gene_slices(self):
+        self.assertEqual([e["dmr_id"] for e in self.index.gene_edges(11)], [1, 2, 3])
+        self.assertEqual([e["dmr_id"] for e in self.index.gene_edges(10)], [1])
+        self.assertEqual(self.index.gene_edges(12), [])
+
+    def test_set_edit_types(self):
+        changed = self.index.set_edit_types(
+            [(1, 10, "false_positive"), (1, 11, "permanent"), (9, 10, "permanent")]
+        )
+        self.assertEqual(changed, 2)
+        edges = self.index.dmr_edges(1)
+        self.assertEqual([e["edit_type"] for e in edges], ["false_positive", "permanent"])
+        self.assertEqual([e["edge_type"] for e in edges], ["promoter", "promoter"])
+        self.assertEqual(self.index.dmr_edges(3)[0]["edit_type"], None)
+
+    def test_dmr_metadata_layout(self):
+        self.assertEqual(self.index.dmr_edge_counts(), {1: 2, 2: 1, 3: 1})
+        metadata = self.index.dmr_metadata()
+        self.assertEqual(
+            metadata[2]["edge_details"],
+            [
+                {
+                    "gene_id": 11,
+                    "gene_name": "Xyz2",
+                    "edge_type": "permanent",
+                    "distance_from_tss": 500,
+                    "edit_type": None,
+                }
+            ],
+        )
+
+    def test_empty(self):
+        index = EdgeDetailsIndex.from_rows([])
+        self.assertEqual(index.dmr_edges(1), [])
+        self.assertEqual(index.dmr_edge_counts(), {})
+
+
+class TestGraphManagerEdgeIndex(unittest.TestCase):
+    def test_concurrent_first_requests_build_once(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            url = f"sqlite:///{Path(tmp) / 'edges.db'}"
+            engine = create_engine(url)
+            Base.metadata.create_all(engine)
+            engine.dispose()
+            with mock.patch.object(GraphManager, "load_all_timepoints"):
+                manager = GraphManager(config={"GRAPH_PRELOAD": False}, database_url=url)
+
+            builds = []
+            from_rows = EdgeDetailsIndex.from_rows
+
+            def slow_from_rows(rows):
+                builds.append(threading.get_ident())
+                time.sleep(0.05)
+                return from_rows(rows)
+
+            results = []
+            with mock.patch.object(
+                graph_manager_module.EdgeDetailsIndex, "from_rows", side_effect=slow_from_rows
+            ):
+                threads = [
+                    threading.Thread(target=lambda: results.append(manager.get_edge_index(1)))
+                    for _ in range(4)
+                ]
+                for thread in threads:
+                    thread.start()
+                for thread in threads:
+                    thread.join()
+
+            self.assertEqual(len(builds), 1)
+            self.assertEqual(len({id(index) for index in results}), 1)
+
+
+class StubGraphManager:
+    def __init__(self):
+        self.indexes = {1: EdgeDetailsIndex.from_rows(make_rows())}
+
+    def get_edge_index(self, timepoint_id):
+        return self.indexes.get(timepoint_id) or EdgeDetailsIndex.from_rows([])
+
+
+class TestEdgeRoutesFromIndex(unittest.TestCase):
+    def setUp(self):
+        app = Flask(__name__)
+        app.register_blueprint(edge_bp, url_prefix="/api/edge-details")
+        app.graph_manager = StubGraphManager()
+        self.client = app.test_client()
+
+    def test_single_lookups(self):
+        response = self.client.get("/api/edge-details/timepoint/1/gene/11")
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(len(response.get_json()["edges"]), 3)
+        self.assertEqual(
+            self.client.get("/api/edge-details/timepoint/2/dmr/1").status_code, 404
+        )
+
+    def test_batch(self):
+        response = self.client.post(
+            "/api/edge-details/timepoint/1/batch", json={"dmr_ids": [3, 1, 1, 7]}
+        )
+        edges = response.get_json()["edges"]
+        self.assertEqual(sorted(edges), ["1", "3"])
+        self.assertEqual([e["gene_symbol"] for e in edges["1"]], ["Abc1", "Xyz2"])
+        self.assertNotIn("description", edges["3"][0])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,103 @@
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+from backend.app.enrichment.result_cache import (
+    LOCK_STRIPES,
+    EnrichmentCache,
+    enrichment_cache_key,
+)
+
+
+class TestEnrichmentCacheKey(unittest.TestCase):
+    def test_canonical(self):
+        key = enrichment_cache_key(["12", "7", "7"], "Mouse", "david", "v1")
+        self.assertEqual(key, enrichment_cache_key([7, 12], "mouse", "david", "v1"))
+        self.assertNotEqual(key, enrichment_cache_key([7, 12], "human", "david", "v1"))
+        self.assertNotEqual(key, enrichment_cache_key([7, 12], "mouse", "david", "v2"))
+        self.assertEqual(len(key), 64)
+
+    def test_stable_across_processes(self):
+        """Keys must not depend on the per-process hash seed."""
+        code = (
+            "from backend.app.enrichment.result_cache import enrichment_cache_key;"
+            "print(enrichment_cache_key(['7', '12'], 'mouse', 'david', 'v1'))"
+        )
+        keys = set()
+        for seed in ("1", "2"):
+            env = dict(os.environ, PYTHONHASHSEED=seed)
+            output = subprocess.run(
+                [sys.executable, "-c", code],
+                capture_output=True,
+                text=True,
+                env=env,
+                check=True,
+            ).stdout.strip()
+            keys.add(output)
+        self.assertEqual(keys, {enrichment_cache_key([7, 12], "mouse", "david", "v1")})
+
+
+class TestEnrichmentCache(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.path = Path(self.tmp.name) / "cache.db"
+        self.cache = EnrichmentCache(self.path)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_get_or_compute_once(self):
+        calls = []
+
+        def compute(genes):
+            calls.append(genes)
+            return {"terms": genes}
+
+        first = self.cache.get_or_compute(["b", "a"], "mouse", "david", "v1", compute)
+        second = self.cache.get_or_compute(["a", "b", "a"], "mouse", "david", "v1", compute)
+        self.assertEqual(first, {"terms": ["a", "b"]})
+        self.assertEqual(second, first)
+        self.assertEqual(calls, [["a", "b"]])
+
+        # A second instance on the same file (another worker) sees the record
+        other = EnrichmentCache(self.path)
+        self.assertEqual(
+            other.get(enrichment_cache_key(["a", "b"], "mouse", "david", "v1")), first
+        )
+
+    def test_empty_results_not_cached(self):
+        calls = []
+
+        def compute(genes):
+            calls.append(genes)
+            return {}
+
+        self.cache.get_or_compute(["a"], "mouse", "david", "v1", compute)
+        self.cache.get_or_compute(["a"], "mouse", "david", "v1", compute)
+        self.assertEqual(len(calls), 2)
+
+    def test_fill_locks_bounded(self):
+        for i in range(200):
+            self.cache.get_or_compute([str(i)], "mouse", "david", "v1", lambda g: {"terms": g})
+        self.assertEqual(len(self.cache._key_locks), LOCK_STRIPES)
+        key = enrichment_cache_key(["1"], "mouse", "david", "v1")
+        self.assertIs(self.cache._lock_for(key), self.cache._lock_for(key))
+
+    def test_size_bounded_eviction(self):
+        cache = EnrichmentCache(self.path, max_bytes=1)
+        cache.put("old", {"x": 1}, "david", "mouse", "v1", 1)
+        cache.put("new", {"x": 2}, "david", "mouse", "v1", 1)
+        self.assertIsNone(cache.get("old"))
+        self.assertEqual(cache.stats()["records"], 1)
+
+        cache.max_bytes = 10_000
+        cache.put("newer", {"x": 3}, "david", "mouse", "v1", 1)
+        self.assertEqual(cache.get("newer"), {"x": 3})
+        self.assertEqual(cache.stats()["records"], 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,130 @@
+import struct
+import unittest
+
+import networkx as nx
+import numpy as np
+from flask import Flask
+
+from backend.app.core.graph_arrays import GraphArrays, HEADER_FORMAT
+from backend.app.routes.timepoint_routes import timepoint_bp
+
+
+def make_graph():
+    """Two components (a K2,2 and a single edge) plus an isolated DMR."""
+    graph = nx.Graph()
+    graph.add_nodes_from([5, 1, 2, 9], bipartite=0)
+    graph.add_nodes_from([100001, 100000, 100002], bipartite=1)
+    graph.add_edges_from(
+        [(1, 100000), (1, 100001), (2, 100000), (2, 100001), (5, 100002)]
+    )
+    return graph
+
+
+class TestGraphArrays(unittest.TestCase):
+    def setUp(self):
+        self.graph = make_graph()
+        self.arrays = GraphArrays.from_networkx(self.graph)
+
+    def test_csr_matches_graph(self):
+        self.assertEqual(self.arrays.num_nodes, 7)
+        self.assertEqual(self.arrays.num_edges, 5)
+        self.assertEqual(list(self.arrays.node_ids), sorted(self.graph.nodes()))
+        for node in self.graph.nodes():
+            self.assertEqual(
+                sorted(self.arrays.neighbors(node).tolist()),
+                sorted(self.graph.neighbors(node)),
+            )
+        self.assertEqual(len(self.arrays.neighbors(12345)), 0)
+
+    def test_component_labels(self):
+        comp = dict(zip(self.arrays.node_ids.tolist(), self.arrays.component.tolist()))
+        self.assertEqual(comp[9], -1)
+        self.assertEqual(comp[1], comp[100001])
+        self.assertNotEqual(comp[1], comp[5])
+        self.assertEqual(
+            self.arrays.summary(),
+            {
+                "num_nodes": 7,
+                "num_edges": 5,
+                "num_dmrs": 4,
+                "num_genes": 3,
+                "num_isolated": 1,
+                "num_components": 2,
+                "largest_component": 4,
+            },
+        )
+
+    def test_edge_arrays_once(self):
+        src, dst = self.arrays.edge_arrays()
+        edges = {
+            tuple(sorted(e))
+            for e in zip(self.arrays.node_ids[src], self.arrays.node_ids[dst])
+        }
+        self.assertEqual(edges, {tuple(sorted(e)) for e in self.graph.edges()})
+
+    def test_bytes_roundtrip(self):
+        data = self.arrays.to_bytes()
+        self.assertEqual(len(data) % 8, 0)
+        magic, version, n, m, k, sections = struct.unpack_from(HEADER_FORMAT, data)
+        self.assertEqual((magic, n, m, k, sections), (b"DMRG", 7, 5, 2, 5))
+
+        restored = GraphArrays.from_bytes(data)
+        for attr in ("node_ids", "node_type", "indptr", "indices", "component"):
+            np.testing.assert_array_equal(
+                getattr(restored, attr), getattr(self.arrays, attr)
+            )
+
+    def test_empty_graph(self):
+        arrays = GraphArrays.from_networkx(nx.Graph())
+        self.assertEqual(arrays.summary()["num_nodes"], 0)
+        self.assertEqual(GraphArrays.from_bytes(arrays.to_bytes()).num_nodes, 0)
+
+
+class StubGraphManager:
+    def __init__(self, arrays):
+        self.arrays = arrays
+
+    def get_graph_array_bytes(self, timepoint_id, graph_type="original"):
+        return self.arrays.to_bytes() if timepoint_id == 1 else None
+
+    def get_graph_array_etag(self, timepoint_id, graph_type="original"):
+        return "etag-1" if timepoint_id == 1 else None
+
+
+class TestTimepointGraphDownload(unittest.TestCase):
+    def setUp(self):
+        app = Flask(__name__)
+        app.register_blueprint(timepoint_bp)
+        app.graph_manager = StubGraphManager(GraphArrays.from_networkx(make_graph()))
+        self.client = app.test_client()
+        self.data = app.graph_manager.get_graph_array_bytes(1)
+
+    def test_full_download(self):
+        response = self.client.get("/api/timepoints/1/graph")
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(response.data, self.data)
+        self.assertEqual(response.headers["Accept-Ranges"], "bytes")
+        self.assertEqual(response.headers["ETag"], '"etag-1"')
+
+    def test_conditional_request(self):
+        response = self.client.get(
+            "/api/timepoints/1/graph", headers={"If-None-Match": '"etag-1"'}
+        )
+        self.assertEqual(response.status_code, 304)
+
+    def test_range_request(self):
+        response = self.client.get(
+            "/api/timepoints/1/graph", headers={"Range": "bytes=0-23"}
+        )
+        self.assertEqual(response.status_code, 206)
+        self.assertEqual(response.data, self.data[:24])
+
+    def test_unknown_graph(self):
+        self.assertEqual(self.client.get("/api/timepoints/2/graph").status_code, 404)
+        self.assertEqual(
+            self.client.get("/api/timepoints/1/graph?type=bogus").status_code, 400
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,175 @@
+import io
+import json
+import os
+import tempfile
+import time
+import unittest
+from unittest import mock
+
+from flask import Flask
+
+from backend.app.core.datasets import DatasetRegistry
+from backend.app.core.ingest_jobs import IngestCancelled, IngestManager
+from backend.app.routes import graph_routes
+from backend.app.routes.ingest_routes import ingest_bp
+
+UPLOADS = {"DSS1.xlsx": b"dss1", "DSS_PAIRWISE.xlsx": b"pairwise"}
+
+
+def fake_pipeline(job_dir, env, cancel_event, events):
+    """Records its environment and reports a few stages."""
+    with open(os.path.join(job_dir, "env.json"), "w") as f:
+        json.dump(env, f)
+    for stage, detail in [("schema", ""), ("timepoints", "1/2"), ("timepoints", "2/2")]:
+        events.put(("stage", stage, detail, time.time()))
+    events.put(("done",))
+
+
+def slow_pipeline(job_dir, env, cancel_event, events):
+    """Checks for cancellation between stages like initialize_database does."""
+    try:
+        for i in range(200):
+            if cancel_event.is_set():
+                raise IngestCancelled()
+            events.put(("stage", "timepoints", f"{i}/200", time.time()))
+            time.sleep(0.05)
+        events.put(("done",))
+    except IngestCancelled:
+        events.put(("cancelled",))
+
+
+def crashing_pipeline(job_dir, env, cancel_event, events):
+    os._exit(3)
+
+
+class TestIngestJobs(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.registry = DatasetRegistry(os.path.join(self.tmp.name, "datasets.json"))
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def manager(self, pipeline):
+        manager = IngestManager(
+            os.path.join(self.tmp.name, "ingest"),
+            self.registry,
+            pipeline=pipeline,
+            start_method="fork",
+        )
+        self.addCleanup(manager.shutdown)
+        return manager
+
+    def wait_until_finished(self, manager, job_id, timeout=30):
+        deadline = time.time() + timeout
+        job = manager.get(job_id)
+        while job.status not in ("succeeded", "failed", "cancelled"):
+            self.assertLess(time.time(), deadline, job.to_dict())
+            job = manager.wait(job_id, job.version, timeout=1)
+        return job
+
+    def test_successful_job_is_published(self):
+        manager = self.manager(fake_pipeline)
+        job = manager.submit("cohort_b", UPLOADS)
+        job = self.wait_until_finished(manager, job.id)
+        self.assertEqual(job.status, "succeeded", job.error)
+        self.assertEqual([s["name"] for s in job.stages], ["queued", "schema", "timepoints"])
+        self.assertEqual(job.stages[-1]["detail"], "2/2")
+        self.assertTrue(all("seconds" in s for s in job.stages))
+
+        config = self.registry.config("cohort_b")
+        self.assertEqual(config.data_dir, job.directory)
+        with open(os.path.join(job.directory, "env.json")) as f:
+            env = json.load(f)
+        self.assertEqual(config.database_url, env["DATABASE_URL"])
+        self.assertTrue(env["DATABASE_URL"].startswith(f"sqlite:///{job.directory}"))
+
+        # A second version replaces the first in the manifest
+        second = self.wait_until_finished(manager, manager.submit("cohort_b", UPLOADS).id)
+        self.assertEqual(self.registry.config("cohort_b").data_dir, second.directory)
+
+    def test_publish_clears_render_cache(self):
+        self.registry.on_reset(graph_routes.clear_render_cache)
+        self.addCleanup(graph_routes.clear_render_cache)
+        manager = self.manager(fake_pipeline)
+        self.wait_until_finished(manager, manager.submit("cohort_b", UPLOADS).id)
+
+        def cached(dataset):
+            with mock.patch.object(graph_routes, "current_dataset_name", lambda: dataset):
+                return graph_routes.get_cached_render(1, 7)
+
+        for dataset in ("cohort_b", "cohort_c"):
+            with mock.patch.object(graph_routes, "current_dataset_name", lambda: dataset):
+                graph_routes.cache_render(1, 7, {"dataset": dataset})
+        self.assertEqual(cached("cohort_b"), {"dataset": "cohort_b"})
+
+        # The next render of the new version is rebuilt; other datasets keep theirs
+        self.wait_until_finished(manager, manager.submit("cohort_b", UPLOADS).id)
+        self.assertIsNone(cached("cohort_b"))
+        self.assertEqual(cached("cohort_c"), {"dataset": "cohort_c"})
+
+        self.registry.unload("cohort_c")
+        self.assertIsNone(cached("cohort_c"))
+
+    def test_cancel_running_job(self):
+        manager = self.manager(slow_pipeline)
+        job = manager.submit("cohort_b", UPLOADS)
+        while manager.get(job.id).stage != "timepoints":
+            manager.wait(job.id, manager.get(job.id).version, timeout=1)
+        self.assertTrue(manager.cancel(job.id))
+        job = self.wait_until_finished(manager, job.id)
+        self.assertEqual(job.status, "cancelled")
+        self.assertFalse(manager.cancel(job.id))
+        # Staged data is removed and nothing was published
+        self.assertEqual(os.listdir(job.directory), ["job.json"])
+        with self.assertRaises(KeyError):
+            self.registry.config("cohort_b")
+
+    def test_crash_and_bad_requests(self):
+        manager = self.manager(crashing_pipeline)
+        job = self.wait_until_finished(manager, manager.submit("cohort_b", UPLOADS).id)
+        self.assertEqual(job.status, "failed")
+        self.assertIn("exited with code 3", job.error)
+
+        with self.assertRaises(ValueError):
+            manager.submit("default", UPLOADS)
+        with self.assertRaises(ValueError):
+            manager.submit("cohort_b", {"DSS1.xlsx": b""})
+        with self.assertRaises(ValueError):
+            manager.submit("cohort_b", {**UPLOADS, "../x.txt": b""})
+
+    def test_routes(self):
+        app = Flask(__name__)
+        app.register_blueprint(ingest_bp)
+        app.datasets = self.registry
+        app.ingest_manager = self.manager(fake_pipeline)
+        client = app.test_client()
+
+        response = client.post(
+            "/api/ingest/jobs",
+            data={
+                "dataset": "cohort_c",
+                "dss1": (io.BytesIO(b"dss1"), "mine.xlsx"),
+                "dss_pairwise": (io.BytesIO(b"pairwise"), "pairwise.xlsx"),
+                "files": [(io.BytesIO(b"1 2"), "bipartite_graph_output_P21.txt")],
+            },
+            content_type="multipart/form-data",
+        )
+        self.assertEqual(response.status_code, 202)
+        job = response.get_json()["data"]
+        self.assertEqual(
+            job["files"], ["DSS1.xlsx", "DSS_PAIRWISE.xlsx", "bipartite_graph_output_P21.txt"]
+        )
+
+        stream = client.get(f"/api/ingest/jobs/{job['id']}/events").get_data(as_text=True)
+        updates = [json.loads(line[6:]) for line in stream.splitlines() if line.startswith("data: ")]
+        self.assertEqual(updates[-1]["status"], "succeeded")
+
+        self.assertEqual(client.get(f"/api/ingest/jobs/{job['id']}").get_json()["data"]["status"], "succeeded")
+        self.assertEqual(client.post(f"/api/ingest/jobs/{job['id']}/cancel").status_code, 409)
+        self.assertEqual(client.get("/api/ingest/jobs/missing").status_code, 404)
+        self.assertEqual(client.post("/api/ingest/jobs", data={"dataset": "x"}).status_code, 400)
+
+
+if __name__ == "__main__":
+    unittest.main()
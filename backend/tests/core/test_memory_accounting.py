@@ -0,0 +1,186 @@
+import functools
+import sys
+import unittest
+from types import SimpleNamespace
+from unittest import mock
+
+import networkx as nx
+import numpy as np
+from flask import Flask
+
+from backend.app.core.edge_index import EdgeDetailsIndex
+from backend.app.core.graph_arrays import GraphArrays
+from backend.app.core.graph_manager import ComponentMapping, GraphManager, estimate_graph_bytes
+from backend.app.utils.memory_accounting import (
+    DEFAULT_SNAPSHOTS_KEPT,
+    deep_sizeof,
+    graph_manager_report,
+    init_memory_debug,
+    inspectable_lru_cache,
+    lru_cache_report,
+)
+
+TOKEN = "secret"
+
+# Allocations made by a request between two snapshots
+_retained = []
+
+
+def make_manager():
+    with mock.patch.object(GraphManager, "load_all_timepoints"):
+        manager = GraphManager(config={"GRAPH_PRELOAD": False})
+    original = nx.complete_bipartite_graph(30, 40)
+    nx.set_node_attributes(original, {n: f"label {n}" for n in original}, "label")
+    split = original.copy()
+    split.remove_edges_from(list(split.edges())[::2])
+    manager.original_graphs[1] = original
+    manager.split_graphs[1] = split
+    manager.component_mappings[1] = ComponentMapping(original, split)
+    manager.graph_arrays[(1, "original")] = GraphArrays.from_networkx(original)
+    manager.graph_array_bytes[(1, "original")] = manager.graph_arrays[(1, "original")].to_bytes()
+    manager.edge_indexes[1] = EdgeDetailsIndex.from_rows(
+        SimpleNamespace(
+            dmr_id=dmr,
+            gene_id=100 + dmr % 7,
+            gene_symbol=f"G{dmr % 7}",
+            edge_type="promoter",
+            edit_type=None,
+            distance_from_tss=1000 * dmr,
+            description=None,
+        )
+        for dmr in range(50)
+    )
+    manager.timepoint_bytes[1] = 0
+    return manager
+
+
+class TestMemoryAccounting(unittest.TestCase):
+    def test_deep_sizeof_counts_shared_objects_once(self):
+        shared = ["x" * 1000]
+        seen = set()
+        first = deep_sizeof({"a": shared}, seen)
+        second = deep_sizeof({"b": shared}, seen)
+        self.assertGreater(first, 1000)
+        self.assertLess(second, 1000)
+
+        array = np.zeros(10_000, dtype=np.int64)
+        self.assertGreaterEqual(deep_sizeof(array), array.nbytes)
+        self.assertEqual(deep_sizeof(array, {id(array)}), 0)
+
+    def test_graph_manager_report(self):
+        manager = make_manager()
+        report = graph_manager_report(manager)
+        timepoint = report["timepoints"][1]
+
+        self.assertGreater(timepoint["original_graph"], estimate_graph_bytes(manager.original_graphs[1]) / 4)
+        self.assertEqual(timepoint["graph_arrays"], manager.graph_arrays[(1, "original")].nbytes)
+        self.assertEqual(timepoint["serialized_arrays"], len(manager.graph_array_bytes[(1, "original")]))
+        self.assertGreater(timepoint["edge_index"], manager.edge_indexes[1].nbytes)
+        # The mapping's subgraph views are charged to the graphs they wrap
+        self.assertGreater(timepoint["component_mapping"], 0)
+        self.assertLess(timepoint["component_mapping"], timepoint["original_graph"])
+        self.assertEqual(timepoint["total"], report["total_bytes"])
+
+        estimate = graph_manager_report(manager, deep=False)["timepoints"][1]
+        self.assertEqual(estimate["original_graph"], estimate_graph_bytes(manager.original_graphs[1]))
+
+    def test_lru_cache_report(self):
+        @inspectable_lru_cache(maxsize=2)
+        def lookup(key, suffix=""):
+            return "v" * 5000 + str(key) + suffix
+
+        self.assertEqual(lru_cache_report(lookup, set())["bytes"], 0)
+        for key in range(3):
+            lookup(key)
+        self.assertEqual(lookup(2), "v" * 5000 + "2")
+        self.assertNotEqual(lookup(2, suffix="x"), lookup(2))
+        report = lru_cache_report(lookup, set())
+        self.assertEqual((report["entries"], report["hits"], report["misses"]), (2, 2, 4))
+        self.assertGreater(report["bytes"], 2 * 5000)
+
+        lookup.cache_clear()
+        self.assertEqual(lookup.cache_info().currsize, 0)
+        self.assertIsNone(lru_cache_report(functools.lru_cache()(len), set())["bytes"])
+
+
+class TestMemoryRoutes(unittest.TestCase):
+    def setUp(self):
+        self.app = Flask(__name__)
+        self.app.config.update(MEMORY_DEBUG=True, MEMORY_DEBUG_TOKEN=TOKEN)
+        self.app.graph_manager = make_manager()
+
+        @self.app.route("/allocate")
+        def allocate():
+            _retained.append([bytearray(1000) for _ in range(2000)])
+            return "ok"
+
+        self.store = init_memory_debug(self.app)
+        self.addCleanup(self.store.stop)
+        self.addCleanup(_retained.clear)
+        self.client = self.app.test_client()
+        self.client.environ_base["HTTP_X_ADMIN_TOKEN"] = TOKEN
+
+    def test_disabled_by_default(self):
+        app = Flask(__name__)
+        self.assertIsNone(init_memory_debug(app))
+        self.assertNotIn("debug_routes", app.blueprints)
+        app.config.update(MEMORY_DEBUG=True)
+        self.assertIsNone(init_memory_debug(app))
+
+    def test_requires_admin_token(self):
+        client = self.app.test_client()
+        self.assertEqual(client.get("/debug/memory").status_code, 404)
+        self.assertEqual(client.post("/debug/memory/snapshots").status_code, 404)
+        wrong = {"X-Admin-Token": "wrong"}
+        self.assertEqual(client.get("/debug/memory/snapshots", headers=wrong).status_code, 404)
+        self.assertEqual(
+            client.post("/debug/memory/tracemalloc?action=start", headers=wrong).status_code, 404
+        )
+
+    def test_config_from_environment(self):
+        app = Flask(__name__)
+        app.config.update(MEMORY_DEBUG=True, MEMORY_DEBUG_TOKEN=TOKEN, MEMORY_SNAPSHOTS_KEPT="2")
+        self.assertEqual(init_memory_debug(app).keep, 2)
+        self.assertEqual(self.store.keep, DEFAULT_SNAPSHOTS_KEPT)
+
+    def test_memory_report(self):
+        report = self.client.get("/debug/memory").get_json()["data"]
+        self.assertEqual(report["method"], "deep")
+        self.assertIn(1, [int(tp) for tp in report["datasets"]["default"]["timepoints"]])
+        self.assertGreaterEqual(report["accounted_bytes"], report["datasets"]["default"]["total_bytes"])
+        if sys.platform.startswith("linux"):
+            self.assertGreater(report["process"]["rss_bytes"], 0)
+        self.assertFalse(report["tracemalloc"]["tracing"])
+
+        estimate = self.client.get("/debug/memory?deep=0").get_json()["data"]
+        self.assertEqual(estimate["method"], "estimate")
+
+    def test_snapshot_diff(self):
+        self.assertEqual(self.client.post("/debug/memory/snapshots").status_code, 409)
+        self.client.post("/debug/memory/tracemalloc?action=start&frames=5")
+        first = self.client.post("/debug/memory/snapshots?label=before").get_json()["data"]
+        self.client.get("/allocate")
+
+        diff = self.client.get(f"/debug/memory/snapshots/{first['id']}/diff/now").get_json()["data"]
+        self.assertEqual(diff["old"]["label"], "before")
+        self.assertGreater(diff["size_diff_bytes"], 2000 * 1000)
+        top = diff["top"][0]
+        self.assertIn("test_memory_accounting.py", top["location"])
+        self.assertGreater(top["size_diff_bytes"], 2000 * 1000)
+
+        listed = self.client.get("/debug/memory/snapshots").get_json()["data"]
+        self.assertEqual([s["label"] for s in listed], ["before", "now"])
+        by_file = self.client.get(f"/debug/memory/snapshots/{first['id']}?group_by=filename")
+        self.assertEqual(by_file.status_code, 200)
+        self.assertEqual(self.client.get("/debug/memory/snapshots/99").status_code, 404)
+        self.assertEqual(
+            self.client.get(f"/debug/memory/snapshots/{first['id']}?group_by=x").status_code, 400
+        )
+
+        stopped = self.client.post("/debug/memory/tracemalloc?action=stop").get_json()["data"]
+        self.assertFalse(stopped["tracing"])
+        self.assertEqual(stopped["snapshots"], [])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,164 @@
+import unittest
+from unittest import mock
+
+import networkx as nx
+import numpy as np
+import pandas as pd
+
+from backend.app import native
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.biclique_analysis.edge_classification import classify_edges
+from backend.app.biclique_analysis.reader import parse_bicliques
+from backend.app.biclique_analysis.statistics import calculate_edge_coverage
+from backend.app.core import rb_domination
+from backend.app.core.graph_manager import ComponentMapping
+from backend.app.core.rb_domination import greedy_rb_domination_python
+
+
+def random_bipartite(seed, n_dmrs=120, n_genes=80, edges=260):
+    rng = np.random.default_rng(seed)
+    graph = nx.Graph()
+    graph.add_nodes_from(range(n_dmrs), bipartite=0)
+    graph.add_nodes_from(range(START_GENE_ID, START_GENE_ID + n_genes), bipartite=1)
+    for d, g in zip(rng.integers(0, n_dmrs, edges), rng.integers(0, n_genes, edges)):
+        graph.add_edge(int(d), START_GENE_ID + int(g))
+    return graph
+
+
+def random_bicliques(graph, seed, count=15):
+    rng = np.random.default_rng(seed)
+    dmrs = [n for n, d in graph.nodes(data=True) if d["bipartite"] == 0]
+    genes = [n for n, d in graph.nodes(data=True) if d["bipartite"] == 1]
+    return [
+        (
+            set(rng.choice(dmrs, size=rng.integers(1, 4), replace=False).tolist()),
+            set(rng.choice(genes, size=rng.integers(1, 5), replace=False).tolist()),
+        )
+        for _ in range(count)
+    ]
+
+
+def python_only():
+    """Patch every dispatch site back to the reference implementation."""
+    return mock.patch.object(native, "_kernels", None)
+
+
+@unittest.skipUnless(native.available(), "native kernels not built")
+class TestNativeEquivalence(unittest.TestCase):
+    def test_rb_domination(self):
+        for seed in range(5):
+            graph = random_bipartite(seed)
+            df = pd.DataFrame(
+                {
+                    "DMR_No.": np.arange(1, 121),
+                    # Coarse values so area ties fall through to the DMR id
+                    "Area_Stat": np.random.default_rng(seed).integers(0, 4, 120).astype(float),
+                }
+            )
+            expected = greedy_rb_domination_python(graph, df, area_col="Area_Stat")
+            self.assertEqual(rb_domination.greedy_rb_domination(graph, df, "Area_Stat"), expected)
+            self.assertEqual(
+                rb_domination.greedy_rb_domination(graph, df), greedy_rb_domination_python(graph, df)
+            )
+
+    def test_component_mapping(self):
+        original = random_bipartite(1)
+        split = original.copy()
+        split.remove_edges_from(list(split.edges())[::3])
+        native_mapping = ComponentMapping(original, split)
+        with python_only():
+            reference = ComponentMapping(original, split)
+
+        def pairs(mapping):
+            return {
+                (frozenset(nodes), frozenset(mapping.get_original_component(i)))
+                for i, nodes in mapping.split_components.items()
+            }
+
+        self.assertEqual(pairs(native_mapping), pairs(reference))
+        self.assertEqual(
+            {frozenset(c) for c in native_mapping.original_components.values()},
+            {frozenset(c) for c in reference.original_components.values()},
+        )
+
+    def test_classify_edges(self):
+        original = random_bipartite(2)
+        bicliques = random_bicliques(original, 2)
+        # Same node order keeps networkx edge orientation identical in both graphs
+        biclique_graph = nx.Graph()
+        biclique_graph.add_nodes_from(original.nodes(data=True))
+        for dmrs, genes in bicliques:
+            biclique_graph.add_edges_from((d, g) for d in dmrs for g in genes)
+
+        result = classify_edges(original, biclique_graph, {}, bicliques)
+        with python_only():
+            expected = classify_edges(original, biclique_graph, {}, bicliques)
+
+        for label in ("permanent", "false_positive", "false_negative"):
+            self.assertEqual(
+                sorted(e.edge for e in result["classifications"][label]),
+                sorted(e.edge for e in expected["classifications"][label]),
+            )
+        self.assertEqual(result["stats"], expected["stats"])
+
+    def test_edge_coverage(self):
+        graph = random_bipartite(3)
+        bicliques = random_bicliques(graph, 3, count=40)
+        result = calculate_edge_coverage(bicliques, graph)
+        with python_only():
+            self.assertEqual(calculate_edge_coverage(bicliques, graph), result)
+
+    def test_parse_bicliques(self):
+        mapping = {"gene_a": START_GENE_ID, "gène_b": START_GENE_ID + 1, "c": START_GENE_ID + 2}
+        lines = [
+            "# Header",
+            "1 2 GENE_A",
+            "# Clusters",
+            "1 2 GENE_A\n",
+            "  3\tGène_B unknown 4_0 99\n",
+            "",
+            "-5 C 0x10 +7 ٣",
+            "5 nothing_known",
+            "9223372036854775807 9223372036854775808 -9223372036854775808 1_0000000000000000000_0",
+            "92233720368547758070 9223372036854775808x C",
+        ]
+        result = parse_bicliques(lines, 50, mapping)
+        with python_only():
+            expected = parse_bicliques(lines, 50, mapping)
+        self.assertEqual(result, expected)
+        self.assertEqual(result[0][2], ({-5, 7, 3}, {START_GENE_ID + 2}))
+
+
+class TestPythonFallback(unittest.TestCase):
+    def test_unavailable_kernels_use_reference(self):
+        graph = random_bipartite(4)
+        df = pd.DataFrame({"DMR_No.": np.arange(1, 121)})
+        with python_only():
+            self.assertFalse(native.available())
+            with mock.patch.object(
+                rb_domination, "greedy_rb_domination_python", return_value={1}
+            ) as reference:
+                self.assertEqual(rb_domination.greedy_rb_domination(graph, df), {1})
+                reference.assert_called_once()
+            mapping = ComponentMapping(graph, graph)
+            self.assertEqual(
+                len(mapping.original_components),
+                nx.number_connected_components(
+                    graph.subgraph(n for n, d in graph.degree() if d > 0)
+                ),
+            )
+
+    def test_csr_layout(self):
+        graph = nx.Graph([(0, 5), (0, 6), (7, 5)])
+        graph.add_node(9)
+        nodes, indptr, indices = native.to_csr(graph)
+        self.assertEqual(nodes, [0, 5, 6, 7, 9])
+        np.testing.assert_array_equal(indptr, [0, 2, 4, 5, 6, 6])
+        self.assertEqual(
+            {(nodes[i], nodes[j]) for i in range(5) for j in indices[indptr[i] : indptr[i + 1]]},
+            {(0, 5), (0, 6), (5, 0), (5, 7), (6, 0), (7, 5)},
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,88 @@
+import json
+import os
+import tempfile
+import unittest
+
+import networkx as nx
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app.utils.constants import START_GENE_ID
+from backend.app.biclique_analysis.statistics_engine import (
+    STATISTICS_VERSION,
+    StatisticsJob,
+    compute_timepoint_statistics,
+    run_statistics_engine,
+)
+from backend.app.database.models import Base, Metadata
+from backend.app.database.operations import (
+    get_timepoint_statistics_version,
+    load_timepoint_statistics,
+    store_timepoint_statistics,
+)
+
+
+def make_graph():
+    """Two K_{3,3} bicliques sharing one gene, as in test_statistics."""
+    graph = nx.Graph()
+    graph.add_nodes_from(range(6), bipartite=0)
+    graph.add_nodes_from(range(START_GENE_ID, START_GENE_ID + 5), bipartite=1)
+    bicliques = [
+        ({0, 1, 2}, {START_GENE_ID, START_GENE_ID + 1, START_GENE_ID + 2}),
+        ({3, 4, 5}, {START_GENE_ID + 2, START_GENE_ID + 3, START_GENE_ID + 4}),
+    ]
+    for dmrs, genes in bicliques:
+        graph.add_edges_from((d, g) for d in dmrs for g in genes)
+    return graph, bicliques
+
+
+class TestStatisticsEngine(unittest.TestCase):
+    def setUp(self):
+        self.graph, self.bicliques = make_graph()
+        self.stats = compute_timepoint_statistics(
+            self.graph, {"bicliques": self.bicliques}
+        )
+
+    def test_sections(self):
+        self.assertEqual(self.stats["graph_info"]["total_edges"], 18)
+        self.assertEqual(self.stats["graph_info"]["total_bicliques"], 2)
+        self.assertEqual(self.stats["coverage"]["dmrs"]["covered"], 6)
+        self.assertEqual(self.stats["edge_coverage"]["single"], 18)
+        self.assertEqual(self.stats["edge_coverage"]["uncovered"], 0)
+        self.assertEqual(
+            self.stats["components"]["original"]["connected"]["total"], 1
+        )
+        self.assertEqual(self.stats["size_distribution"], {"3_3": 2})
+
+    def test_json_safe(self):
+        self.assertEqual(json.loads(json.dumps(self.stats)), self.stats)
+
+    def test_store_and_load(self):
+        engine = create_engine("sqlite:///:memory:")
+        Base.metadata.create_all(engine)
+        with Session(engine) as session:
+            store_timepoint_statistics(session, 4, self.stats, STATISTICS_VERSION)
+            # Storing again replaces rather than duplicates
+            store_timepoint_statistics(session, 4, self.stats, STATISTICS_VERSION)
+
+            self.assertEqual(load_timepoint_statistics(session, 4), self.stats)
+            self.assertEqual(load_timepoint_statistics(session, 5), {})
+            self.assertEqual(get_timepoint_statistics_version(session, 4), STATISTICS_VERSION)
+            self.assertIsNone(get_timepoint_statistics_version(session, 5))
+            # Timepoints are not bicliques: nothing goes to the biclique Metadata
+            self.assertEqual(session.query(Metadata).count(), 0)
+
+    def test_engine_skips_missing_files(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            job = StatisticsJob(
+                timepoint_id=1,
+                timepoint_name="DSS1",
+                original_graph_file=os.path.join(tmp, "missing.txt"),
+                bicliques_file=os.path.join(tmp, "missing.biclusters"),
+                gene_id_mapping={},
+            )
+            self.assertEqual(run_statistics_engine([job], max_workers=1), {})
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,195 @@
+"""Tests for the Parquet/DuckDB analytics snapshot."""
+
+import pytest
+from flask import Flask
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+pytest.importorskip("duckdb")
+pytest.importorskip("pyarrow")
+
+from backend.app.database import analytics
+from backend.app.database.analytics import AnalyticsStore, export_snapshot
+from backend.app.database.models import (
+    Base,
+    Biclique,
+    DMR,
+    Gene,
+    GeneTimepointAnnotation,
+    Timepoint,
+)
+from backend.app.routes import analytics_routes
+from backend.app.routes.analytics_routes import analytics_bp
+from backend.app.routes.llm_routes import llm_bp
+
+GENE = 100000
+
+
+@pytest.fixture
+def engine(tmp_path):
+    engine = create_engine(f"sqlite:///{tmp_path / 'oltp.db'}")
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add_all(
+            [
+                Timepoint(id=1, name="DSS1", sheet_name="DSS1"),
+                Timepoint(id=2, name="P21", sheet_name="P21"),
+                Gene(id=GENE, symbol="abc1"),
+                Gene(id=GENE + 1, symbol="xyz2"),
+            ]
+        )
+        session.flush()
+        session.add_all(
+            [
+                DMR(id=1, dmr_number=1, timepoint_id=1, area_stat=2.5),
+                DMR(id=2, dmr_number=2, timepoint_id=1, area_stat=1.0),
+                DMR(id=3, dmr_number=1, timepoint_id=2, area_stat=4.0),
+                Biclique(timepoint_id=1, dmr_ids=[1, 2], gene_ids=[GENE]),
+                Biclique(timepoint_id=2, dmr_ids=[3], gene_ids=[GENE, GENE + 1]),
+                GeneTimepointAnnotation(timepoint_id=1, gene_id=GENE, biclique_ids="0,1"),
+                GeneTimepointAnnotation(timepoint_id=2, gene_id=GENE + 1, biclique_ids=None),
+            ]
+        )
+        session.commit()
+    yield engine
+    engine.dispose()
+
+
+def test_export_and_query(engine, tmp_path):
+    analytics_dir = tmp_path / "analytics"
+    snapshot = export_snapshot(engine, analytics_dir)
+    store = AnalyticsStore(analytics_dir)
+
+    result = store.query(
+        """
+        SELECT t.name, count(*) AS dmrs, sum(d.area_stat) AS area
+        FROM dmrs d JOIN timepoints t ON t.id = d.timepoint_id
+        GROUP BY t.name ORDER BY t.name
+        """
+    )
+    assert result["columns"] == ["name", "dmrs", "area"]
+    assert result["rows"] == [["DSS1", 2, 3.5], ["P21", 1, 4.0]]
+    assert result["snapshot"] == snapshot.name
+
+    # Id lists are native lists, including the comma-separated annotation column
+    assert store.query(
+        "SELECT id FROM bicliques WHERE list_contains(gene_ids, ?) ORDER BY id",
+        [GENE + 1],
+    )["rows"] == [[2]]
+    assert store.query(
+        "SELECT gene_id, len(biclique_ids) FROM gene_annotations_view ORDER BY gene_id"
+    )["rows"] == [[GENE, 2], [GENE + 1, None]]
+
+    truncated = store.query("SELECT * FROM range(50)", row_limit=10)
+    assert len(truncated["rows"]) == 10 and truncated["truncated"]
+
+    schema = store.schema_description()
+    assert "TABLE bicliques(" in schema and "gene_ids BIGINT[]" in schema
+    assert "VIEW gene_annotations_view(" in schema
+
+
+def test_store_is_read_only_and_sandboxed(engine, tmp_path):
+    analytics_dir = tmp_path / "analytics"
+    export_snapshot(engine, analytics_dir)
+    store = AnalyticsStore(analytics_dir)
+
+    with pytest.raises(Exception):
+        store.query("DELETE FROM dmrs")
+    with pytest.raises(Exception):
+        store.query(f"SELECT * FROM read_csv('{tmp_path / 'oltp.db'}')")
+    assert store.query("SELECT count(*) FROM dmrs")["rows"] == [[3]]
+
+
+def test_new_snapshot_replaces_old(engine, tmp_path):
+    analytics_dir = tmp_path / "analytics"
+    export_snapshot(engine, analytics_dir)
+    store = AnalyticsStore(analytics_dir)
+    assert store.query("SELECT count(*) FROM genes")["rows"] == [[2]]
+
+    with Session(engine) as session:
+        session.add(Gene(id=GENE + 2, symbol="new3"))
+        session.commit()
+    second = export_snapshot(engine, analytics_dir)
+
+    assert store.query("SELECT count(*) FROM genes")["rows"] == [[3]]
+    assert store.snapshot == second.name
+
+
+def test_replaced_connection_closed_after_its_cursors(engine, tmp_path):
+    analytics_dir = tmp_path / "analytics"
+    export_snapshot(engine, analytics_dir)
+    store = AnalyticsStore(analytics_dir)
+    running = store.connection()
+    first = running._conn
+
+    export_snapshot(engine, analytics_dir)
+    store.query("SELECT 1")
+    # The running cursor still reads the snapshot it started on
+    assert running.execute("SELECT count(*) FROM genes").fetchall() == [(2,)]
+    running.close()
+    with pytest.raises(Exception):
+        first.execute("SELECT 1")
+
+    export_snapshot(engine, analytics_dir)
+    second = store._conn
+    store.query("SELECT 1")
+    with pytest.raises(Exception):
+        second.execute("SELECT 1")
+    assert store._open_cursors == {} and store._retired == {}
+
+
+def test_routes(engine, tmp_path, monkeypatch):
+    analytics_dir = tmp_path / "analytics"
+    monkeypatch.setattr(analytics, "_store", AnalyticsStore(analytics_dir))
+    app = Flask(__name__)
+    app.register_blueprint(analytics_bp)
+    app.register_blueprint(llm_bp)
+    client = app.test_client()
+
+    assert client.get("/api/analytics/schema").status_code == 404
+
+    export_snapshot(engine, analytics_dir)
+    response = client.post(
+        "/api/analytics/query", json={"sql": "SELECT count(*) AS n FROM bicliques"}
+    )
+    assert response.get_json()["rows"] == [[2]]
+    for row_limit in (0, -5):
+        response = client.post(
+            "/api/analytics/query",
+            json={"sql": "SELECT id FROM bicliques", "row_limit": row_limit},
+        )
+        assert len(response.get_json()["rows"]) == 1
+    assert client.post("/api/analytics/query", json={}).status_code == 400
+    bad = client.post("/api/analytics/query", json={"sql": "SELECT * FROM nope"})
+    assert bad.status_code == 400 and "nope" in bad.get_json()["message"]
+    assert "bicliques" in client.get("/api/analytics/schema").get_json()["schema"]
+
+    response = client.post(
+        "/api/llm/analyze", json={"prompt_id": "analysis", "include_schema": True}
+    )
+    assert "TABLE bicliques(" in response.get_json()["analysis"]["parameters"]["schema"]
+    assert client.post("/api/llm/analyze", json={"prompt_id": "nope"}).status_code == 404
+
+
+def test_query_limited_per_client_address(engine, tmp_path, monkeypatch):
+    analytics_dir = tmp_path / "analytics"
+    monkeypatch.setattr(analytics, "_store", AnalyticsStore(analytics_dir))
+    export_snapshot(engine, analytics_dir)
+    users = []
+    sandbox = analytics_routes.get_sandbox()
+
+    def execute(sql, params=None, user="anonymous", row_limit=None):
+        users.append(user)
+        return {"rows": []}
+
+    monkeypatch.setattr(sandbox, "execute", execute)
+    app = Flask(__name__)
+    app.register_blueprint(analytics_bp)
+    client = app.test_client()
+    for user_id in ("u1", "u2"):
+        client.post(
+            "/api/analytics/query", json={"sql": "SELECT 1"}, headers={"X-User-Id": user_id}
+        )
+    # The client-supplied header does not pick the concurrency key
+    assert users == ["127.0.0.1", "127.0.0.1"]
+
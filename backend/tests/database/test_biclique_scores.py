@@ -0,0 +1,118 @@
+"""Significance and stability scores stored against ingested bicliques."""
+
+import pandas as pd
+import pytest
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app.biclique_analysis.significance import compute_timepoint_significance
+from backend.app.biclique_analysis.stability import compute_timepoint_stability
+from backend.app.biclique_analysis.statistics_engine import StatisticsJob
+from backend.app.database.models import Base, Biclique, Metadata, Timepoint
+from backend.app.database.operations import (
+    get_edge_sources,
+    store_biclique_significance,
+    store_stability_scores,
+)
+from backend.app.database.process_timepoints import (
+    process_bicliques_for_timepoint,
+    process_timepoint_table_data,
+)
+from backend.app.utils.constants import START_GENE_ID
+
+TIMEPOINT = 2  # non-zero DMR id offset
+GENES = {f"g{i}": START_GENE_ID + i for i in range(5)}
+
+
+@pytest.fixture
+def ingested(tmp_path):
+    """A P21-P28 timepoint loaded through process_bicliques_for_timepoint."""
+    # DMRs 0-2 x genes g0-g2 form a K(3,3); DMR 3 has g3 and g4
+    edges = [(d, g) for d in range(3) for g in range(3)] + [(3, 3), (3, 4)]
+    graph_file = tmp_path / "graph.txt"
+    graph_file.write_text(
+        f"4 5 {START_GENE_ID}\n" + "".join(f"{d} {START_GENE_ID + g}\n" for d, g in edges)
+    )
+    bicliques_file = tmp_path / "graph.biclusters"
+    bicliques_file.write_text("# Clusters\n0 1 2 g0 g1 g2\n3 g3 g4\n")
+    df = pd.DataFrame(
+        {
+            "DMR_No.": [1, 2, 3, 4],
+            "Gene_Symbol_Nearby": ["g0", "g1", "g2", "g3"],
+            "Distance_From_TSS": [100, -5, 100, 100],
+            "ENCODE_Enhancer_Interaction(BingRen_Lab)": [".", ".", ".", "g4/1"],
+            "ENCODE_Promoter_Interaction(BingRen_Lab)": [".", ".", ".", "."],
+            "Area_Stat": [1.0, 2.0, 3.0, 4.0],
+        }
+    )
+
+    engine = create_engine(f"sqlite:///{tmp_path / 'scores.db'}")
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add(Timepoint(id=TIMEPOINT, name="P21-P28", sheet_name="P21-P28_TSS"))
+        session.commit()
+        process_timepoint_table_data(session, TIMEPOINT, df, GENES)
+        process_bicliques_for_timepoint(
+            session,
+            timepoint_id=TIMEPOINT,
+            timepoint_name="P21-P28",
+            original_graph_file=str(graph_file),
+            bicliques_file=str(bicliques_file),
+            df=df,
+            gene_id_mapping=GENES,
+        )
+        session.commit()
+        job = StatisticsJob(
+            timepoint_id=TIMEPOINT,
+            timepoint_name="P21-P28",
+            original_graph_file=str(graph_file),
+            bicliques_file=str(bicliques_file),
+            gene_id_mapping=GENES,
+        )
+        yield session, job
+    engine.dispose()
+
+
+def stored_values(session, key):
+    return {
+        m.entity_id: float(m.value) for m in session.query(Metadata).filter(Metadata.key == key)
+    }
+
+
+def test_scores_match_ingested_bicliques(ingested):
+    session, job = ingested
+    stored_ids = {b.id for b in session.query(Biclique).filter_by(timepoint_id=TIMEPOINT)}
+    assert len(stored_ids) == 2
+
+    bicliques, significance = compute_timepoint_significance(job, n_null=5, max_workers=1)
+    # Every biclique's DMRs are graph nodes, so each has its observed common genes
+    assert [b["observed_common_genes"] for b in significance["bicliques"]] == [3, 2]
+    assert store_biclique_significance(session, TIMEPOINT, bicliques, significance) == 2
+    assert set(stored_values(session, "null_p_value")) == stored_ids
+
+    bicliques, stability = compute_timepoint_stability(
+        job, n_replicates=4, drop_rate=0.0, max_workers=1
+    )
+    assert store_stability_scores(session, TIMEPOINT, bicliques, stability) == 2
+    assert set(stored_values(session, "stability_survival_rate").values()) == {1.0}
+
+
+def test_edge_sources_weight_drop_rates(ingested):
+    session, job = ingested
+    sources = get_edge_sources(session, TIMEPOINT)
+    # Keyed by the graph's DMR node ids: P21-P28 offsets DMR_No. - 1 by 10000
+    assert sources[(10001, GENES["g1"])] == {"direct"}
+    assert sources[(10003, GENES["g4"])] == {"enhancer"}
+
+    # Only nearby edges are dropped: the K(3,3) never survives, DMR 3 keeps g4
+    _, stability = compute_timepoint_stability(
+        job,
+        n_replicates=10,
+        drop_rate=1.0,
+        source_weights={"direct": 0.0, "enhancer": 0.0},
+        edge_sources=sources,
+        max_workers=1,
+    )
+    block, star = stability["bicliques"]
+    assert block["survival_rate"] == 0.0
+    assert star["mean_cell_retention"] == 0.5
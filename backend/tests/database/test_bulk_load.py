@@ -0,0 +1,176 @@
+"""Tests for the COPY-based bulk loader and its SQLite fallback.
+
+The PostgreSQL test runs only when TEST_POSTGRES_URL points at a scratch
+database, e.g. postgresql://postgres@localhost/dmr_test; it drops and
+recreates every table there.
+"""
+
+import os
+
+import networkx as nx
+import pandas as pd
+import pytest
+from flask import Flask
+from sqlalchemy import create_engine, inspect, text
+from sqlalchemy.orm import Session
+
+from backend.app.database.bulk_load import copy_buffer, format_copy_value, next_ids
+from backend.app.database.management.create_views import create_views
+from backend.app.database.models import (
+    Base,
+    DMR,
+    Biclique,
+    Component,
+    ComponentBiclique,
+    EdgeDetails,
+    Gene,
+    GeneTimepointAnnotation,
+    Timepoint,
+)
+from backend.app.database.populate_tables import (
+    populate_bicliques_bulk,
+    populate_edge_details,
+    populate_gene_annotations,
+)
+from backend.app.routes import component_routes
+
+GENE = 100000
+
+
+def test_copy_text_format():
+    assert format_copy_value(None) == "\\N"
+    assert format_copy_value(float("nan")) == "\\N"
+    assert format_copy_value(True) == "t"
+    assert format_copy_value([3, 1, 2]) == "{3,1,2}"
+    assert format_copy_value([]) == "{}"
+    assert format_copy_value("a\tb\\c\nd") == "a\\tb\\\\c\\nd"
+    assert copy_buffer([(1, None, "x"), (2, [5], "")]).read() == "1\t\\N\tx\n2\t{5}\t\n"
+
+
+def load_timepoint(session):
+    """Edge details, two bicliques and split-graph gene annotations for timepoint 1."""
+    session.add(Timepoint(id=1, name="DSS1", sheet_name="DSS1"))
+    session.add_all([Gene(id=GENE, symbol="abc1"), Gene(id=GENE + 1, symbol="xyz2")])
+    session.flush()
+    session.add_all([DMR(id=d, dmr_number=d, timepoint_id=1) for d in (1, 2)])
+    session.add(Component(id=7, timepoint_id=1, graph_type="split"))
+    session.commit()
+
+    df = pd.DataFrame(
+        {
+            "DMR_No.": [1, 2, 2],
+            "Gene_Symbol_Nearby": ["abc1", "abc1", "xyz2"],
+            "Distance_From_TSS": [100, float("nan"), -5],
+            "Gene_Description": ["tab\there", None, "d"],
+            "ENCODE_Enhancer_Interaction(BingRen_Lab)": ["xyz2/e1", ".", "."],
+        }
+    )
+    populate_edge_details(session, df, 1, {"abc1": GENE, "xyz2": GENE + 1})
+
+    bicliques = [({1, 2}, {GENE}), ({2}, {GENE + 1})]
+    ids = populate_bicliques_bulk(session, 1, 7, bicliques)
+
+    graph = nx.Graph()
+    graph.add_nodes_from([1, 2], bipartite=0)
+    graph.add_nodes_from([GENE, GENE + 1], bipartite=1)
+    graph.add_edges_from([(1, GENE), (2, GENE), (2, GENE + 1)])
+    populate_gene_annotations(session, 1, 7, graph, df, True)
+    populate_gene_annotations(session, 1, 7, graph, df, False, bicliques=bicliques)
+    populate_gene_annotations(session, 1, 7, graph, df, False, bicliques=bicliques[::-1])
+    return ids
+
+
+def check_loaded(session, ids):
+    edges = {
+        (e.dmr_id, e.gene_id): (e.edge_type, e.distance_from_tss, e.description)
+        for e in session.query(EdgeDetails)
+    }
+    assert edges == {
+        (1, GENE): ("nearby", 100, "tab\there"),
+        (2, GENE): ("nearby", None, None),
+        (2, GENE + 1): ("direct", -5, "d"),
+        (1, GENE + 1): ("enhancer", None, "Enhancer interaction: xyz2/e1"),
+    }
+
+    assert ids == [1, 2]
+    rows = session.query(Biclique).order_by(Biclique.id).all()
+    assert [(sorted(b.dmr_ids), b.gene_ids) for b in rows] == [([1, 2], [GENE]), ([2], [GENE + 1])]
+    links = session.query(ComponentBiclique.biclique_id).order_by("biclique_id").all()
+    assert [l.biclique_id for l in links] == ids
+
+    annotations = {a.gene_id: a for a in session.query(GeneTimepointAnnotation)}
+    assert annotations[GENE].degree == 2
+    assert annotations[GENE].gene_type == "Nearby"
+    # Second split pass (biclique order reversed) unions the stored ids
+    assert annotations[GENE].biclique_ids == "0,1"
+    assert annotations[GENE + 1].biclique_ids == "0,1"
+
+
+def check_component_genes(engine, monkeypatch):
+    """The component gene route lists the genes of the component's bicliques."""
+    create_views(engine)
+    monkeypatch.setattr(component_routes, "get_db_engine", lambda: engine)
+    app = Flask(__name__)
+    app.register_blueprint(component_routes.component_bp)
+    response = app.test_client().post(
+        "/api/component/genes/annotations", json={"timepoint_id": 1, "component_id": 7}
+    )
+    gene_info = response.get_json()["gene_info"]
+    assert sorted(gene_info) == [str(GENE), str(GENE + 1)]
+    assert gene_info[str(GENE)]["biclique_count"] == 2
+
+
+def test_sqlite_fallback(tmp_path, monkeypatch):
+    engine = create_engine(f"sqlite:///{tmp_path / 'bulk.db'}")
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        ids = load_timepoint(session)
+        check_loaded(session, ids)
+        assert next_ids(session, Biclique.__table__, 2) == [3, 4]
+        assert next_ids(session, Biclique.__table__, 0) == []
+    check_component_genes(engine, monkeypatch)
+    engine.dispose()
+
+
+def reset_schema(engine):
+    with engine.begin() as conn:
+        conn.execute(text("DROP SCHEMA public CASCADE"))
+        conn.execute(text("CREATE SCHEMA public"))
+
+
+@pytest.mark.skipif(
+    not os.environ.get("TEST_POSTGRES_URL"), reason="TEST_POSTGRES_URL not set"
+)
+def test_postgres_copy_arrays_and_views(monkeypatch):
+    engine = create_engine(os.environ["TEST_POSTGRES_URL"])
+    reset_schema(engine)
+    Base.metadata.create_all(engine)
+    try:
+        with Session(engine) as session:
+            ids = load_timepoint(session)
+            check_loaded(session, ids)
+
+            assert session.execute(
+                text("SELECT id FROM bicliques WHERE 2 = ANY(dmr_ids) ORDER BY id")
+            ).scalars().all() == [1, 2]
+            # New rows without an explicit id continue after the copied ones
+            session.add(Biclique(timepoint_id=1, dmr_ids=[9], gene_ids=[GENE]))
+            session.commit()
+            assert next_ids(session, Biclique.__table__, 2) == [4, 5]
+
+        index_names = {i["name"] for i in inspect(engine).get_indexes("bicliques")}
+        assert {"ix_bicliques_dmr_ids_gin", "ix_bicliques_gene_ids_gin"} <= index_names
+        assert "ix_gene_timepoint_annotations_biclique_ids_gin" in {
+            i["name"] for i in inspect(engine).get_indexes("gene_timepoint_annotations")
+        }
+
+        create_views(engine)
+        with engine.connect() as conn:
+            row = conn.execute(
+                text("SELECT dmr_count, gene_count FROM biclique_details_view WHERE biclique_id = 1")
+            ).one()
+            assert (row.dmr_count, row.gene_count) == (2, 1)
+        check_component_genes(engine, monkeypatch)
+    finally:
+        reset_schema(engine)
+        engine.dispose()
@@ -0,0 +1,241 @@
+"""Tests for the checkpoints of a resumable initialize_database."""
+
+import os
+
+import numpy as np
+import pandas as pd
+import pytest
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app.database.cleanup import clean_timepoint
+from backend.app.database.management.checkpoints import (
+    CheckpointStore,
+    atomic_session,
+    decode_bicliques,
+    encode_bicliques,
+    stage_key,
+)
+from backend.app.database.models import DMR, Base, Biclique, Metadata, Timepoint
+from backend.app.utils.data_processing import process_enhancer_info
+
+try:
+    from backend.app.database.management import initialize_database as init_db
+except FileNotFoundError:  # processDMR.env is created from processDMR_sample.env on setup
+    init_db = None
+
+SHEETS = ["DSS_Time_Series", "P21-P28_TSS", "P28-P35_TSS"]
+
+
+def sheet_frame(sheet):
+    df = pd.DataFrame(
+        {
+            "DMR_No.": [1, 2, 3],
+            "Gene_Symbol_Nearby": ["Gata4", None, "Tbx5"],
+            "ENCODE_Enhancer_Interaction(BingRen_Lab)": ["Nkx2-5/1.2;./0", np.nan, "Hand2/3"],
+            "Area_Stat": [1.5, np.nan, 2.5],
+            "Sheet": sheet,
+        }
+    )
+    df["Processed_Enhancer_Info"] = df["ENCODE_Enhancer_Interaction(BingRen_Lab)"].apply(
+        process_enhancer_info
+    )
+    return df
+
+
+def test_store_round_trip(tmp_path):
+    store = CheckpointStore(tmp_path)
+    df = sheet_frame("P21-P28_TSS").drop(columns=["Processed_Enhancer_Info"])
+    calls = []
+
+    def parse():
+        calls.append(1)
+        return df
+
+    store.frame("sheets", "k", parse)
+    loaded = store.frame("sheets", "k", parse)
+    assert len(calls) == 1
+    assert (tmp_path / "sheets" / "k.parquet").exists()
+    pd.testing.assert_frame_equal(loaded, df)
+    assert pd.isna(loaded.loc[1, "Gene_Symbol_Nearby"])
+
+    # Columns Parquet cannot type fall back to a pickle
+    mixed = pd.DataFrame({"a": [1, "x", 2.5]})
+    store.save_frame("sheets", "mixed", mixed)
+    assert (tmp_path / "sheets" / "mixed.pkl").exists()
+    assert store.load_frame("sheets", "mixed")["a"].tolist() == [1, "x", 2.5]
+
+    bicliques = [({3, 1}, {7}), ({2}, {9, 8})]
+    store.save_json("stability", "k", {"bicliques": encode_bicliques(bicliques)})
+    assert decode_bicliques(store.load_json("stability", "k")["bicliques"]) == bicliques
+    assert stage_key("a", 1) == stage_key("a", 1) != stage_key("a", 2)
+
+
+def test_ledger_resumes_only_unfinished_runs(tmp_path):
+    store = CheckpointStore(tmp_path)
+    ledger = store.ledger("sqlite:///a.db")
+    assert not ledger.begin("run-1")
+    ledger.complete("genes")
+    ledger.complete("significance", "samples-100")
+
+    ledger = store.ledger("sqlite:///a.db")
+    assert ledger.begin("run-1")
+    assert ledger.done("genes")
+    assert ledger.done("significance", "samples-100")
+    assert not ledger.done("significance", "samples-200")
+    assert not store.ledger("sqlite:///b.db").begin("run-1")
+
+    ledger.finish()
+    assert not store.ledger("sqlite:///a.db").begin("run-1")
+    ledger = store.ledger("sqlite:///a.db")
+    ledger.begin("run-1")
+    ledger.complete("genes")
+    assert not store.ledger("sqlite:///a.db").begin("run-2")
+    assert not store.ledger("sqlite:///a.db").begin("run-2", resume=False)
+
+
+def test_atomic_session_and_clean_timepoint(tmp_path):
+    engine = create_engine(f"sqlite:///{tmp_path / 'test.db'}")
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add_all([Timepoint(id=1, name="a", sheet_name="a"), Timepoint(id=2, name="b", sheet_name="b")])
+        session.commit()
+
+    with pytest.raises(RuntimeError):
+        with atomic_session(engine) as session:
+            session.add(DMR(timepoint_id=1, dmr_number=1))
+            session.commit()  # releases a savepoint only
+            session.add(DMR(timepoint_id=1, dmr_number=2))
+            raise RuntimeError("crash")
+    with Session(engine) as session:
+        assert session.query(DMR).count() == 0
+
+    for timepoint_id in (1, 2):
+        with atomic_session(engine) as session:
+            session.add(DMR(timepoint_id=timepoint_id, dmr_number=1))
+            biclique = Biclique(timepoint_id=timepoint_id, dmr_ids=[1], gene_ids=[5])
+            session.add(biclique)
+            session.flush()
+            session.add(Metadata(entity_type="biclique", entity_id=biclique.id, key="k", value="v"))
+
+    with Session(engine) as session:
+        clean_timepoint(session, 1)
+        session.commit()
+        assert [d.timepoint_id for d in session.query(DMR)] == [2]
+        assert [b.timepoint_id for b in session.query(Biclique)] == [2]
+        assert session.query(Metadata).count() == 1
+
+
+@pytest.fixture
+def ingest(tmp_path, monkeypatch):
+    """initialize_database with the parsers and loaders replaced by fakes."""
+    if init_db is None:
+        pytest.skip("initialize_database needs processDMR.env")
+    data_dir = tmp_path / "data"
+    data_dir.mkdir()
+    for name in ["DSS1.xlsx", "DSS_PAIRWISE.xlsx", "master_gene_ids.csv"]:
+        (data_dir / name).write_text(name)
+    for sheet in SHEETS[1:]:
+        (data_dir / f"bipartite_graph_output_{sheet}.txt").write_text(sheet)
+    monkeypatch.setenv("DATA_DIR", str(data_dir))
+    monkeypatch.setenv("DATABASE_URL", f"sqlite:///{tmp_path / 'dmr.db'}")
+    monkeypatch.setenv("CHECKPOINT_DIR", str(tmp_path / "checkpoints"))
+    monkeypatch.setenv("ANALYTICS_DIR", str(tmp_path / "analytics"))
+    monkeypatch.setenv("GRAPH_DATA_DIR", str(tmp_path / "graphs"))
+    monkeypatch.setenv("NULL_MODEL_SAMPLES", "0")
+    monkeypatch.setenv("STABILITY_REPLICATES", "0")
+    for name in ["DATASET", "DSS1_FILE", "DSS_PAIRWISE_FILE", "INGEST_RESUME"]:
+        monkeypatch.delenv(name, raising=False)
+
+    calls = {
+        "read": [], "load": [], "populate": 0, "statistics": 0, "similarity": [], "fail": set()
+    }
+
+    def read_excel_file(path, sheet_name=None):
+        calls["read"].append(sheet_name)
+        return sheet_frame(sheet_name)
+
+    def populate_timepoints(session, timeseries_sheet, pairwise_sheets, start_gene_id):
+        calls["populate"] += 1
+        for sheet in [timeseries_sheet, *pairwise_sheets]:
+            session.add(Timepoint(name=sheet, sheet_name=sheet))
+
+    def process_timepoint_table_data(session, timepoint_id, df, gene_id_mapping):
+        calls["load"].append(df)
+        session.add_all(DMR(timepoint_id=timepoint_id, dmr_number=n) for n in df["DMR_No."])
+        session.commit()
+
+    def process_bicliques_for_timepoint(session, timepoint_id, df, **kwargs):
+        if df["Sheet"][0] in calls["fail"]:
+            raise RuntimeError("biclique processing failed")
+        session.add(Biclique(timepoint_id=timepoint_id, dmr_ids=[1], gene_ids=[5]))
+        session.commit()
+
+    def run_statistics_engine(jobs, max_workers=None):
+        calls["statistics"] += 1
+        return {job.timepoint_id: {"coverage": {"dmrs": 3}} for job in jobs}
+
+    def build_timepoint_index(graph, timepoint_id, output_root, bicliques=None):
+        calls["similarity"].append((graph, output_root))
+        return []
+
+    fakes = {
+        "get_excel_sheets": lambda path: SHEETS[1:],
+        "read_excel_file": read_excel_file,
+        "read_gene_mapping": lambda path: {"GATA4": 1},
+        "populate_timepoints": populate_timepoints,
+        "populate_master_gene_ids": lambda session, mapping: None,
+        "populate_core_genes": lambda session, mapping: None,
+        "process_timepoint_table_data": process_timepoint_table_data,
+        "process_bicliques_for_timepoint": process_bicliques_for_timepoint,
+        "run_statistics_engine": run_statistics_engine,
+        "read_bipartite_graph": lambda path, timepoint=None: timepoint,
+        "build_timepoint_index": build_timepoint_index,
+        "export_snapshot": lambda engine, directory: directory,
+    }
+    for name, fake in fakes.items():
+        monkeypatch.setattr(init_db, name, fake)
+    return calls
+
+
+def loaded_sheets():
+    engine = init_db.connection.get_db_engine()
+    with Session(engine) as session:
+        return sorted(
+            {tp.sheet_name for tp in session.query(Timepoint).join(DMR, DMR.timepoint_id == Timepoint.id)}
+        )
+
+
+def test_resume_after_crash(ingest):
+    ingest["fail"] = {"P28-P35_TSS"}
+    with pytest.raises(RuntimeError):
+        init_db.initialize_database()
+    # The failed timepoint's table data was rolled back with it
+    assert loaded_sheets() == ["DSS_Time_Series", "P21-P28_TSS"]
+    parsed = ingest["load"][-1]
+
+    ingest["fail"] = set()
+    ingest["read"].clear()
+    ingest["load"].clear()
+    stages = []
+    init_db.initialize_database(progress=lambda stage, detail="": stages.append((stage, detail)))
+    assert ingest["populate"] == 1
+    assert ingest["read"] == []  # the sheet comes from its Parquet artifact
+    assert len(ingest["load"]) == 1
+    pd.testing.assert_frame_equal(ingest["load"][0], parsed)
+    assert ("genes", "(checkpoint)") in stages
+    assert ("timepoints", "P21-P28_TSS (2/3) (checkpoint)") in stages
+    assert loaded_sheets() == sorted(SHEETS)
+    # Similarity indexes are built at ingest for the timepoints with a graph file
+    assert ingest["similarity"][-2:] == [
+        (name, os.path.join(os.environ["GRAPH_DATA_DIR"], "embeddings"))
+        for name in ("P21-P28", "P28-P35")
+    ]
+
+    # A finished run is not resumed: the schema is rebuilt from the artifacts
+    init_db.initialize_database()
+    assert ingest["populate"] == 2
+    assert ingest["read"] == []
+    assert len(ingest["load"]) == 1 + len(SHEETS)
+    assert ingest["statistics"] == 1  # the third run takes every timepoint from artifacts
+    assert loaded_sheets() == sorted(SHEETS)
@@ -0,0 +1,141 @@
+"""Tests for the persisted decomposition hierarchy and its drill-down routes."""
+
+import networkx as nx
+import pytest
+from flask import Flask
+from sqlalchemy import create_engine
+from sqlalchemy.orm import Session
+
+from backend.app.biclique_analysis.triconnected import split_components
+from backend.app.database.decomposition import (
+    build_timepoint_decomposition,
+    load_decomposition_index,
+    store_decomposition_index,
+)
+from backend.app.database.models import (
+    Base,
+    Biclique,
+    Component,
+    DecompositionNode,
+    Timepoint,
+    TriconnectedComponent,
+)
+from backend.app.routes import component_routes
+from backend.app.utils.id_mapping import convert_dmr_id
+
+TIMEPOINT = 2  # non-zero DMR id offset
+
+
+def bipartite_graph():
+    """A K2,3 block and a 4-cycle joined at DMR 1, plus a separate star."""
+    graph = nx.Graph()
+    graph.add_nodes_from([0, 1, 2, 3, 4], bipartite=0)
+    graph.add_nodes_from(range(100000, 100006), bipartite=1)
+    graph.add_edges_from((d, g) for d in (0, 1) for g in (100000, 100001, 100002))
+    graph.add_edges_from([(1, 100003), (2, 100003), (2, 100004), (1, 100004)])
+    graph.add_edges_from([(3, 100005), (4, 100005)])
+    return graph
+
+
+def test_split_components_kinds():
+    assert [p.kind for p in split_components(nx.complete_bipartite_graph(3, 3))] == ["R"]
+    assert [p.kind for p in split_components(nx.cycle_graph(6))] == ["S"]
+    parts = split_components(nx.complete_bipartite_graph(2, 3))
+    assert sorted(p.kind for p in parts) == ["P", "S", "S", "S"]
+    assert parts[0].parent == -1
+    assert all(p.separation_pair == (0, 1) for p in parts[1:])
+
+
+@pytest.fixture
+def session(tmp_path):
+    engine = create_engine(f"sqlite:///{tmp_path / 'decomposition.db'}")
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add(Timepoint(id=TIMEPOINT, name="P21-P28", sheet_name="P21-P28_TSS"))
+        session.commit()
+        yield session
+    engine.dispose()
+
+
+def stored_index(session, graph):
+    component_ids = []
+    for nodes in nx.connected_components(graph):
+        component = Component(timepoint_id=TIMEPOINT, graph_type="original", size=len(nodes))
+        session.add(component)
+        session.flush()
+        component_ids.append((nodes, component.id))
+    for block in nx.biconnected_components(graph):
+        session.add(TriconnectedComponent(timepoint_id=TIMEPOINT, nodes=sorted(block)))
+    session.add(
+        Biclique(
+            timepoint_id=TIMEPOINT,
+            dmr_ids=[convert_dmr_id(0, TIMEPOINT), convert_dmr_id(1, TIMEPOINT)],
+            gene_ids=[100000, 100001],
+        )
+    )
+    session.commit()
+    index = build_timepoint_decomposition(session, TIMEPOINT, graph, component_ids)
+    store_decomposition_index(session, TIMEPOINT, index)
+    return index, dict((min(nodes), comp_id) for nodes, comp_id in component_ids)
+
+
+def test_store_and_load(session):
+    index, components = stored_index(session, bipartite_graph())
+    loaded = load_decomposition_index(session, TIMEPOINT)
+    assert session.query(DecompositionNode).count() == index.num_nodes
+    assert [loaded.describe(p) for p in range(loaded.num_nodes)] == [
+        index.describe(p) for p in range(index.num_nodes)
+    ]
+    assert load_decomposition_index(session, TIMEPOINT + 1) is None
+
+    # Each level occupies a contiguous range of positions
+    for level in ("component", "block", "spqr", "biclique"):
+        for position in loaded.level_positions(level):
+            assert loaded.describe(position)["level"] == level
+    component = loaded.find("component", components[0])
+    blocks = loaded.children(component, "block")
+    assert len(blocks) == 2
+    assert all(loaded.describe(int(b))["source_id"] is not None for b in blocks)
+    biclique = loaded.describe(loaded.level_positions("biclique")[0])
+    assert biclique["dmrs"] == [0, 1] and biclique["genes"] == [100000, 100001]
+    assert loaded.ancestors(loaded.level_positions("biclique")[0])[-1] == component
+
+
+class StubGraphManager:
+    def __init__(self, index):
+        self.index = index
+
+    def get_decomposition_index(self, timepoint_id):
+        return self.index if timepoint_id == TIMEPOINT else None
+
+
+def test_drill_down_routes(session, monkeypatch):
+    index, components = stored_index(session, bipartite_graph())
+    monkeypatch.setattr(
+        component_routes, "get_graph_manager", lambda: StubGraphManager(index)
+    )
+    app = Flask(__name__)
+    app.register_blueprint(component_routes.component_bp)
+    client = app.test_client()
+
+    response = client.get(f"/api/component/{TIMEPOINT}/{components[0]}/hierarchy")
+    assert response.status_code == 200
+    tree = response.get_json()["data"]
+    assert tree["level"] == "component"
+    assert tree["dmrs"] == [convert_dmr_id(n, TIMEPOINT) for n in (0, 1, 2)]
+    assert {child["kind"] for child in tree["children"]} == {"block"}
+    cut = {n for child in tree["children"] for n in child["link_nodes"]}
+    assert cut == {convert_dmr_id(1, TIMEPOINT)}
+
+    position = tree["children"][0]["position"]
+    node = client.get(f"/api/component/{TIMEPOINT}/hierarchy/{position}").get_json()["data"]
+    assert [a["level"] for a in node["ancestors"]] == ["component"]
+
+    chain = client.get(
+        f"/api/component/{TIMEPOINT}/hierarchy/dmr/{convert_dmr_id(0, TIMEPOINT)}"
+    ).get_json()["data"]
+    assert [c["level"] for c in chain][:2] == ["component", "block"]
+    assert chain[-1]["level"] == "biclique"
+
+    assert client.get(f"/api/component/{TIMEPOINT}/999/hierarchy").status_code == 404
+    assert client.get(f"/api/component/1/{components[0]}/hierarchy").status_code == 404
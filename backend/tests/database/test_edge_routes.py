@@ -0,0 +1,105 @@
+"""Tests for the batched edge-details lookups."""
+
+import os
+import pytest
+from flask import Flask
+from sqlalchemy import text
+from sqlalchemy.orm import Session
+
+from backend.app.database.connection import get_db_engine
+from backend.app.database.models import Base, EdgeDetails, Gene, Timepoint
+from backend.app.routes.edge_routes import edge_bp
+
+
+@pytest.fixture
+def client(tmp_path):
+    """Flask client with three DMRs sharing two genes in timepoint 1."""
+    original_env = dict(os.environ)
+    os.environ["DATABASE_URL"] = f"sqlite:///{tmp_path / 'edges.db'}"
+
+    engine = get_db_engine()
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add(Timepoint(id=1, name="DSS1", sheet_name="DSS1"))
+        session.add_all([Gene(id=10, symbol="Abc1"), Gene(id=11, symbol="Xyz2")])
+        for dmr_id, gene_id, distance in [
+            (1, 10, 100),
+            (1, 11, -50),
+            (2, 10, 2000),
+            (3, 11, 0),
+        ]:
+            session.add(
+                EdgeDetails(
+                    dmr_id=dmr_id,
+                    gene_id=gene_id,
+                    timepoint_id=1,
+                    edge_type="promoter",
+                    distance_from_tss=distance,
+                    description="edge",
+                )
+            )
+        # Same edge in another timepoint must not leak into timepoint 1
+        session.add(EdgeDetails(dmr_id=2, gene_id=11, timepoint_id=2))
+        session.commit()
+
+    app = Flask(__name__)
+    app.register_blueprint(edge_bp, url_prefix="/api/edge-details")
+    app.engine = engine
+    yield app.test_client()
+
+    engine.dispose()
+    os.environ.clear()
+    os.environ.update(original_env)
+
+
+def test_single_dmr(client):
+    response = client.get("/api/edge-details/timepoint/1/dmr/1")
+    assert response.status_code == 200
+    edges = response.get_json()["edges"]
+    assert {(e["gene_symbol"], e["distance_from_tss"]) for e in edges} == {
+        ("Abc1", 100),
+        ("Xyz2", -50),
+    }
+    assert edges[0]["description"] == "edge"
+
+    assert client.get("/api/edge-details/timepoint/1/dmr/99").status_code == 404
+
+
+def test_batch_dmrs(client):
+    response = client.post(
+        "/api/edge-details/timepoint/1/batch", json={"dmr_ids": [1, 2, 99]}
+    )
+    assert response.status_code == 200
+    edges = response.get_json()["edges"]
+    assert sorted(edges) == ["1", "2"]
+    assert [e["gene_symbol"] for e in edges["2"]] == ["Abc1"]
+    assert "description" not in edges["1"][0]
+
+
+def test_batch_genes(client):
+    response = client.post(
+        "/api/edge-details/timepoint/1/batch", json={"gene_ids": [11]}
+    )
+    edges = response.get_json()["edges"]
+    assert sorted(e["dmr_id"] for e in edges["11"]) == [1, 3]
+
+
+def test_batch_bad_request(client):
+    url = "/api/edge-details/timepoint/1/batch"
+    assert client.post(url, json={}).status_code == 400
+    assert client.post(url, json={"dmr_ids": ["a"]}).status_code == 400
+
+
+def test_batch_query_uses_covering_index(client):
+    engine = client.application.engine
+    with engine.connect() as conn:
+        plan = conn.execute(
+            text(
+                "EXPLAIN QUERY PLAN SELECT dmr_id, gene_id, edge_type, edit_type, "
+                "distance_from_tss FROM edge_details "
+                "WHERE timepoint_id = 1 AND dmr_id IN (1, 2)"
+            )
+        ).fetchall()
+    assert any(
+        "COVERING INDEX ix_edge_details_timepoint_dmr" in row[-1] for row in plan
+    )
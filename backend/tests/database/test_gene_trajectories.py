@@ -0,0 +1,140 @@
+"""Tests for the pivoted gene trajectory table and its routes."""
+
+import io
+import os
+
+import pandas as pd
+import pytest
+from flask import Flask
+from sqlalchemy.orm import Session
+
+from backend.app.database.connection import get_db_engine
+from backend.app.database.models import (
+    DMR,
+    Base,
+    Component,
+    DominatingSet,
+    EdgeDetails,
+    Gene,
+    GeneTimepointAnnotation,
+    GeneTrajectory,
+    Timepoint,
+)
+from backend.app.database.trajectories import (
+    HUB,
+    PRESENT,
+    SPLIT,
+    build_gene_trajectories,
+    export_gene_trajectories,
+    get_gene_trajectory,
+    trajectory_frame,
+)
+from backend.app.routes.gene_routes import gene_bp
+
+
+@pytest.fixture
+def engine(tmp_path):
+    """Gene 100 in both timepoints, gene 101 only in the second."""
+    original_env = dict(os.environ)
+    os.environ["DATABASE_URL"] = f"sqlite:///{tmp_path / 'trajectories.db'}"
+    engine = get_db_engine()
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add_all(
+            [
+                Timepoint(id=1, name="DSStimeseries", sheet_name="DSS_Time_Series"),
+                Timepoint(id=2, name="P21-P28", sheet_name="P21-P28_TSS"),
+                Gene(id=100, symbol="Gata4"),
+                Gene(id=101, symbol="Tbx5"),
+                Component(id=1, timepoint_id=1, graph_type="split", size=5),
+                Component(id=2, timepoint_id=2, graph_type="split", size=9),
+                DMR(id=1, timepoint_id=1, dmr_number=1),
+                DMR(id=2, timepoint_id=1, dmr_number=2),
+                DMR(id=10001, timepoint_id=2, dmr_number=1),
+            ]
+        )
+        session.add_all(
+            [
+                GeneTimepointAnnotation(
+                    timepoint_id=1, gene_id=100, component_id=1, degree=2,
+                    node_type="split_gene", biclique_ids="0,1",
+                ),
+                GeneTimepointAnnotation(
+                    timepoint_id=2, gene_id=100, component_id=2, degree=1,
+                    node_type="regular_gene", biclique_ids="3",
+                ),
+                GeneTimepointAnnotation(
+                    timepoint_id=2, gene_id=101, component_id=2, degree=4,
+                    node_type="regular_gene", biclique_ids=None,
+                ),
+                EdgeDetails(dmr_id=2, gene_id=100, timepoint_id=1),
+                EdgeDetails(dmr_id=1, gene_id=100, timepoint_id=1),
+                EdgeDetails(dmr_id=10001, gene_id=101, timepoint_id=2),
+                DominatingSet(timepoint_id=1, dmr_id=1),
+                DominatingSet(timepoint_id=1, dmr_id=2),
+                DominatingSet(timepoint_id=2, dmr_id=10001),
+            ]
+        )
+        session.commit()
+    yield engine
+    engine.dispose()
+    os.environ.clear()
+    os.environ.update(original_env)
+
+
+def test_build_and_read(engine):
+    with Session(engine) as session:
+        assert build_gene_trajectories(session) == 2
+        assert build_gene_trajectories(session) == 2  # rebuilds in place
+        assert session.query(GeneTrajectory).count() == 2
+
+        row = session.get(GeneTrajectory, 100)
+        assert row.timepoint_ids == [1, 2]
+        assert row.status == [PRESENT | SPLIT | HUB, PRESENT]
+        assert row.dominated_by_indptr == [0, 2, 2]
+        assert session.get(GeneTrajectory, 101).status == [0, PRESENT | HUB]
+
+        trajectory = get_gene_trajectory(session, 100)
+        assert trajectory["timepoint_count"] == 2
+        first, second = trajectory["timepoints"]
+        assert (first["degree"], first["component_size"], first["biclique_count"]) == (2, 5, 2)
+        assert first["split"] and not second["split"]
+        assert first["dominated_by"] == [1, 2] and second["dominated_by"] == []
+        assert second["component_size"] == 9
+        assert get_gene_trajectory(session, 999) is None
+
+
+def test_export(engine, tmp_path):
+    with Session(engine) as session:
+        build_gene_trajectories(session)
+        frame = trajectory_frame(session)
+        assert frame["symbol"].tolist() == ["Gata4", "Tbx5"]
+        assert frame["degree_DSStimeseries"].tolist() == [2, 0]
+        assert frame["dominated_by_DSStimeseries"].tolist() == ["1;2", ""]
+        assert frame["dominated_by_P21-P28"].tolist() == ["", "10001"]
+
+        assert export_gene_trajectories(session, tmp_path / "out.parquet") == 2
+        pd.testing.assert_frame_equal(pd.read_parquet(tmp_path / "out.parquet"), frame)
+
+
+def test_routes(engine):
+    with Session(engine) as session:
+        build_gene_trajectories(session)
+    app = Flask(__name__)
+    app.register_blueprint(gene_bp)
+    client = app.test_client()
+
+    response = client.get("/api/genes/101/trajectory")
+    assert response.status_code == 200
+    timepoints = response.get_json()["data"]["timepoints"]
+    assert [t["present"] for t in timepoints] == [False, True]
+    assert timepoints[1]["dominated_by"] == [10001]
+    assert client.get("/api/genes/999/trajectory").status_code == 404
+
+    response = client.get("/api/genes/trajectories/export")
+    assert response.status_code == 200
+    exported = pd.read_csv(io.BytesIO(response.data))
+    assert exported["gene_id"].tolist() == [100, 101]
+    response = client.get("/api/genes/trajectories/export?format=parquet")
+    assert pd.read_parquet(io.BytesIO(response.data))["biclique_count_P21-P28"].tolist() == [1, 0]
+    assert client.get("/api/genes/trajectories/export?format=xlsx").status_code == 400
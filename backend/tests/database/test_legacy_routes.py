@@ -0,0 +1,75 @@
+"""Tests for the app_db.py compatibility routes served by the main app."""
+
+import os
+import pytest
+from flask import Flask
+from sqlalchemy.orm import Session
+
+from backend.app.database.connection import get_db_engine
+from backend.app.database.models import Base, Biclique, Component, Timepoint
+from backend.app.routes.legacy_routes import legacy_bp
+
+
+@pytest.fixture
+def client(tmp_path):
+    """Flask client backed by a small file database."""
+    original_env = dict(os.environ)
+    os.environ["DATABASE_URL"] = f"sqlite:///{tmp_path / 'legacy.db'}"
+
+    engine = get_db_engine()
+    Base.metadata.create_all(engine)
+    with Session(engine) as session:
+        session.add(Timepoint(id=1, name="DSS1", sheet_name="DSS1", description="d"))
+        session.add(
+            Component(
+                id=7,
+                timepoint_id=1,
+                graph_type="split",
+                category="interesting",
+                size=5,
+                dmr_count=2,
+                gene_count=3,
+                edge_count=6,
+                density=1.0,
+            )
+        )
+        session.add(
+            Biclique(
+                id=3,
+                timepoint_id=1,
+                component_id=7,
+                category="interesting",
+                dmr_ids=[1, 2],
+                gene_ids=[100000, 100001, 100002],
+            )
+        )
+        session.commit()
+
+    app = Flask(__name__)
+    app.register_blueprint(legacy_bp)
+    yield app.test_client()
+
+    engine.dispose()
+    os.environ.clear()
+    os.environ.update(original_env)
+
+
+def test_timepoint_components(client):
+    response = client.get("/api/timepoint/1/components")
+    assert response.status_code == 200
+    assert [c["id"] for c in response.get_json()] == [7]
+
+
+def test_component_counts_biclique_members(client):
+    response = client.get("/api/component/7")
+    assert response.status_code == 200
+    data = response.get_json()
+    assert data["dmr_count"] == 2
+    assert data["bicliques"] == [
+        {"id": 3, "category": "interesting", "dmr_count": 2, "gene_count": 3}
+    ]
+
+
+def test_missing_component(client):
+    assert client.get("/api/component/99").status_code == 404
+    assert client.get("/api/component/99/visualization").status_code == 404
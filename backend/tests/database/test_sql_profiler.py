@@ -0,0 +1,116 @@
+"""Tests for the opt-in per-request SQL profiler."""
+
+import pytest
+from flask import Flask, jsonify
+from sqlalchemy import create_engine, text
+
+from backend.app.database.profiler import DEFAULT_HISTORY, fingerprint, init_sql_profiler
+
+
+@pytest.fixture
+def app(tmp_path):
+    engine = create_engine(f"sqlite:///{tmp_path / 'profile.db'}")
+    with engine.begin() as conn:
+        conn.execute(text("CREATE TABLE genes (id INTEGER PRIMARY KEY, symbol TEXT)"))
+        for i in range(10):
+            conn.execute(text("INSERT INTO genes VALUES (:id, :s)"), {"id": i, "s": f"G{i}"})
+
+    app = Flask(__name__)
+    app.config.update(SQL_PROFILE=True, SQL_PROFILE_EXPLAIN_MS=0, SQL_PROFILE_TOKEN="secret")
+
+    @app.route("/n_plus_one")
+    def n_plus_one():
+        with engine.connect() as conn:
+            symbols = [
+                conn.execute(
+                    text("SELECT symbol FROM genes WHERE id = :id"), {"id": i}
+                ).scalar()
+                for i in range(8)
+            ]
+        return jsonify(symbols)
+
+    @app.route("/batched")
+    def batched():
+        with engine.connect() as conn:
+            rows = conn.execute(text("SELECT symbol FROM genes WHERE id < 8")).fetchall()
+        return jsonify([r.symbol for r in rows])
+
+    @app.route("/no_sql")
+    def no_sql():
+        return jsonify([])
+
+    init_sql_profiler(app)
+    yield app
+    engine.dispose()
+
+
+def test_disabled_by_default():
+    app = Flask(__name__)
+    assert init_sql_profiler(app) is None
+    assert "sql_profiler" not in app.extensions
+
+
+def test_config_from_environment():
+    """configure_app passes unset variables as None and set ones as strings."""
+    app = Flask(__name__)
+    app.config.update(
+        SQL_PROFILE=True, SQL_PROFILE_HISTORY=None, SQL_PROFILE_REPEAT_THRESHOLD="3"
+    )
+    profiler = init_sql_profiler(app)
+    assert profiler.history == DEFAULT_HISTORY
+    assert profiler.repeat_threshold == 3
+
+
+def admin_client(app):
+    client = app.test_client()
+    client.environ_base["HTTP_X_ADMIN_TOKEN"] = "secret"
+    return client
+
+
+def test_fingerprint_collapses_literals_and_lists():
+    assert fingerprint("SELECT * FROM t WHERE id = 5") == fingerprint(
+        "SELECT *  FROM t\n WHERE id = 17"
+    )
+    assert fingerprint("SELECT * FROM t WHERE id IN (?, ?, ?)") == fingerprint(
+        "SELECT * FROM t WHERE id IN (?)"
+    )
+    assert fingerprint("SELECT 'a'") == "SELECT ?"
+
+
+def test_repeated_statement_flagged(app):
+    client = admin_client(app)
+    response = client.get("/n_plus_one")
+    assert response.headers["X-SQL-Count"] == "8"
+    assert response.headers["X-SQL-Repeated"] == "8"
+
+    request_id = response.headers["X-SQL-Profile-Id"]
+    profile = client.get(f"/debug/requests/{request_id}").get_json()["data"]
+    assert profile["path"] == "/n_plus_one"
+    assert profile["distinct_statements"] == 1
+    assert profile["repeated_statements"][0]["count"] == 8
+    assert len(profile["slowest"]) == 5
+    assert profile["plans"] and "genes" in " ".join(profile["plans"][0]["plan"])
+
+
+def test_batched_request_not_flagged(app):
+    client = admin_client(app)
+    response = client.get("/batched")
+    assert response.headers["X-SQL-Count"] == "1"
+    assert "X-SQL-Repeated" not in response.headers
+
+    response = client.get("/no_sql")
+    assert response.headers["X-SQL-Count"] == "0"
+
+    recent = client.get("/debug/requests").get_json()["requests"]
+    assert [r["path"] for r in recent[:2]] == ["/no_sql", "/batched"]
+    assert client.get("/debug/requests/unknown").status_code == 404
+
+
+def test_requires_admin_token(app):
+    client = app.test_client()
+    request_id = client.get("/batched").headers["X-SQL-Profile-Id"]
+    assert client.get("/debug/requests").status_code == 404
+    assert client.get(f"/debug/requests/{request_id}").status_code == 404
+    client.environ_base["HTTP_X_ADMIN_TOKEN"] = "wrong"
+    assert client.get("/debug/requests").status_code == 404
+    assert admin_client(app).get(f"/debug/requests/{request_id}").status_code == 200
@@ -0,0 +1,149 @@
+"""Tests for the cost-guarded SQL sandbox."""
+
+import sqlite3
+import threading
+
+import pytest
+
+from backend.app.database.sql_sandbox import (
+    SandboxLimits,
+    SandboxRejection,
+    SQLiteBackend,
+    SQLSandbox,
+    check_statement,
+)
+
+
+@pytest.fixture
+def db_path(tmp_path):
+    path = tmp_path / "sandbox.db"
+    conn = sqlite3.connect(path)
+    conn.execute("CREATE TABLE genes (id INTEGER PRIMARY KEY, symbol TEXT)")
+    conn.execute("CREATE TABLE dmrs (id INTEGER PRIMARY KEY, gene_id INTEGER)")
+    conn.executemany(
+        "INSERT INTO genes VALUES (?, ?)", [(i, f"g{i}") for i in range(2000)]
+    )
+    conn.executemany("INSERT INTO dmrs VALUES (?, ?)", [(i, i % 2000) for i in range(2000)])
+    conn.commit()
+    conn.close()
+    return str(path)
+
+
+def rejection(sandbox, sql, **kwargs):
+    with pytest.raises(SandboxRejection) as info:
+        sandbox.execute(sql, **kwargs)
+    return info.value.reason
+
+
+def test_static_checks():
+    assert check_statement("  SELECT 1; -- trailing\n") == "SELECT 1"
+    assert check_statement("SELECT 'a;b' AS x") == "SELECT 'a;b' AS x"
+    for sql, reason in [
+        ("", "empty"),
+        ("SELECT 1; SELECT 2", "multiple_statements"),
+        ("DELETE FROM genes", "not_read_only"),
+        ("PRAGMA table_info(genes)", "not_read_only"),
+        ("WITH x AS (SELECT 1) INSERT INTO genes SELECT * FROM x", "not_read_only"),
+    ]:
+        with pytest.raises(SandboxRejection) as info:
+            check_statement(sql)
+        assert info.value.reason == reason
+
+
+def test_plan_checks(db_path):
+    sandbox = SQLSandbox(
+        SQLiteBackend(db_path),
+        SandboxLimits(max_full_scan_rows=5000, max_cross_product_rows=100000),
+    )
+    # Key join: one scan plus an indexed lookup per row
+    result = sandbox.execute(
+        "SELECT g.symbol FROM dmrs d JOIN genes g ON g.id = d.gene_id WHERE d.id < ?", [3]
+    )
+    assert result["rows"] == [["g0"], ["g1"], ["g2"]]
+
+    assert rejection(sandbox, "SELECT count(*) FROM dmrs d, genes g") == "cartesian_product"
+    assert rejection(sandbox, "SELECT * FROM nope") == "invalid_sql"
+
+    strict = SQLSandbox(SQLiteBackend(db_path), SandboxLimits(max_full_scan_rows=1000))
+    assert rejection(strict, "SELECT * FROM genes WHERE symbol = 'g1'") == "full_scan"
+    assert strict.execute("SELECT symbol FROM genes WHERE id = 1")["rows"] == [["g1"]]
+
+
+def test_read_only_and_time_budget(db_path):
+    sandbox = SQLSandbox(SQLiteBackend(db_path), SandboxLimits(time_budget_s=0.2))
+    conn = sandbox.backend.connect()
+    with pytest.raises(sqlite3.OperationalError):
+        conn.execute("DELETE FROM genes")
+    conn.close()
+
+    slow = """
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n)
+        SELECT count(*) FROM n
+    """
+    assert rejection(sandbox, slow) == "timeout"
+
+
+def test_streaming_truncation(db_path):
+    sandbox = SQLSandbox(SQLiteBackend(db_path), SandboxLimits(max_rows=1500, max_bytes=10**6))
+    result = sandbox.execute("SELECT id FROM genes")
+    assert len(result["rows"]) == 1500
+    assert result["truncation_reason"] == "rows"
+    assert len(sandbox.execute("SELECT id FROM genes", row_limit=10)["rows"]) == 10
+
+    tight = SQLSandbox(SQLiteBackend(db_path), SandboxLimits(max_bytes=100))
+    result = tight.execute("SELECT id, symbol FROM genes")
+    assert result["truncated"] and result["truncation_reason"] == "bytes"
+    assert result["bytes"] <= 100
+
+
+def test_per_user_concurrency(db_path):
+    sandbox = SQLSandbox(SQLiteBackend(db_path), SandboxLimits(max_concurrent_per_user=1))
+    started, release = threading.Event(), threading.Event()
+    connect = sandbox.backend.connect
+
+    def blocking_connect():
+        started.set()
+        release.wait(5)
+        return connect()
+
+    sandbox.backend.connect = blocking_connect
+    worker = threading.Thread(target=sandbox.execute, args=("SELECT 1",), kwargs={"user": "a"})
+    worker.start()
+    started.wait(5)
+    try:
+        assert rejection(sandbox, "SELECT 1", user="a") == "concurrency_limit"
+        sandbox.backend.connect = connect
+        assert sandbox.execute("SELECT 1", user="b")["rows"] == [[1]]
+    finally:
+        release.set()
+        worker.join()
+    assert sandbox.execute("SELECT 1", user="a")["rows"] == [[1]]
+    # Users with nothing running hold no bookkeeping
+    assert sandbox._running == {}
+    assert rejection(sandbox, "SELECT * FROM nope", user="c") == "invalid_sql"
+    assert sandbox._running == {}
+
+
+def test_duckdb_backend():
+    duckdb = pytest.importorskip("duckdb")
+    from backend.app.database.sql_sandbox import DuckDBBackend
+
+    class Store:
+        def __init__(self):
+            self.db = duckdb.connect()
+            self.db.execute("CREATE TABLE t AS SELECT range AS id FROM range(5000)")
+
+        def connection(self):
+            return self.db.cursor()
+
+    sandbox = SQLSandbox(
+        DuckDBBackend(Store()), SandboxLimits(time_budget_s=0.3, max_estimated_cost=1e12)
+    )
+    assert sandbox.execute("SELECT count(*) FROM t WHERE id < 10")["rows"] == [[10]]
+    assert rejection(sandbox, "SELECT count(*) FROM t a, t b") == "cartesian_product"
+
+    strict = SQLSandbox(DuckDBBackend(Store()), SandboxLimits(max_full_scan_rows=1000))
+    assert rejection(strict, "SELECT * FROM t") == "full_scan"
+    assert strict.execute("SELECT * FROM t WHERE id < 10")["rows"][-1] == [9]
+    slow = "SELECT count(*) FROM range(100000000000) r WHERE hash(r.range) % 7 = 1"
+    assert rejection(sandbox, slow) == "timeout"
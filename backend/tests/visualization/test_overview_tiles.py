@@ -0,0 +1,126 @@
+import gzip
+import json
+import os
+import tempfile
+import unittest
+from unittest import mock
+
+import networkx as nx
+from flask import Flask
+
+from backend.app.routes import overview_routes
+from backend.app.visualization.overview_tiles import (
+    build_global_layout,
+    build_tiles,
+    get_tile_path,
+    write_overview,
+)
+
+
+def make_graph(num_components=30, dmrs=4, genes=3):
+    """Disjoint complete bipartite components plus one isolated DMR."""
+    graph = nx.Graph()
+    gene_id = 100000
+    dmr_id = 0
+    for _ in range(num_components):
+        dmr_nodes = list(range(dmr_id, dmr_id + dmrs))
+        gene_nodes = list(range(gene_id, gene_id + genes))
+        graph.add_nodes_from(dmr_nodes, bipartite=0)
+        graph.add_nodes_from(gene_nodes, bipartite=1)
+        graph.add_edges_from((d, g) for d in dmr_nodes for g in gene_nodes)
+        dmr_id += dmrs
+        gene_id += genes
+    graph.add_node(dmr_id, bipartite=0)
+    return graph
+
+
+class TestOverviewTiles(unittest.TestCase):
+    def setUp(self):
+        self.graph = make_graph()
+        self.layout = build_global_layout(self.graph)
+
+    def test_layout_skips_isolated_nodes(self):
+        self.assertEqual(len(self.layout["node_ids"]), 30 * 7)
+        self.assertEqual(len(self.layout["components"]), 30)
+        self.assertEqual(self.layout["edges"].shape, (30 * 12, 2))
+
+    def test_components_do_not_overlap(self):
+        boxes = self.layout["components"]
+        for i, a in enumerate(boxes):
+            for b in boxes[i + 1 :]:
+                overlap = a[1] < b[3] and b[1] < a[3] and a[2] < b[4] and b[2] < a[4]
+                self.assertFalse(overlap, f"components {a[0]} and {b[0]} overlap")
+
+    def test_leaf_tiles_cover_every_node_and_edge_once(self):
+        tiles = list(build_tiles(self.layout, max_zoom=6, max_nodes_per_tile=20))
+        leaves = [tile for _, _, _, tile in tiles if tile["mode"] == "nodes"]
+        self.assertTrue(any(t["mode"] == "density" for _, _, _, t in tiles))
+
+        node_ids = [n for tile in leaves for n in tile["nodes"]["id"]]
+        self.assertEqual(sorted(node_ids), sorted(self.layout["node_ids"].tolist()))
+
+        # Internal edges once, crossing edges once from each side
+        internal = sum(len(tile["edges"]) for tile in leaves)
+        external = sum(len(tile["external_edges"]) for tile in leaves)
+        self.assertEqual(internal + external // 2, self.graph.number_of_edges())
+        self.assertEqual(external % 2, 0)
+
+    def test_density_counts_match_tile_population(self):
+        for _, _, _, tile in build_tiles(self.layout, max_nodes_per_tile=20):
+            if tile["mode"] == "density":
+                total = sum(c[2] + c[3] for c in tile["cells"])
+                self.assertEqual(total, tile["node_count"])
+
+    def test_write_overview(self):
+        with tempfile.TemporaryDirectory() as output_dir:
+            metadata = write_overview(
+                self.graph, output_dir, timepoint_id=1, max_nodes_per_tile=50
+            )
+            self.assertTrue(os.path.exists(os.path.join(output_dir, "overview.json")))
+            self.assertEqual(metadata["node_count"], 30 * 7)
+
+            with gzip.open(get_tile_path(output_dir, 0, 0, 0)) as f:
+                root = json.load(f)
+            self.assertEqual(root["z"], 0)
+            self.assertEqual(metadata["tiles"]["0/0/0"], root["mode"])
+
+    def test_rebuild_removes_stale_tiles(self):
+        with tempfile.TemporaryDirectory() as root:
+            output_dir = os.path.join(root, "1")
+            first = write_overview(self.graph, output_dir, max_nodes_per_tile=5)
+            second = write_overview(make_graph(num_components=2), output_dir)
+            written = {
+                os.path.relpath(os.path.join(d, f), output_dir)[: -len(".json.gz")]
+                for d, _, files in os.walk(output_dir)
+                for f in files
+                if f.endswith(".json.gz")
+            }
+            self.assertEqual(written, set(second["tiles"]))
+            self.assertLess(len(second["tiles"]), len(first["tiles"]))
+            self.assertEqual(os.listdir(root), ["1"])
+
+    def test_tile_urls_name_one_build(self):
+        app = Flask(__name__)
+        app.register_blueprint(overview_routes.overview_bp)
+        client = app.test_client()
+        with tempfile.TemporaryDirectory() as root, mock.patch.object(
+            overview_routes, "get_overview_root", lambda: root
+        ):
+            write_overview(self.graph, os.path.join(root, "1"), timepoint_id=1)
+            first = client.get("/api/overview/1/metadata").get_json()["data"]["build_id"]
+            response = client.get(f"/api/overview/1/tiles/{first}/0/0/0")
+            self.assertEqual(response.status_code, 200)
+            self.assertIn("immutable", response.headers["Cache-Control"])
+            response.close()
+
+            write_overview(make_graph(num_components=2), os.path.join(root, "1"))
+            second = client.get("/api/overview/1/metadata").get_json()["data"]["build_id"]
+            self.assertNotEqual(first, second)
+            self.assertEqual(client.get(f"/api/overview/1/tiles/{first}/0/0/0").status_code, 404)
+            response = client.get(f"/api/overview/1/tiles/{second}/0/0/0")
+            self.assertEqual(response.status_code, 200)
+            response.close()
+
+
+if __name__ == "__main__":
+    unittest.main()
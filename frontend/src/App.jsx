@@ -20,6 +20,7 @@ import CircularProgress from "@mui/material/CircularProgress";
 import BicliqueDetailView from "./components/BicliqueDetailView.jsx";
 import LLMAnalysisView from "./components/LLMAnalysisView.jsx";
 import ComponentsView from "./components/ComponentsView";
+import OverviewMapView from "./components/OverviewMapView.jsx";
 
 import { API_BASE_URL } from "./config.js";
 console.log('App.jsx - API_BASE_URL:', API_BASE_URL);
@@ -253,6 +254,9 @@ function App() {
             <TabPanel>
               {selectedTimepoint && (
                 <Grid container spacing={3}>
+                  <Grid item xs={12}>
+                    <OverviewMapView timepointId={selectedTimepoint} />
+                  </Grid>
                   <Grid item xs={12}>
                     <ComponentsView
                       selectedTimepoint={selectedTimepoint}
@@ -229,6 +229,29 @@ const toggleRow = (dmrId) => {
   setExpandedRows((prev) => ({ ...prev, [dmrId]: !prev[dmrId] }));
 };
 
+// Fetch the edges of many DMRs in one request and attach them to their rows
+const fetchDmrEdgeDetails = async (dmrIds, signal) => {
+    if (!dmrIds || dmrIds.length === 0) return;
+    const response = await fetch(`${API_BASE_URL}/edge-details/timepoint/${timepointId}/batch`, {
+        method: "POST",
+        headers: { "Content-Type": "application/json" },
+        body: JSON.stringify({ dmr_ids: dmrIds }),
+        signal
+    });
+    if (!response.ok) throw new Error(`Edge details request failed: ${response.status}`);
+    const data = await response.json();
+    const edgesByDmr = data.edges || {};
+    setComponentDetails(prev => {
+        if (!prev || !prev.dmr_details) return prev;
+        const updatedDmrDetails = prev.dmr_details.map(dmr =>
+            dmrIds.includes(dmr.dmr_id)
+                ? { ...dmr, edge_details: edgesByDmr[dmr.dmr_id] || [] }
+                : dmr
+        );
+        return { ...prev, dmr_details: updatedDmrDetails };
+    });
+};
+
 const fetchEnrichmentData = async (bicliqueId) => {
     if (!bicliqueId || !timepointId) return;
     
@@ -540,6 +563,20 @@ const fetchDmrEnrichment = async (dmrId) => {
     return () => abortController.abort();
   }, [timepointId, componentId]);
 
+  // Load the edges of every DMR in the component once its rows are known
+  const componentDmrIds = componentDetails?.dmr_details?.map(dmr => dmr.dmr_id).join(',');
+  React.useEffect(() => {
+    if (!componentDmrIds) return;
+    const abortController = new AbortController();
+    fetchDmrEdgeDetails(componentDmrIds.split(',').map(Number), abortController.signal)
+      .catch(error => {
+        if (error.name !== 'AbortError') {
+          console.error('Error fetching DMR edge details:', error);
+        }
+      });
+    return () => abortController.abort();
+  }, [timepointId, componentDmrIds]);
+
   if (loading) {
     return (
       <Box
@@ -1190,26 +1227,13 @@ return (
           onDMRSelected={(dmrId) => {
             console.log('DMR selected:', dmrId);
             setSelectedDmrForEnrichment(dmrId);
-            // Fetch edge details
-            fetch(`${API_BASE_URL}/edge-details/timepoint/${timepointId}/dmr/${dmrId}`)
-              .then(res => res.json())
-              .then(data => {
-                if (data.edges) {
-                  console.log('Fetched DMR edge details:', data.edges);
-                  // Update the componentDetails state by adding edge_details to the matching DMR row
-                  setComponentDetails(prev => {
-                    if (!prev || !prev.dmr_details) return prev;
-                    const updatedDmrDetails = prev.dmr_details.map(dmr => {
-                      if (dmr.dmr_id === dmrId) {
-                        return { ...dmr, edge_details: data.edges };
-                      }
-                      return dmr;
-                    });
-                    return { ...prev, dmr_details: updatedDmrDetails };
-                  });
-                  setActiveTab(1); // Switch to Details tab to visually update the table
-                }
-              })
+            // Edge details are normally loaded with the component; fetch if missing
+            const dmrRow = componentDetails?.dmr_details?.find(dmr => dmr.dmr_id === dmrId);
+            const pending = dmrRow && !dmrRow.edge_details
+              ? fetchDmrEdgeDetails([dmrId])
+              : Promise.resolve();
+            pending
+              .then(() => setActiveTab(1)) // Switch to Details tab to visually update the table
               .catch(error => {
                 console.error('Error fetching DMR edge details:', error);
               });
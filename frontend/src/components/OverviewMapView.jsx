@@ -0,0 +1,212 @@
+import React, { useState, useEffect, useRef, useCallback } from 'react';
+import { Paper, Typography, Box, CircularProgress, Alert, Button } from '@mui/material';
+import { API_BASE_URL } from '../config.js';
+
+const CANVAS_WIDTH = 1000;
+const CANVAS_HEIGHT = 700;
+// Screen size a tile should roughly occupy before we descend a zoom level
+const TARGET_TILE_PIXELS = 512;
+const DMR_COLOR = '#1976d2';
+const GENE_COLOR = '#dc004e';
+
+// Whole-timepoint map drawn from the precomputed overview tiles
+function OverviewMapView({ timepointId }) {
+    const canvasRef = useRef(null);
+    const tileCache = useRef(new Map());
+    const dragState = useRef(null);
+    const [metadata, setMetadata] = useState(null);
+    const [loading, setLoading] = useState(true);
+    const [error, setError] = useState(null);
+    // World -> screen transform: screen = world * scale + offset
+    const [view, setView] = useState({ scale: 1, offsetX: 0, offsetY: 0 });
+    const [, setTileVersion] = useState(0);
+
+    const resetView = useCallback((meta) => {
+        const scale = Math.min(CANVAS_WIDTH, CANVAS_HEIGHT) / meta.canvas_size;
+        setView({ scale, offsetX: 0, offsetY: 0 });
+    }, []);
+
+    useEffect(() => {
+        tileCache.current = new Map();
+        setLoading(true);
+        setError(null);
+        fetch(`${API_BASE_URL}/overview/${timepointId}/metadata`)
+            .then((res) => res.json())
+            .then((data) => {
+                if (data.status !== 'success') {
+                    throw new Error(data.message || 'Failed to load overview');
+                }
+                setMetadata(data.data);
+                resetView(data.data);
+                setLoading(false);
+            })
+            .catch((err) => {
+                console.error('Error fetching overview metadata:', err);
+                setError(err.message);
+                setLoading(false);
+            });
+    }, [timepointId, resetView]);
+
+    const requestTile = useCallback((key) => {
+        if (tileCache.current.has(key)) {
+            return tileCache.current.get(key);
+        }
+        tileCache.current.set(key, null);
+        fetch(`${API_BASE_URL}/overview/${timepointId}/tiles/${metadata.build_id}/${key}`)
+            .then((res) => (res.status === 200 ? res.json() : null))
+            .then((tile) => {
+                tileCache.current.set(key, tile);
+                setTileVersion((v) => v + 1);
+            })
+            .catch((err) => console.error(`Error fetching tile ${key}:`, err));
+        return null;
+    }, [timepointId, metadata]);
+
+    // Walk the quadtree from the root, stopping at leaves or at tiles that are
+    // already detailed enough for the current scale
+    const visibleTiles = useCallback(() => {
+        if (!metadata) return [];
+        const result = [];
+        const stack = [[0, 0, 0]];
+        while (stack.length) {
+            const [z, x, y] = stack.pop();
+            const span = metadata.canvas_size / 2 ** z;
+            const sx = x * span * view.scale + view.offsetX;
+            const sy = y * span * view.scale + view.offsetY;
+            const size = span * view.scale;
+            if (sx > CANVAS_WIDTH || sy > CANVAS_HEIGHT || sx + size < 0 || sy + size < 0) {
+                continue;
+            }
+            const key = `${z}/${x}/${y}`;
+            const mode = metadata.tiles[key];
+            if (!mode) continue;
+            if (mode === 'density' && size > TARGET_TILE_PIXELS) {
+                const children = [[0, 0], [1, 0], [0, 1], [1, 1]]
+                    .map(([dx, dy]) => [z + 1, 2 * x + dx, 2 * y + dy])
+                    .filter(([cz, cx, cy]) => metadata.tiles[`${cz}/${cx}/${cy}`]);
+                if (children.length) {
+                    stack.push(...children);
+                    continue;
+                }
+            }
+            result.push({ key, sx, sy, size });
+        }
+        return result;
+    }, [metadata, view]);
+
+    useEffect(() => {
+        const canvas = canvasRef.current;
+        if (!canvas || !metadata) return;
+        const ctx = canvas.getContext('2d');
+        ctx.clearRect(0, 0, CANVAS_WIDTH, CANVAS_HEIGHT);
+
+        visibleTiles().forEach(({ key, sx, sy, size }) => {
+            const tile = requestTile(key);
+            if (!tile) return;
+            const unit = size / tile.extent;
+
+            if (tile.mode === 'density') {
+                const cell = size / tile.bins;
+                const maxCount = Math.max(...tile.cells.map((c) => c[2] + c[3]), 1);
+                tile.cells.forEach(([bx, by, dmrs, genes]) => {
+                    const alpha = 0.15 + 0.85 * ((dmrs + genes) / maxCount);
+                    ctx.fillStyle = dmrs >= genes ? DMR_COLOR : GENE_COLOR;
+                    ctx.globalAlpha = alpha;
+                    ctx.fillRect(sx + bx * cell, sy + by * cell, cell, cell);
+                });
+                ctx.globalAlpha = 1;
+                return;
+            }
+
+            const { x, y, type } = tile.nodes;
+            ctx.strokeStyle = 'rgba(120, 120, 120, 0.4)';
+            ctx.lineWidth = 0.5;
+            ctx.beginPath();
+            tile.edges.forEach(([a, b]) => {
+                ctx.moveTo(sx + x[a] * unit, sy + y[a] * unit);
+                ctx.lineTo(sx + x[b] * unit, sy + y[b] * unit);
+            });
+            // Edges leaving the tile are drawn from both sides
+            tile.external_edges.forEach(([a, ex, ey]) => {
+                ctx.moveTo(sx + x[a] * unit, sy + y[a] * unit);
+                ctx.lineTo(sx + ex * unit, sy + ey * unit);
+            });
+            ctx.stroke();
+
+            const radius = Math.max(1.5, Math.min(5, view.scale * 0.3));
+            x.forEach((nx, i) => {
+                ctx.fillStyle = type[i] === 0 ? DMR_COLOR : GENE_COLOR;
+                ctx.beginPath();
+                ctx.arc(sx + nx * unit, sy + y[i] * unit, radius, 0, 2 * Math.PI);
+                ctx.fill();
+            });
+        });
+    });
+
+    const handleWheel = (event) => {
+        event.preventDefault();
+        const rect = canvasRef.current.getBoundingClientRect();
+        const mx = event.clientX - rect.left;
+        const my = event.clientY - rect.top;
+        const factor = event.deltaY < 0 ? 1.25 : 0.8;
+        setView((v) => ({
+            scale: v.scale * factor,
+            offsetX: mx - (mx - v.offsetX) * factor,
+            offsetY: my - (my - v.offsetY) * factor,
+        }));
+    };
+
+    const handleMouseDown = (event) => {
+        dragState.current = { x: event.clientX, y: event.clientY };
+    };
+
+    const handleMouseMove = (event) => {
+        if (!dragState.current) return;
+        const dx = event.clientX - dragState.current.x;
+        const dy = event.clientY - dragState.current.y;
+        dragState.current = { x: event.clientX, y: event.clientY };
+        setView((v) => ({ ...v, offsetX: v.offsetX + dx, offsetY: v.offsetY + dy }));
+    };
+
+    const handleMouseUp = () => {
+        dragState.current = null;
+    };
+
+    if (loading) {
+        return (
+            <Box sx={{ display: 'flex', justifyContent: 'center', p: 3 }}>
+                <CircularProgress />
+            </Box>
+        );
+    }
+
+    if (error) {
+        return <Alert severity="info">Overview map unavailable: {error}</Alert>;
+    }
+
+    return (
+        <Paper elevation={3} sx={{ p: 2 }}>
+            <Box sx={{ display: 'flex', justifyContent: 'space-between', alignItems: 'center', mb: 1 }}>
+                <Typography variant="h6">
+                    Timepoint Overview ({metadata.node_count} nodes, {metadata.edge_count} edges, {metadata.components.length} components)
+                </Typography>
+                <Button size="small" onClick={() => resetView(metadata)}>
+                    Reset view
+                </Button>
+            </Box>
+            <canvas
+                ref={canvasRef}
+                width={CANVAS_WIDTH}
+                height={CANVAS_HEIGHT}
+                style={{ border: '1px solid #ddd', cursor: 'grab', maxWidth: '100%' }}
+                onWheel={handleWheel}
+                onMouseDown={handleMouseDown}
+                onMouseMove={handleMouseMove}
+                onMouseUp={handleMouseUp}
+                onMouseLeave={handleMouseUp}
+            />
+        </Paper>
+    );
+}
+
+export default OverviewMapView;